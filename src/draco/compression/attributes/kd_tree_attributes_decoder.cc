@@ -13,10 +13,15 @@
 // limitations under the License.
 //
 #include "draco/compression/attributes/kd_tree_attributes_decoder.h"
+
+#include <cmath>
+#include <limits>
+
 #include "draco/compression/attributes/kd_tree_attributes_shared.h"
 #include "draco/compression/point_cloud/algorithms/dynamic_integer_points_kd_tree_decoder.h"
 #include "draco/compression/point_cloud/algorithms/float_points_tree_decoder.h"
 #include "draco/compression/point_cloud/point_cloud_decoder.h"
+#include "draco/core/quantization_utils.h"
 
 namespace draco {
 
@@ -59,6 +64,132 @@ class PointAttributeVectorOutputIterator {
   PointIndex point_id_;
 };
 
+// Output iterator that dequantizes decoded integer points and stores them
+// into a float PointAttribute.
+class DequantizedPointAttributeOutputIterator {
+  typedef DequantizedPointAttributeOutputIterator Self;
+
+ public:
+  DequantizedPointAttributeOutputIterator(PointAttribute *att,
+                                          const Dequantizer *dequantizer,
+                                          const float *origin)
+      : attribute_(att),
+        dequantizer_(dequantizer),
+        origin_(origin),
+        point_id_(0) {}
+
+  const Self &operator++() {
+    ++point_id_;
+    return *this;
+  }
+  Self operator++(int) {
+    Self copy = *this;
+    ++point_id_;
+    return copy;
+  }
+  Self &operator*() { return *this; }
+  const Self &operator=(const std::vector<uint32_t> &val) {
+    DCHECK_EQ(val.size(), 3);
+    float value[3];
+    for (int c = 0; c < 3; ++c) {
+      value[c] = (*dequantizer_)(val[c]) + origin_[c];
+    }
+    attribute_->SetAttributeValue(attribute_->mapped_index(point_id_), value);
+    return *this;
+  }
+
+ private:
+  PointAttribute *attribute_;
+  const Dequantizer *dequantizer_;
+  const float *origin_;
+  PointIndex point_id_;
+};
+
+namespace {
+
+// Parameters of the decoding of integer kD-trees stored on a grid spanning the
+// bounding box of the points.
+struct IntegerTreeDecodingParams {
+  KdTreeAttributesEncodingMethod method;
+  // Limits of kKdTreeLevelOrderEncoding.
+  int max_depth;
+  int64_t max_num_points;
+  // Query region of kKdTreeSubtreesEncoding.
+  uint32_t region_min[3];
+  uint32_t region_max[3];
+  // Number of threads used to decode subtrees of kKdTreeSubtreesEncoding.
+  int num_threads;
+};
+
+template <int compression_level_t, class OutputIteratorT>
+bool DecodeIntegerPoints(DecoderBuffer *in_buffer,
+                         const IntegerTreeDecodingParams &params,
+                         OutputIteratorT oit,
+                         uint32_t *out_num_decoded_points) {
+  DynamicIntegerPointsKdTreeDecoder<compression_level_t> decoder(3);
+  if (params.method ==
+      KdTreeAttributesEncodingMethod::kKdTreeSubtreesEncoding) {
+    return decoder.DecodePointsInRegion(in_buffer, params.region_min,
+                                        params.region_max, oit,
+                                        out_num_decoded_points,
+                                        params.num_threads);
+  }
+  return decoder.DecodePointsLevelOrder(in_buffer, oit, params.max_depth,
+                                        params.max_num_points,
+                                        out_num_decoded_points);
+}
+
+template <class OutputIteratorT>
+bool DecodeIntegerPoints(int compression_level, DecoderBuffer *in_buffer,
+                         const IntegerTreeDecodingParams &params,
+                         OutputIteratorT oit,
+                         uint32_t *out_num_decoded_points) {
+  switch (compression_level) {
+    case 0:
+      return DecodeIntegerPoints<0>(in_buffer, params, oit,
+                                    out_num_decoded_points);
+    case 1:
+      return DecodeIntegerPoints<1>(in_buffer, params, oit,
+                                    out_num_decoded_points);
+    case 2:
+      return DecodeIntegerPoints<2>(in_buffer, params, oit,
+                                    out_num_decoded_points);
+    case 3:
+      return DecodeIntegerPoints<3>(in_buffer, params, oit,
+                                    out_num_decoded_points);
+    case 4:
+      return DecodeIntegerPoints<4>(in_buffer, params, oit,
+                                    out_num_decoded_points);
+    case 5:
+      return DecodeIntegerPoints<5>(in_buffer, params, oit,
+                                    out_num_decoded_points);
+    case 6:
+      return DecodeIntegerPoints<6>(in_buffer, params, oit,
+                                    out_num_decoded_points);
+    default:
+      return false;
+  }
+}
+
+// Computes the range of integer values |q| for which
+// min_value <= q * scale + offset <= max_value. An empty range is returned as
+// |out_min| > |out_max|.
+void GetIntegerRange(float min_value, float max_value, double scale,
+                     double offset, uint32_t *out_min, uint32_t *out_max) {
+  const double max_uint32 = std::numeric_limits<uint32_t>::max();
+  const double low = std::ceil((min_value - offset) / scale);
+  const double high = std::floor((max_value - offset) / scale);
+  if (!(low <= high) || high < 0.0 || low > max_uint32) {
+    *out_min = 1;
+    *out_max = 0;
+    return;
+  }
+  *out_min = static_cast<uint32_t>(std::max(low, 0.0));
+  *out_max = static_cast<uint32_t>(std::min(high, max_uint32));
+}
+
+}  // namespace
+
 KdTreeAttributesDecoder::KdTreeAttributesDecoder() {}
 
 bool KdTreeAttributesDecoder::DecodePortableAttributes(
@@ -152,6 +283,12 @@ bool KdTreeAttributesDecoder::DecodeDataNeededByPortableTransforms(
       default:
         return false;
     }
+  } else if (method ==
+                 KdTreeAttributesEncodingMethod::kKdTreeLevelOrderEncoding ||
+             method ==
+                 KdTreeAttributesEncodingMethod::kKdTreeSubtreesEncoding) {
+    return DecodeIntegerTree(
+        in_buffer, static_cast<KdTreeAttributesEncodingMethod>(method), att);
   } else {
     // Invalid method.
     return false;
@@ -159,4 +296,90 @@ bool KdTreeAttributesDecoder::DecodeDataNeededByPortableTransforms(
   return true;
 }
 
+bool KdTreeAttributesDecoder::DecodeIntegerTree(
+    DecoderBuffer *in_buffer, KdTreeAttributesEncodingMethod method,
+    PointAttribute *att) {
+  uint8_t compression_level = 0;
+  if (!in_buffer->Decode(&compression_level))
+    return false;
+  if (6 < compression_level) {
+    LOGE("KdTreeAttributesDecoder: compression level %i not supported.\n",
+         compression_level);
+    return false;
+  }
+  uint32_t num_points;
+  if (!in_buffer->Decode(&num_points))
+    return false;
+  if (num_points != GetDecoder()->point_cloud()->num_points())
+    return false;
+
+  const DecoderOptions *const options = GetDecoder()->options();
+  IntegerTreeDecodingParams params;
+  params.method = method;
+  params.max_depth = options->GetGlobalInt("kd_tree_max_depth", -1);
+  params.max_num_points = options->GetGlobalInt("kd_tree_max_points", -1);
+  params.num_threads = options->GetGlobalInt("num_decoding_threads", 1);
+  float box_min[3], box_max[3];
+  const bool has_query_box =
+      options->GetGlobalVector("kd_tree_query_box_min", 3, box_min) &&
+      options->GetGlobalVector("kd_tree_query_box_max", 3, box_max);
+  for (int c = 0; c < 3; ++c) {
+    params.region_min[c] = 0;
+    params.region_max[c] = std::numeric_limits<uint32_t>::max();
+  }
+  uint32_t num_decoded_points = 0;
+  att->Reset(num_points);
+  if (att->data_type() == DT_FLOAT32) {
+    uint8_t quantization_bits;
+    if (!in_buffer->Decode(&quantization_bits))
+      return false;
+    if (quantization_bits < 1 || quantization_bits > 30)
+      return false;
+    float origin[3];
+    if (!in_buffer->Decode(origin, sizeof(origin)))
+      return false;
+    float range;
+    if (!in_buffer->Decode(&range))
+      return false;
+    Dequantizer dequantizer;
+    if (!dequantizer.Init(range, (1 << quantization_bits) - 1))
+      return false;
+    if (has_query_box) {
+      // Convert the query box to the quantized coordinates.
+      const double scale =
+          static_cast<double>(range) / ((1 << quantization_bits) - 1);
+      for (int c = 0; c < 3; ++c) {
+        GetIntegerRange(box_min[c], box_max[c], scale, origin[c],
+                        &params.region_min[c], &params.region_max[c]);
+      }
+    }
+    DequantizedPointAttributeOutputIterator out_it(att, &dequantizer, origin);
+    if (!DecodeIntegerPoints(compression_level, in_buffer, params, out_it,
+                             &num_decoded_points))
+      return false;
+  } else if (att->data_type() == DT_UINT32) {
+    if (has_query_box) {
+      for (int c = 0; c < 3; ++c) {
+        GetIntegerRange(box_min[c], box_max[c], 1.0, 0.0,
+                        &params.region_min[c], &params.region_max[c]);
+      }
+    }
+    PointAttributeVectorOutputIterator<uint32_t, 3> out_it(att);
+    if (!DecodeIntegerPoints(compression_level, in_buffer, params, out_it,
+                             &num_decoded_points))
+      return false;
+  } else {
+    return false;
+  }
+  if (num_decoded_points > num_points)
+    return false;
+  if (num_decoded_points < num_points) {
+    // Only a part of the tree was decoded or the points were filtered by the
+    // query box.
+    att->Resize(num_decoded_points);
+    GetDecoder()->point_cloud()->set_num_points(num_decoded_points);
+  }
+  return true;
+}
+
 }  // namespace draco
@@ -16,10 +16,26 @@
 #define DRACO_COMPRESSION_ATTRIBUTES_KD_TREE_ATTRIBUTES_DECODER_H_
 
 #include "draco/compression/attributes/attributes_decoder.h"
+#include "draco/compression/attributes/kd_tree_attributes_shared.h"
 
 namespace draco {
 
 // Decodes attributes encoded with the KdTreeAttributesEncoder.
+//
+// Attributes encoded with the level order kD-tree (see encoder option
+// "kd_tree_level_order") can be decoded only partially. The decoding is
+// controlled by the following global decoder options:
+//   "kd_tree_max_depth"  - maximum number of decoded levels of the tree.
+//   "kd_tree_max_points" - maximum number of decoded points.
+// Subtrees that are not decoded are replaced by single points and the number
+// of points of the decoded point cloud is reduced accordingly.
+//
+// Attributes encoded with independent subtrees (see encoder option
+// "kd_tree_subtree_points") can be queried by an axis aligned box given by
+// global decoder options "kd_tree_query_box_min" and "kd_tree_query_box_max"
+// (3 floats each). Only points inside of the box are decoded and subtrees
+// outside of the box are skipped. The subtrees are decoded in parallel when
+// the global decoder option "num_decoding_threads" is larger than 1.
 class KdTreeAttributesDecoder : public AttributesDecoder {
  public:
   KdTreeAttributesDecoder();
@@ -27,6 +43,13 @@ class KdTreeAttributesDecoder : public AttributesDecoder {
  protected:
   bool DecodePortableAttributes(DecoderBuffer *in_buffer) override;
   bool DecodeDataNeededByPortableTransforms(DecoderBuffer *in_buffer) override;
+
+ private:
+  // Decodes |att| encoded with kKdTreeLevelOrderEncoding or
+  // kKdTreeSubtreesEncoding.
+  bool DecodeIntegerTree(DecoderBuffer *in_buffer,
+                         KdTreeAttributesEncodingMethod method,
+                         PointAttribute *att);
 };
 
 }  // namespace draco
@@ -17,6 +17,7 @@
 #include "draco/compression/point_cloud/algorithms/dynamic_integer_points_kd_tree_encoder.h"
 #include "draco/compression/point_cloud/algorithms/float_points_tree_encoder.h"
 #include "draco/compression/point_cloud/point_cloud_encoder.h"
+#include "draco/core/quantization_utils.h"
 
 namespace draco {
 
@@ -65,6 +66,28 @@ class PointAttributeVectorIterator {
   PointIndex point_id_;
 };
 
+namespace {
+
+// Encodes |points| using the integer kD-tree with nodes stored either level by
+// level or in independently encoded subtrees of at most |max_subtree_points|
+// points. The subtrees are encoded using up to |num_threads| threads.
+template <int compression_level_t>
+bool EncodeIntegerPoints(std::vector<Point3ui> *points, uint32_t bit_length,
+                         KdTreeAttributesEncodingMethod method,
+                         uint32_t max_subtree_points, int num_threads,
+                         EncoderBuffer *out_buffer) {
+  DynamicIntegerPointsKdTreeEncoder<compression_level_t> points_encoder(3);
+  if (method == KdTreeAttributesEncodingMethod::kKdTreeSubtreesEncoding) {
+    return points_encoder.EncodePointsInSubtrees(
+        points->begin(), points->end(), bit_length, max_subtree_points,
+        out_buffer, num_threads);
+  }
+  return points_encoder.EncodePointsLevelOrder(points->begin(), points->end(),
+                                               bit_length, out_buffer);
+}
+
+}  // namespace
+
 KdTreeAttributesEncoder::KdTreeAttributesEncoder() {}
 
 KdTreeAttributesEncoder::KdTreeAttributesEncoder(int att_id)
@@ -90,6 +113,16 @@ bool KdTreeAttributesEncoder::EncodeDataNeededByPortableTransforms(
   const uint8_t compression_level =
       std::min(10 - encoder()->options()->GetSpeed(), 6);
   DCHECK_LE(compression_level, 6);
+  if (encoder()->options()->GetGlobalBool("kd_tree_level_order", false)) {
+    return EncodeIntegerTree(
+        att, KdTreeAttributesEncodingMethod::kKdTreeLevelOrderEncoding,
+        compression_level, out_buffer);
+  }
+  if (encoder()->options()->GetGlobalInt("kd_tree_subtree_points", 0) > 0) {
+    return EncodeIntegerTree(
+        att, KdTreeAttributesEncodingMethod::kKdTreeSubtreesEncoding,
+        compression_level, out_buffer);
+  }
   if (att->data_type() == DT_FLOAT32) {
     const int quantization_bits =
         encoder()->options()->GetAttributeInt(att_id, "quantization_bits", -1);
@@ -186,4 +219,109 @@ bool KdTreeAttributesEncoder::EncodeDataNeededByPortableTransforms(
   return true;
 }
 
+bool KdTreeAttributesEncoder::EncodeIntegerTree(
+    const PointAttribute *att, KdTreeAttributesEncodingMethod method,
+    uint8_t compression_level, EncoderBuffer *out_buffer) {
+  const uint32_t num_points = encoder()->point_cloud()->num_points();
+  std::vector<Point3ui> int_points(num_points);
+  uint32_t bit_length = 0;
+  if (att->data_type() == DT_FLOAT32) {
+    const int quantization_bits = encoder()->options()->GetAttributeInt(
+        GetAttributeId(0), "quantization_bits", -1);
+    if (quantization_bits <= 0 || quantization_bits > 30)
+      return false;
+    // Quantize the points to a grid covering their bounding box. Unlike
+    // kKdTreeQuantizationEncoding, the grid is not centered at the origin
+    // which preserves the precision of points placed far from the origin.
+    std::vector<Vector3f> points(num_points);
+    float min_values[3] = {0.f, 0.f, 0.f};
+    float max_values[3] = {0.f, 0.f, 0.f};
+    for (PointIndex i(0); i < num_points; ++i) {
+      Vector3f &point = points[i.value()];
+      att->GetMappedValue(i, &point[0]);
+      for (int c = 0; c < 3; ++c) {
+        if (i == 0 || point[c] < min_values[c])
+          min_values[c] = point[c];
+        if (i == 0 || point[c] > max_values[c])
+          max_values[c] = point[c];
+      }
+    }
+    float range = 0.f;
+    for (int c = 0; c < 3; ++c)
+      range = std::max(range, max_values[c] - min_values[c]);
+    if (range == 0.f)
+      range = 1.f;
+    Quantizer quantizer;
+    quantizer.Init(range, (1 << quantization_bits) - 1);
+    for (uint32_t i = 0; i < num_points; ++i) {
+      for (int c = 0; c < 3; ++c) {
+        int_points[i][c] = quantizer(points[i][c] - min_values[c]);
+      }
+    }
+    bit_length = quantization_bits;
+    out_buffer->Encode(static_cast<uint8_t>(method));
+    out_buffer->Encode(compression_level);
+    out_buffer->Encode(num_points);
+    out_buffer->Encode(static_cast<uint8_t>(quantization_bits));
+    out_buffer->Encode(min_values, sizeof(min_values));
+    out_buffer->Encode(range);
+  } else if (att->data_type() == DT_UINT32) {
+    typedef PointAttributeVectorIterator<uint32_t, 3> AttributeIterator;
+    AttributeIterator it(att);
+    std::copy(it, it + num_points, int_points.begin());
+    // Use only as many bits as needed by the largest value, so that the top
+    // levels of the tree are not spent on empty space.
+    uint32_t max_value = 0;
+    for (const Point3ui &point : int_points) {
+      for (int c = 0; c < 3; ++c)
+        max_value = std::max(max_value, point[c]);
+    }
+    bit_length = max_value ? bits::MostSignificantBit(max_value) + 1 : 1;
+    out_buffer->Encode(static_cast<uint8_t>(method));
+    out_buffer->Encode(compression_level);
+    out_buffer->Encode(num_points);
+  } else {
+    // Unsupported data type.
+    return false;
+  }
+
+  const uint32_t max_subtree_points =
+      encoder()->options()->GetGlobalInt("kd_tree_subtree_points", 0);
+  const int num_threads =
+      encoder()->options()->GetGlobalInt("num_encoding_threads", 1);
+  switch (compression_level) {
+    case 6:
+      return EncodeIntegerPoints<6>(&int_points, bit_length, method,
+                                    max_subtree_points, num_threads,
+                                    out_buffer);
+    case 5:
+      return EncodeIntegerPoints<5>(&int_points, bit_length, method,
+                                    max_subtree_points, num_threads,
+                                    out_buffer);
+    case 4:
+      return EncodeIntegerPoints<4>(&int_points, bit_length, method,
+                                    max_subtree_points, num_threads,
+                                    out_buffer);
+    case 3:
+      return EncodeIntegerPoints<3>(&int_points, bit_length, method,
+                                    max_subtree_points, num_threads,
+                                    out_buffer);
+    case 2:
+      return EncodeIntegerPoints<2>(&int_points, bit_length, method,
+                                    max_subtree_points, num_threads,
+                                    out_buffer);
+    case 1:
+      return EncodeIntegerPoints<1>(&int_points, bit_length, method,
+                                    max_subtree_points, num_threads,
+                                    out_buffer);
+    case 0:
+      return EncodeIntegerPoints<0>(&int_points, bit_length, method,
+                                    max_subtree_points, num_threads,
+                                    out_buffer);
+    // Compression level and/or encoding speed seem wrong.
+    default:
+      return false;
+  }
+}
+
 }  // namespace draco
@@ -16,6 +16,7 @@
 #define DRACO_COMPRESSION_ATTRIBUTES_POINT_CLOUD_KD_TREE_ATTRIBUTES_ENCODER_H_
 
 #include "draco/compression/attributes/attributes_encoder.h"
+#include "draco/compression/attributes/kd_tree_attributes_shared.h"
 #include "draco/compression/config/compression_shared.h"
 
 namespace draco {
@@ -33,6 +34,14 @@ class KdTreeAttributesEncoder : public AttributesEncoder {
  protected:
   bool EncodePortableAttributes(EncoderBuffer *out_buffer) override;
   bool EncodeDataNeededByPortableTransforms(EncoderBuffer *out_buffer) override;
+
+ private:
+  // Encodes |att| using one of the integer kD-tree methods that store the
+  // points on a grid spanning their bounding box (kKdTreeLevelOrderEncoding
+  // or kKdTreeSubtreesEncoding).
+  bool EncodeIntegerTree(const PointAttribute *att,
+                         KdTreeAttributesEncodingMethod method,
+                         uint8_t compression_level, EncoderBuffer *out_buffer);
 };
 
 }  // namespace draco
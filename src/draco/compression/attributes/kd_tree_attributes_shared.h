@@ -20,7 +20,13 @@ namespace draco {
 // Defines types of kD-tree compression
 enum KdTreeAttributesEncodingMethod {
   kKdTreeQuantizationEncoding = 0,
-  kKdTreeIntegerEncoding
+  kKdTreeIntegerEncoding,
+  // Integer kD-tree with nodes stored level by level. Floating point values
+  // are quantized to a grid spanning the bounding box of the points first.
+  kKdTreeLevelOrderEncoding,
+  // Integer kD-tree split into independently encoded subtrees that can be
+  // skipped by the decoder. Uses the same grid as kKdTreeLevelOrderEncoding.
+  kKdTreeSubtreesEncoding
 };
 
 }  // namespace draco
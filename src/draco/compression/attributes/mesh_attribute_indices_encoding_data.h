@@ -28,10 +28,22 @@ struct MeshAttributeIndicesEncodingData {
   MeshAttributeIndicesEncodingData() : num_values(0) {}
 
   void Initialize(int num_vertices) {
+    // Existing data is removed so that the instance can be reused.
+    vertex_to_encoded_attribute_value_index_map.clear();
     vertex_to_encoded_attribute_value_index_map.resize(num_vertices);
 
     // We expect to store one value for each vertex.
+    encoded_attribute_value_index_to_corner_map.clear();
     encoded_attribute_value_index_to_corner_map.reserve(num_vertices);
+    num_values = 0;
+  }
+
+  // Returns the number of bytes allocated by the encoding data.
+  size_t GetMemoryUsage() const {
+    return encoded_attribute_value_index_to_corner_map.capacity() *
+               sizeof(CornerIndex) +
+           vertex_to_encoded_attribute_value_index_map.capacity() *
+               sizeof(int32_t);
   }
 
   // Array for storing the corner ids in the order their associated attribute
@@ -86,22 +86,24 @@ bool MeshPredictionSchemeConstrainedMultiParallelogramDecoder<
 
   // Predicted values for all simple parallelograms encountered at any given
   // vertex.
-  std::vector<DataTypeT> pred_vals[kMaxNumParallelograms];
+  DataTypeT *pred_vals[kMaxNumParallelograms];
+  DataTypeT *const scratch_values =
+      this->GetScratchValues((kMaxNumParallelograms + 1) * num_components);
   for (int i = 0; i < kMaxNumParallelograms; ++i) {
-    pred_vals[i].resize(num_components, 0);
+    pred_vals[i] = scratch_values + i * num_components;
   }
-  this->transform().ComputeOriginalValue(pred_vals[0].data(), in_corr,
-                                         out_data);
+  this->transform().ComputeOriginalValue(pred_vals[0], in_corr, out_data);
 
   const CornerTable *const table = this->mesh_data().corner_table();
   const std::vector<int32_t> *const vertex_to_data_map =
       this->mesh_data().vertex_to_data_map();
 
   // Current position in the |is_crease_edge_| array for each context.
-  std::vector<int> is_crease_edge_pos(kMaxNumParallelograms, 0);
+  int is_crease_edge_pos[kMaxNumParallelograms] = {0};
 
   // Used to store predicted value for multi-parallelogram prediction.
-  std::vector<DataTypeT> multi_pred_vals(num_components);
+  DataTypeT *const multi_pred_vals =
+      scratch_values + kMaxNumParallelograms * num_components;
 
   const int corner_map_size = this->mesh_data().data_to_corner_map()->size();
   for (int p = 1; p < corner_map_size; ++p) {
@@ -114,7 +116,7 @@ bool MeshPredictionSchemeConstrainedMultiParallelogramDecoder<
     while (corner_id != kInvalidCornerIndex) {
       if (ComputeParallelogramPrediction(
               p, corner_id, table, *vertex_to_data_map, out_data,
-              num_components, &(pred_vals[num_parallelograms][0]))) {
+              num_components, pred_vals[num_parallelograms])) {
         // Parallelogram prediction applied and stored in
         // |pred_vals[num_parallelograms]|
         ++num_parallelograms;
@@ -173,7 +175,7 @@ bool MeshPredictionSchemeConstrainedMultiParallelogramDecoder<
         multi_pred_vals[c] /= num_used_parallelograms;
       }
       this->transform().ComputeOriginalValue(
-          multi_pred_vals.data(), in_corr + dst_offset, out_data + dst_offset);
+          multi_pred_vals, in_corr + dst_offset, out_data + dst_offset);
     }
   }
   return true;
@@ -61,11 +61,10 @@ bool MeshPredictionSchemeMultiParallelogramDecoder<DataTypeT, TransformT,
                           const PointIndex * /* entry_to_point_id_map */) {
   this->transform().Initialize(num_components);
 
-  std::unique_ptr<DataTypeT[]> pred_vals(new DataTypeT[num_components]());
-  std::unique_ptr<DataTypeT[]> parallelogram_pred_vals(
-      new DataTypeT[num_components]());
+  DataTypeT *const pred_vals = this->GetScratchValues(2 * num_components);
+  DataTypeT *const parallelogram_pred_vals = pred_vals + num_components;
 
-  this->transform().ComputeOriginalValue(pred_vals.get(), in_corr, out_data);
+  this->transform().ComputeOriginalValue(pred_vals, in_corr, out_data);
 
   const CornerTable *const table = this->mesh_data().corner_table();
   const std::vector<int32_t> *const vertex_to_data_map =
@@ -84,7 +83,7 @@ bool MeshPredictionSchemeMultiParallelogramDecoder<DataTypeT, TransformT,
     while (corner_id != kInvalidCornerIndex) {
       if (ComputeParallelogramPrediction(
               p, corner_id, table, *vertex_to_data_map, out_data,
-              num_components, parallelogram_pred_vals.get())) {
+              num_components, parallelogram_pred_vals)) {
         for (int c = 0; c < num_components; ++c) {
           pred_vals[c] += parallelogram_pred_vals[c];
         }
@@ -110,7 +109,7 @@ bool MeshPredictionSchemeMultiParallelogramDecoder<DataTypeT, TransformT,
         pred_vals[c] /= num_parallelograms;
       }
       this->transform().ComputeOriginalValue(
-          pred_vals.get(), in_corr + dst_offset, out_data + dst_offset);
+          pred_vals, in_corr + dst_offset, out_data + dst_offset);
     }
   }
   return true;
@@ -64,10 +64,10 @@ bool MeshPredictionSchemeParallelogramDecoder<DataTypeT, TransformT,
   const std::vector<int32_t> *const vertex_to_data_map =
       this->mesh_data().vertex_to_data_map();
 
-  std::unique_ptr<DataTypeT[]> pred_vals(new DataTypeT[num_components]());
+  DataTypeT *const pred_vals = this->GetScratchValues(num_components);
 
   // Restore the first value.
-  this->transform().ComputeOriginalValue(pred_vals.get(), in_corr, out_data);
+  this->transform().ComputeOriginalValue(pred_vals, in_corr, out_data);
 
   const int corner_map_size = this->mesh_data().data_to_corner_map()->size();
   for (int p = 1; p < corner_map_size; ++p) {
@@ -75,7 +75,7 @@ bool MeshPredictionSchemeParallelogramDecoder<DataTypeT, TransformT,
     const int dst_offset = p * num_components;
     if (!ComputeParallelogramPrediction(p, corner_id, table,
                                         *vertex_to_data_map, out_data,
-                                        num_components, pred_vals.get())) {
+                                        num_components, pred_vals)) {
       // Parallelogram could not be computed, Possible because some of the
       // vertices are not valid (not encoded yet).
       // We use the last encoded point as a reference (delta coding).
@@ -85,7 +85,7 @@ bool MeshPredictionSchemeParallelogramDecoder<DataTypeT, TransformT,
     } else {
       // Apply the parallelogram prediction.
       this->transform().ComputeOriginalValue(
-          pred_vals.get(), in_corr + dst_offset, out_data + dst_offset);
+          pred_vals, in_corr + dst_offset, out_data + dst_offset);
     }
   }
   return true;
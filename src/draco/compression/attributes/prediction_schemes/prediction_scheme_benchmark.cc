@@ -0,0 +1,210 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "benchmark/benchmark.h"
+#include "draco/compression/attributes/normal_compression_utils.h"
+#include "draco/compression/attributes/prediction_schemes/prediction_scheme_decoder_factory.h"
+#include "draco/compression/attributes/prediction_schemes/prediction_scheme_encoder_factory.h"
+#include "draco/compression/attributes/prediction_schemes/prediction_scheme_normal_octahedron_canonicalized_decoding_transform.h"
+#include "draco/compression/attributes/prediction_schemes/prediction_scheme_normal_octahedron_canonicalized_encoding_transform.h"
+#include "draco/compression/attributes/prediction_schemes/prediction_scheme_wrap_decoding_transform.h"
+#include "draco/compression/attributes/prediction_schemes/prediction_scheme_wrap_encoding_transform.h"
+#include "draco/core/draco_benchmark_utils.h"
+#include "draco/mesh/mesh_misc_functions.h"
+
+namespace draco {
+
+namespace {
+
+constexpr int kGridSize = 256;
+constexpr int kNormalQuantizationBits = 10;
+
+// Grid mesh with its connectivity and quantized attribute values as they are
+// seen by the prediction schemes. Attribute values are ordered by the vertex
+// ids of the corner table.
+struct PredictionSchemeBenchmarkMesh {
+  std::unique_ptr<Mesh> mesh;
+  std::unique_ptr<CornerTable> corner_table;
+  std::vector<CornerIndex> data_to_corner_map;
+  std::vector<int32_t> vertex_to_data_map;
+  std::vector<PointIndex> entry_to_point_id_map;
+  // Quantized values of all attributes of |mesh| indexed by attribute id.
+  std::vector<std::vector<int32_t>> values;
+};
+
+const PredictionSchemeBenchmarkMesh &GetBenchmarkMesh() {
+  static const PredictionSchemeBenchmarkMesh *const benchmark_mesh = [] {
+    PredictionSchemeBenchmarkMesh *const data =
+        new PredictionSchemeBenchmarkMesh();
+    data->mesh = CreateGridMesh(kGridSize);
+    data->corner_table = CreateCornerTableFromPositionAttribute(
+        data->mesh.get());
+    const int num_vertices = data->corner_table->num_vertices();
+    for (VertexIndex v(0); v < num_vertices; ++v) {
+      data->data_to_corner_map.push_back(data->corner_table->LeftMostCorner(v));
+      data->vertex_to_data_map.push_back(v.value());
+      data->entry_to_point_id_map.push_back(PointIndex(v.value()));
+    }
+    const OctahedronToolBox octahedron_tool_box(kNormalQuantizationBits);
+    data->values.resize(data->mesh->num_attributes());
+    for (int att_id = 0; att_id < data->mesh->num_attributes(); ++att_id) {
+      const PointAttribute *const att = data->mesh->attribute(att_id);
+      std::vector<int32_t> &values = data->values[att_id];
+      for (int i = 0; i < num_vertices; ++i) {
+        float value[3];
+        att->GetMappedValue(PointIndex(i), value);
+        if (att->attribute_type() == GeometryAttribute::NORMAL) {
+          int32_t s, t;
+          octahedron_tool_box.FloatVectorToQuantizedOctahedralCoords(value, &s,
+                                                                     &t);
+          values.push_back(s);
+          values.push_back(t);
+        } else if (att->attribute_type() == GeometryAttribute::TEX_COORD) {
+          values.push_back(static_cast<int32_t>(value[0] * 4095.f));
+          values.push_back(static_cast<int32_t>(value[1] * 4095.f));
+        } else {
+          for (int c = 0; c < 3; ++c) {
+            values.push_back(static_cast<int32_t>(value[c] * 64.f));
+          }
+        }
+      }
+    }
+    return data;
+  }();
+  return *benchmark_mesh;
+}
+
+// Computes corrections of the attribute of type |att_type| using the encoder
+// of prediction scheme |method| and measures how fast the decoder of the same
+// prediction scheme reverts them. The measured time includes decoding of the
+// prediction data.
+template <class EncodingTransformT, class DecodingTransformT>
+void BenchmarkComputeOriginalValues(benchmark::State &state,
+                                    PredictionSchemeMethod method,
+                                    GeometryAttribute::Type att_type,
+                                    const EncodingTransformT &enc_transform) {
+  typedef MeshPredictionSchemeData<CornerTable> MeshData;
+  const PredictionSchemeBenchmarkMesh &data = GetBenchmarkMesh();
+  MeshData mesh_data;
+  mesh_data.Set(data.mesh.get(), data.corner_table.get(),
+                &data.data_to_corner_map, &data.vertex_to_data_map);
+  const int att_id = data.mesh->GetNamedAttributeId(att_type);
+  const PointAttribute *const att = data.mesh->attribute(att_id);
+  const PointAttribute *const pos_att =
+      data.mesh->GetNamedAttribute(GeometryAttribute::POSITION);
+  const std::vector<int32_t> &values = data.values[att_id];
+  const int num_components = att_type == GeometryAttribute::POSITION ? 3 : 2;
+
+  std::unique_ptr<PredictionSchemeEncoder<int32_t, EncodingTransformT>>
+      encoder;
+  if (method == PREDICTION_DIFFERENCE) {
+    encoder.reset(new PredictionSchemeDeltaEncoder<int32_t, EncodingTransformT>(
+        att, enc_transform));
+  } else {
+    encoder = MeshPredictionSchemeEncoderFactory<int32_t>()(
+        method, att, enc_transform, mesh_data, kDracoBitstreamVersion);
+  }
+  if (encoder->GetNumParentAttributes() > 0)
+    encoder->SetParentAttribute(pos_att);
+  std::vector<int32_t> corrections(values.size());
+  EncoderBuffer encoder_buffer;
+  if (!encoder->ComputeCorrectionValues(
+          values.data(), corrections.data(), static_cast<int>(values.size()),
+          num_components, data.entry_to_point_id_map.data()) ||
+      !encoder->EncodePredictionData(&encoder_buffer)) {
+    state.SkipWithError("Failed to compute the corrections.");
+    return;
+  }
+
+  std::vector<int32_t> decoded_values(values.size());
+  for (auto _ : state) {
+    std::unique_ptr<PredictionSchemeDecoder<int32_t, DecodingTransformT>>
+        decoder;
+    if (method == PREDICTION_DIFFERENCE) {
+      decoder.reset(
+          new PredictionSchemeDeltaDecoder<int32_t, DecodingTransformT>(att));
+    } else {
+      decoder = MeshPredictionSchemeDecoderFactory<int32_t>()(
+          method, att, DecodingTransformT(), mesh_data,
+          kDracoBitstreamVersion);
+    }
+    if (decoder->GetNumParentAttributes() > 0)
+      decoder->SetParentAttribute(pos_att);
+    DecoderBuffer buffer;
+    buffer.Init(encoder_buffer.data(), encoder_buffer.size(),
+                kDracoBitstreamVersion);
+    if (!decoder->DecodePredictionData(&buffer) ||
+        !decoder->ComputeOriginalValues(
+            corrections.data(), decoded_values.data(),
+            static_cast<int>(values.size()), num_components,
+            data.entry_to_point_id_map.data())) {
+      state.SkipWithError("Failed to compute the original values.");
+      break;
+    }
+    benchmark::DoNotOptimize(decoded_values.data());
+  }
+  if (decoded_values != values)
+    state.SkipWithError("Decoded values don't match the encoded values.");
+  state.SetItemsProcessed(state.iterations() * values.size() /
+                          num_components);
+}
+
+// Benchmarks prediction schemes with the wrap transform that are used for
+// generic attributes such as positions and texture coordinates.
+void BM_ComputeOriginalValuesWrap(benchmark::State &state,
+                                  PredictionSchemeMethod method,
+                                  GeometryAttribute::Type att_type) {
+  typedef PredictionSchemeWrapEncodingTransform<int32_t> EncodingTransform;
+  typedef PredictionSchemeWrapDecodingTransform<int32_t> DecodingTransform;
+  BenchmarkComputeOriginalValues<EncodingTransform, DecodingTransform>(
+      state, method, att_type, EncodingTransform());
+}
+BENCHMARK_CAPTURE(BM_ComputeOriginalValuesWrap, difference,
+                  PREDICTION_DIFFERENCE, GeometryAttribute::POSITION);
+BENCHMARK_CAPTURE(BM_ComputeOriginalValuesWrap, parallelogram,
+                  MESH_PREDICTION_PARALLELOGRAM, GeometryAttribute::POSITION);
+#ifdef DRACO_BACKWARDS_COMPATIBILITY_SUPPORTED
+BENCHMARK_CAPTURE(BM_ComputeOriginalValuesWrap, multi_parallelogram,
+                  MESH_PREDICTION_MULTI_PARALLELOGRAM,
+                  GeometryAttribute::POSITION);
+#endif
+BENCHMARK_CAPTURE(BM_ComputeOriginalValuesWrap, constrained_multi_parallelogram,
+                  MESH_PREDICTION_CONSTRAINED_MULTI_PARALLELOGRAM,
+                  GeometryAttribute::POSITION);
+BENCHMARK_CAPTURE(BM_ComputeOriginalValuesWrap, tex_coords_portable,
+                  MESH_PREDICTION_TEX_COORDS_PORTABLE,
+                  GeometryAttribute::TEX_COORD);
+
+// Benchmarks prediction schemes with the canonicalized octahedron transform
+// that are used for normals.
+void BM_ComputeOriginalValuesNormal(benchmark::State &state,
+                                    PredictionSchemeMethod method) {
+  typedef PredictionSchemeNormalOctahedronCanonicalizedEncodingTransform<
+      int32_t>
+      EncodingTransform;
+  typedef PredictionSchemeNormalOctahedronCanonicalizedDecodingTransform<
+      int32_t>
+      DecodingTransform;
+  BenchmarkComputeOriginalValues<EncodingTransform, DecodingTransform>(
+      state, method, GeometryAttribute::NORMAL,
+      EncodingTransform((1 << kNormalQuantizationBits) - 1));
+}
+BENCHMARK_CAPTURE(BM_ComputeOriginalValuesNormal, difference,
+                  PREDICTION_DIFFERENCE);
+BENCHMARK_CAPTURE(BM_ComputeOriginalValuesNormal, geometric_normal,
+                  MESH_PREDICTION_GEOMETRIC_NORMAL);
+
+}  // namespace
+
+}  // namespace draco
@@ -15,10 +15,12 @@
 #ifndef DRACO_COMPRESSION_ATTRIBUTES_PREDICTION_SCHEMES_PREDICTION_SCHEME_DECODER_H_
 #define DRACO_COMPRESSION_ATTRIBUTES_PREDICTION_SCHEMES_PREDICTION_SCHEME_DECODER_H_
 
+#include <algorithm>
 #include <type_traits>
 
 #include "draco/compression/attributes/prediction_schemes/prediction_scheme_decoder_interface.h"
 #include "draco/compression/attributes/prediction_schemes/prediction_scheme_decoding_transform.h"
+#include "draco/core/arena.h"
 
 // Prediction schemes can be used during encoding and decoding of vertex
 // attributes to predict attribute values based on the previously
@@ -48,6 +50,13 @@ class PredictionSchemeDecoder : public PredictionSchemeTypedDecoderInterface<
   bool DecodePredictionData(DecoderBuffer *buffer) override {
     if (!transform_.DecodeTransformData(buffer))
       return false;
+    // The scratch values are allocated here and not in
+    // ComputeOriginalValues(), because the original values can be computed
+    // on a worker thread where the arena of |buffer| must not be used.
+    const int num_components = attribute_ ? attribute_->num_components() : 0;
+    scratch_values_ = ArenaVector<DataTypeT>(
+        kMaxNumScratchVectors * num_components, DataTypeT(),
+        ArenaAllocator<DataTypeT>(buffer->arena()));
     return true;
   }
 
@@ -75,13 +84,33 @@ class PredictionSchemeDecoder : public PredictionSchemeTypedDecoderInterface<
   }
 
  protected:
+  // Maximum number of vectors of attribute components that can be requested
+  // from GetScratchValues() without a heap allocation.
+  static constexpr int kMaxNumScratchVectors = 5;
+
   inline const PointAttribute *attribute() const { return attribute_; }
   inline const Transform &transform() const { return transform_; }
   inline Transform &transform() { return transform_; }
 
+  // Returns |num_values| zero-initialized values that can be used as
+  // temporary storage by ComputeOriginalValues(). The storage is allocated
+  // from the scratch arena of the decoder by DecodePredictionData() and only
+  // larger requests (or calls without decoded prediction data) are allocated
+  // on the heap. The values are valid until the next call.
+  DataTypeT *GetScratchValues(int num_values) {
+    if (scratch_values_.size() < static_cast<size_t>(num_values)) {
+      scratch_values_ = ArenaVector<DataTypeT>(num_values, DataTypeT());
+    } else {
+      std::fill(scratch_values_.begin(), scratch_values_.begin() + num_values,
+                DataTypeT());
+    }
+    return scratch_values_.data();
+  }
+
  private:
   const PointAttribute *attribute_;
   Transform transform_;
+  ArenaVector<DataTypeT> scratch_values_;
 };
 
 }  // namespace draco
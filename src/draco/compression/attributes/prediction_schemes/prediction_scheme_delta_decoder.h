@@ -49,8 +49,8 @@ bool PredictionSchemeDeltaDecoder<DataTypeT, TransformT>::ComputeOriginalValues(
     const PointIndex *) {
   this->transform().Initialize(num_components);
   // Decode the original value for the first element.
-  std::unique_ptr<DataTypeT[]> zero_vals(new DataTypeT[num_components]());
-  this->transform().ComputeOriginalValue(zero_vals.get(), in_corr, out_data);
+  const DataTypeT *const zero_vals = this->GetScratchValues(num_components);
+  this->transform().ComputeOriginalValue(zero_vals, in_corr, out_data);
 
   // Decode data from the front using D(i) = D(i) + D(i - 1).
   for (int i = num_components; i < size; i += num_components) {
@@ -75,6 +75,7 @@ bool SequentialAttributeDecoder::InitPredictionScheme(
         ps->GetParentAttributeType(i));
     if (att_id == -1)
       return false;  // Requested attribute does not exist.
+    parent_attribute_ids_.push_back(att_id);
 #ifdef DRACO_BACKWARDS_COMPATIBILITY_SUPPORTED
     if (decoder_->bitstream_version() < DRACO_BITSTREAM_VERSION(2, 0)) {
       if (!ps->SetParentAttribute(decoder_->point_cloud()->attribute(att_id))) {
@@ -47,8 +47,24 @@ class SequentialAttributeDecoder {
   virtual bool TransformAttributeToOriginalFormat(
       const std::vector<PointIndex> &point_ids);
 
+  // Finishes decoding of the portable attribute when part of the work was
+  // postponed in DecodePortableAttribute() because parallel attribute
+  // decoding is enabled (see PointCloudDecoder::AddDeferredAttributeTask()).
+  // Unlike DecodePortableAttribute(), this method does not access the input
+  // buffer and it can be called concurrently for different attributes.
+  virtual bool FinishDecodingPortableAttribute(
+      const std::vector<PointIndex> & /* point_ids */) {
+    return true;
+  }
+
   const PointAttribute *GetPortableAttribute();
 
+  // Returns ids of attributes whose portable data are used for decoding of
+  // this attribute (e.g. by the prediction scheme).
+  const std::vector<int32_t> &parent_attribute_ids() const {
+    return parent_attribute_ids_;
+  }
+
   const PointAttribute *attribute() const { return attribute_; }
   PointAttribute *attribute() { return attribute_; }
   int attribute_id() const { return attribute_id_; }
@@ -78,6 +94,8 @@ class SequentialAttributeDecoder {
 
   // Storage for decoded portable attribute (after lossless decoding).
   std::unique_ptr<PointAttribute> portable_attribute_;
+
+  std::vector<int32_t> parent_attribute_ids_;
 };
 
 }  // namespace draco
@@ -85,29 +85,54 @@ bool SequentialAttributeDecodersController::
     TransformAttributesToOriginalFormat() {
   const int32_t num_attributes = GetNumAttributes();
   for (int i = 0; i < num_attributes; ++i) {
-    // Check whether the attribute transform should be skipped.
-    if (GetDecoder()->options()) {
-      const PointAttribute *const attribute =
-          sequential_decoders_[i]->attribute();
-      if (GetDecoder()->options()->GetAttributeBool(
-              attribute->attribute_type(), "skip_attribute_transform", false)) {
-        // Attribute transform should not be performed. In this case, we replace
-        // the output geometry attribute with the portable attribute.
-        // TODO(ostava): We can potentially avoid this copy by introducing a new
-        // mechanism that would allow to use the final attributes as portable
-        // attributes for predictors that may need them.
-        sequential_decoders_[i]->attribute()->CopyFrom(
-            *sequential_decoders_[i]->GetPortableAttribute());
-        return true;
-      }
+    if (GetDecoder()->IsParallelAttributeDecodingEnabled()) {
+      // Finish the decoding together with the transform later, possibly in
+      // parallel with other attributes.
+      SequentialAttributeDecoder *const decoder = sequential_decoders_[i].get();
+      GetDecoder()->AddDeferredAttributeTask(
+          decoder->attribute_id(), decoder->parent_attribute_ids(),
+          [this, i]() {
+            if (!sequential_decoders_[i]->FinishDecodingPortableAttribute(
+                    point_ids_))
+              return false;
+            return TransformAttributeToOriginalFormat(i);
+          });
+      continue;
     }
-    if (!sequential_decoders_[i]->TransformAttributeToOriginalFormat(
-            point_ids_))
+    if (!TransformAttributeToOriginalFormat(i))
       return false;
   }
   return true;
 }
 
+bool SequentialAttributeDecodersController::TransformAttributeToOriginalFormat(
+    int local_id) {
+  SequentialAttributeDecoder *const decoder =
+      sequential_decoders_[local_id].get();
+  if (GetDecoder()->options()) {
+    // The caller is going to read the values directly from the portable
+    // attributes (see MeshBufferDecoder).
+    if (GetDecoder()->options()->GetGlobalBool(
+            "decode_portable_attributes_only", false))
+      return true;
+    // Check whether the attribute transform should be skipped.
+    const PointAttribute *const attribute = decoder->attribute();
+    if (GetDecoder()->options()->GetAttributeBool(
+            attribute->attribute_type(), "skip_attribute_transform", false)) {
+      // Attribute transform should not be performed. In this case, we replace
+      // the output geometry attribute with the portable attribute.
+      // TODO(ostava): We can potentially avoid this copy by introducing a new
+      // mechanism that would allow to use the final attributes as portable
+      // attributes for predictors that may need them.
+      decoder->attribute()->CopyFrom(*decoder->GetPortableAttribute());
+      return true;
+    }
+  }
+  CodingStatsScope scope(GetDecoder()->stats(), "transform",
+                         decoder->attribute_id());
+  return decoder->TransformAttributeToOriginalFormat(point_ids_);
+}
+
 std::unique_ptr<SequentialAttributeDecoder>
 SequentialAttributeDecodersController::CreateSequentialDecoder(
     uint8_t decoder_type) {
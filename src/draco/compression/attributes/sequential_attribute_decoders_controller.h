@@ -46,6 +46,8 @@ class SequentialAttributeDecodersController : public AttributesDecoder {
   bool DecodePortableAttributes(DecoderBuffer *in_buffer) override;
   bool DecodeDataNeededByPortableTransforms(DecoderBuffer *in_buffer) override;
   bool TransformAttributesToOriginalFormat() override;
+  // Transforms a single attribute identified by its |local_id|.
+  bool TransformAttributeToOriginalFormat(int local_id);
   virtual std::unique_ptr<SequentialAttributeDecoder> CreateSequentialDecoder(
       uint8_t decoder_type);
 
@@ -63,6 +63,8 @@ bool SequentialAttributeEncodersController::EncodeAttributes(
 bool SequentialAttributeEncodersController::
     TransformAttributesToPortableFormat() {
   for (uint32_t i = 0; i < sequential_encoders_.size(); ++i) {
+    CodingStatsScope scope(encoder()->stats(), "transform",
+                           sequential_encoders_[i]->attribute_id());
     if (!sequential_encoders_[i]->TransformAttributeToPortableFormat(
             point_ids_))
       return false;
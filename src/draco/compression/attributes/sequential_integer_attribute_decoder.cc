@@ -16,6 +16,7 @@
 
 #include "draco/compression/attributes/prediction_schemes/prediction_scheme_decoder_factory.h"
 #include "draco/compression/attributes/prediction_schemes/prediction_scheme_wrap_decoding_transform.h"
+#include "draco/core/coding_stats.h"
 #include "draco/core/symbol_decoding.h"
 
 namespace draco {
@@ -29,6 +30,21 @@ bool SequentialIntegerAttributeDecoder::Initialize(PointCloudDecoder *decoder,
   return true;
 }
 
+bool SequentialIntegerAttributeDecoder::DecodePortableAttribute(
+    const std::vector<PointIndex> &point_ids, DecoderBuffer *in_buffer) {
+  if (decoder() && decoder()->options() &&
+      decoder()->bitstream_version() >= DRACO_BITSTREAM_VERSION(2, 0) &&
+      decoder()->options()->GetGlobalBool("decode_portable_attributes_only",
+                                          false)) {
+    // The values are never transformed into the final attribute so there is
+    // no need to allocate its storage. All values are decoded into the
+    // portable attribute.
+    return DecodeValues(point_ids, in_buffer);
+  }
+  return SequentialAttributeDecoder::DecodePortableAttribute(point_ids,
+                                                             in_buffer);
+}
+
 bool SequentialIntegerAttributeDecoder::TransformAttributeToOriginalFormat(
     const std::vector<PointIndex> &point_ids) {
 #ifdef DRACO_BACKWARDS_COMPATIBILITY_SUPPORTED
@@ -92,38 +108,65 @@ bool SequentialIntegerAttributeDecoder::DecodeIntegerValues(
   const size_t num_values = num_entries * num_components;
   PreparePortableAttribute(num_entries, num_components);
   int32_t *const portable_attribute_data = GetPortableAttributeData();
-  uint8_t compressed;
-  if (!in_buffer->Decode(&compressed))
-    return false;
-  if (compressed > 0) {
-    // Decode compressed values.
-    if (!DecodeSymbols(num_values, num_components, in_buffer,
-                       reinterpret_cast<uint32_t *>(portable_attribute_data)))
-      return false;
-  } else {
-    // Decode the integer data directly.
-    // Get the number of bytes for a given entry.
-    uint8_t num_bytes;
-    if (!in_buffer->Decode(&num_bytes))
+  {
+    CodingStatsScope scope(decoder() ? decoder()->stats() : nullptr,
+                           "entropy", attribute_id(), in_buffer);
+    uint8_t compressed;
+    if (!in_buffer->Decode(&compressed))
       return false;
-    if (num_bytes == DataTypeLength(DT_INT32)) {
-      if (portable_attribute()->buffer()->data_size() <
-          sizeof(int32_t) * num_values)
-        return false;
-      if (!in_buffer->Decode(portable_attribute_data,
-                             sizeof(int32_t) * num_values))
+    if (compressed > 0) {
+      // Decode compressed values.
+      if (!DecodeSymbols(num_values, num_components, in_buffer,
+                         reinterpret_cast<uint32_t *>(portable_attribute_data)))
         return false;
     } else {
-      if (portable_attribute()->buffer()->data_size() < num_bytes * num_values)
-        return false;
-      if (in_buffer->remaining_size() < num_bytes * num_values)
+      // Decode the integer data directly.
+      // Get the number of bytes for a given entry.
+      uint8_t num_bytes;
+      if (!in_buffer->Decode(&num_bytes))
         return false;
-      for (size_t i = 0; i < num_values; ++i) {
-        in_buffer->Decode(portable_attribute_data + i, num_bytes);
+      if (num_bytes == DataTypeLength(DT_INT32)) {
+        if (portable_attribute()->buffer()->data_size() <
+            sizeof(int32_t) * num_values)
+          return false;
+        if (!in_buffer->Decode(portable_attribute_data,
+                               sizeof(int32_t) * num_values))
+          return false;
+      } else {
+        if (portable_attribute()->buffer()->data_size() <
+            num_bytes * num_values)
+          return false;
+        if (in_buffer->remaining_size() < num_bytes * num_values)
+          return false;
+        for (size_t i = 0; i < num_values; ++i) {
+          in_buffer->Decode(portable_attribute_data + i, num_bytes);
+        }
       }
     }
+
+    if (prediction_scheme_) {
+      if (!prediction_scheme_->DecodePredictionData(in_buffer))
+        return false;
+    }
   }
 
+  if (decoder() && decoder()->IsParallelAttributeDecodingEnabled())
+    return true;  // See FinishDecodingPortableAttribute().
+  return ComputeOriginalIntegerValues(point_ids);
+}
+
+bool SequentialIntegerAttributeDecoder::FinishDecodingPortableAttribute(
+    const std::vector<PointIndex> &point_ids) {
+  if (!decoder() || !decoder()->IsParallelAttributeDecodingEnabled())
+    return true;  // The values were already computed.
+  return ComputeOriginalIntegerValues(point_ids);
+}
+
+bool SequentialIntegerAttributeDecoder::ComputeOriginalIntegerValues(
+    const std::vector<PointIndex> &point_ids) {
+  const int num_components = GetNumValueComponents();
+  const size_t num_values = point_ids.size() * num_components;
+  int32_t *const portable_attribute_data = GetPortableAttributeData();
   if (num_values > 0 && (prediction_scheme_ == nullptr ||
                          !prediction_scheme_->AreCorrectionsPositive())) {
     // Convert the values back to the original signed format.
@@ -133,16 +176,13 @@ bool SequentialIntegerAttributeDecoder::DecodeIntegerValues(
   }
 
   // If the data was encoded with a prediction scheme, we must revert it.
-  if (prediction_scheme_) {
-    if (!prediction_scheme_->DecodePredictionData(in_buffer))
+  if (prediction_scheme_ && num_values > 0) {
+    CodingStatsScope scope(decoder() ? decoder()->stats() : nullptr,
+                           "prediction", attribute_id());
+    if (!prediction_scheme_->ComputeOriginalValues(
+            portable_attribute_data, portable_attribute_data, num_values,
+            num_components, point_ids.data())) {
       return false;
-
-    if (num_values > 0) {
-      if (!prediction_scheme_->ComputeOriginalValues(
-              portable_attribute_data, portable_attribute_data, num_values,
-              num_components, point_ids.data())) {
-        return false;
-      }
     }
   }
   return true;
@@ -177,21 +217,13 @@ bool SequentialIntegerAttributeDecoder::StoreValues(uint32_t num_values) {
 template <typename AttributeTypeT>
 void SequentialIntegerAttributeDecoder::StoreTypedValues(uint32_t num_values) {
   const int num_components = attribute()->num_components();
-  const int entry_size = sizeof(AttributeTypeT) * num_components;
-  const std::unique_ptr<AttributeTypeT[]> att_val(
-      new AttributeTypeT[num_components]);
   const int32_t *const portable_attribute_data = GetPortableAttributeData();
-  int val_id = 0;
-  int out_byte_pos = 0;
-  for (uint32_t i = 0; i < num_values; ++i) {
-    for (int c = 0; c < num_components; ++c) {
-      const AttributeTypeT value =
-          static_cast<AttributeTypeT>(portable_attribute_data[val_id++]);
-      att_val[c] = value;
-    }
-    // Store the integer value into the attribute buffer.
-    attribute()->buffer()->Write(out_byte_pos, att_val.get(), entry_size);
-    out_byte_pos += entry_size;
+  // Store the integer values directly into the attribute buffer.
+  AttributeTypeT *const att_data =
+      reinterpret_cast<AttributeTypeT *>(attribute()->buffer()->data());
+  const uint32_t num_portable_values = num_values * num_components;
+  for (uint32_t i = 0; i < num_portable_values; ++i) {
+    att_data[i] = static_cast<AttributeTypeT>(portable_attribute_data[i]);
   }
 }
 
@@ -26,9 +26,15 @@ class SequentialIntegerAttributeDecoder : public SequentialAttributeDecoder {
   SequentialIntegerAttributeDecoder();
   bool Initialize(PointCloudDecoder *decoder, int attribute_id) override;
 
+  bool DecodePortableAttribute(const std::vector<PointIndex> &point_ids,
+                               DecoderBuffer *in_buffer) override;
+
   bool TransformAttributeToOriginalFormat(
       const std::vector<PointIndex> &point_ids) override;
 
+  bool FinishDecodingPortableAttribute(
+      const std::vector<PointIndex> &point_ids) override;
+
  protected:
   bool DecodeValues(const std::vector<PointIndex> &point_ids,
                     DecoderBuffer *in_buffer) override;
@@ -53,6 +59,10 @@ class SequentialIntegerAttributeDecoder : public SequentialAttributeDecoder {
 
   void PreparePortableAttribute(int num_entries, int num_components);
 
+  // Converts the decoded symbols stored in the portable attribute to signed
+  // integers and reverts the prediction scheme.
+  bool ComputeOriginalIntegerValues(const std::vector<PointIndex> &point_ids);
+
   int32_t *GetPortableAttributeData() {
     return reinterpret_cast<int32_t *>(
         portable_attribute()->GetAddress(AttributeValueIndex(0)));
@@ -17,6 +17,7 @@
 #include "draco/compression/attributes/prediction_schemes/prediction_scheme_encoder_factory.h"
 #include "draco/compression/attributes/prediction_schemes/prediction_scheme_wrap_encoding_transform.h"
 #include "draco/core/bit_utils.h"
+#include "draco/core/coding_stats.h"
 #include "draco/core/symbol_encoding.h"
 
 namespace draco {
@@ -130,11 +131,16 @@ bool SequentialIntegerAttributeEncoder::EncodeValues(
   // All integer values are initialized. Process them using the prediction
   // scheme if we have one.
   if (prediction_scheme_) {
+    CodingStatsScope scope(encoder() ? encoder()->stats() : nullptr,
+                           "prediction", attribute_id());
     prediction_scheme_->ComputeCorrectionValues(
         portable_attribute_data, &encoded_data[0], num_values, num_components,
         point_ids.data());
   }
 
+  CodingStatsScope scope(encoder() ? encoder()->stats() : nullptr, "entropy",
+                         attribute_id(), out_buffer);
+
   if (prediction_scheme_ == nullptr ||
       !prediction_scheme_->AreCorrectionsPositive()) {
     const int32_t *const input =
@@ -150,6 +156,14 @@ bool SequentialIntegerAttributeEncoder::EncodeValues(
     if (encoder() != nullptr) {
       SetSymbolEncodingCompressionLevel(&symbol_encoding_options,
                                         10 - encoder()->options()->GetSpeed());
+      // Optionally use interleaved rANS states that speed up the decoding.
+      const int num_rans_states =
+          encoder()->options()->GetGlobalInt("num_rans_states", 1);
+      if (num_rans_states > 1 &&
+          !SetSymbolEncodingNumRAnsStates(&symbol_encoding_options,
+                                          num_rans_states)) {
+        return false;
+      }
     }
     if (!EncodeSymbols(reinterpret_cast<uint32_t *>(encoded_data.data()),
                        point_ids.size() * num_components, num_components,
@@ -87,25 +87,14 @@ bool SequentialQuantizationAttributeDecoder::DequantizeValues(
   const int32_t max_quantized_value =
       (1u << static_cast<uint32_t>(quantization_bits_)) - 1;
   const int num_components = attribute()->num_components();
-  const int entry_size = sizeof(float) * num_components;
-  const std::unique_ptr<float[]> att_val(new float[num_components]);
-  int quant_val_id = 0;
-  int out_byte_pos = 0;
   Dequantizer dequantizer;
   if (!dequantizer.Init(max_value_dif_, max_quantized_value))
     return false;
-  const int32_t *const portable_attribute_data = GetPortableAttributeData();
-  for (uint32_t i = 0; i < num_values; ++i) {
-    for (int c = 0; c < num_components; ++c) {
-      float value =
-          dequantizer.DequantizeFloat(portable_attribute_data[quant_val_id++]);
-      value = value + min_value_[c];
-      att_val[c] = value;
-    }
-    // Store the floating point value into the attribute buffer.
-    attribute()->buffer()->Write(out_byte_pos, att_val.get(), entry_size);
-    out_byte_pos += entry_size;
-  }
+  // Dequantize all values directly into the attribute buffer.
+  float *const att_data =
+      reinterpret_cast<float *>(attribute()->buffer()->data());
+  dequantizer.DequantizeValues(GetPortableAttributeData(), num_values,
+                               num_components, min_value_.get(), att_data);
   return true;
 }
 
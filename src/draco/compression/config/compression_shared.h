@@ -43,13 +43,18 @@ enum EncodedGeometryType {
 // List of encoding methods for point clouds.
 enum PointCloudEncodingMethod {
   POINT_CLOUD_SEQUENTIAL_ENCODING = 0,
-  POINT_CLOUD_KD_TREE_ENCODING
+  POINT_CLOUD_KD_TREE_ENCODING,
+  // Point cloud split into independently encoded kd-tree tiles (see
+  // PointCloudStreamingEncoder).
+  POINT_CLOUD_TILED_ENCODING,
 };
 
 // List of encoding methods for meshes.
 enum MeshEncoderMethod {
   MESH_SEQUENTIAL_ENCODING = 0,
   MESH_EDGEBREAKER_ENCODING,
+  // Mesh split into independently encoded chunks (see MeshChunkedEncoder).
+  MESH_CHUNKED_ENCODING,
 };
 
 // List of various attribute encoders supported by our framework. The entries
@@ -138,6 +143,9 @@ enum NormalPredictionMode {
 enum SymbolCodingMethod {
   SYMBOL_CODING_TAGGED = 0,
   SYMBOL_CODING_RAW = 1,
+  // Same as SYMBOL_CODING_RAW but the symbols are encoded using multiple
+  // interleaved rANS states that can be decoded in parallel.
+  SYMBOL_CODING_RAW_INTERLEAVED = 2,
   NUM_SYMBOL_CODING_METHODS,
 };
 
@@ -14,9 +14,21 @@
 //
 #include "draco/compression/decode.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#include "draco/attributes/attribute_octahedron_transform.h"
+#include "draco/attributes/attribute_quantization_transform.h"
+#include "draco/compression/attributes/normal_compression_utils.h"
 #include "draco/compression/config/compression_shared.h"
+#include "draco/compression/mesh/mesh_decoder.h"
+#include "draco/core/quantization_utils.h"
 
 #ifdef DRACO_MESH_COMPRESSION_SUPPORTED
+#include "draco/compression/mesh/mesh_chunked_decoder.h"
 #include "draco/compression/mesh/mesh_edgebreaker_decoder.h"
 #include "draco/compression/mesh/mesh_sequential_decoder.h"
 #endif
@@ -24,6 +36,7 @@
 #ifdef DRACO_POINT_CLOUD_COMPRESSION_SUPPORTED
 #include "draco/compression/point_cloud/point_cloud_kd_tree_decoder.h"
 #include "draco/compression/point_cloud/point_cloud_sequential_decoder.h"
+#include "draco/compression/point_cloud/point_cloud_tiled_decoder.h"
 #endif
 
 namespace draco {
@@ -36,6 +49,8 @@ StatusOr<std::unique_ptr<PointCloudDecoder>> CreatePointCloudDecoder(
         new PointCloudSequentialDecoder());
   } else if (method == POINT_CLOUD_KD_TREE_ENCODING) {
     return std::unique_ptr<PointCloudDecoder>(new PointCloudKdTreeDecoder());
+  } else if (method == POINT_CLOUD_TILED_ENCODING) {
+    return std::unique_ptr<PointCloudDecoder>(new PointCloudTiledDecoder());
   }
   return Status(Status::ERROR, "Unsupported encoding method.");
 }
@@ -47,11 +62,17 @@ StatusOr<std::unique_ptr<MeshDecoder>> CreateMeshDecoder(uint8_t method) {
     return std::unique_ptr<MeshDecoder>(new MeshSequentialDecoder());
   } else if (method == MESH_EDGEBREAKER_ENCODING) {
     return std::unique_ptr<MeshDecoder>(new MeshEdgeBreakerDecoder());
+  } else if (method == MESH_CHUNKED_ENCODING) {
+    return std::unique_ptr<MeshDecoder>(new MeshChunkedDecoder());
   }
   return Status(Status::ERROR, "Unsupported encoding method.");
 }
 #endif
 
+Decoder::Decoder() : peak_memory_usage_(0), stats_(nullptr) {}
+
+Decoder::~Decoder() {}
+
 StatusOr<EncodedGeometryType> Decoder::GetEncodedGeometryType(
     DecoderBuffer *in_buffer) {
   DecoderBuffer temp_buffer(*in_buffer);
@@ -96,11 +117,9 @@ Status Decoder::DecodeBufferToGeometry(DecoderBuffer *in_buffer,
   if (header.encoder_type != POINT_CLOUD) {
     return Status(Status::ERROR, "Input is not a point cloud.");
   }
-  DRACO_ASSIGN_OR_RETURN(std::unique_ptr<PointCloudDecoder> decoder,
-                         CreatePointCloudDecoder(header.encoder_method))
-
-  DRACO_RETURN_IF_ERROR(decoder->Decode(options_, in_buffer, out_geometry))
-  return OkStatus();
+  DRACO_ASSIGN_OR_RETURN(PointCloudDecoder *const decoder,
+                         GetPointCloudDecoder(header.encoder_method))
+  return DecodeWithScratchArena(decoder, in_buffer, out_geometry);
 #else
   return Status(Status::ERROR, "Unsupported geometry type.");
 #endif
@@ -115,18 +134,478 @@ Status Decoder::DecodeBufferToGeometry(DecoderBuffer *in_buffer,
   if (header.encoder_type != TRIANGULAR_MESH) {
     return Status(Status::ERROR, "Input is not a mesh.");
   }
-  DRACO_ASSIGN_OR_RETURN(std::unique_ptr<MeshDecoder> decoder,
-                         CreateMeshDecoder(header.encoder_method))
+  DRACO_ASSIGN_OR_RETURN(MeshDecoder *const decoder,
+                         GetMeshDecoder(header.encoder_method))
+  return DecodeWithScratchArena(decoder, in_buffer, out_geometry);
+#else
+  return Status(Status::ERROR, "Unsupported geometry type.");
+#endif
+}
 
-  DRACO_RETURN_IF_ERROR(decoder->Decode(options_, in_buffer, out_geometry))
-  return OkStatus();
+template <class DecoderT, class GeometryT>
+Status Decoder::DecodeWithScratchArena(DecoderT *decoder,
+                                       DecoderBuffer *in_buffer,
+                                       GeometryT *out_geometry) {
+  decoder->set_stats(stats_);
+  if (in_buffer->arena() != nullptr) {
+    const Status status = decoder->Decode(options_, in_buffer, out_geometry);
+    peak_memory_usage_ = decoder->peak_memory_usage();
+    return status;
+  }
+  // Scratch allocations of the previous call are not used anymore, so the
+  // arena can be reused.
+  scratch_arena_.Reset();
+  in_buffer->set_arena(&scratch_arena_);
+  const Status status = decoder->Decode(options_, in_buffer, out_geometry);
+  in_buffer->set_arena(nullptr);
+  peak_memory_usage_ =
+      decoder->peak_memory_usage() + scratch_arena_.capacity();
+  return status;
+}
+
+StatusOr<PointCloudDecoder *> Decoder::GetPointCloudDecoder(int8_t method) {
+#ifdef DRACO_POINT_CLOUD_COMPRESSION_SUPPORTED
+  if (method >= 0 && method < static_cast<int>(point_cloud_decoders_.size()) &&
+      point_cloud_decoders_[method] != nullptr)
+    return point_cloud_decoders_[method].get();
+  DRACO_ASSIGN_OR_RETURN(std::unique_ptr<PointCloudDecoder> decoder,
+                         CreatePointCloudDecoder(method))
+  if (method >= static_cast<int>(point_cloud_decoders_.size()))
+    point_cloud_decoders_.resize(method + 1);
+  point_cloud_decoders_[method] = std::move(decoder);
+  return point_cloud_decoders_[method].get();
 #else
   return Status(Status::ERROR, "Unsupported geometry type.");
 #endif
 }
 
+StatusOr<MeshDecoder *> Decoder::GetMeshDecoder(uint8_t method) {
+#ifdef DRACO_MESH_COMPRESSION_SUPPORTED
+  if (method < mesh_decoders_.size() && mesh_decoders_[method] != nullptr)
+    return mesh_decoders_[method].get();
+  DRACO_ASSIGN_OR_RETURN(std::unique_ptr<MeshDecoder> decoder,
+                         CreateMeshDecoder(method))
+  if (method >= mesh_decoders_.size())
+    mesh_decoders_.resize(method + 1);
+  mesh_decoders_[method] = std::move(decoder);
+  return mesh_decoders_[method].get();
+#else
+  return Status(Status::ERROR, "Unsupported geometry type.");
+#endif
+}
+
+void Decoder::ReleaseScratchMemory() {
+  point_cloud_decoders_.clear();
+  mesh_decoders_.clear();
+  scratch_arena_.Release();
+}
+
 void Decoder::SetSkipAttributeTransform(GeometryAttribute::Type att_type) {
   options_.SetAttributeBool(att_type, "skip_attribute_transform", true);
 }
 
+namespace {
+
+// Stores |value| at |address| that does not need to be aligned.
+template <typename T>
+inline void StoreValue(uint8_t *address, T value) {
+  memcpy(address, &value, sizeof(T));
+}
+
+// Writes values of attribute |att| that are stored in their final form.
+template <typename OutT>
+bool WriteFinalAttributeValues(const PointAttribute &att, int num_points,
+                               int num_components, int64_t byte_stride,
+                               uint8_t *out_data) {
+  const std::unique_ptr<OutT[]> value(new OutT[num_components]);
+  for (PointIndex i(0); i < num_points; ++i) {
+    if (!att.ConvertValue<OutT>(att.mapped_index(i), num_components,
+                                value.get()))
+      return false;
+    uint8_t *const out = out_data + i.value() * byte_stride;
+    for (int c = 0; c < num_components; ++c)
+      StoreValue(out + c * sizeof(OutT), value[c]);
+  }
+  return true;
+}
+
+// Writes portable values of an integer attribute that were not transformed.
+// The values are first converted to the attribute data type |AttT| exactly
+// like the decoder would do when storing them into the final attribute.
+template <typename AttT, typename OutT>
+void WriteIntegerValues(const PointAttribute &portable_att, bool normalized,
+                        int num_points, int num_components,
+                        int64_t byte_stride, uint8_t *out_data) {
+  const OutT scale =
+      normalized && std::is_floating_point<OutT>::value
+          ? static_cast<OutT>(1) /
+                static_cast<OutT>(std::numeric_limits<AttT>::max())
+          : static_cast<OutT>(1);
+  for (PointIndex i(0); i < num_points; ++i) {
+    const int32_t *const in = reinterpret_cast<const int32_t *>(
+        portable_att.GetAddress(portable_att.mapped_index(i)));
+    uint8_t *const out = out_data + i.value() * byte_stride;
+    for (int c = 0; c < num_components; ++c) {
+      const OutT value = static_cast<OutT>(static_cast<AttT>(in[c]));
+      StoreValue(out + c * sizeof(OutT), scale == 1 ? value : value * scale);
+    }
+  }
+}
+
+template <typename OutT>
+bool WriteIntegerValues(const PointAttribute &att,
+                        const PointAttribute &portable_att, int num_points,
+                        int num_components, int64_t byte_stride,
+                        uint8_t *out_data) {
+  const bool normalized = att.normalized();
+  switch (att.data_type()) {
+    case DT_UINT8:
+      WriteIntegerValues<uint8_t, OutT>(portable_att, normalized, num_points,
+                                        num_components, byte_stride, out_data);
+      return true;
+    case DT_INT8:
+      WriteIntegerValues<int8_t, OutT>(portable_att, normalized, num_points,
+                                       num_components, byte_stride, out_data);
+      return true;
+    case DT_UINT16:
+      WriteIntegerValues<uint16_t, OutT>(portable_att, normalized, num_points,
+                                         num_components, byte_stride,
+                                         out_data);
+      return true;
+    case DT_INT16:
+      WriteIntegerValues<int16_t, OutT>(portable_att, normalized, num_points,
+                                        num_components, byte_stride, out_data);
+      return true;
+    case DT_UINT32:
+      WriteIntegerValues<uint32_t, OutT>(portable_att, normalized, num_points,
+                                         num_components, byte_stride,
+                                         out_data);
+      return true;
+    case DT_INT32:
+      WriteIntegerValues<int32_t, OutT>(portable_att, normalized, num_points,
+                                        num_components, byte_stride, out_data);
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+MeshBufferDecoder::MeshBufferDecoder() {}
+
+MeshBufferDecoder::~MeshBufferDecoder() {}
+
+Status MeshBufferDecoder::Decode(DecoderBuffer *in_buffer) {
+#ifdef DRACO_MESH_COMPRESSION_SUPPORTED
+  decoder_.reset();
+  mesh_.reset();
+  DecoderBuffer temp_buffer(*in_buffer);
+  DracoHeader header;
+  DRACO_RETURN_IF_ERROR(PointCloudDecoder::DecodeHeader(&temp_buffer, &header))
+  if (header.encoder_type != TRIANGULAR_MESH) {
+    return Status(Status::ERROR, "Input is not a mesh.");
+  }
+  DRACO_ASSIGN_OR_RETURN(decoder_, CreateMeshDecoder(header.encoder_method))
+
+  // Keep the decoded attributes in their portable form. They are transformed
+  // once they are written into the output buffers.
+  options_.SetGlobalBool("decode_portable_attributes_only", true);
+  std::unique_ptr<Mesh> mesh(new Mesh());
+  const Status status = decoder_->Decode(options_, in_buffer, mesh.get());
+  if (!status.ok()) {
+    decoder_.reset();
+    return status;
+  }
+  mesh_ = std::move(mesh);
+  return OkStatus();
+#else
+  return Status(Status::ERROR, "Unsupported geometry type.");
+#endif
+}
+
+int32_t MeshBufferDecoder::num_points() const {
+  return mesh_ ? mesh_->num_points() : 0;
+}
+
+int32_t MeshBufferDecoder::num_faces() const {
+  return mesh_ ? mesh_->num_faces() : 0;
+}
+
+bool MeshBufferDecoder::HasAttribute(GeometryAttribute::Type att_type) const {
+  return mesh_ && mesh_->GetNamedAttributeId(att_type) != -1;
+}
+
+Status MeshBufferDecoder::WriteAttribute(GeometryAttribute::Type att_type,
+                                         DataType data_type,
+                                         int num_components,
+                                         int64_t byte_stride,
+                                         void *out_data) const {
+  if (!mesh_)
+    return Status(Status::ERROR, "No mesh has been decoded.");
+  if (data_type != DT_FLOAT32 && data_type != DT_UINT16)
+    return Status(Status::ERROR, "Unsupported output data type.");
+  const int att_id = mesh_->GetNamedAttributeId(att_type);
+  if (att_id == -1)
+    return Status(Status::ERROR, "Attribute not found.");
+  const PointAttribute *const att = mesh_->attribute(att_id);
+  if (num_components <= 0 || num_components > att->num_components())
+    return Status(Status::ERROR, "Invalid number of output components.");
+  const int64_t value_size = DataTypeLength(data_type) * num_components;
+  if (byte_stride == 0)
+    byte_stride = value_size;
+  if (byte_stride < value_size)
+    return Status(Status::ERROR, "Output stride is too small.");
+  uint8_t *const out = static_cast<uint8_t *>(out_data);
+  const int num_points = mesh_->num_points();
+
+  // Attributes of older bit-streams are always stored in their final form.
+  const PointAttribute *const portable_att =
+      decoder_->bitstream_version() >= DRACO_BITSTREAM_VERSION(2, 0)
+          ? decoder_->GetPortableAttribute(att_id)
+          : nullptr;
+  if (portable_att == nullptr) {
+    // The attribute was decoded directly into its final form.
+    const bool success =
+        data_type == DT_FLOAT32
+            ? WriteFinalAttributeValues<float>(*att, num_points,
+                                               num_components, byte_stride, out)
+            : WriteFinalAttributeValues<uint16_t>(
+                  *att, num_points, num_components, byte_stride, out);
+    if (!success)
+      return Status(Status::ERROR, "Failed to convert attribute values.");
+    return OkStatus();
+  }
+
+  const AttributeTransformData *const transform_data =
+      portable_att->GetAttributeTransformData();
+  const AttributeTransformType transform_type =
+      transform_data ? transform_data->transform_type()
+                     : ATTRIBUTE_NO_TRANSFORM;
+  if (transform_type == ATTRIBUTE_QUANTIZATION_TRANSFORM) {
+    AttributeQuantizationTransform transform;
+    if (!transform.InitFromAttribute(*portable_att))
+      return Status(Status::ERROR, "Invalid quantization data.");
+    if (data_type == DT_UINT16) {
+      // Output the raw quantized values (e.g. for dequantization on GPU).
+      if (transform.quantization_bits() > 16)
+        return Status(Status::ERROR, "Quantized values do not fit 16 bits.");
+      WriteIntegerValues<uint16_t, uint16_t>(*portable_att, false, num_points,
+                                             num_components, byte_stride, out);
+      return OkStatus();
+    }
+    const int32_t max_quantized_value =
+        (1u << static_cast<uint32_t>(transform.quantization_bits())) - 1;
+    Dequantizer dequantizer;
+    if (!dequantizer.Init(transform.range(), max_quantized_value))
+      return Status(Status::ERROR, "Invalid quantization data.");
+    const float *const min_values = transform.min_values().data();
+    if (portable_att->is_mapping_identity() &&
+        num_components == att->num_components() && byte_stride == value_size &&
+        reinterpret_cast<uintptr_t>(out) % alignof(float) == 0) {
+      // Tightly packed output of all components can be dequantized in bulk.
+      dequantizer.DequantizeValues(
+          reinterpret_cast<const int32_t *>(
+              portable_att->GetAddress(AttributeValueIndex(0))),
+          num_points, num_components, min_values,
+          reinterpret_cast<float *>(out));
+      return OkStatus();
+    }
+    for (PointIndex i(0); i < num_points; ++i) {
+      const int32_t *const in = reinterpret_cast<const int32_t *>(
+          portable_att->GetAddress(portable_att->mapped_index(i)));
+      uint8_t *const dst = out + i.value() * byte_stride;
+      for (int c = 0; c < num_components; ++c) {
+        StoreValue(dst + c * sizeof(float),
+                   dequantizer.DequantizeFloat(in[c]) + min_values[c]);
+      }
+    }
+    return OkStatus();
+  }
+  if (transform_type == ATTRIBUTE_OCTAHEDRON_TRANSFORM) {
+    if (data_type != DT_FLOAT32)
+      return Status(Status::ERROR, "Normals can be written only as floats.");
+    AttributeOctahedronTransform transform;
+    if (!transform.InitFromAttribute(*portable_att))
+      return Status(Status::ERROR, "Invalid octahedron transform data.");
+    const OctahedronToolBox octahedron_tool_box(transform.quantization_bits());
+    float value[3];
+    for (PointIndex i(0); i < num_points; ++i) {
+      const int32_t *const in = reinterpret_cast<const int32_t *>(
+          portable_att->GetAddress(portable_att->mapped_index(i)));
+      octahedron_tool_box.QuantizedOctaherdalCoordsToUnitVector(in[0], in[1],
+                                                                value);
+      uint8_t *const dst = out + i.value() * byte_stride;
+      for (int c = 0; c < num_components; ++c)
+        StoreValue(dst + c * sizeof(float), value[c]);
+    }
+    return OkStatus();
+  }
+  if (transform_type != ATTRIBUTE_NO_TRANSFORM)
+    return Status(Status::ERROR, "Unsupported attribute transform.");
+  const bool success =
+      data_type == DT_FLOAT32
+          ? WriteIntegerValues<float>(*att, *portable_att, num_points,
+                                      num_components, byte_stride, out)
+          : WriteIntegerValues<uint16_t>(*att, *portable_att, num_points,
+                                         num_components, byte_stride, out);
+  if (!success)
+    return Status(Status::ERROR, "Unsupported attribute data type.");
+  return OkStatus();
+}
+
+Status MeshBufferDecoder::WriteIndices(DataType index_type,
+                                       void *out_data) const {
+  if (!mesh_)
+    return Status(Status::ERROR, "No mesh has been decoded.");
+  uint8_t *const out = static_cast<uint8_t *>(out_data);
+  if (index_type == DT_UINT32) {
+    for (FaceIndex f(0); f < mesh_->num_faces(); ++f) {
+      const Mesh::Face &face = mesh_->face(f);
+      for (int c = 0; c < 3; ++c) {
+        StoreValue(out + (3 * f.value() + c) * sizeof(uint32_t),
+                   face[c].value());
+      }
+    }
+    return OkStatus();
+  }
+  if (index_type == DT_UINT16) {
+    if (mesh_->num_points() > std::numeric_limits<uint16_t>::max() + 1)
+      return Status(Status::ERROR, "Too many points for 16-bit indices.");
+    for (FaceIndex f(0); f < mesh_->num_faces(); ++f) {
+      const Mesh::Face &face = mesh_->face(f);
+      for (int c = 0; c < 3; ++c) {
+        StoreValue(out + (3 * f.value() + c) * sizeof(uint16_t),
+                   static_cast<uint16_t>(face[c].value()));
+      }
+    }
+    return OkStatus();
+  }
+  return Status(Status::ERROR, "Unsupported index type.");
+}
+
+StreamingDecoder::StreamingDecoder()
+    : next_attempt_size_(0),
+      is_finished_(false),
+      is_complete_(false),
+      geometry_type_(INVALID_GEOMETRY_TYPE) {}
+
+StreamingDecoder::~StreamingDecoder() {}
+
+Status StreamingDecoder::AppendData(const char *data, size_t size) {
+  if (is_finished_)
+    return Status(Status::ERROR, "Data appended after the end of the stream.");
+  data_.insert(data_.end(), data, data + size);
+  if (is_complete_ || data_.size() < next_attempt_size_)
+    return OkStatus();
+  return DecodeReceivedData(false);
+}
+
+Status StreamingDecoder::Finish() {
+  is_finished_ = true;
+  if (is_complete_)
+    return OkStatus();
+  return DecodeReceivedData(true);
+}
+
+bool StreamingDecoder::IsConnectivityDecoded() const {
+  return decoder_ != nullptr && decoder_->is_geometry_data_decoded();
+}
+
+bool StreamingDecoder::IsAttributeDecoded(int32_t att_id) const {
+  if (att_id < 0 ||
+      att_id >= static_cast<int32_t>(is_attribute_decoded_.size()))
+    return false;
+  return is_attribute_decoded_[att_id];
+}
+
+const PointCloud *StreamingDecoder::point_cloud() const {
+  if (!is_complete_ && !IsConnectivityDecoded())
+    return nullptr;
+  return geometry_.get();
+}
+
+const Mesh *StreamingDecoder::mesh() const {
+  if (geometry_type_ != TRIANGULAR_MESH)
+    return nullptr;
+  return static_cast<const Mesh *>(point_cloud());
+}
+
+std::unique_ptr<PointCloud> StreamingDecoder::ReleaseGeometry() {
+  if (!is_complete_)
+    return nullptr;
+  is_attribute_decoded_.clear();
+  return std::move(geometry_);
+}
+
+Status StreamingDecoder::DecodeReceivedData(bool is_final) {
+  next_attempt_size_ = data_.size() + data_.size() / 4 + 1;
+  DecoderBuffer buffer;
+  buffer.Init(data_.data(), data_.size());
+  Status status;
+  if (IsConnectivityDecoded()) {
+    // Keep the decoded connectivity and attributes.
+    status = decoder_->ResumeDecoding(&buffer);
+  } else {
+    DecoderBuffer header_buffer(buffer);
+    DracoHeader header;
+    const Status header_status =
+        PointCloudDecoder::DecodeHeader(&header_buffer, &header);
+    if (!header_status.ok()) {
+      // Wait for the rest of an incomplete header.
+      if (header_status.code() == Status::IO_ERROR && !is_final)
+        return OkStatus();
+      return header_status;
+    }
+
+    std::unique_ptr<PointCloudDecoder> decoder;
+    std::unique_ptr<PointCloud> geometry;
+    status = Status(Status::ERROR, "Unsupported geometry type.");
+    if (header.encoder_type == TRIANGULAR_MESH) {
+#ifdef DRACO_MESH_COMPRESSION_SUPPORTED
+      DRACO_ASSIGN_OR_RETURN(std::unique_ptr<MeshDecoder> mesh_decoder,
+                             CreateMeshDecoder(header.encoder_method))
+      std::unique_ptr<Mesh> mesh(new Mesh());
+      status = mesh_decoder->Decode(options_, &buffer, mesh.get());
+      decoder = std::move(mesh_decoder);
+      geometry = std::move(mesh);
+#endif
+    } else if (header.encoder_type == POINT_CLOUD) {
+#ifdef DRACO_POINT_CLOUD_COMPRESSION_SUPPORTED
+      DRACO_ASSIGN_OR_RETURN(decoder,
+                             CreatePointCloudDecoder(header.encoder_method))
+      geometry.reset(new PointCloud());
+      status = decoder->Decode(options_, &buffer, geometry.get());
+#endif
+    }
+    if (decoder == nullptr)
+      return status;
+    geometry_type_ = static_cast<EncodedGeometryType>(header.encoder_type);
+    decoder_ = std::move(decoder);
+    geometry_ = std::move(geometry);
+  }
+
+  if (status.ok()) {
+    is_complete_ = true;
+    is_attribute_decoded_.assign(geometry_->num_attributes(), true);
+    // The decoder is not needed anymore.
+    decoder_ = nullptr;
+    return OkStatus();
+  }
+  // Errors that are not caused by missing data are reported immediately.
+  if (is_final || status.code() == Status::UNKNOWN_VERSION)
+    return status;
+  if (!IsConnectivityDecoded())
+    return OkStatus();
+
+  is_attribute_decoded_.assign(geometry_->num_attributes(), false);
+  for (int i = 0; i < decoder_->num_decoded_attributes_decoders(); ++i) {
+    const AttributesDecoderInterface *const att_dec =
+        decoder_->attributes_decoder(i);
+    for (int j = 0; j < att_dec->GetNumAttributes(); ++j)
+      is_attribute_decoded_[att_dec->GetAttributeId(j)] = true;
+  }
+  return OkStatus();
+}
+
 }  // namespace draco
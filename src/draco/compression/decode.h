@@ -15,18 +15,36 @@
 #ifndef DRACO_COMPRESSION_DECODE_H_
 #define DRACO_COMPRESSION_DECODE_H_
 
+#include <vector>
+
 #include "draco/compression/config/compression_shared.h"
 #include "draco/compression/config/decoder_options.h"
+#include "draco/core/arena.h"
+#include "draco/core/coding_stats.h"
 #include "draco/core/decoder_buffer.h"
 #include "draco/core/statusor.h"
 #include "draco/mesh/mesh.h"
 
 namespace draco {
 
+class MeshDecoder;
+class PointCloudDecoder;
+
 // Class responsible for decoding of meshes and point clouds that were
 // compressed by a Draco encoder.
+// The decoder keeps its internal decoding objects (such as the connectivity
+// decoders, corner tables and entropy decoding tables) between the decoding
+// calls. Reusing a single Decoder instance for decoding of many geometries
+// therefore avoids most of the per-call setup cost, which dominates the
+// decoding time of small geometries.
+// When memory is more important than speed, the global option
+// "release_connectivity_data" can be set to free the corner tables of meshes
+// as soon as they are no longer needed during decoding.
 class Decoder {
  public:
+  Decoder();
+  ~Decoder();
+
   // Returns the geometry type encoded in the input |in_buffer|.
   // The return value is one of POINT_CLOUD, MESH or INVALID_GEOMETRY in case
   // the input data is invalid.
@@ -70,8 +88,185 @@ class Decoder {
   // to control the decoding process.
   DecoderOptions *options() { return &options_; }
 
+  // Sets an object that collects statistics of the individual stages of the
+  // following decoding calls, such as their time and the number of decoded
+  // bytes. Use nullptr to stop the collection. The statistics are collected
+  // only when Draco is built with DRACO_STATS_SUPPORTED (see CodingStats).
+  void SetStats(CodingStats *stats) { stats_ = stats; }
+
+  // Frees all memory and decoding objects that are kept by the decoder between
+  // decoding calls.
+  void ReleaseScratchMemory();
+
+  // Returns the peak number of bytes of temporary memory used by the last
+  // decoding call, such as the memory of corner tables and of the scratch
+  // arena. Memory of the decoded geometry is not included.
+  size_t peak_memory_usage() const { return peak_memory_usage_; }
+
+ private:
+  // Decodes the geometry using a |decoder| of |GeometryT| type.
+  template <class DecoderT, class GeometryT>
+  Status DecodeWithScratchArena(DecoderT *decoder, DecoderBuffer *in_buffer,
+                                GeometryT *out_geometry);
+
+  // Returns a decoder for the given encoding |method|. The decoders are created
+  // on the first use and then reused by all subsequent decoding calls.
+  StatusOr<PointCloudDecoder *> GetPointCloudDecoder(int8_t method);
+  StatusOr<MeshDecoder *> GetMeshDecoder(uint8_t method);
+
+  DecoderOptions options_;
+  // Arena for temporary allocations of the decoders, such as the rANS decoding
+  // tables. The memory is reused by subsequent decoding calls so that decoding
+  // of many similar geometries doesn't allocate scratch memory on the heap.
+  // Not used when the input buffer already has an arena set.
+  Arena scratch_arena_;
+  // Decoders indexed by their encoding method.
+  std::vector<std::unique_ptr<PointCloudDecoder>> point_cloud_decoders_;
+  std::vector<std::unique_ptr<MeshDecoder>> mesh_decoders_;
+  size_t peak_memory_usage_;
+  CodingStats *stats_;
+};
+
+// Class for decoding of meshes directly into vertex and index buffers owned by
+// the caller. Unlike Decoder::DecodeMeshFromBuffer(), the decoded attribute
+// values are never stored in a draco::Mesh. Instead they are kept in their
+// portable (e.g. quantized) form and transformed into the requested output
+// format while they are written into the caller's buffers.
+//
+// Usage:
+//   MeshBufferDecoder decoder;
+//   DRACO_RETURN_IF_ERROR(decoder.Decode(&buffer))
+//   std::vector<float> positions(decoder.num_points() * 3);
+//   DRACO_RETURN_IF_ERROR(decoder.WriteAttribute(
+//       GeometryAttribute::POSITION, DT_FLOAT32, 3, 0, positions.data()))
+//   std::vector<uint32_t> indices(decoder.num_faces() * 3);
+//   DRACO_RETURN_IF_ERROR(decoder.WriteIndices(DT_UINT32, indices.data()))
+class MeshBufferDecoder {
+ public:
+  MeshBufferDecoder();
+  ~MeshBufferDecoder();
+
+  // Decodes the mesh from |in_buffer|. After a successful call, the sizes of
+  // the output buffers can be queried and the buffers can be filled using the
+  // Write*() methods below.
+  Status Decode(DecoderBuffer *in_buffer);
+
+  int32_t num_points() const;
+  int32_t num_faces() const;
+
+  // Returns true when the decoded mesh contains an attribute of |att_type|.
+  bool HasAttribute(GeometryAttribute::Type att_type) const;
+
+  // Writes |num_components| values of the first attribute of |att_type| for
+  // each point of the mesh into |out_data|. Values of two consecutive points
+  // are |byte_stride| bytes apart (use 0 for tightly packed values). Planar
+  // buffers are filled with a tight stride, interleaved buffers with the
+  // vertex size as the stride and |out_data| pointing to the attribute within
+  // the first vertex.
+  // |data_type| can be DT_FLOAT32 or DT_UINT16. Floating point outputs receive
+  // the dequantized values. DT_UINT16 outputs receive the raw quantized values
+  // of attributes quantized to at most 16 bits or the values of integer
+  // attributes.
+  Status WriteAttribute(GeometryAttribute::Type att_type, DataType data_type,
+                        int num_components, int64_t byte_stride,
+                        void *out_data) const;
+
+  // Writes three point indices for each face into |out_data|. |index_type|
+  // can be DT_UINT16 or DT_UINT32.
+  Status WriteIndices(DataType index_type, void *out_data) const;
+
+  DecoderOptions *options() { return &options_; }
+
  private:
   DecoderOptions options_;
+  std::unique_ptr<MeshDecoder> decoder_;
+  std::unique_ptr<Mesh> mesh_;
+};
+
+// Class for incremental decoding of geometry whose encoded data is received
+// in pieces, for example over a network stream. Parts of the geometry are
+// exposed as soon as they are decoded: first the connectivity together with
+// the number of points, then the individual attributes.
+//
+// The Draco bitstream does not store sizes of its parts, so the decoder can't
+// suspend decoding in the middle of a part. Instead, a new decoding attempt is
+// made whenever the amount of received data grows by a quarter since the last
+// attempt. Each attempt decodes as many parts as the data allows. Once the
+// connectivity is decoded, it is kept together with all completely decoded
+// attributes, and later attempts continue with the first unfinished attribute
+// (see PointCloudDecoder::ResumeDecoding()). Only the part that was cut off is
+// decoded again, and thanks to the geometric growth, the total work stays
+// within a small constant factor of decoding the complete data at once.
+//
+// When the global option "num_decoding_threads" is larger than 1, attributes
+// become available all at once after the whole geometry is decoded.
+//
+// Usage:
+//   StreamingDecoder decoder;
+//   while (ReceiveData(&data)) {
+//     DRACO_RETURN_IF_ERROR(decoder.AppendData(data.data(), data.size()))
+//     if (decoder.IsConnectivityDecoded())
+//       UploadIndices(*decoder.mesh());
+//     if (decoder.IsAttributeDecoded(att_id))
+//       UploadAttribute(*decoder.mesh()->attribute(att_id));
+//   }
+//   DRACO_RETURN_IF_ERROR(decoder.Finish())
+class StreamingDecoder {
+ public:
+  StreamingDecoder();
+  ~StreamingDecoder();
+
+  // Appends |size| bytes of encoded data and decodes as much of the geometry
+  // as possible. Returns an error when the received data is known to be
+  // invalid, e.g. when it doesn't start with a valid Draco header.
+  Status AppendData(const char *data, size_t size);
+
+  // Signals the end of the encoded data and decodes the complete geometry.
+  // Returns an error when the data couldn't be decoded.
+  Status Finish();
+
+  // Returns true when the connectivity of the geometry is decoded. For point
+  // clouds, this means that the number of points is known.
+  bool IsConnectivityDecoded() const;
+
+  // Returns true when values of attribute |att_id| are decoded.
+  bool IsAttributeDecoded(int32_t att_id) const;
+
+  // Returns true when the whole geometry is decoded.
+  bool IsComplete() const { return is_complete_; }
+
+  // Returns the geometry decoded so far or nullptr when the connectivity is
+  // not decoded yet. Attributes that are not decoded yet contain undefined
+  // values and may be replaced during subsequent calls of AppendData() and
+  // Finish(). The returned instance and the values of decoded parts never
+  // change.
+  const PointCloud *point_cloud() const;
+
+  // Same as point_cloud() but returns nullptr when the input is not a mesh.
+  const Mesh *mesh() const;
+
+  // Transfers the ownership of the decoded geometry to the caller. Returns
+  // nullptr when the geometry is not complete.
+  std::unique_ptr<PointCloud> ReleaseGeometry();
+
+  DecoderOptions *options() { return &options_; }
+
+ private:
+  // Decodes the geometry from all received data. Errors caused by missing
+  // data are reported only when |is_final| is true.
+  Status DecodeReceivedData(bool is_final);
+
+  DecoderOptions options_;
+  std::vector<char> data_;
+  // Size of the received data needed for the next decoding attempt.
+  size_t next_attempt_size_;
+  bool is_finished_;
+  bool is_complete_;
+  EncodedGeometryType geometry_type_;
+  // Decoder of the last attempt and the geometry it decodes into.
+  std::unique_ptr<PointCloudDecoder> decoder_;
+  std::unique_ptr<PointCloud> geometry_;
+  std::vector<bool> is_attribute_decoded_;
 };
 
 }  // namespace draco
@@ -14,10 +14,14 @@
 //
 #include "draco/compression/decode.h"
 
+#include <algorithm>
 #include <cinttypes>
+#include <cstring>
 #include <fstream>
+#include <iterator>
 #include <sstream>
 
+#include "draco/compression/encode.h"
 #include "draco/core/draco_test_base.h"
 #include "draco/core/draco_test_utils.h"
 
@@ -76,4 +80,517 @@ TEST_F(DecodeTest, TestSkipAttributeTransform) {
 }
 #endif
 
+TEST_F(DecodeTest, TestParallelAttributeDecoding) {
+  // Tests that decoding of attributes in parallel produces the same geometry
+  // as the serial decoding.
+  const std::unique_ptr<draco::Mesh> mesh =
+      draco::ReadMeshFromTestFile("cube_att.obj");
+  ASSERT_NE(mesh, nullptr);
+  for (int method = 0; method < 2; ++method) {
+    draco::Encoder encoder;
+    encoder.SetEncodingMethod(method == 0 ? draco::MESH_SEQUENTIAL_ENCODING
+                                          : draco::MESH_EDGEBREAKER_ENCODING);
+    encoder.SetAttributeQuantization(draco::GeometryAttribute::POSITION, 12);
+    encoder.SetAttributeQuantization(draco::GeometryAttribute::NORMAL, 8);
+    encoder.SetAttributeQuantization(draco::GeometryAttribute::TEX_COORD, 10);
+    draco::EncoderBuffer encoder_buffer;
+    ASSERT_TRUE(encoder.EncodeMeshToBuffer(*mesh, &encoder_buffer).ok());
+
+    draco::DecoderBuffer buffer;
+    buffer.Init(encoder_buffer.data(), encoder_buffer.size());
+    draco::Decoder decoder;
+    std::unique_ptr<draco::Mesh> serial_mesh =
+        decoder.DecodeMeshFromBuffer(&buffer).value();
+    ASSERT_NE(serial_mesh, nullptr);
+
+    buffer.Init(encoder_buffer.data(), encoder_buffer.size());
+    draco::Decoder parallel_decoder;
+    parallel_decoder.options()->SetGlobalInt("num_decoding_threads", 4);
+    std::unique_ptr<draco::Mesh> parallel_mesh =
+        parallel_decoder.DecodeMeshFromBuffer(&buffer).value();
+    ASSERT_NE(parallel_mesh, nullptr);
+
+    ASSERT_EQ(serial_mesh->num_faces(), parallel_mesh->num_faces());
+    ASSERT_EQ(serial_mesh->num_attributes(), parallel_mesh->num_attributes());
+    for (int i = 0; i < serial_mesh->num_attributes(); ++i) {
+      const draco::PointAttribute *const serial_att =
+          serial_mesh->attribute(i);
+      const draco::PointAttribute *const parallel_att =
+          parallel_mesh->attribute(i);
+      ASSERT_EQ(serial_att->size(), parallel_att->size());
+      ASSERT_EQ(serial_att->buffer()->data_size(),
+                parallel_att->buffer()->data_size());
+      ASSERT_EQ(0, memcmp(serial_att->buffer()->data(),
+                          parallel_att->buffer()->data(),
+                          serial_att->buffer()->data_size()));
+    }
+  }
+}
+
+// Returns true when both point clouds have the same attribute data (and faces
+// for meshes).
+bool AreGeometriesIdentical(const draco::PointCloud &pc0,
+                            const draco::PointCloud &pc1) {
+  if (pc0.num_points() != pc1.num_points() ||
+      pc0.num_attributes() != pc1.num_attributes())
+    return false;
+  for (int i = 0; i < pc0.num_attributes(); ++i) {
+    const draco::DataBuffer *const data0 = pc0.attribute(i)->buffer();
+    const draco::DataBuffer *const data1 = pc1.attribute(i)->buffer();
+    if (data0->data_size() != data1->data_size() ||
+        memcmp(data0->data(), data1->data(), data0->data_size()) != 0)
+      return false;
+    for (draco::PointIndex p(0); p < pc0.num_points(); ++p) {
+      if (pc0.attribute(i)->mapped_index(p) !=
+          pc1.attribute(i)->mapped_index(p))
+        return false;
+    }
+  }
+  const draco::Mesh *const mesh0 = dynamic_cast<const draco::Mesh *>(&pc0);
+  const draco::Mesh *const mesh1 = dynamic_cast<const draco::Mesh *>(&pc1);
+  if ((mesh0 == nullptr) != (mesh1 == nullptr))
+    return false;
+  if (mesh0 == nullptr)
+    return true;
+  if (mesh0->num_faces() != mesh1->num_faces())
+    return false;
+  for (draco::FaceIndex f(0); f < mesh0->num_faces(); ++f) {
+    if (mesh0->face(f) != mesh1->face(f))
+      return false;
+  }
+  return true;
+}
+
+TEST_F(DecodeTest, TestDecoderReuse) {
+  // Tests that a single decoder instance can be used to decode many different
+  // geometries and that it produces the same results as new decoders.
+  std::vector<std::vector<char>> encoded_data;
+  const std::string mesh_files[] = {"cube_att.obj", "test_nm.obj"};
+  for (const std::string &file_name : mesh_files) {
+    const std::unique_ptr<draco::Mesh> mesh =
+        draco::ReadMeshFromTestFile(file_name);
+    ASSERT_NE(mesh, nullptr);
+    for (int config = 0; config < 5; ++config) {
+      draco::Encoder encoder;
+      encoder.SetAttributeQuantization(draco::GeometryAttribute::POSITION, 11);
+      encoder.SetAttributeQuantization(draco::GeometryAttribute::NORMAL, 8);
+      encoder.SetAttributeQuantization(draco::GeometryAttribute::TEX_COORD,
+                                       10);
+      draco::EncoderBuffer buffer;
+      if (config == 0) {
+        encoder.SetEncodingMethod(draco::MESH_SEQUENTIAL_ENCODING);
+      } else if (config == 1) {
+        // Standard edgebreaker.
+        encoder.SetSpeedOptions(5, 5);
+        encoder.SetEncodingMethod(draco::MESH_EDGEBREAKER_ENCODING);
+      } else if (config == 2) {
+        // Valence edgebreaker.
+        encoder.SetSpeedOptions(0, 0);
+        encoder.SetEncodingMethod(draco::MESH_EDGEBREAKER_ENCODING);
+      } else if (config == 3) {
+        encoder.SetEncodingMethod(draco::MESH_CHUNKED_ENCODING);
+        encoder.SetMaxChunkFaces(32);
+      }
+      if (config == 4) {
+        encoder.SetEncodingMethod(draco::POINT_CLOUD_SEQUENTIAL_ENCODING);
+        ASSERT_TRUE(encoder.EncodePointCloudToBuffer(*mesh, &buffer).ok());
+      } else {
+        ASSERT_TRUE(encoder.EncodeMeshToBuffer(*mesh, &buffer).ok());
+      }
+      encoded_data.push_back(
+          std::vector<char>(buffer.data(), buffer.data() + buffer.size()));
+    }
+  }
+  // Files encoded with older versions of the library.
+  const std::string legacy_files[] = {"test_nm.obj.edgebreaker.0.10.0.drc",
+                                      "test_nm.obj.edgebreaker.1.2.0.drc",
+                                      "test_nm.obj.sequential.1.2.0.drc"};
+  for (const std::string &file_name : legacy_files) {
+    std::ifstream input_file(draco::GetTestFileFullPath(file_name),
+                             std::ios::binary);
+    ASSERT_TRUE(input_file);
+    encoded_data.push_back(
+        std::vector<char>((std::istreambuf_iterator<char>(input_file)),
+                          std::istreambuf_iterator<char>()));
+  }
+
+  draco::Decoder decoder;
+  for (int pass = 0; pass < 2; ++pass) {
+    for (const std::vector<char> &data : encoded_data) {
+      draco::DecoderBuffer buffer;
+      buffer.Init(data.data(), data.size());
+      std::unique_ptr<draco::PointCloud> pc =
+          decoder.DecodePointCloudFromBuffer(&buffer).value();
+      ASSERT_NE(pc, nullptr);
+
+      buffer.Init(data.data(), data.size());
+      draco::Decoder new_decoder;
+      std::unique_ptr<draco::PointCloud> expected_pc =
+          new_decoder.DecodePointCloudFromBuffer(&buffer).value();
+      ASSERT_NE(expected_pc, nullptr);
+      ASSERT_TRUE(AreGeometriesIdentical(*pc, *expected_pc));
+    }
+  }
+  decoder.ReleaseScratchMemory();
+  draco::DecoderBuffer buffer;
+  buffer.Init(encoded_data[0].data(), encoded_data[0].size());
+  ASSERT_TRUE(decoder.DecodePointCloudFromBuffer(&buffer).ok());
+}
+
+TEST_F(DecodeTest, TestCodingStats) {
+  // Tests that statistics of the individual stages are collected by both the
+  // encoder and the decoder when the library is built with the support.
+  const std::unique_ptr<draco::Mesh> mesh =
+      draco::ReadMeshFromTestFile("cube_att.obj");
+  ASSERT_NE(mesh, nullptr);
+  draco::CodingStats encoder_stats;
+  draco::Encoder encoder;
+  encoder.SetAttributeQuantization(draco::GeometryAttribute::POSITION, 11);
+  encoder.SetStats(&encoder_stats);
+  draco::EncoderBuffer encoder_buffer;
+  ASSERT_TRUE(encoder.EncodeMeshToBuffer(*mesh, &encoder_buffer).ok());
+
+  draco::CodingStats decoder_stats;
+  draco::Decoder decoder;
+  decoder.SetStats(&decoder_stats);
+  draco::DecoderBuffer buffer;
+  buffer.Init(encoder_buffer.data(), encoder_buffer.size());
+  std::unique_ptr<draco::Mesh> decoded_mesh =
+      decoder.DecodeMeshFromBuffer(&buffer).value();
+  ASSERT_NE(decoded_mesh, nullptr);
+
+#ifdef DRACO_STATS_SUPPORTED
+  const int pos_att_id =
+      decoded_mesh->GetNamedAttributeId(draco::GeometryAttribute::POSITION);
+  for (const draco::CodingStats *stats : {&encoder_stats, &decoder_stats}) {
+    draco::CodingStats::Stage stage;
+    ASSERT_TRUE(stats->GetStage("header", -1, &stage));
+    ASSERT_GT(stage.num_bytes, 0);
+    ASSERT_TRUE(stats->GetStage("connectivity", -1, &stage));
+    ASSERT_EQ(stage.num_runs, 1);
+    ASSERT_GT(stage.num_bytes, 0);
+    ASSERT_TRUE(stats->GetStage("entropy", pos_att_id, &stage));
+    ASSERT_GT(stage.num_bytes, 0);
+    ASSERT_TRUE(stats->GetStage("prediction", pos_att_id, &stage));
+    ASSERT_TRUE(stats->GetStage("transform", pos_att_id, &stage));
+  }
+  // The decoding stages cannot read more than the whole input.
+  int64_t num_decoded_bytes = 0;
+  for (const draco::CodingStats::Stage &stage : decoder_stats.GetStages())
+    num_decoded_bytes += stage.num_bytes;
+  ASSERT_LE(num_decoded_bytes, encoder_buffer.size());
+  decoder_stats.Clear();
+  ASSERT_TRUE(decoder_stats.GetStages().empty());
+#else
+  ASSERT_TRUE(encoder_stats.GetStages().empty());
+  ASSERT_TRUE(decoder_stats.GetStages().empty());
+#endif
+}
+
+TEST_F(DecodeTest, TestReleaseConnectivityData) {
+  // Tests that releasing of the connectivity data does not change the decoded
+  // meshes and that the decoder can be reused afterwards.
+  const std::unique_ptr<draco::Mesh> mesh =
+      draco::ReadMeshFromTestFile("cube_att.obj");
+  ASSERT_NE(mesh, nullptr);
+  for (int speed = 0; speed <= 5; speed += 5) {
+    draco::Encoder encoder;
+    encoder.SetSpeedOptions(speed, speed);
+    encoder.SetEncodingMethod(draco::MESH_EDGEBREAKER_ENCODING);
+    encoder.SetAttributeQuantization(draco::GeometryAttribute::POSITION, 11);
+    encoder.SetAttributeQuantization(draco::GeometryAttribute::NORMAL, 8);
+    encoder.SetAttributeQuantization(draco::GeometryAttribute::TEX_COORD, 10);
+    draco::EncoderBuffer encoder_buffer;
+    ASSERT_TRUE(encoder.EncodeMeshToBuffer(*mesh, &encoder_buffer).ok());
+
+    draco::DecoderBuffer buffer;
+    buffer.Init(encoder_buffer.data(), encoder_buffer.size());
+    draco::Decoder decoder;
+    std::unique_ptr<draco::Mesh> expected_mesh =
+        decoder.DecodeMeshFromBuffer(&buffer).value();
+    ASSERT_NE(expected_mesh, nullptr);
+    ASSERT_GT(decoder.peak_memory_usage(), 0);
+
+    draco::Decoder lean_decoder;
+    lean_decoder.options()->SetGlobalBool("release_connectivity_data", true);
+    for (int pass = 0; pass < 2; ++pass) {
+      buffer.Init(encoder_buffer.data(), encoder_buffer.size());
+      std::unique_ptr<draco::Mesh> lean_mesh =
+          lean_decoder.DecodeMeshFromBuffer(&buffer).value();
+      ASSERT_NE(lean_mesh, nullptr);
+      ASSERT_TRUE(AreGeometriesIdentical(*lean_mesh, *expected_mesh));
+      ASSERT_GT(lean_decoder.peak_memory_usage(), 0);
+    }
+  }
+}
+
+class MeshBufferDecoderTest : public ::testing::Test {
+ protected:
+  void TestDecodingToBuffers(const std::string &file_name) {
+    const std::string path = draco::GetTestFileFullPath(file_name);
+    std::ifstream input_file(path, std::ios::binary);
+    ASSERT_TRUE(input_file);
+    const std::vector<char> data((std::istreambuf_iterator<char>(input_file)),
+                                 std::istreambuf_iterator<char>());
+    ASSERT_FALSE(data.empty());
+
+    // Decode the reference mesh.
+    draco::DecoderBuffer buffer;
+    buffer.Init(data.data(), data.size());
+    draco::Decoder decoder;
+    std::unique_ptr<draco::Mesh> mesh =
+        decoder.DecodeMeshFromBuffer(&buffer).value();
+    ASSERT_NE(mesh, nullptr);
+
+    buffer.Init(data.data(), data.size());
+    draco::MeshBufferDecoder buffer_decoder;
+    ASSERT_TRUE(buffer_decoder.Decode(&buffer).ok());
+    ASSERT_EQ(buffer_decoder.num_points(), mesh->num_points());
+    ASSERT_EQ(buffer_decoder.num_faces(), mesh->num_faces());
+
+    // Check indices.
+    std::vector<uint32_t> indices(mesh->num_faces() * 3);
+    ASSERT_TRUE(
+        buffer_decoder.WriteIndices(draco::DT_UINT32, indices.data()).ok());
+    std::vector<uint16_t> indices16(mesh->num_faces() * 3);
+    ASSERT_TRUE(
+        buffer_decoder.WriteIndices(draco::DT_UINT16, indices16.data()).ok());
+    for (draco::FaceIndex f(0); f < mesh->num_faces(); ++f) {
+      for (int c = 0; c < 3; ++c) {
+        ASSERT_EQ(indices[3 * f.value() + c], mesh->face(f)[c].value());
+        ASSERT_EQ(indices16[3 * f.value() + c], mesh->face(f)[c].value());
+      }
+    }
+
+    // Write positions and normals into one interleaved vertex buffer.
+    constexpr int kVertexSize = 6;
+    std::vector<float> vertices(mesh->num_points() * kVertexSize);
+    ASSERT_TRUE(buffer_decoder
+                    .WriteAttribute(draco::GeometryAttribute::POSITION,
+                                    draco::DT_FLOAT32, 3,
+                                    kVertexSize * sizeof(float),
+                                    vertices.data())
+                    .ok());
+    ASSERT_TRUE(buffer_decoder
+                    .WriteAttribute(draco::GeometryAttribute::NORMAL,
+                                    draco::DT_FLOAT32, 3,
+                                    kVertexSize * sizeof(float),
+                                    vertices.data() + 3)
+                    .ok());
+    const draco::PointAttribute *const pos_att =
+        mesh->GetNamedAttribute(draco::GeometryAttribute::POSITION);
+    const draco::PointAttribute *const norm_att =
+        mesh->GetNamedAttribute(draco::GeometryAttribute::NORMAL);
+    ASSERT_NE(pos_att, nullptr);
+    ASSERT_NE(norm_att, nullptr);
+    for (draco::PointIndex i(0); i < mesh->num_points(); ++i) {
+      float pos[3], norm[3];
+      pos_att->GetMappedValue(i, pos);
+      norm_att->GetMappedValue(i, norm);
+      for (int c = 0; c < 3; ++c) {
+        ASSERT_EQ(vertices[i.value() * kVertexSize + c], pos[c]);
+        ASSERT_EQ(vertices[i.value() * kVertexSize + 3 + c], norm[c]);
+      }
+    }
+  }
+};
+
+TEST_F(MeshBufferDecoderTest, TestDecodingToBuffers) {
+  TestDecodingToBuffers("test_nm.obj.edgebreaker.1.2.0.drc");
+  TestDecodingToBuffers("test_nm.obj.sequential.1.2.0.drc");
+}
+
+TEST_F(MeshBufferDecoderTest, TestDecodingLegacyFilesToBuffers) {
+  TestDecodingToBuffers("test_nm.obj.edgebreaker.1.1.0.drc");
+  TestDecodingToBuffers("test_nm.obj.sequential.0.10.0.drc");
+}
+
+TEST_F(MeshBufferDecoderTest, TestQuantizedOutput) {
+  const std::unique_ptr<draco::Mesh> mesh =
+      draco::ReadMeshFromTestFile("test_nm.obj");
+  ASSERT_NE(mesh, nullptr);
+  draco::Encoder encoder;
+  encoder.SetAttributeQuantization(draco::GeometryAttribute::POSITION, 11);
+  encoder.SetAttributeQuantization(draco::GeometryAttribute::NORMAL, 8);
+  draco::EncoderBuffer encoder_buffer;
+  ASSERT_TRUE(encoder.EncodeMeshToBuffer(*mesh, &encoder_buffer).ok());
+
+  draco::DecoderBuffer buffer;
+  buffer.Init(encoder_buffer.data(), encoder_buffer.size());
+  draco::MeshBufferDecoder decoder;
+  ASSERT_TRUE(decoder.Decode(&buffer).ok());
+
+  // Quantized positions can be written as 16-bit integers.
+  std::vector<uint16_t> positions(decoder.num_points() * 3);
+  ASSERT_TRUE(decoder
+                  .WriteAttribute(draco::GeometryAttribute::POSITION,
+                                  draco::DT_UINT16, 3, 0, positions.data())
+                  .ok());
+  for (const uint16_t value : positions)
+    ASSERT_LT(value, 1 << 11);
+  // Normals need to be converted to floats.
+  std::vector<uint16_t> normals(decoder.num_points() * 3);
+  ASSERT_FALSE(decoder
+                   .WriteAttribute(draco::GeometryAttribute::NORMAL,
+                                   draco::DT_UINT16, 3, 0, normals.data())
+                   .ok());
+  // Too many components or too small stride.
+  std::vector<float> values(decoder.num_points() * 4);
+  ASSERT_FALSE(decoder
+                   .WriteAttribute(draco::GeometryAttribute::POSITION,
+                                   draco::DT_FLOAT32, 4, 0, values.data())
+                   .ok());
+  ASSERT_FALSE(decoder
+                   .WriteAttribute(draco::GeometryAttribute::POSITION,
+                                   draco::DT_FLOAT32, 3, 8, values.data())
+                   .ok());
+  ASSERT_FALSE(decoder.HasAttribute(draco::GeometryAttribute::COLOR));
+}
+
+TEST(StreamingDecoderTest, TestDecodingInPieces) {
+  // Tests that the streaming decoder exposes the connectivity and attributes
+  // before all data is received and that the final geometry is the same as
+  // the geometry decoded from the complete data.
+  const std::unique_ptr<draco::Mesh> mesh =
+      draco::ReadMeshFromTestFile("test_nm.obj");
+  ASSERT_NE(mesh, nullptr);
+  draco::Encoder encoder;
+  encoder.SetAttributeQuantization(draco::GeometryAttribute::POSITION, 11);
+  encoder.SetAttributeQuantization(draco::GeometryAttribute::NORMAL, 8);
+  draco::EncoderBuffer encoder_buffer;
+  ASSERT_TRUE(encoder.EncodeMeshToBuffer(*mesh, &encoder_buffer).ok());
+
+  draco::DecoderBuffer buffer;
+  buffer.Init(encoder_buffer.data(), encoder_buffer.size());
+  draco::Decoder decoder;
+  const std::unique_ptr<draco::Mesh> decoded_mesh =
+      decoder.DecodeMeshFromBuffer(&buffer).value();
+  ASSERT_NE(decoded_mesh, nullptr);
+
+  draco::StreamingDecoder streaming_decoder;
+  const size_t kPieceSize = 16;
+  size_t connectivity_size = 0;
+  for (size_t offset = 0; offset < encoder_buffer.size();
+       offset += kPieceSize) {
+    const size_t size = std::min(kPieceSize, encoder_buffer.size() - offset);
+    ASSERT_TRUE(
+        streaming_decoder.AppendData(encoder_buffer.data() + offset, size)
+            .ok());
+    if (connectivity_size == 0 && streaming_decoder.IsConnectivityDecoded())
+      connectivity_size = offset + size;
+    if (!streaming_decoder.IsConnectivityDecoded())
+      continue;
+    // Parts that were already decoded must match the reference mesh.
+    const draco::Mesh *const partial_mesh = streaming_decoder.mesh();
+    ASSERT_NE(partial_mesh, nullptr);
+    ASSERT_EQ(partial_mesh->num_faces(), decoded_mesh->num_faces());
+    ASSERT_EQ(partial_mesh->num_points(), decoded_mesh->num_points());
+    for (int i = 0; i < partial_mesh->num_attributes(); ++i) {
+      if (!streaming_decoder.IsAttributeDecoded(i))
+        continue;
+      const draco::DataBuffer *const data =
+          partial_mesh->attribute(i)->buffer();
+      const draco::DataBuffer *const ref_data =
+          decoded_mesh->attribute(i)->buffer();
+      ASSERT_EQ(data->data_size(), ref_data->data_size());
+      ASSERT_EQ(0, memcmp(data->data(), ref_data->data(), data->data_size()));
+    }
+  }
+  ASSERT_GT(connectivity_size, 0);
+  ASSERT_LT(connectivity_size, encoder_buffer.size());
+  ASSERT_TRUE(streaming_decoder.Finish().ok());
+  ASSERT_TRUE(streaming_decoder.IsComplete());
+  for (int i = 0; i < decoded_mesh->num_attributes(); ++i)
+    ASSERT_TRUE(streaming_decoder.IsAttributeDecoded(i));
+  const std::unique_ptr<draco::PointCloud> streamed_geometry =
+      streaming_decoder.ReleaseGeometry();
+  ASSERT_NE(streamed_geometry, nullptr);
+  const draco::Mesh &streamed_mesh =
+      static_cast<const draco::Mesh &>(*streamed_geometry);
+  for (draco::FaceIndex f(0); f < decoded_mesh->num_faces(); ++f)
+    ASSERT_EQ(streamed_mesh.face(f), decoded_mesh->face(f));
+}
+
+TEST(StreamingDecoderTest, TestResumeDecoding) {
+  // Tests that decoding continued after the data was cut at any position
+  // produces the same geometry as decoding of the complete data, including
+  // metadata of attributes that had to be decoded again.
+  const std::unique_ptr<draco::Mesh> mesh =
+      draco::ReadMeshFromTestFile("cube_att.obj");
+  ASSERT_NE(mesh, nullptr);
+  std::unique_ptr<draco::AttributeMetadata> att_metadata(
+      new draco::AttributeMetadata());
+  att_metadata->AddEntryString("name", "normals");
+  mesh->AddAttributeMetadata(
+      mesh->GetNamedAttributeId(draco::GeometryAttribute::NORMAL),
+      std::move(att_metadata));
+  draco::Encoder encoder;
+  encoder.SetAttributeQuantization(draco::GeometryAttribute::POSITION, 11);
+  encoder.SetAttributeQuantization(draco::GeometryAttribute::NORMAL, 8);
+  encoder.SetAttributeQuantization(draco::GeometryAttribute::TEX_COORD, 10);
+  draco::EncoderBuffer encoder_buffer;
+  ASSERT_TRUE(encoder.EncodeMeshToBuffer(*mesh, &encoder_buffer).ok());
+
+  draco::DecoderBuffer buffer;
+  buffer.Init(encoder_buffer.data(), encoder_buffer.size());
+  draco::Decoder decoder;
+  const std::unique_ptr<draco::Mesh> decoded_mesh =
+      decoder.DecodeMeshFromBuffer(&buffer).value();
+  ASSERT_NE(decoded_mesh, nullptr);
+
+  int num_resumed_attempts = 0;
+  // With more than one thread, transforms of the attributes are deferred to
+  // the end of the decoding.
+  for (int num_threads = 1; num_threads <= 2; ++num_threads) {
+    for (size_t cut = 1; cut < encoder_buffer.size(); ++cut) {
+      draco::StreamingDecoder streaming_decoder;
+      streaming_decoder.options()->SetGlobalInt("num_decoding_threads",
+                                                num_threads);
+      ASSERT_TRUE(
+          streaming_decoder.AppendData(encoder_buffer.data(), cut).ok());
+      if (streaming_decoder.IsConnectivityDecoded())
+        ++num_resumed_attempts;
+      ASSERT_TRUE(streaming_decoder
+                      .AppendData(encoder_buffer.data() + cut,
+                                  encoder_buffer.size() - cut)
+                      .ok());
+      ASSERT_TRUE(streaming_decoder.Finish().ok()) << "cut at " << cut;
+      const draco::Mesh *const streamed_mesh = streaming_decoder.mesh();
+      ASSERT_NE(streamed_mesh, nullptr);
+      ASSERT_EQ(streamed_mesh->num_faces(), decoded_mesh->num_faces());
+      ASSERT_EQ(streamed_mesh->num_attributes(),
+                decoded_mesh->num_attributes());
+      for (int i = 0; i < decoded_mesh->num_attributes(); ++i) {
+        const draco::PointAttribute *const att = streamed_mesh->attribute(i);
+        const draco::PointAttribute *const ref_att =
+            decoded_mesh->attribute(i);
+        ASSERT_EQ(att->unique_id(), ref_att->unique_id());
+        ASSERT_EQ(att->size(), ref_att->size());
+        ASSERT_EQ(0, memcmp(att->buffer()->data(), ref_att->buffer()->data(),
+                            ref_att->buffer()->data_size()));
+        for (draco::PointIndex p(0); p < decoded_mesh->num_points(); ++p)
+          ASSERT_EQ(att->mapped_index(p), ref_att->mapped_index(p));
+      }
+      const draco::AttributeMetadata *const decoded_metadata =
+          streamed_mesh->GetAttributeMetadataByStringEntry("name", "normals");
+      ASSERT_NE(decoded_metadata, nullptr) << "cut at " << cut;
+    }
+  }
+  ASSERT_GT(num_resumed_attempts, 0);
+}
+
+TEST(StreamingDecoderTest, TestInvalidData) {
+  // Tests that invalid data is reported as soon as the header is received.
+  const char kData[] = "NOT A DRACO FILE";
+  draco::StreamingDecoder decoder;
+  ASSERT_TRUE(decoder.AppendData(kData, 4).ok());
+  ASSERT_FALSE(decoder.AppendData(kData + 4, sizeof(kData) - 4).ok());
+
+  // Truncated data is reported at the end of the stream.
+  draco::StreamingDecoder truncated_decoder;
+  ASSERT_TRUE(truncated_decoder.AppendData("DRACO", 5).ok());
+  ASSERT_FALSE(truncated_decoder.Finish().ok());
+  ASSERT_FALSE(truncated_decoder.IsConnectivityDecoded());
+}
+
 }  // namespace
@@ -24,12 +24,14 @@ Status Encoder::EncodePointCloudToBuffer(const PointCloud &pc,
                                          EncoderBuffer *out_buffer) {
   ExpertEncoder encoder(pc);
   encoder.Reset(CreateExpertEncoderOptions(pc));
+  encoder.SetStats(stats());
   return encoder.EncodeToBuffer(out_buffer);
 }
 
 Status Encoder::EncodeMeshToBuffer(const Mesh &m, EncoderBuffer *out_buffer) {
   ExpertEncoder encoder(m);
   encoder.Reset(CreateExpertEncoderOptions(m));
+  encoder.SetStats(stats());
   return encoder.EncodeToBuffer(out_buffer);
 }
 
@@ -79,6 +81,18 @@ void Encoder::SetEncodingMethod(int encoding_method) {
   Base::SetEncodingMethod(encoding_method);
 }
 
+void Encoder::SetMaxChunkFaces(int max_chunk_faces) {
+  Base::SetMaxChunkFaces(max_chunk_faces);
+}
+
+void Encoder::SetKdTreeLevelOrder(bool enabled) {
+  Base::SetKdTreeLevelOrder(enabled);
+}
+
+void Encoder::SetKdTreeSubtreePoints(int max_subtree_points) {
+  Base::SetKdTreeSubtreePoints(max_subtree_points);
+}
+
 Status Encoder::SetAttributePredictionScheme(GeometryAttribute::Type type,
                                              int prediction_scheme_method) {
   Status status = CheckPredictionScheme(type, prediction_scheme_method);
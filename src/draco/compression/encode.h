@@ -123,11 +123,33 @@ class Encoder
   // For meshes the input can be
   //   MESH_SEQUENTIAL_ENCODING
   //   MESH_EDGEBREAKER_ENCODING
+  //   MESH_CHUNKED_ENCODING - splits the mesh into chunks that can be decoded
+  //                           in parallel (see SetMaxChunkFaces()).
   //
   // If the selected method cannot be used for the given input, the subsequent
   // call of EncodePointCloudToBuffer or EncodeMeshToBuffer is going to fail.
   void SetEncodingMethod(int encoding_method);
 
+  // Sets the maximum number of faces in one chunk of a mesh encoded with the
+  // MESH_CHUNKED_ENCODING method. Smaller chunks allow more chunks to be
+  // decoded in parallel at the cost of a slightly worse compression.
+  void SetMaxChunkFaces(int max_chunk_faces);
+
+  // Enables encoding of the kD-tree of point clouds encoded with the
+  // POINT_CLOUD_KD_TREE_ENCODING method level by level. Such point clouds can
+  // be decoded at a lower level of detail using the "kd_tree_max_depth" and
+  // "kd_tree_max_points" decoder options.
+  void SetKdTreeLevelOrder(bool enabled);
+
+  // Splits the kD-tree of point clouds encoded with the
+  // POINT_CLOUD_KD_TREE_ENCODING method into independently encoded subtrees
+  // with at most |max_subtree_points| points. The decoder can then decode
+  // only the points inside of a query box given by the "kd_tree_query_box_min"
+  // and "kd_tree_query_box_max" decoder options while skipping the remaining
+  // subtrees. Smaller subtrees allow more precise skipping at the cost of a
+  // slightly worse compression. Ignored when SetKdTreeLevelOrder() is enabled.
+  void SetKdTreeSubtreePoints(int max_subtree_points);
+
  private:
   // Creates encoder options for the expert encoder used during the actual
   // encoding.
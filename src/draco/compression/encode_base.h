@@ -17,6 +17,7 @@
 
 #include "draco/attributes/geometry_attribute.h"
 #include "draco/compression/config/compression_shared.h"
+#include "draco/core/coding_stats.h"
 #include "draco/core/status.h"
 
 namespace draco {
@@ -29,11 +30,19 @@ class EncoderBase {
  public:
   typedef EncoderOptionsT OptionsType;
 
-  EncoderBase() : options_(EncoderOptionsT::CreateDefaultOptions()) {}
+  EncoderBase()
+      : options_(EncoderOptionsT::CreateDefaultOptions()), stats_(nullptr) {}
 
   const EncoderOptionsT &options() const { return options_; }
   EncoderOptionsT &options() { return options_; }
 
+  // Sets an object that collects statistics of the individual stages of the
+  // following encoding calls, such as their time and the number of encoded
+  // bytes. Use nullptr to stop the collection. The statistics are collected
+  // only when Draco is built with DRACO_STATS_SUPPORTED (see CodingStats).
+  void SetStats(CodingStats *stats) { stats_ = stats; }
+  CodingStats *stats() const { return stats_; }
+
  protected:
   void Reset(const EncoderOptionsT &options) { options_ = options; }
 
@@ -47,6 +56,18 @@ class EncoderBase {
     options_.SetGlobalInt("encoding_method", encoding_method);
   }
 
+  void SetMaxChunkFaces(int max_chunk_faces) {
+    options_.SetGlobalInt("max_chunk_faces", max_chunk_faces);
+  }
+
+  void SetKdTreeLevelOrder(bool enabled) {
+    options_.SetGlobalBool("kd_tree_level_order", enabled);
+  }
+
+  void SetKdTreeSubtreePoints(int max_subtree_points) {
+    options_.SetGlobalInt("kd_tree_subtree_points", max_subtree_points);
+  }
+
   Status CheckPredictionScheme(GeometryAttribute::Type att_type,
                                int prediction_scheme) {
     if (prediction_scheme < 0)
@@ -71,6 +92,7 @@ class EncoderBase {
 
  private:
   EncoderOptionsT options_;
+  CodingStats *stats_;
 };
 
 }  // namespace draco
@@ -0,0 +1,215 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// End-to-end benchmarks of the encoder and the decoder. Each benchmark is run
+// for every input mesh and every compression level in the range <0, 10>, the
+// same way meshes are compressed by the draco_encoder tool.
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "draco/compression/decode.h"
+#include "draco/compression/encode.h"
+#include "draco/core/draco_benchmark_utils.h"
+#include "draco/io/mesh_io.h"
+
+namespace draco {
+
+namespace {
+
+// Test files used as inputs.
+const char *const kInputFiles[] = {"bun_zipper.ply", "cube_att.obj",
+                                   "test_nm.obj", "test_sphere.obj"};
+constexpr int kNumInputFiles = sizeof(kInputFiles) / sizeof(kInputFiles[0]);
+// Grid sizes of the synthetic input meshes that follow the test files.
+constexpr int kInputGridSizes[] = {128, 512};
+constexpr int kNumInputs =
+    kNumInputFiles + sizeof(kInputGridSizes) / sizeof(kInputGridSizes[0]);
+
+// Returns the name of the input with index |input|.
+std::string GetInputName(int input) {
+  if (input < kNumInputFiles)
+    return kInputFiles[input];
+  const int grid_size = kInputGridSizes[input - kNumInputFiles];
+  return "grid_" + std::to_string(grid_size);
+}
+
+// Returns the input mesh with index |input| or nullptr when the mesh can't be
+// loaded. The meshes are loaded only once.
+const Mesh *GetInputMesh(int input) {
+  static std::vector<std::unique_ptr<Mesh>> meshes(kNumInputs);
+  if (meshes[input] == nullptr) {
+    if (input < kNumInputFiles) {
+      auto maybe_mesh =
+          ReadMeshFromFile(GetBenchmarkFileFullPath(kInputFiles[input]));
+      if (maybe_mesh.ok())
+        meshes[input] = std::move(maybe_mesh).value();
+    } else {
+      meshes[input] = CreateGridMesh(kInputGridSizes[input - kNumInputFiles]);
+    }
+  }
+  return meshes[input].get();
+}
+
+// Sets up |encoder| with the default options of the draco_encoder tool for
+// the given |compression_level|.
+void SetUpEncoder(int compression_level, Encoder *encoder) {
+  const int speed = 10 - compression_level;
+  encoder->SetAttributeQuantization(GeometryAttribute::POSITION, 14);
+  encoder->SetAttributeQuantization(GeometryAttribute::TEX_COORD, 12);
+  encoder->SetAttributeQuantization(GeometryAttribute::NORMAL, 10);
+  encoder->SetAttributeQuantization(GeometryAttribute::GENERIC, 8);
+  encoder->SetSpeedOptions(speed, speed);
+}
+
+// Encodes the input mesh state.range(0) as a mesh (|as_point_cloud| is false)
+// or as a point cloud with compression level state.range(1). Returns false
+// on error.
+bool EncodeInput(benchmark::State &state, bool as_point_cloud,
+                 EncoderBuffer *out_buffer) {
+  const Mesh *const mesh = GetInputMesh(static_cast<int>(state.range(0)));
+  if (mesh == nullptr) {
+    state.SkipWithError("Failed to load the input mesh.");
+    return false;
+  }
+  Encoder encoder;
+  SetUpEncoder(static_cast<int>(state.range(1)), &encoder);
+  out_buffer->Clear();
+  const Status status =
+      as_point_cloud ? encoder.EncodePointCloudToBuffer(*mesh, out_buffer)
+                     : encoder.EncodeMeshToBuffer(*mesh, out_buffer);
+  if (!status.ok()) {
+    state.SkipWithError(status.error_msg());
+    return false;
+  }
+  return true;
+}
+
+// Sets the label and the counters shared by all end-to-end benchmarks.
+void SetInputCounters(benchmark::State &state,
+                      const EncoderBuffer &encoded_buffer) {
+  const Mesh *const mesh = GetInputMesh(static_cast<int>(state.range(0)));
+  state.SetLabel(GetInputName(static_cast<int>(state.range(0))));
+  state.counters["encoded_size"] = encoded_buffer.size();
+  state.SetItemsProcessed(state.iterations() * mesh->num_points());
+}
+
+void BM_EncodeMesh(benchmark::State &state) {
+  EncoderBuffer buffer;
+  for (auto _ : state) {
+    if (!EncodeInput(state, false, &buffer))
+      return;
+  }
+  SetInputCounters(state, buffer);
+}
+
+void BM_DecodeMesh(benchmark::State &state) {
+  EncoderBuffer encoded_buffer;
+  if (!EncodeInput(state, false, &encoded_buffer))
+    return;
+  // The decoder is reused the same way as by applications decoding many
+  // meshes, so its decoders and scratch memory are kept between iterations.
+  Decoder decoder;
+  for (auto _ : state) {
+    DecoderBuffer buffer;
+    buffer.Init(encoded_buffer.data(), encoded_buffer.size());
+    auto maybe_mesh = decoder.DecodeMeshFromBuffer(&buffer);
+    if (!maybe_mesh.ok()) {
+      state.SkipWithError(maybe_mesh.status().error_msg());
+      return;
+    }
+    benchmark::DoNotOptimize(maybe_mesh.value().get());
+  }
+  SetInputCounters(state, encoded_buffer);
+}
+
+void BM_EncodePointCloud(benchmark::State &state) {
+  EncoderBuffer buffer;
+  for (auto _ : state) {
+    if (!EncodeInput(state, true, &buffer))
+      return;
+  }
+  SetInputCounters(state, buffer);
+}
+
+void BM_DecodePointCloud(benchmark::State &state) {
+  EncoderBuffer encoded_buffer;
+  if (!EncodeInput(state, true, &encoded_buffer))
+    return;
+  Decoder decoder;
+  for (auto _ : state) {
+    DecoderBuffer buffer;
+    buffer.Init(encoded_buffer.data(), encoded_buffer.size());
+    auto maybe_pc = decoder.DecodePointCloudFromBuffer(&buffer);
+    if (!maybe_pc.ok()) {
+      state.SkipWithError(maybe_pc.status().error_msg());
+      return;
+    }
+    benchmark::DoNotOptimize(maybe_pc.value().get());
+  }
+  SetInputCounters(state, encoded_buffer);
+}
+
+// Decodes the small input mesh state.range(0) compressed with compression
+// level state.range(1) many times in a row, either with a new Decoder for
+// every mesh or with one Decoder reused for all meshes (state.range(2) is 1).
+// This is the typical use case of streaming many small meshes, where the
+// setup cost of the decoder is significant.
+void BM_DecodeSmallMeshRepeated(benchmark::State &state) {
+  constexpr int kNumDecodes = 100;
+  EncoderBuffer encoded_buffer;
+  if (!EncodeInput(state, false, &encoded_buffer))
+    return;
+  const bool reuse_decoder = state.range(2) != 0;
+  Decoder reused_decoder;
+  for (auto _ : state) {
+    for (int i = 0; i < kNumDecodes; ++i) {
+      DecoderBuffer buffer;
+      buffer.Init(encoded_buffer.data(), encoded_buffer.size());
+      Decoder new_decoder;
+      Decoder &decoder = reuse_decoder ? reused_decoder : new_decoder;
+      auto maybe_mesh = decoder.DecodeMeshFromBuffer(&buffer);
+      if (!maybe_mesh.ok()) {
+        state.SkipWithError(maybe_mesh.status().error_msg());
+        return;
+      }
+      benchmark::DoNotOptimize(maybe_mesh.value().get());
+    }
+  }
+  state.SetLabel(GetInputName(static_cast<int>(state.range(0))));
+  state.counters["encoded_size"] = encoded_buffer.size();
+  state.SetItemsProcessed(state.iterations() * kNumDecodes);
+}
+
+// Runs benchmark |bm| for all inputs and compression levels.
+void ApplyInputsAndLevels(benchmark::internal::Benchmark *bm) {
+  bm->ArgNames({"input", "level"})
+      ->ArgsProduct({benchmark::CreateDenseRange(0, kNumInputs - 1, 1),
+                     benchmark::CreateDenseRange(0, 10, 1)})
+      ->Unit(benchmark::kMillisecond);
+}
+
+BENCHMARK(BM_EncodeMesh)->Apply(ApplyInputsAndLevels);
+BENCHMARK(BM_DecodeMesh)->Apply(ApplyInputsAndLevels);
+BENCHMARK(BM_EncodePointCloud)->Apply(ApplyInputsAndLevels);
+BENCHMARK(BM_DecodePointCloud)->Apply(ApplyInputsAndLevels);
+// Inputs cube_att.obj and test_nm.obj with the default compression level of
+// the draco_encoder tool.
+BENCHMARK(BM_DecodeSmallMeshRepeated)
+    ->ArgNames({"input", "level", "reuse"})
+    ->ArgsProduct({{1, 2}, {7}, {0, 1}})
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace
+
+}  // namespace draco
@@ -13,6 +13,7 @@
 // limitations under the License.
 //
 
+#include <algorithm>
 #include <cinttypes>
 #include <fstream>
 #include <sstream>
@@ -143,4 +144,41 @@ TEST_F(EncodeTest, TestLinesObj) {
   ASSERT_TRUE(encoder.EncodePointCloudToBuffer(*pc, &buffer).ok());
 }
 
+TEST_F(EncodeTest, TestParallelAttributeEncoding) {
+  // This test verifies that encoding of attributes on multiple threads
+  // produces exactly the same data as the serial encoder.
+  const std::string file_names[] = {"cube_att.obj", "test_nm.obj",
+                                    "test_sphere.obj"};
+  for (const std::string &file_name : file_names) {
+    std::unique_ptr<draco::Mesh> mesh(draco::ReadMeshFromTestFile(file_name));
+    ASSERT_NE(mesh, nullptr) << "Failed to load " << file_name;
+    for (int method = 0; method < 2; ++method) {
+      for (int speed = 0; speed < 11; speed += 5) {
+        draco::Encoder encoder;
+        encoder.SetAttributeQuantization(draco::GeometryAttribute::POSITION,
+                                         14);
+        encoder.SetAttributeQuantization(draco::GeometryAttribute::TEX_COORD,
+                                         12);
+        encoder.SetAttributeQuantization(draco::GeometryAttribute::NORMAL, 10);
+        encoder.SetSpeedOptions(speed, speed);
+        encoder.SetEncodingMethod(method == 0
+                                      ? draco::MESH_SEQUENTIAL_ENCODING
+                                      : draco::MESH_EDGEBREAKER_ENCODING);
+        draco::EncoderBuffer serial_buffer;
+        ASSERT_TRUE(encoder.EncodeMeshToBuffer(*mesh, &serial_buffer).ok());
+
+        encoder.options().SetGlobalInt("num_encoding_threads", 4);
+        draco::EncoderBuffer parallel_buffer;
+        ASSERT_TRUE(encoder.EncodeMeshToBuffer(*mesh, &parallel_buffer).ok());
+        ASSERT_EQ(serial_buffer.size(), parallel_buffer.size())
+            << file_name << " method " << method << " speed " << speed;
+        ASSERT_TRUE(std::equal(serial_buffer.data(),
+                               serial_buffer.data() + serial_buffer.size(),
+                               parallel_buffer.data()))
+            << file_name << " method " << method << " speed " << speed;
+      }
+    }
+  }
+}
+
 }  // namespace
@@ -14,6 +14,7 @@
 //
 #include "draco/compression/expert_encode.h"
 
+#include "draco/compression/mesh/mesh_chunked_encoder.h"
 #include "draco/compression/mesh/mesh_edgebreaker_encoder.h"
 #include "draco/compression/mesh/mesh_sequential_encoder.h"
 #include "draco/compression/point_cloud/point_cloud_kd_tree_encoder.h"
@@ -86,6 +87,7 @@ Status ExpertEncoder::EncodePointCloudToBuffer(const PointCloud &pc,
     encoder.reset(new PointCloudSequentialEncoder());
   }
   encoder->SetPointCloud(pc);
+  encoder->set_stats(stats());
   return encoder->Encode(options(), out_buffer);
 }
 
@@ -104,10 +106,13 @@ Status ExpertEncoder::EncodeMeshToBuffer(const Mesh &m,
   }
   if (encoding_method == MESH_EDGEBREAKER_ENCODING) {
     encoder = std::unique_ptr<MeshEncoder>(new MeshEdgeBreakerEncoder());
+  } else if (encoding_method == MESH_CHUNKED_ENCODING) {
+    encoder = std::unique_ptr<MeshEncoder>(new MeshChunkedEncoder());
   } else {
     encoder = std::unique_ptr<MeshEncoder>(new MeshSequentialEncoder());
   }
   encoder->SetMesh(m);
+  encoder->set_stats(stats());
   return encoder->Encode(options(), out_buffer);
 }
 
@@ -147,6 +152,18 @@ void ExpertEncoder::SetEncodingMethod(int encoding_method) {
   Base::SetEncodingMethod(encoding_method);
 }
 
+void ExpertEncoder::SetMaxChunkFaces(int max_chunk_faces) {
+  Base::SetMaxChunkFaces(max_chunk_faces);
+}
+
+void ExpertEncoder::SetKdTreeLevelOrder(bool enabled) {
+  Base::SetKdTreeLevelOrder(enabled);
+}
+
+void ExpertEncoder::SetKdTreeSubtreePoints(int max_subtree_points) {
+  Base::SetKdTreeSubtreePoints(max_subtree_points);
+}
+
 Status ExpertEncoder::SetAttributePredictionScheme(
     int32_t attribute_id, int prediction_scheme_method) {
   auto att = point_cloud_->GetAttributeByUniqueId(attribute_id);
@@ -0,0 +1,402 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/compression/mesh/mesh_chunked_decoder.h"
+
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+
+#include "draco/compression/mesh/mesh_edgebreaker_decoder.h"
+#include "draco/compression/mesh/mesh_sequential_decoder.h"
+#include "draco/core/thread_pool.h"
+#include "draco/core/varint_decoding.h"
+
+namespace draco {
+
+struct MeshChunkedDecoder::DecodedChunk {
+  DecodedChunk()
+      : info(nullptr),
+        num_stitch_points(0),
+        first_point(0),
+        num_new_stitch_points(0),
+        num_new_points(0),
+        first_face(0),
+        peak_memory_usage(0),
+        success(false) {}
+  const ChunkInfo *info;
+  std::unique_ptr<Mesh> mesh;
+  // Ids of the attributes of |mesh| that are copied into the output mesh (all
+  // attributes except for the stitch attribute).
+  std::vector<int> att_ids;
+  // Points of |mesh| with equal stitch ids are merged into a single point.
+  // Merged points with stitch ids come first, sorted by the ids.
+  std::vector<uint32_t> point_to_merged_point;
+  // Point of |mesh| representing each merged point.
+  std::vector<PointIndex> merged_points;
+  uint32_t num_stitch_points;
+  // Stitch ids of the first |num_stitch_points| merged points.
+  std::vector<uint32_t> stitch_ids;
+  // Map between merged points and points of the output mesh.
+  std::vector<PointIndex> output_points;
+  // Points of the output mesh created by this chunk are stored in the range
+  // [first_point, first_point + num_new_points). The new stitched points come
+  // first.
+  uint32_t first_point;
+  uint32_t num_new_stitch_points;
+  uint32_t num_new_points;
+  uint32_t first_face;
+  // For each attribute: number of values copied into the output attribute and
+  // offset of the first of them.
+  std::vector<uint32_t> num_values;
+  std::vector<uint32_t> value_offsets;
+  // For each attribute with explicit mapping: map between values of the chunk
+  // and values copied into the output attribute (-1 for unused values).
+  std::vector<std::vector<int32_t>> value_maps;
+  // Peak memory usage of the decoder of the chunk.
+  size_t peak_memory_usage;
+  bool success;
+};
+
+MeshChunkedDecoder::MeshChunkedDecoder() : stitch_att_unique_id_(0) {}
+
+bool MeshChunkedDecoder::DecodeConnectivity() {
+  if (!DecodeVarint(&stitch_att_unique_id_, buffer()))
+    return false;
+  uint32_t num_chunks;
+  if (!DecodeVarint(&num_chunks, buffer()))
+    return false;
+  // Every directory entry takes at least 28 bytes.
+  if (num_chunks == 0 || num_chunks > buffer()->remaining_size() / 28)
+    return false;
+  chunks_.resize(num_chunks);
+  for (ChunkInfo &chunk : chunks_) {
+    if (!DecodeVarint(&chunk.num_faces, buffer()))
+      return false;
+    if (!DecodeVarint(&chunk.num_points, buffer()))
+      return false;
+    if (!buffer()->Decode(chunk.bbox_min, sizeof(chunk.bbox_min)))
+      return false;
+    if (!buffer()->Decode(chunk.bbox_max, sizeof(chunk.bbox_max)))
+      return false;
+    if (!DecodeVarint(&chunk.offset, buffer()))
+      return false;
+    if (!DecodeVarint(&chunk.size, buffer()))
+      return false;
+  }
+  const char *const data = buffer()->data_head();
+  const uint64_t data_size = buffer()->remaining_size();
+  uint64_t data_end = 0;
+  for (const ChunkInfo &chunk : chunks_) {
+    if (chunk.offset > data_size || chunk.size > data_size - chunk.offset)
+      return false;
+    data_end = std::max(data_end, chunk.offset + chunk.size);
+  }
+  buffer()->Advance(data_end);
+
+  // Decode the chunks concurrently when requested. In that case the attributes
+  // within each chunk are decoded serially.
+  const int num_threads = options()->GetGlobalInt("num_decoding_threads", 1);
+  const int num_chunk_threads =
+      std::min(num_threads, static_cast<int>(num_chunks));
+  DecoderOptions chunk_options = *options();
+  chunk_options.SetGlobalInt("num_decoding_threads",
+                             num_chunk_threads > 1 ? 1 : num_threads);
+  // Chunk attributes are always needed in their final form for stitching.
+  chunk_options.SetGlobalBool("decode_portable_attributes_only", false);
+
+  std::vector<DecodedChunk> decoded_chunks(num_chunks);
+  ThreadPool thread_pool(num_chunk_threads > 1 ? num_chunk_threads : 0);
+  for (uint32_t c = 0; c < num_chunks; ++c) {
+    decoded_chunks[c].info = &chunks_[c];
+    thread_pool.Schedule([this, data, &chunk_options, &decoded_chunks, c]() {
+      decoded_chunks[c].success =
+          DecodeChunk(data, chunk_options, &decoded_chunks[c]);
+    });
+  }
+  thread_pool.Wait();
+  size_t chunks_memory_usage = 0;
+  for (const DecodedChunk &chunk : decoded_chunks) {
+    if (!chunk.success)
+      return false;
+    // Chunks decoded in parallel may all be in memory at the same time.
+    if (num_chunk_threads > 1) {
+      chunks_memory_usage += chunk.peak_memory_usage;
+    } else {
+      chunks_memory_usage =
+          std::max(chunks_memory_usage, chunk.peak_memory_usage);
+    }
+  }
+  UpdatePeakMemoryUsage(chunks_memory_usage);
+  return StitchChunks(&decoded_chunks, num_threads);
+}
+
+bool MeshChunkedDecoder::DecodeChunk(const char *data,
+                                     const DecoderOptions &options,
+                                     DecodedChunk *chunk) const {
+  DecoderBuffer chunk_buffer;
+  chunk_buffer.Init(data + chunk->info->offset, chunk->info->size);
+  DecoderBuffer header_buffer(chunk_buffer);
+  DracoHeader header;
+  if (!DecodeHeader(&header_buffer, &header).ok())
+    return false;
+  if (header.encoder_type != TRIANGULAR_MESH)
+    return false;
+  std::unique_ptr<MeshDecoder> decoder;
+  if (header.encoder_method == MESH_EDGEBREAKER_ENCODING) {
+    decoder.reset(new MeshEdgeBreakerDecoder());
+  } else if (header.encoder_method == MESH_SEQUENTIAL_ENCODING) {
+    decoder.reset(new MeshSequentialDecoder());
+  } else {
+    return false;  // Chunks cannot be nested.
+  }
+  chunk->mesh.reset(new Mesh());
+  if (!decoder->Decode(options, &chunk_buffer, chunk->mesh.get()).ok())
+    return false;
+  chunk->peak_memory_usage = decoder->peak_memory_usage();
+
+  const Mesh &mesh = *chunk->mesh;
+  if (mesh.num_faces() != chunk->info->num_faces)
+    return false;
+  const PointAttribute *stitch_att = nullptr;
+  chunk->att_ids.clear();
+  for (int i = 0; i < mesh.num_attributes(); ++i) {
+    if (mesh.attribute(i)->unique_id() == stitch_att_unique_id_) {
+      stitch_att = mesh.attribute(i);
+    } else {
+      chunk->att_ids.push_back(i);
+    }
+  }
+  if (stitch_att == nullptr || stitch_att->data_type() != DT_UINT32 ||
+      stitch_att->num_components() != 1)
+    return false;
+
+  // Merge points with equal stitch ids. This reverts splitting of points on
+  // non-manifold vertices and makes each point shared with other chunks appear
+  // only once.
+  const uint32_t num_points = mesh.num_points();
+  std::vector<uint32_t> point_stitch_ids(num_points);
+  std::vector<std::pair<uint32_t, uint32_t>> stitched_points;
+  for (PointIndex p(0); p < num_points; ++p) {
+    stitch_att->GetMappedValue(p, &point_stitch_ids[p.value()]);
+    if (point_stitch_ids[p.value()] != 0)
+      stitched_points.push_back(
+          std::make_pair(point_stitch_ids[p.value()], p.value()));
+  }
+  std::sort(stitched_points.begin(), stitched_points.end());
+  chunk->point_to_merged_point.resize(num_points);
+  chunk->merged_points.clear();
+  chunk->stitch_ids.clear();
+  for (size_t i = 0; i < stitched_points.size(); ++i) {
+    if (i == 0 || stitched_points[i].first != stitched_points[i - 1].first) {
+      chunk->merged_points.push_back(PointIndex(stitched_points[i].second));
+      chunk->stitch_ids.push_back(stitched_points[i].first);
+    }
+    chunk->point_to_merged_point[stitched_points[i].second] =
+        static_cast<uint32_t>(chunk->merged_points.size() - 1);
+  }
+  chunk->num_stitch_points = static_cast<uint32_t>(chunk->stitch_ids.size());
+  for (PointIndex p(0); p < num_points; ++p) {
+    if (point_stitch_ids[p.value()] == 0) {
+      chunk->point_to_merged_point[p.value()] =
+          static_cast<uint32_t>(chunk->merged_points.size());
+      chunk->merged_points.push_back(p);
+    }
+  }
+  return chunk->merged_points.size() == chunk->info->num_points;
+}
+
+bool MeshChunkedDecoder::StitchChunks(
+    std::vector<DecodedChunk> *decoded_chunks, int num_threads) {
+  // All chunks must contain the same attributes.
+  const DecodedChunk &first_chunk = (*decoded_chunks)[0];
+  const Mesh &first_mesh = *first_chunk.mesh;
+  const int num_attributes = static_cast<int>(first_chunk.att_ids.size());
+  for (const DecodedChunk &chunk : *decoded_chunks) {
+    if (static_cast<int>(chunk.att_ids.size()) != num_attributes)
+      return false;
+    for (int i = 0; i < num_attributes; ++i) {
+      const PointAttribute *const att =
+          chunk.mesh->attribute(chunk.att_ids[i]);
+      const PointAttribute *const first_att =
+          first_mesh.attribute(first_chunk.att_ids[i]);
+      if (att->attribute_type() != first_att->attribute_type() ||
+          att->data_type() != first_att->data_type() ||
+          att->num_components() != first_att->num_components())
+        return false;
+    }
+  }
+
+  // Assign output point ids to the stitched points. This is the only serial
+  // step that processes individual points and it visits just the stitched
+  // ones.
+  std::unordered_map<uint32_t, PointIndex> stitched_points;
+  uint64_t num_points = 0;
+  uint64_t num_faces = 0;
+  for (DecodedChunk &chunk : *decoded_chunks) {
+    chunk.first_point = static_cast<uint32_t>(num_points);
+    chunk.first_face = static_cast<uint32_t>(num_faces);
+    chunk.output_points.resize(chunk.merged_points.size());
+    uint32_t next_point = chunk.first_point;
+    for (uint32_t i = 0; i < chunk.num_stitch_points; ++i) {
+      const auto it = stitched_points.insert(
+          std::make_pair(chunk.stitch_ids[i], PointIndex(next_point)));
+      if (it.second)
+        ++next_point;
+      chunk.output_points[i] = it.first->second;
+    }
+    chunk.num_new_stitch_points = next_point - chunk.first_point;
+    chunk.num_new_points = chunk.num_new_stitch_points +
+                           static_cast<uint32_t>(chunk.merged_points.size()) -
+                           chunk.num_stitch_points;
+    num_points += chunk.num_new_points;
+    num_faces += chunk.mesh->num_faces();
+    if (num_points > std::numeric_limits<uint32_t>::max() ||
+        num_faces > std::numeric_limits<uint32_t>::max())
+      return false;
+  }
+
+  const int num_chunks = static_cast<int>(decoded_chunks->size());
+  const int num_stitch_threads = std::min(num_threads, num_chunks);
+  ThreadPool thread_pool(num_stitch_threads > 1 ? num_stitch_threads : 0);
+
+  // Assign output ids to the remaining points and find attribute values used
+  // by the new points of each chunk.
+  for (DecodedChunk &chunk : *decoded_chunks) {
+    thread_pool.Schedule([&chunk, num_attributes]() {
+      const uint32_t num_merged_points =
+          static_cast<uint32_t>(chunk.merged_points.size());
+      for (uint32_t i = chunk.num_stitch_points; i < num_merged_points; ++i) {
+        chunk.output_points[i] = PointIndex(chunk.first_point +
+                                            chunk.num_new_stitch_points + i -
+                                            chunk.num_stitch_points);
+      }
+      chunk.num_values.assign(num_attributes, 0);
+      chunk.value_maps.resize(num_attributes);
+      for (int a = 0; a < num_attributes; ++a) {
+        const PointAttribute *const att =
+            chunk.mesh->attribute(chunk.att_ids[a]);
+        if (att->is_mapping_identity()) {
+          chunk.num_values[a] = chunk.num_new_points;
+          continue;
+        }
+        std::vector<int32_t> &value_map = chunk.value_maps[a];
+        value_map.assign(att->size(), -1);
+        int32_t num_values = 0;
+        for (uint32_t i = 0; i < num_merged_points; ++i) {
+          if (chunk.output_points[i].value() < chunk.first_point)
+            continue;  // Point was created by a previous chunk.
+          const AttributeValueIndex avi =
+              att->mapped_index(chunk.merged_points[i]);
+          if (value_map[avi.value()] < 0)
+            value_map[avi.value()] = num_values++;
+        }
+        chunk.num_values[a] = num_values;
+      }
+    });
+  }
+  thread_pool.Wait();
+
+  // Create the output attributes. Attributes that are identity-mapped in all
+  // chunks stay identity-mapped, other attributes share values between points
+  // in the same way as in the chunks.
+  Mesh *const out_mesh = mesh();
+  out_mesh->set_num_points(static_cast<uint32_t>(num_points));
+  std::vector<uint8_t> is_identity_mapping(num_attributes, 1);
+  for (int a = 0; a < num_attributes; ++a) {
+    uint32_t num_values = 0;
+    for (DecodedChunk &chunk : *decoded_chunks) {
+      chunk.value_offsets.resize(num_attributes);
+      chunk.value_offsets[a] = num_values;
+      num_values += chunk.num_values[a];
+      if (!chunk.mesh->attribute(chunk.att_ids[a])->is_mapping_identity())
+        is_identity_mapping[a] = 0;
+    }
+    const PointAttribute *const first_att =
+        first_mesh.attribute(first_chunk.att_ids[a]);
+    GeometryAttribute ga;
+    ga.Init(first_att->attribute_type(), nullptr, first_att->num_components(),
+            first_att->data_type(), first_att->normalized(),
+            DataTypeLength(first_att->data_type()) *
+                first_att->num_components(),
+            0);
+    const int att_id = out_mesh->AddAttribute(ga, is_identity_mapping[a] != 0,
+                                              num_values);
+    out_mesh->attribute(att_id)->set_unique_id(first_att->unique_id());
+  }
+
+  // Copy attribute values and faces of all chunks.
+  out_mesh->SetNumFaces(num_faces);
+  for (const DecodedChunk &chunk : *decoded_chunks) {
+    thread_pool.Schedule([&chunk, &is_identity_mapping, out_mesh,
+                          num_attributes]() {
+      const uint32_t num_merged_points =
+          static_cast<uint32_t>(chunk.merged_points.size());
+      for (int a = 0; a < num_attributes; ++a) {
+        const PointAttribute *const att =
+            chunk.mesh->attribute(chunk.att_ids[a]);
+        PointAttribute *const out_att = out_mesh->attribute(a);
+        const uint32_t value_offset = chunk.value_offsets[a];
+        if (att->is_mapping_identity()) {
+          for (uint32_t i = 0; i < num_merged_points; ++i) {
+            const PointIndex point = chunk.output_points[i];
+            if (point.value() < chunk.first_point)
+              continue;
+            const AttributeValueIndex out_avi(value_offset + point.value() -
+                                              chunk.first_point);
+            out_att->SetAttributeValue(
+                out_avi, att->GetAddress(att->mapped_index(
+                             chunk.merged_points[i])));
+            if (!is_identity_mapping[a])
+              out_att->SetPointMapEntry(point, out_avi);
+          }
+          continue;
+        }
+        const std::vector<int32_t> &value_map = chunk.value_maps[a];
+        for (AttributeValueIndex avi(0); avi < att->size(); ++avi) {
+          if (value_map[avi.value()] >= 0) {
+            out_att->SetAttributeValue(
+                AttributeValueIndex(value_offset + value_map[avi.value()]),
+                att->GetAddress(avi));
+          }
+        }
+        for (uint32_t i = 0; i < num_merged_points; ++i) {
+          const PointIndex point = chunk.output_points[i];
+          if (point.value() < chunk.first_point)
+            continue;
+          const AttributeValueIndex avi =
+              att->mapped_index(chunk.merged_points[i]);
+          out_att->SetPointMapEntry(
+              point,
+              AttributeValueIndex(value_offset + value_map[avi.value()]));
+        }
+      }
+      FaceIndex face_id(chunk.first_face);
+      for (FaceIndex f(0); f < chunk.mesh->num_faces(); ++f) {
+        const Mesh::Face &chunk_face = chunk.mesh->face(f);
+        Mesh::Face face;
+        for (int c = 0; c < 3; ++c) {
+          face[c] = chunk.output_points[chunk.point_to_merged_point
+                                            [chunk_face[c].value()]];
+        }
+        out_mesh->SetFace(face_id++, face);
+      }
+    });
+  }
+  thread_pool.Wait();
+  return true;
+}
+
+}  // namespace draco
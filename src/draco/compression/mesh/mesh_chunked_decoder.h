@@ -0,0 +1,75 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef DRACO_COMPRESSION_MESH_MESH_CHUNKED_DECODER_H_
+#define DRACO_COMPRESSION_MESH_MESH_CHUNKED_DECODER_H_
+
+#include <vector>
+
+#include "draco/compression/mesh/mesh_decoder.h"
+
+namespace draco {
+
+// Class for decoding data encoded by MeshChunkedEncoder. The chunks are
+// decoded concurrently when the global decoder option "num_decoding_threads"
+// is larger than 1. Decoded chunks are merged into the output mesh where the
+// points with equal stitch ids (see mesh_chunked_encoder.h) are stitched
+// together. Only the stitched points are processed serially, all other work
+// is done for each chunk in parallel.
+class MeshChunkedDecoder : public MeshDecoder {
+ public:
+  // Entry of the chunk directory.
+  struct ChunkInfo {
+    uint32_t num_faces;
+    uint32_t num_points;
+    float bbox_min[3];
+    float bbox_max[3];
+    // Offset of the chunk data from the end of the chunk directory.
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  MeshChunkedDecoder();
+
+  // Returns the chunk directory of the decoded mesh.
+  const std::vector<ChunkInfo> &chunks() const { return chunks_; }
+
+ protected:
+  bool DecodeConnectivity() override;
+  bool CreateAttributesDecoder(int32_t /* att_decoder_id */) override {
+    return false;
+  }
+  // All attribute data is decoded together with the chunks.
+  bool DecodePointAttributes() override { return true; }
+
+ private:
+  struct DecodedChunk;
+
+  // Decodes a single chunk from |data| and merges its points with equal
+  // stitch ids.
+  bool DecodeChunk(const char *data, const DecoderOptions &options,
+                   DecodedChunk *chunk) const;
+
+  // Merges all decoded chunks into the output mesh using up to |num_threads|
+  // threads.
+  bool StitchChunks(std::vector<DecodedChunk> *decoded_chunks,
+                    int num_threads);
+
+  std::vector<ChunkInfo> chunks_;
+  uint32_t stitch_att_unique_id_;
+};
+
+}  // namespace draco
+
+#endif  // DRACO_COMPRESSION_MESH_MESH_CHUNKED_DECODER_H_
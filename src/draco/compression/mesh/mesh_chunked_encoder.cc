@@ -0,0 +1,410 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/compression/mesh/mesh_chunked_encoder.h"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <utility>
+
+#include "draco/attributes/attribute_quantization_transform.h"
+#include "draco/compression/mesh/mesh_edgebreaker_encoder.h"
+#include "draco/compression/mesh/mesh_sequential_encoder.h"
+#include "draco/core/thread_pool.h"
+#include "draco/core/varint_encoding.h"
+#include "draco/mesh/mesh_misc_functions.h"
+
+namespace draco {
+
+namespace {
+
+// Data of one encoded chunk.
+struct EncodedChunk {
+  EncodedChunk() : num_faces(0), num_points(0), success(false) {
+    for (int i = 0; i < 3; ++i) {
+      bbox_min[i] = std::numeric_limits<float>::max();
+      bbox_max[i] = -std::numeric_limits<float>::max();
+    }
+  }
+  EncoderBuffer buffer;
+  uint32_t num_faces;
+  uint32_t num_points;
+  float bbox_min[3];
+  float bbox_max[3];
+  bool success;
+};
+
+}  // namespace
+
+MeshChunkedEncoder::MeshChunkedEncoder() {}
+
+bool MeshChunkedEncoder::EncodeConnectivity() {
+  if (mesh()->num_faces() == 0)
+    return false;
+  const PointAttribute *const pos_att =
+      mesh()->GetNamedAttribute(GeometryAttribute::POSITION);
+  if (pos_att == nullptr || pos_att->num_components() != 3)
+    return false;
+  const int max_chunk_faces =
+      options()->GetGlobalInt("max_chunk_faces", kDefaultMaxChunkFaces);
+  if (max_chunk_faces <= 0)
+    return false;
+
+  std::vector<FaceIndex> face_order;
+  std::vector<int> chunk_starts;
+  if (!SplitFaces(max_chunk_faces, &face_order, &chunk_starts))
+    return false;
+  const int num_chunks = static_cast<int>(chunk_starts.size()) - 1;
+
+  // Find points that are used by more than one chunk. These must be stitched
+  // by the decoder.
+  std::vector<int> point_chunks(mesh()->num_points(), -1);
+  std::vector<uint8_t> is_shared_point(mesh()->num_points(), 0);
+  for (int c = 0; c < num_chunks; ++c) {
+    for (int i = chunk_starts[c]; i < chunk_starts[c + 1]; ++i) {
+      const Mesh::Face &face = mesh()->face(face_order[i]);
+      for (int j = 0; j < 3; ++j) {
+        const uint32_t p = face[j].value();
+        if (point_chunks[p] < 0) {
+          point_chunks[p] = c;
+        } else if (point_chunks[p] != c) {
+          is_shared_point[p] = 1;
+        }
+      }
+    }
+  }
+  // The stitch attribute gets a unique id that is not used by any attribute
+  // of the input mesh.
+  uint32_t stitch_att_unique_id = 0;
+  for (int i = 0; i < mesh()->num_attributes(); ++i) {
+    stitch_att_unique_id =
+        std::max(stitch_att_unique_id, mesh()->attribute(i)->unique_id() + 1);
+  }
+
+  // Chunks are encoded concurrently when "num_encoding_threads" is set. In
+  // that case the attributes within each chunk are encoded serially.
+  const int num_threads = options()->GetGlobalInt("num_encoding_threads", 1);
+  const int num_chunk_threads = std::min(num_threads, num_chunks);
+  const EncoderOptions chunk_options =
+      CreateChunkOptions(num_chunk_threads > 1 ? 1 : num_threads);
+  const bool use_edgebreaker = options()->GetSpeed() < 10;
+
+  std::vector<EncodedChunk> chunks(num_chunks);
+  ThreadPool thread_pool(num_chunk_threads > 1 ? num_chunk_threads : 0);
+  for (int c = 0; c < num_chunks; ++c) {
+    thread_pool.Schedule([&, c]() {
+      EncodedChunk &chunk = chunks[c];
+      const std::unique_ptr<Mesh> chunk_mesh = CreateStitchedChunkMesh(
+          &face_order[chunk_starts[c]], chunk_starts[c + 1] - chunk_starts[c],
+          is_shared_point, stitch_att_unique_id, use_edgebreaker);
+      if (chunk_mesh == nullptr)
+        return;
+      chunk.num_faces = chunk_mesh->num_faces();
+      chunk.num_points = chunk_mesh->num_points();
+      const PointAttribute *const chunk_pos_att =
+          chunk_mesh->GetNamedAttribute(GeometryAttribute::POSITION);
+      float pos[3];
+      for (AttributeValueIndex i(0); i < chunk_pos_att->size(); ++i) {
+        if (!chunk_pos_att->ConvertValue<float>(i, 3, pos))
+          return;
+        for (int j = 0; j < 3; ++j) {
+          chunk.bbox_min[j] = std::min(chunk.bbox_min[j], pos[j]);
+          chunk.bbox_max[j] = std::max(chunk.bbox_max[j], pos[j]);
+        }
+      }
+      std::unique_ptr<MeshEncoder> encoder;
+      if (use_edgebreaker) {
+        encoder.reset(new MeshEdgeBreakerEncoder());
+      } else {
+        encoder.reset(new MeshSequentialEncoder());
+      }
+      encoder->SetMesh(*chunk_mesh);
+      chunk.success = encoder->Encode(chunk_options, &chunk.buffer).ok();
+    });
+  }
+  thread_pool.Wait();
+
+  // Encode the chunk directory followed by the data of all chunks.
+  EncodeVarint(stitch_att_unique_id, buffer());
+  EncodeVarint(static_cast<uint32_t>(num_chunks), buffer());
+  uint64_t chunk_offset = 0;
+  for (const EncodedChunk &chunk : chunks) {
+    if (!chunk.success)
+      return false;
+    EncodeVarint(chunk.num_faces, buffer());
+    EncodeVarint(chunk.num_points, buffer());
+    buffer()->Encode(chunk.bbox_min, sizeof(chunk.bbox_min));
+    buffer()->Encode(chunk.bbox_max, sizeof(chunk.bbox_max));
+    EncodeVarint(chunk_offset, buffer());
+    EncodeVarint(static_cast<uint64_t>(chunk.buffer.size()), buffer());
+    chunk_offset += chunk.buffer.size();
+  }
+  for (const EncodedChunk &chunk : chunks) {
+    buffer()->Encode(chunk.buffer.data(), chunk.buffer.size());
+  }
+  return true;
+}
+
+bool MeshChunkedEncoder::GenerateAttributesEncoder(int32_t /* att_id */) {
+  // Attribute encoders are created separately for each chunk.
+  return true;
+}
+
+bool MeshChunkedEncoder::SplitFaces(int max_chunk_faces,
+                                    std::vector<FaceIndex> *face_order,
+                                    std::vector<int> *chunk_starts) const {
+  const PointAttribute *const pos_att =
+      mesh()->GetNamedAttribute(GeometryAttribute::POSITION);
+  const int num_faces = mesh()->num_faces();
+  // Sums of the corner positions are used instead of the centroids because
+  // they result in the same ordering.
+  std::vector<std::array<float, 3>> centroids(num_faces);
+  face_order->resize(num_faces);
+  for (FaceIndex f(0); f < num_faces; ++f) {
+    std::array<float, 3> &centroid = centroids[f.value()];
+    centroid.fill(0.f);
+    for (int c = 0; c < 3; ++c) {
+      float pos[3];
+      if (!pos_att->ConvertValue<float>(
+              pos_att->mapped_index(mesh()->face(f)[c]), 3, pos))
+        return false;
+      for (int i = 0; i < 3; ++i)
+        centroid[i] += pos[i];
+    }
+    (*face_order)[f.value()] = f;
+  }
+
+  // Ranges of faces that still need to be processed. The right halves are
+  // processed after the left ones so the chunks are ordered by the splits.
+  std::vector<std::pair<int, int>> ranges;
+  ranges.push_back(std::make_pair(0, num_faces));
+  chunk_starts->clear();
+  while (!ranges.empty()) {
+    const int begin = ranges.back().first;
+    const int end = ranges.back().second;
+    ranges.pop_back();
+    if (end - begin <= max_chunk_faces) {
+      chunk_starts->push_back(begin);
+      continue;
+    }
+    std::array<float, 3> min_centroid, max_centroid;
+    min_centroid.fill(std::numeric_limits<float>::max());
+    max_centroid.fill(-std::numeric_limits<float>::max());
+    for (int i = begin; i < end; ++i) {
+      const std::array<float, 3> &centroid =
+          centroids[(*face_order)[i].value()];
+      for (int j = 0; j < 3; ++j) {
+        min_centroid[j] = std::min(min_centroid[j], centroid[j]);
+        max_centroid[j] = std::max(max_centroid[j], centroid[j]);
+      }
+    }
+    int axis = 0;
+    for (int j = 1; j < 3; ++j) {
+      if (max_centroid[j] - min_centroid[j] >
+          max_centroid[axis] - min_centroid[axis])
+        axis = j;
+    }
+    const int mid = begin + (end - begin) / 2;
+    std::nth_element(face_order->begin() + begin, face_order->begin() + mid,
+                     face_order->begin() + end,
+                     [&centroids, axis](FaceIndex a, FaceIndex b) {
+                       return centroids[a.value()][axis] <
+                              centroids[b.value()][axis];
+                     });
+    ranges.push_back(std::make_pair(mid, end));
+    ranges.push_back(std::make_pair(begin, mid));
+  }
+  chunk_starts->push_back(num_faces);
+  return true;
+}
+
+std::unique_ptr<Mesh> MeshChunkedEncoder::CreateChunkMesh(
+    const FaceIndex *faces, int num_faces,
+    std::vector<PointIndex> *out_points) const {
+  const Mesh &mesh = *this->mesh();
+  // Collect all points used by the chunk. The local point ids follow the order
+  // of the original point ids.
+  std::vector<PointIndex> &points = *out_points;
+  points.clear();
+  points.reserve(3 * num_faces);
+  for (int f = 0; f < num_faces; ++f) {
+    for (int c = 0; c < 3; ++c)
+      points.push_back(mesh.face(faces[f])[c]);
+  }
+  std::sort(points.begin(), points.end());
+  points.erase(std::unique(points.begin(), points.end()), points.end());
+
+  std::unique_ptr<Mesh> chunk_mesh(new Mesh());
+  chunk_mesh->set_num_points(points.size());
+  chunk_mesh->SetNumFaces(num_faces);
+  for (int f = 0; f < num_faces; ++f) {
+    Mesh::Face face;
+    for (int c = 0; c < 3; ++c) {
+      face[c] = PointIndex(static_cast<uint32_t>(
+          std::lower_bound(points.begin(), points.end(),
+                           mesh.face(faces[f])[c]) -
+          points.begin()));
+    }
+    chunk_mesh->SetFace(FaceIndex(f), face);
+  }
+
+  // Copy all attribute values used by the chunk points. Attribute ids and
+  // unique ids are the same as in the input mesh.
+  std::vector<AttributeValueIndex> values;
+  for (int i = 0; i < mesh.num_attributes(); ++i) {
+    const PointAttribute *const att = mesh.attribute(i);
+    values.clear();
+    for (const PointIndex &point : points)
+      values.push_back(att->mapped_index(point));
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+
+    GeometryAttribute ga;
+    ga.Init(att->attribute_type(), nullptr, att->num_components(),
+            att->data_type(), att->normalized(), att->byte_stride(), 0);
+    const int att_id = chunk_mesh->AddAttribute(ga, false, values.size());
+    chunk_mesh->SetAttributeElementType(att_id,
+                                        mesh.GetAttributeElementType(i));
+    PointAttribute *const chunk_att = chunk_mesh->attribute(att_id);
+    chunk_att->set_unique_id(att->unique_id());
+    for (uint32_t v = 0; v < values.size(); ++v) {
+      chunk_att->SetAttributeValue(AttributeValueIndex(v),
+                                   att->GetAddress(values[v]));
+    }
+    for (uint32_t p = 0; p < points.size(); ++p) {
+      const AttributeValueIndex value_index(static_cast<uint32_t>(
+          std::lower_bound(values.begin(), values.end(),
+                           att->mapped_index(points[p])) -
+          values.begin()));
+      chunk_att->SetPointMapEntry(PointIndex(p), value_index);
+    }
+  }
+  return chunk_mesh;
+}
+
+std::unique_ptr<Mesh> MeshChunkedEncoder::CreateStitchedChunkMesh(
+    const FaceIndex *faces, int num_faces,
+    const std::vector<uint8_t> &is_shared_point, uint32_t stitch_att_unique_id,
+    bool use_edgebreaker) const {
+  std::vector<PointIndex> points;
+  std::unique_ptr<Mesh> chunk_mesh = CreateChunkMesh(faces, num_faces, &points);
+  // Points split by the Edgebreaker encoder on non-manifold vertices are
+  // stitched in the same way as points shared between chunks.
+  std::vector<uint8_t> is_stitch_point(points.size(), 0);
+  if (use_edgebreaker) {
+    // Build the same corner table as MeshEdgeBreakerEncoderImpl.
+    bool use_single_connectivity = options()->GetSpeed() >= 6;
+    if (options()->IsGlobalOptionSet("split_mesh_on_seams")) {
+      use_single_connectivity =
+          options()->GetGlobalBool("split_mesh_on_seams", false);
+    }
+    std::unique_ptr<CornerTable> corner_table =
+        use_single_connectivity
+            ? CreateCornerTableFromAllAttributes(chunk_mesh.get())
+            : CreateCornerTableFromPositionAttribute(chunk_mesh.get());
+    if (corner_table == nullptr)
+      return nullptr;
+    if (corner_table->NumDegeneratedFaces() > 0) {
+      // Degenerated faces are not encoded by the Edgebreaker encoder. Remove
+      // them so that the chunk directory matches the decoded chunk.
+      std::vector<FaceIndex> valid_faces;
+      for (FaceIndex f(0); f < chunk_mesh->num_faces(); ++f) {
+        if (!corner_table->IsDegenerated(f))
+          valid_faces.push_back(faces[f.value()]);
+      }
+      if (valid_faces.empty())
+        return nullptr;
+      chunk_mesh = CreateChunkMesh(valid_faces.data(),
+                                   static_cast<int>(valid_faces.size()),
+                                   &points);
+      corner_table =
+          use_single_connectivity
+              ? CreateCornerTableFromAllAttributes(chunk_mesh.get())
+              : CreateCornerTableFromPositionAttribute(chunk_mesh.get());
+      if (corner_table == nullptr)
+        return nullptr;
+      is_stitch_point.assign(points.size(), 0);
+    }
+    if (corner_table->NumNewVertices() > 0) {
+      std::vector<uint8_t> is_split_vertex(
+          corner_table->NumOriginalVertices(), 0);
+      for (VertexIndex v(corner_table->NumOriginalVertices());
+           v < corner_table->num_vertices(); ++v) {
+        is_split_vertex[corner_table->VertexParent(v).value()] = 1;
+      }
+      for (CornerIndex c(0); c < corner_table->num_corners(); ++c) {
+        const VertexIndex v =
+            corner_table->VertexParent(corner_table->Vertex(c));
+        if (is_split_vertex[v.value()])
+          is_stitch_point[chunk_mesh->CornerToPointId(c).value()] = 1;
+      }
+    }
+  }
+
+  // Each point is a separate value of the stitch attribute, so the encoder
+  // never merges points that differ only in their stitch ids.
+  GeometryAttribute ga;
+  ga.Init(GeometryAttribute::GENERIC, nullptr, 1, DT_UINT32, false,
+          sizeof(uint32_t), 0);
+  const int att_id =
+      chunk_mesh->AddAttribute(ga, true, chunk_mesh->num_points());
+  PointAttribute *const stitch_att = chunk_mesh->attribute(att_id);
+  stitch_att->set_unique_id(stitch_att_unique_id);
+  for (uint32_t p = 0; p < points.size(); ++p) {
+    const uint32_t stitch_id =
+        is_shared_point[points[p].value()] || is_stitch_point[p]
+            ? points[p].value() + 1
+            : 0;
+    stitch_att->SetAttributeValue(AttributeValueIndex(p), &stitch_id);
+  }
+  return chunk_mesh;
+}
+
+EncoderOptions MeshChunkedEncoder::CreateChunkOptions(int num_threads) const {
+  EncoderOptions chunk_options = *options();
+  chunk_options.SetGlobalInt("num_encoding_threads", num_threads);
+  chunk_options.SetGlobalInt("encoding_method",
+                             options()->GetSpeed() < 10
+                                 ? MESH_EDGEBREAKER_ENCODING
+                                 : MESH_SEQUENTIAL_ENCODING);
+  for (int i = 0; i < mesh()->num_attributes(); ++i) {
+    const PointAttribute *const att = mesh()->attribute(i);
+    // Normals are quantized using the octahedron transform that does not
+    // depend on the range of the attribute values.
+    if (att->data_type() != DT_FLOAT32 ||
+        att->attribute_type() == GeometryAttribute::NORMAL)
+      continue;
+    const int quantization_bits =
+        chunk_options.GetAttributeInt(i, "quantization_bits", -1);
+    if (quantization_bits < 1)
+      continue;
+    if (chunk_options.IsAttributeOptionSet(i, "quantization_origin") &&
+        chunk_options.IsAttributeOptionSet(i, "quantization_range"))
+      continue;  // The grid is already specified by the user.
+    AttributeQuantizationTransform transform;
+    if (!transform.ComputeParameters(*att, quantization_bits))
+      continue;
+    chunk_options.SetAttributeVector(i, "quantization_origin",
+                                     att->num_components(),
+                                     transform.min_values().data());
+    chunk_options.SetAttributeFloat(i, "quantization_range", transform.range());
+  }
+  // Stitch ids are mostly zeros and don't correlate with their neighbors.
+  chunk_options.SetAttributeInt(mesh()->num_attributes(), "prediction_scheme",
+                                PREDICTION_NONE);
+  return chunk_options;
+}
+
+}  // namespace draco
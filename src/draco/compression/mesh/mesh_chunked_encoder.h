@@ -0,0 +1,89 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// The chunked encoder splits the input mesh into spatially coherent chunks
+// that are compressed as independent Draco meshes (using either the
+// Edgebreaker or the sequential encoder). The encoded data starts with a chunk
+// directory storing the byte offset, size and bounding box of every chunk so
+// that the decoder can process the chunks in parallel.
+// The maximum number of faces in one chunk is controlled by the global encoder
+// option "max_chunk_faces".
+// All chunks share the same quantization grid for each quantized attribute
+// which guarantees that points on the boundaries between chunks are decoded to
+// the same values in all chunks.
+// Every chunk contains an extra "stitch" attribute that stores, for each point
+// shared with another chunk or split by the chunk encoder on a non-manifold
+// vertex, the id of the point in the input mesh (plus one) and zero for all
+// other points. The decoder merges only the points with equal stitch ids when
+// it stitches the chunks back into a single mesh.
+
+#ifndef DRACO_COMPRESSION_MESH_MESH_CHUNKED_ENCODER_H_
+#define DRACO_COMPRESSION_MESH_MESH_CHUNKED_ENCODER_H_
+
+#include <vector>
+
+#include "draco/compression/mesh/mesh_encoder.h"
+
+namespace draco {
+
+// Default value of the "max_chunk_faces" option.
+static constexpr int kDefaultMaxChunkFaces = 1 << 19;
+
+// Class that encodes a mesh as a set of independently decodable chunks.
+class MeshChunkedEncoder : public MeshEncoder {
+ public:
+  MeshChunkedEncoder();
+  uint8_t GetEncodingMethod() const override { return MESH_CHUNKED_ENCODING; }
+
+ protected:
+  bool EncodeConnectivity() override;
+  bool GenerateAttributesEncoder(int32_t att_id) override;
+  // All attribute data is stored within the chunks.
+  bool EncodePointAttributes() override { return true; }
+
+ private:
+  // Splits faces of the mesh into chunks with at most |max_chunk_faces| faces.
+  // The faces are recursively divided by the median of their centroids along
+  // the longest axis of the bounding box of the centroids. |face_order|
+  // receives ids of the faces sorted by chunks and |chunk_starts| the offset of
+  // the first face of each chunk in |face_order| (with the total number of
+  // faces appended at the end).
+  bool SplitFaces(int max_chunk_faces, std::vector<FaceIndex> *face_order,
+                  std::vector<int> *chunk_starts) const;
+
+  // Creates a mesh containing |num_faces| faces from |faces| and all points and
+  // attribute values referenced by them. |out_points| receives the ids of the
+  // input points of the chunk mesh.
+  std::unique_ptr<Mesh> CreateChunkMesh(const FaceIndex *faces, int num_faces,
+                                        std::vector<PointIndex> *out_points)
+      const;
+
+  // Creates the mesh of a single chunk including its stitch attribute with
+  // unique id |stitch_att_unique_id|. Points with non-zero |is_shared_point|
+  // are used by multiple chunks. When |use_edgebreaker| is set, faces that
+  // the Edgebreaker encoder would drop are removed from the chunk.
+  std::unique_ptr<Mesh> CreateStitchedChunkMesh(
+      const FaceIndex *faces, int num_faces,
+      const std::vector<uint8_t> &is_shared_point,
+      uint32_t stitch_att_unique_id, bool use_edgebreaker) const;
+
+  // Returns encoder options shared by all chunks. Quantized attributes get an
+  // explicit quantization grid computed from all values of the input mesh.
+  // Attributes of each chunk are encoded using up to |num_threads| threads.
+  EncoderOptions CreateChunkOptions(int num_threads) const;
+};
+
+}  // namespace draco
+
+#endif  // DRACO_COMPRESSION_MESH_MESH_CHUNKED_ENCODER_H_
@@ -0,0 +1,187 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include <algorithm>
+
+#include "draco/compression/decode.h"
+#include "draco/compression/encode.h"
+#include "draco/compression/mesh/mesh_chunked_decoder.h"
+#include "draco/core/draco_test_base.h"
+#include "draco/core/draco_test_utils.h"
+#include "draco/mesh/mesh_are_equivalent.h"
+#include "draco/mesh/mesh_cleanup.h"
+
+namespace draco {
+
+class MeshChunkedEncodingTest : public ::testing::Test {
+ protected:
+  // Encodes |mesh| into chunks with at most |max_chunk_faces| faces.
+  void EncodeChunks(const Mesh &mesh, int max_chunk_faces,
+                    int quantization_bits, int num_threads,
+                    EncoderBuffer *out_buffer, int speed = -1) {
+    Encoder encoder;
+    if (speed >= 0)
+      encoder.SetSpeedOptions(speed, speed);
+    encoder.SetEncodingMethod(MESH_CHUNKED_ENCODING);
+    encoder.SetMaxChunkFaces(max_chunk_faces);
+    if (quantization_bits > 0) {
+      encoder.SetAttributeQuantization(GeometryAttribute::POSITION,
+                                       quantization_bits);
+      encoder.SetAttributeQuantization(GeometryAttribute::TEX_COORD,
+                                       quantization_bits);
+      encoder.SetAttributeQuantization(GeometryAttribute::NORMAL,
+                                       quantization_bits);
+    }
+    encoder.options().SetGlobalInt("num_encoding_threads", num_threads);
+    ASSERT_TRUE(encoder.EncodeMeshToBuffer(mesh, out_buffer).ok());
+  }
+
+  std::unique_ptr<Mesh> DecodeChunks(const EncoderBuffer &buffer,
+                                     int num_threads) {
+    DecoderBuffer dec_buffer;
+    dec_buffer.Init(buffer.data(), buffer.size());
+    Decoder decoder;
+    decoder.options()->SetGlobalInt("num_decoding_threads", num_threads);
+    auto statusor = decoder.DecodeMeshFromBuffer(&dec_buffer);
+    if (!statusor.ok())
+      return nullptr;
+    return std::move(statusor).value();
+  }
+};
+
+TEST_F(MeshChunkedEncodingTest, TestLosslessChunks) {
+  // Tests that a mesh split into many chunks is decoded losslessly and that
+  // all chunks are stitched together.
+  const std::unique_ptr<Mesh> mesh(ReadMeshFromTestFile("test_nm.obj"));
+  ASSERT_NE(mesh, nullptr);
+  EncoderBuffer buffer;
+  EncodeChunks(*mesh, 20, 0, 1, &buffer);
+
+  DecoderBuffer dec_buffer;
+  dec_buffer.Init(buffer.data(), buffer.size());
+  MeshChunkedDecoder decoder;
+  std::unique_ptr<Mesh> decoded_mesh(new Mesh());
+  DecoderOptions dec_options;
+  ASSERT_TRUE(
+      decoder.Decode(dec_options, &dec_buffer, decoded_mesh.get()).ok());
+  ASSERT_EQ(decoder.chunks().size(), 16);
+  int num_faces = 0;
+  for (const MeshChunkedDecoder::ChunkInfo &chunk : decoder.chunks()) {
+    ASSERT_LE(chunk.num_faces, 20);
+    num_faces += chunk.num_faces;
+    for (int i = 0; i < 3; ++i)
+      ASSERT_LE(chunk.bbox_min[i], chunk.bbox_max[i]);
+  }
+  ASSERT_EQ(num_faces, mesh->num_faces());
+  // Points duplicated on non-manifold vertices are merged back.
+  ASSERT_EQ(decoded_mesh->num_points(), mesh->num_points());
+
+  const MeshCleanupOptions options;
+  MeshCleanup cleanup;
+  ASSERT_TRUE(cleanup(mesh.get(), options));
+  MeshAreEquivalent eq;
+  ASSERT_TRUE(eq(*mesh, *decoded_mesh))
+      << "Decoded mesh is not the same as the input";
+}
+
+TEST_F(MeshChunkedEncodingTest, TestQuantizedChunks) {
+  // Tests that quantized points on the chunk boundaries are stitched.
+  const std::string file_names[] = {"test_nm.obj", "cube_att.obj",
+                                    "test_sphere.obj"};
+  for (const std::string &file_name : file_names) {
+    const std::unique_ptr<Mesh> mesh(ReadMeshFromTestFile(file_name));
+    ASSERT_NE(mesh, nullptr) << "Failed to load " << file_name;
+    EncoderBuffer buffer;
+    EncodeChunks(*mesh, 4, 11, 1, &buffer);
+    const std::unique_ptr<Mesh> decoded_mesh = DecodeChunks(buffer, 1);
+    ASSERT_NE(decoded_mesh, nullptr) << file_name;
+    ASSERT_EQ(decoded_mesh->num_faces(), mesh->num_faces()) << file_name;
+    ASSERT_EQ(decoded_mesh->num_points(), mesh->num_points()) << file_name;
+  }
+}
+
+TEST_F(MeshChunkedEncodingTest, TestParallelChunks) {
+  // Tests that chunks encoded and decoded on multiple threads produce the same
+  // results as the serial code.
+  const std::unique_ptr<Mesh> mesh(ReadMeshFromTestFile("test_nm.obj"));
+  ASSERT_NE(mesh, nullptr);
+  EncoderBuffer serial_buffer, parallel_buffer;
+  EncodeChunks(*mesh, 32, 11, 1, &serial_buffer);
+  EncodeChunks(*mesh, 32, 11, 4, &parallel_buffer);
+  ASSERT_EQ(serial_buffer.size(), parallel_buffer.size());
+  ASSERT_TRUE(std::equal(serial_buffer.data(),
+                         serial_buffer.data() + serial_buffer.size(),
+                         parallel_buffer.data()));
+
+  const std::unique_ptr<Mesh> serial_mesh = DecodeChunks(serial_buffer, 1);
+  const std::unique_ptr<Mesh> parallel_mesh = DecodeChunks(serial_buffer, 4);
+  ASSERT_NE(serial_mesh, nullptr);
+  ASSERT_NE(parallel_mesh, nullptr);
+  ASSERT_EQ(serial_mesh->num_points(), parallel_mesh->num_points());
+  ASSERT_EQ(serial_mesh->num_faces(), parallel_mesh->num_faces());
+  for (FaceIndex f(0); f < serial_mesh->num_faces(); ++f)
+    ASSERT_EQ(serial_mesh->face(f), parallel_mesh->face(f));
+  ASSERT_EQ(serial_mesh->num_attributes(), parallel_mesh->num_attributes());
+  for (int i = 0; i < serial_mesh->num_attributes(); ++i) {
+    const DataBuffer *const serial_data = serial_mesh->attribute(i)->buffer();
+    const DataBuffer *const parallel_data =
+        parallel_mesh->attribute(i)->buffer();
+    ASSERT_EQ(serial_data->data_size(), parallel_data->data_size());
+    ASSERT_TRUE(std::equal(serial_data->data(),
+                           serial_data->data() + serial_data->data_size(),
+                           parallel_data->data()));
+  }
+}
+
+TEST_F(MeshChunkedEncodingTest, TestSpeeds) {
+  // Tests that points are stitched exactly for all connectivity encoders.
+  const std::unique_ptr<Mesh> mesh(ReadMeshFromTestFile("test_nm.obj"));
+  ASSERT_NE(mesh, nullptr);
+  for (int speed : {0, 5, 7, 10}) {
+    EncoderBuffer buffer;
+    EncodeChunks(*mesh, 10, 11, 1, &buffer, speed);
+    const std::unique_ptr<Mesh> decoded_mesh = DecodeChunks(buffer, 2);
+    ASSERT_NE(decoded_mesh, nullptr) << "speed " << speed;
+    ASSERT_EQ(decoded_mesh->num_points(), mesh->num_points())
+        << "speed " << speed;
+  }
+}
+
+TEST_F(MeshChunkedEncodingTest, TestCoincidentPointsAreNotStitched) {
+  // Two triangles that touch at coincident but separate points. The points
+  // must stay separate even though their values are identical.
+  Mesh mesh;
+  mesh.set_num_points(6);
+  GeometryAttribute ga;
+  ga.Init(GeometryAttribute::POSITION, nullptr, 3, DT_FLOAT32, false,
+          3 * sizeof(float), 0);
+  const int att_id = mesh.AddAttribute(ga, true, 6);
+  const float positions[6][3] = {{0.f, 0.f, 0.f}, {1.f, 0.f, 0.f},
+                                 {1.f, 1.f, 0.f}, {1.f, 1.f, 0.f},
+                                 {2.f, 1.f, 0.f}, {2.f, 2.f, 0.f}};
+  for (int i = 0; i < 6; ++i) {
+    mesh.attribute(att_id)->SetAttributeValue(AttributeValueIndex(i),
+                                              positions[i]);
+  }
+  mesh.AddFace({{PointIndex(0), PointIndex(1), PointIndex(2)}});
+  mesh.AddFace({{PointIndex(3), PointIndex(4), PointIndex(5)}});
+  EncoderBuffer buffer;
+  EncodeChunks(mesh, 1, 0, 1, &buffer);
+  const std::unique_ptr<Mesh> decoded_mesh = DecodeChunks(buffer, 1);
+  ASSERT_NE(decoded_mesh, nullptr);
+  ASSERT_EQ(decoded_mesh->num_faces(), 2);
+  ASSERT_EQ(decoded_mesh->num_points(), 6);
+}
+
+}  // namespace draco
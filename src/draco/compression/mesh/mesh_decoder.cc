@@ -14,6 +14,8 @@
 //
 #include "draco/compression/mesh/mesh_decoder.h"
 
+#include "draco/core/coding_stats.h"
+
 namespace draco {
 
 MeshDecoder::MeshDecoder() : mesh_(nullptr) {}
@@ -27,8 +29,11 @@ Status MeshDecoder::Decode(const DecoderOptions &options,
 bool MeshDecoder::DecodeGeometryData() {
   if (mesh_ == nullptr)
     return false;
-  if (!DecodeConnectivity())
-    return false;
+  {
+    CodingStatsScope scope(stats(), "connectivity", -1, buffer());
+    if (!DecodeConnectivity())
+      return false;
+  }
   return PointCloudDecoder::DecodeGeometryData();
 }
 
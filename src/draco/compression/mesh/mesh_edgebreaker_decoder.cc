@@ -19,7 +19,8 @@
 
 namespace draco {
 
-MeshEdgeBreakerDecoder::MeshEdgeBreakerDecoder() {}
+MeshEdgeBreakerDecoder::MeshEdgeBreakerDecoder()
+    : impl_traversal_decoder_type_(-1) {}
 
 bool MeshEdgeBreakerDecoder::CreateAttributesDecoder(int32_t att_decoder_id) {
   return impl_->CreateAttributesDecoder(att_decoder_id);
@@ -29,7 +30,10 @@ bool MeshEdgeBreakerDecoder::InitializeDecoder() {
   uint8_t traversal_decoder_type;
   if (!buffer()->Decode(&traversal_decoder_type))
     return false;
+  if (impl_ && traversal_decoder_type == impl_traversal_decoder_type_)
+    return impl_->Init(this);
   impl_ = nullptr;
+  impl_traversal_decoder_type_ = traversal_decoder_type;
   if (traversal_decoder_type == MESH_EDGEBREAKER_STANDARD_ENCODING) {
 #ifdef DRACO_STANDARD_EDGEBREAKER_SUPPORTED
     impl_ = std::unique_ptr<MeshEdgeBreakerDecoderImplInterface>(
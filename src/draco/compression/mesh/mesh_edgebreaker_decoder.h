@@ -46,6 +46,9 @@ class MeshEdgeBreakerDecoder : public MeshDecoder {
   bool OnAttributesDecoded() override;
 
   std::unique_ptr<MeshEdgeBreakerDecoderImplInterface> impl_;
+  // Traversal decoder type of |impl_|. The implementation is reused when the
+  // decoder is used to decode multiple meshes with the same traversal type.
+  int impl_traversal_decoder_type_;
 };
 
 }  // namespace draco
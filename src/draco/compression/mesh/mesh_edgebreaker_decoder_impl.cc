@@ -21,6 +21,7 @@
 #include "draco/compression/mesh/mesh_edgebreaker_decoder.h"
 #include "draco/compression/mesh/mesh_edgebreaker_traversal_predictive_decoder.h"
 #include "draco/compression/mesh/mesh_edgebreaker_traversal_valence_decoder.h"
+#include "draco/core/arena.h"
 #include "draco/mesh/corner_table_iterators.h"
 #include "draco/mesh/corner_table_traversal_processor.h"
 #include "draco/mesh/edgebreaker_traverser.h"
@@ -48,7 +49,8 @@ MeshEdgeBreakerDecoderImpl<TraversalDecoder>::MeshEdgeBreakerDecoderImpl()
       last_vert_id_(-1),
       last_face_id_(-1),
       num_new_vertices_(0),
-      num_encoded_vertices_(0) {}
+      num_encoded_vertices_(0),
+      pos_data_decoder_id_(-1) {}
 
 template <class TraversalDecoder>
 bool MeshEdgeBreakerDecoderImpl<TraversalDecoder>::Init(
@@ -130,11 +132,23 @@ bool MeshEdgeBreakerDecoderImpl<TraversalDecoder>::CreateAttributesDecoder(
   if (!decoder_->buffer()->Decode(&decoder_type))
     return false;
 
+  MeshAttributeIndicesEncodingData *encoding_data = &pos_encoding_data_;
+  int *data_decoder_id = &pos_data_decoder_id_;
   if (att_data_id >= 0) {
     if (att_data_id >= attribute_data_.size()) {
       return false;  // Unexpected attribute data.
     }
-    attribute_data_[att_data_id].decoder_id = att_decoder_id;
+    encoding_data = &attribute_data_[att_data_id].encoding_data;
+    data_decoder_id = &attribute_data_[att_data_id].decoder_id;
+  }
+  // The encoding data is filled in when the attribute values are decoded. It
+  // is empty at this point unless PointCloudDecoder::ResumeDecoding() creates
+  // the decoder again after a failed attempt, so reset it unless an earlier
+  // decoder (which is kept) uses it as well.
+  if (*data_decoder_id < 0 || *data_decoder_id >= att_decoder_id) {
+    *data_decoder_id = att_decoder_id;
+    encoding_data->Initialize(
+        encoding_data->vertex_to_encoded_attribute_value_index_map.size());
   }
 
   MeshTraversalMethod traversal_method = MESH_TRAVERSAL_DEPTH_FIRST;
@@ -153,14 +167,16 @@ bool MeshEdgeBreakerDecoderImpl<TraversalDecoder>::CreateAttributesDecoder(
     // Per-vertex attribute decoder.
     typedef CornerTableTraversalProcessor<CornerTable> AttProcessor;
     typedef MeshAttributeIndicesEncodingObserver<CornerTable> AttObserver;
-    MeshAttributeIndicesEncodingData *encoding_data = nullptr;
-    if (att_data_id < 0) {
-      encoding_data = &pos_encoding_data_;
-    } else {
-      encoding_data = &attribute_data_[att_data_id].encoding_data;
+    if (att_data_id >= 0) {
       // Mark the attribute connectivity data invalid to ensure it's not used
       // later on.
       attribute_data_[att_data_id].is_connectivity_used = false;
+      if (ShouldReleaseConnectivityData()) {
+        // The attribute connectivity was needed only for the deduplication of
+        // points in AssignPointsToCorners().
+        attribute_data_[att_data_id].connectivity_data =
+            MeshAttributeCornerTable();
+      }
     }
     if (traversal_method == MESH_TRAVERSAL_DEPTH_FIRST) {
       // Traverser that is used to generate the encoding order of each
@@ -188,13 +204,11 @@ bool MeshEdgeBreakerDecoderImpl<TraversalDecoder>::CreateAttributesDecoder(
     typedef EdgeBreakerTraverser<AttProcessor, AttObserver> AttTraverser;
 
     std::unique_ptr<MeshTraversalSequencer<AttTraverser>> traversal_sequencer(
-        new MeshTraversalSequencer<AttTraverser>(
-            mesh, &attribute_data_[att_data_id].encoding_data));
+        new MeshTraversalSequencer<AttTraverser>(mesh, encoding_data));
 
     AttTraverser att_traverser;
     AttObserver att_observer(&attribute_data_[att_data_id].connectivity_data,
-                             mesh, traversal_sequencer.get(),
-                             &attribute_data_[att_data_id].encoding_data);
+                             mesh, traversal_sequencer.get(), encoding_data);
     AttProcessor att_processor;
 
     att_processor.ResetProcessor(
@@ -262,13 +276,9 @@ bool MeshEdgeBreakerDecoderImpl<TraversalDecoder>::DecodeConnectivity() {
 
   // Decode topology (connectivity).
   vertex_traversal_length_.clear();
-  corner_table_ = std::unique_ptr<CornerTable>(new CornerTable());
+  // The corner table is reused when the decoder decodes multiple meshes.
   if (corner_table_ == nullptr)
-    return false;
-  processed_corner_ids_.clear();
-  processed_corner_ids_.reserve(num_faces);
-  processed_connectivity_corners_.clear();
-  processed_connectivity_corners_.reserve(num_faces);
+    corner_table_ = std::unique_ptr<CornerTable>(new CornerTable());
   topology_split_data_.clear();
   hole_event_data_.clear();
   init_face_configurations_.clear();
@@ -418,6 +428,7 @@ bool MeshEdgeBreakerDecoderImpl<TraversalDecoder>::DecodeConnectivity() {
   }
 
   pos_encoding_data_.Initialize(corner_table_->num_vertices());
+  pos_data_decoder_id_ = -1;
   for (uint32_t i = 0; i < attribute_data_.size(); ++i) {
     // For non-position attributes, preallocate the vertex to value mapping
     // using the maximum number of vertices from the base corner table and the
@@ -431,14 +442,54 @@ bool MeshEdgeBreakerDecoderImpl<TraversalDecoder>::DecodeConnectivity() {
   }
   if (!AssignPointsToCorners(num_connectivity_verts))
     return false;
+  decoder_->UpdatePeakMemoryUsage(GetMemoryUsage());
+  if (ShouldReleaseConnectivityData()) {
+    // Free data that was needed only for decoding of the connectivity.
+    std::vector<bool>().swap(is_vert_hole_);
+    std::vector<TopologySplitEventData>().swap(topology_split_data_);
+    std::vector<HoleEventData>().swap(hole_event_data_);
+    for (AttributeData &data : attribute_data_)
+      std::vector<int32_t>().swap(data.attribute_seam_corners);
+    traversal_decoder_ = TraversalDecoder();
+  }
   return true;
 }
 
 template <class TraversalDecoder>
 bool MeshEdgeBreakerDecoderImpl<TraversalDecoder>::OnAttributesDecoded() {
+  decoder_->UpdatePeakMemoryUsage(GetMemoryUsage());
+  if (ShouldReleaseConnectivityData()) {
+    // The connectivity is not used after all attributes are decoded.
+    corner_table_ = nullptr;
+    std::vector<AttributeData>().swap(attribute_data_);
+    pos_encoding_data_ = MeshAttributeIndicesEncodingData();
+  }
   return true;
 }
 
+template <class TraversalDecoder>
+bool MeshEdgeBreakerDecoderImpl<
+    TraversalDecoder>::ShouldReleaseConnectivityData() const {
+  return decoder_->options()->GetGlobalBool("release_connectivity_data",
+                                            false);
+}
+
+template <class TraversalDecoder>
+size_t MeshEdgeBreakerDecoderImpl<TraversalDecoder>::GetMemoryUsage() const {
+  size_t num_bytes = pos_encoding_data_.GetMemoryUsage();
+  if (corner_table_ != nullptr)
+    num_bytes += corner_table_->GetMemoryUsage();
+  num_bytes += is_vert_hole_.capacity() / 8;
+  num_bytes += topology_split_data_.capacity() * sizeof(TopologySplitEventData);
+  num_bytes += hole_event_data_.capacity() * sizeof(HoleEventData);
+  for (const AttributeData &data : attribute_data_) {
+    num_bytes += data.connectivity_data.GetMemoryUsage();
+    num_bytes += data.encoding_data.GetMemoryUsage();
+    num_bytes += data.attribute_seam_corners.capacity() * sizeof(int32_t);
+  }
+  return num_bytes;
+}
+
 template <class TraversalDecoder>
 int MeshEdgeBreakerDecoderImpl<TraversalDecoder>::DecodeConnectivity(
     int num_symbols) {
@@ -452,7 +503,9 @@ int MeshEdgeBreakerDecoderImpl<TraversalDecoder>::DecodeConnectivity(
   // decoder always processes only the latest active edge. TOPOLOGY_S then
   // removes the top edge from the stack and TOPOLOGY_E adds a new edge to the
   // stack.
-  std::vector<CornerIndex> active_corner_stack;
+  Arena *const arena = decoder_->buffer()->arena();
+  ArenaVector<CornerIndex> active_corner_stack(
+      (ArenaAllocator<CornerIndex>(arena)));
 
   // Additional active edges may be added as a result of topology split events.
   // They can be added in arbitrary order, but we always know the split symbol
@@ -462,7 +515,8 @@ int MeshEdgeBreakerDecoderImpl<TraversalDecoder>::DecodeConnectivity(
   // Vector used for storing vertices that were marked as isolated during the
   // decoding process. Currently used only when the mesh doesn't contain any
   // non-position connectivity data.
-  std::vector<VertexIndex> invalid_vertices;
+  ArenaVector<VertexIndex> invalid_vertices(
+      (ArenaAllocator<VertexIndex>(arena)));
   const bool remove_invalid_vertices = attribute_data_.empty();
 
   int max_num_vertices = is_vert_hole_.size();
@@ -1002,9 +1056,11 @@ bool MeshEdgeBreakerDecoderImpl<TraversalDecoder>::AssignPointsToCorners(
   // Map between point id and an associated corner id. Only one corner for
   // each point is stored. The corners are used to sample the attribute values
   // in the last stage of the deduplication.
-  std::vector<int32_t> point_to_corner_map;
+  Arena *const arena = decoder_->buffer()->arena();
+  ArenaVector<int32_t> point_to_corner_map((ArenaAllocator<int32_t>(arena)));
   // Map between every corner and their new point ids.
-  std::vector<int32_t> corner_to_point_map(corner_table_->num_corners());
+  ArenaVector<int32_t> corner_to_point_map(corner_table_->num_corners(), 0,
+                                           ArenaAllocator<int32_t>(arena));
   for (int v = 0; v < corner_table_->num_vertices(); ++v) {
     CornerIndex c = corner_table_->LeftMostCorner(VertexIndex(v));
     if (c == kInvalidCornerIndex)
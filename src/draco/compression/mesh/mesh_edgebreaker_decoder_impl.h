@@ -119,6 +119,13 @@ class MeshEdgeBreakerDecoderImpl : public MeshEdgeBreakerDecoderImplInterface {
   // Initializes mapping between corners and point ids.
   bool AssignPointsToCorners(int num_connectivity_verts);
 
+  // Returns true when the connectivity data should be freed as soon as it is
+  // not needed instead of being kept for the next decoding call.
+  bool ShouldReleaseConnectivityData() const;
+
+  // Returns the number of bytes held by the connectivity data structures.
+  size_t GetMemoryUsage() const;
+
   bool IsFaceVisited(CornerIndex corner_id) const {
     if (corner_id < 0)
       return true;  // Invalid corner signalizes that the face does not exist.
@@ -186,16 +193,9 @@ class MeshEdgeBreakerDecoderImpl : public MeshEdgeBreakerDecoderImplInterface {
   // of vertices of the input mesh).
   int num_encoded_vertices_;
 
-  // Array for storing the encoded corner ids in the order their associated
-  // vertices were decoded.
-  std::vector<int32_t> processed_corner_ids_;
-
-  // Array storing corners in the order they were visited during the
-  // connectivity decoding (always storing the tip corner of each newly visited
-  // face).
-  std::vector<int> processed_connectivity_corners_;
-
   MeshAttributeIndicesEncodingData pos_encoding_data_;
+  // Id of the first attribute decoder that uses |pos_encoding_data_|.
+  int pos_data_decoder_id_;
 
   // Data for non-position attributes used by the decoder.
   struct AttributeData {
@@ -37,6 +37,7 @@ class MeshEdgeBreakerTraversalDecoder {
     buffer_.Init(decoder->GetDecoder()->buffer()->data_head(),
                  decoder->GetDecoder()->buffer()->remaining_size(),
                  decoder->GetDecoder()->buffer()->bitstream_version());
+    buffer_.set_arena(decoder->GetDecoder()->buffer()->arena());
   }
 
   // Returns the Draco bitstream version.
@@ -14,6 +14,8 @@
 //
 #include "draco/compression/mesh/mesh_encoder.h"
 
+#include "draco/core/coding_stats.h"
+
 namespace draco {
 
 MeshEncoder::MeshEncoder() : mesh_(nullptr) {}
@@ -24,6 +26,7 @@ void MeshEncoder::SetMesh(const Mesh &m) {
 }
 
 bool MeshEncoder::EncodeGeometryData() {
+  CodingStatsScope scope(stats(), "connectivity", -1, buffer());
   if (!EncodeConnectivity())
     return false;
   return true;
@@ -17,6 +17,7 @@
 #ifndef DRACO_COMPRESSION_POINT_CLOUD_ALGORITHMS_DYNAMIC_INTEGER_POINTS_KD_TREE_DECODER_H_
 #define DRACO_COMPRESSION_POINT_CLOUD_ALGORITHMS_DYNAMIC_INTEGER_POINTS_KD_TREE_DECODER_H_
 
+#include <algorithm>
 #include <array>
 #include <memory>
 #include <stack>
@@ -29,6 +30,8 @@
 #include "draco/core/bit_utils.h"
 #include "draco/core/decoder_buffer.h"
 #include "draco/core/math_utils.h"
+#include "draco/core/thread_pool.h"
+#include "draco/core/varint_decoding.h"
 
 namespace draco {
 
@@ -94,6 +97,32 @@ class DynamicIntegerPointsKdTreeDecoder {
   template <class OutputIteratorT>
   bool DecodePoints(DecoderBuffer *buffer, OutputIteratorT oit);
 
+  // Decodes a point cloud encoded by
+  // DynamicIntegerPointsKdTreeEncoder::EncodePointsLevelOrder(). The decoding
+  // stops before the tree level |max_depth| or before a level that would
+  // produce more than |max_num_points| points. Each subtree that was not
+  // decoded is replaced by a single point placed at the center of the part of
+  // the subtree cell that overlaps the bounding box of the points. At least
+  // one point is always decoded. Negative values of |max_depth| or
+  // |max_num_points| disable the respective limit. The number of decoded
+  // points is returned in |out_num_decoded_points|.
+  template <class OutputIteratorT>
+  bool DecodePointsLevelOrder(DecoderBuffer *buffer, OutputIteratorT oit,
+                              int max_depth, int64_t max_num_points,
+                              uint32_t *out_num_decoded_points);
+
+  // Decodes points encoded by
+  // DynamicIntegerPointsKdTreeEncoder::EncodePointsInSubtrees() that lie
+  // inside of the region [region_min, region_max] (inclusive). Subtrees that
+  // don't intersect the region are skipped without being decoded. The number
+  // of decoded points is returned in |out_num_decoded_points|. When
+  // |num_threads| is larger than 1, the subtrees are decoded in parallel.
+  template <class OutputIteratorT>
+  bool DecodePointsInRegion(DecoderBuffer *buffer, const uint32_t *region_min,
+                            const uint32_t *region_max, OutputIteratorT oit,
+                            uint32_t *out_num_decoded_points,
+                            int num_threads = 1);
+
   const uint32_t dimension() const { return dimension_; }
 
  private:
@@ -102,11 +131,53 @@ class DynamicIntegerPointsKdTreeDecoder {
       (*target)[i] = source[i];
     }
   }
-  uint32_t GetAxis(uint32_t num_remaining_points, const VectorUint32 &levels,
+  uint32_t GetAxis(uint32_t num_remaining_points, const uint32_t *levels,
                    uint32_t last_axis);
 
+  bool StartDecoding(DecoderBuffer *buffer);
+  void EndDecoding();
+
+  // Decodes |num_remaining_points| points whose bits that are not defined by
+  // |levels| and |old_base| of their node are stored explicitly.
   template <class OutputIteratorT>
-  void DecodeInternal(uint32_t num_points, OutputIteratorT oit);
+  void DecodeRemainingBits(uint32_t num_remaining_points, uint32_t axis,
+                           const uint32_t *old_base, const uint32_t *levels,
+                           OutputIteratorT &oit);
+
+  struct NodeList;
+
+  // Decodes the subtree with |num_points| points whose root node has the given
+  // |root_base|, |root_levels| and |root_last_axis|. When |out_subtrees| is
+  // set, nodes with at most |max_subtree_points| points are not decoded but
+  // added to |out_subtrees|. Returns false when the data is corrupted.
+  template <class OutputIteratorT>
+  bool DecodeInternal(uint32_t num_points, uint32_t root_last_axis,
+                      const uint32_t *root_base, const uint32_t *root_levels,
+                      uint32_t max_subtree_points, NodeList *out_subtrees,
+                      OutputIteratorT &oit);
+
+  // Decodes the subtrees of |subtrees| given by |subtree_ids| using up to
+  // |num_threads| threads. The subtree with index |i| is stored at
+  // |subtree_data| + |subtree_offsets[i]|. Decoded points are passed to
+  // |oit| in the order of |subtree_ids|.
+  template <class OutputIteratorT>
+  bool DecodeSubtreesInParallel(const NodeList &subtrees,
+                                const VectorUint32 &subtree_ids,
+                                const char *subtree_data,
+                                const std::vector<uint64_t> &subtree_offsets,
+                                uint16_t bitstream_version, int num_threads,
+                                OutputIteratorT &oit);
+
+  // Returns true when the cell of a node with |base| and |levels| intersects
+  // the region [region_min, region_max].
+  bool CellIntersectsRegion(const uint32_t *base, const uint32_t *levels,
+                            const uint32_t *region_min,
+                            const uint32_t *region_max) const;
+
+  template <class OutputIteratorT>
+  bool DecodeLevelOrderInternal(OutputIteratorT oit, int max_depth,
+                                int64_t max_num_points,
+                                uint32_t *out_num_decoded_points);
 
   void DecodeNumber(int nbits, uint32_t *value) {
     numbers_decoder_.DecodeLeastSignificantBits32(nbits, value);
@@ -124,6 +195,31 @@ class DynamicIntegerPointsKdTreeDecoder {
     uint32_t stack_pos;  // used to get base and levels
   };
 
+  // List of tree nodes. Bases and levels of all nodes are stored in flat
+  // arrays with |dimension_| values per node.
+  struct NodeList {
+    void Clear() {
+      num_points.clear();
+      last_axes.clear();
+      bases.clear();
+      levels.clear();
+    }
+    void AddNode(uint32_t node_num_points, uint32_t last_axis,
+                 const uint32_t *base, const uint32_t *node_levels,
+                 uint32_t dimension) {
+      num_points.push_back(node_num_points);
+      last_axes.push_back(last_axis);
+      bases.insert(bases.end(), base, base + dimension);
+      levels.insert(levels.end(), node_levels, node_levels + dimension);
+    }
+    size_t size() const { return num_points.size(); }
+
+    VectorUint32 num_points;
+    VectorUint32 last_axes;
+    VectorUint32 bases;
+    VectorUint32 levels;
+  };
+
   uint32_t bit_length_;
   uint32_t num_points_;
   uint32_t dimension_;
@@ -133,6 +229,9 @@ class DynamicIntegerPointsKdTreeDecoder {
   HalfDecoder half_decoder_;
   VectorUint32 p_;
   VectorUint32 axes_;
+  // Bounding box of points decoded in level order.
+  VectorUint32 min_values_;
+  VectorUint32 max_values_;
   std::vector<VectorUint32> base_stack_;
   std::vector<VectorUint32> levels_stack_;
 };
@@ -143,10 +242,278 @@ template <class OutputIteratorT>
 bool DynamicIntegerPointsKdTreeDecoder<compression_level_t>::DecodePoints(
     DecoderBuffer *buffer, OutputIteratorT oit) {
   buffer->Decode(&bit_length_);
+  if (bit_length_ > 32)
+    return false;
   buffer->Decode(&num_points_);
   if (num_points_ == 0)
     return true;
 
+  if (!StartDecoding(buffer))
+    return false;
+  const VectorUint32 zeros(dimension_, 0);
+  if (!DecodeInternal(num_points_, 0, zeros.data(), zeros.data(), 0, nullptr,
+                      oit))
+    return false;
+  EndDecoding();
+  return true;
+}
+
+// Output iterator that passes only points inside of a region to the wrapped
+// output iterator. At most |max_num_points| points are passed.
+template <class OutputIteratorT>
+class RegionFilterOutputIterator {
+  typedef RegionFilterOutputIterator<OutputIteratorT> Self;
+
+ public:
+  RegionFilterOutputIterator(OutputIteratorT oit, const uint32_t *region_min,
+                             const uint32_t *region_max, uint32_t dimension,
+                             uint32_t max_num_points)
+      : oit_(oit),
+        region_min_(region_min),
+        region_max_(region_max),
+        dimension_(dimension),
+        max_num_points_(max_num_points),
+        num_points_(0) {}
+
+  // The iterator is advanced only when a point is assigned.
+  Self &operator++() { return *this; }
+  Self &operator++(int) { return *this; }
+  Self &operator*() { return *this; }
+  const Self &operator=(const std::vector<uint32_t> &val) {
+    for (uint32_t i = 0; i < dimension_; ++i) {
+      if (val[i] < region_min_[i] || val[i] > region_max_[i])
+        return *this;
+    }
+    if (num_points_ < max_num_points_) {
+      *oit_++ = val;
+      ++num_points_;
+    }
+    return *this;
+  }
+
+  uint32_t num_points() const { return num_points_; }
+
+ private:
+  OutputIteratorT oit_;
+  const uint32_t *region_min_;
+  const uint32_t *region_max_;
+  uint32_t dimension_;
+  uint32_t max_num_points_;
+  uint32_t num_points_;
+};
+
+template <int compression_level_t>
+template <class OutputIteratorT>
+bool DynamicIntegerPointsKdTreeDecoder<compression_level_t>::
+    DecodePointsInRegion(DecoderBuffer *buffer, const uint32_t *region_min,
+                         const uint32_t *region_max, OutputIteratorT oit,
+                         uint32_t *out_num_decoded_points, int num_threads) {
+  *out_num_decoded_points = 0;
+  if (!buffer->Decode(&bit_length_))
+    return false;
+  if (bit_length_ > 32)
+    return false;
+  if (!buffer->Decode(&num_points_))
+    return false;
+  if (num_points_ == 0)
+    return true;
+  uint32_t max_subtree_points;
+  if (!buffer->Decode(&max_subtree_points))
+    return false;
+  if (max_subtree_points == 0)
+    return false;
+
+  // Decode the top of the tree. Points stored directly in the top of the tree
+  // are filtered by the region.
+  RegionFilterOutputIterator<OutputIteratorT> filter_it(
+      oit, region_min, region_max, dimension_, num_points_);
+  NodeList subtrees;
+  const VectorUint32 zeros(dimension_, 0);
+  if (!StartDecoding(buffer))
+    return false;
+  if (!DecodeInternal(num_points_, 0, zeros.data(), zeros.data(),
+                      max_subtree_points, &subtrees, filter_it))
+    return false;
+  EndDecoding();
+
+  // Offsets of the subtrees; the last entry holds the total size.
+  std::vector<uint64_t> subtree_offsets(subtrees.size() + 1, 0);
+  for (size_t i = 0; i < subtrees.size(); ++i) {
+    uint64_t size;
+    if (!DecodeVarint(&size, buffer))
+      return false;
+    if (size > buffer->remaining_size())
+      return false;
+    subtree_offsets[i + 1] = subtree_offsets[i] + size;
+  }
+  const uint64_t total_size = subtree_offsets.back();
+  if (total_size > buffer->remaining_size())
+    return false;
+
+  // Decode only the subtrees that intersect the region.
+  VectorUint32 subtree_ids;
+  for (size_t i = 0; i < subtrees.size(); ++i) {
+    const uint32_t *const base = &subtrees.bases[i * dimension_];
+    const uint32_t *const levels = &subtrees.levels[i * dimension_];
+    if (CellIntersectsRegion(base, levels, region_min, region_max))
+      subtree_ids.push_back(static_cast<uint32_t>(i));
+  }
+  const char *const subtree_data = buffer->data_head();
+  if (num_threads > 1 && subtree_ids.size() > 1) {
+    if (!DecodeSubtreesInParallel(subtrees, subtree_ids, subtree_data,
+                                  subtree_offsets, buffer->bitstream_version(),
+                                  num_threads, filter_it))
+      return false;
+  } else {
+    for (const uint32_t i : subtree_ids) {
+      DecoderBuffer subtree_buffer;
+      subtree_buffer.Init(subtree_data + subtree_offsets[i],
+                          subtree_offsets[i + 1] - subtree_offsets[i],
+                          buffer->bitstream_version());
+      if (!StartDecoding(&subtree_buffer))
+        return false;
+      if (!DecodeInternal(subtrees.num_points[i], subtrees.last_axes[i],
+                          &subtrees.bases[i * dimension_],
+                          &subtrees.levels[i * dimension_], 0, nullptr,
+                          filter_it))
+        return false;
+      EndDecoding();
+    }
+  }
+  buffer->Advance(total_size);
+  *out_num_decoded_points = filter_it.num_points();
+  return true;
+}
+
+// Output iterator that appends points to a flat array of coordinates.
+class FlatPointsOutputIterator {
+  typedef FlatPointsOutputIterator Self;
+
+ public:
+  explicit FlatPointsOutputIterator(std::vector<uint32_t> *values)
+      : values_(values) {}
+
+  Self &operator++() { return *this; }
+  Self &operator++(int) { return *this; }
+  Self &operator*() { return *this; }
+  const Self &operator=(const std::vector<uint32_t> &val) {
+    values_->insert(values_->end(), val.begin(), val.end());
+    return *this;
+  }
+
+ private:
+  std::vector<uint32_t> *values_;
+};
+
+template <int compression_level_t>
+template <class OutputIteratorT>
+bool DynamicIntegerPointsKdTreeDecoder<compression_level_t>::
+    DecodeSubtreesInParallel(const NodeList &subtrees,
+                             const VectorUint32 &subtree_ids,
+                             const char *subtree_data,
+                             const std::vector<uint64_t> &subtree_offsets,
+                             uint16_t bitstream_version, int num_threads,
+                             OutputIteratorT &oit) {
+  // Each group of consecutive subtrees is decoded by its own decoder into a
+  // separate array. The arrays are passed to |oit| in order once all groups
+  // are decoded.
+  const size_t num_subtrees = subtree_ids.size();
+  const size_t num_groups =
+      std::min<size_t>(num_subtrees, 4 * static_cast<size_t>(num_threads));
+  std::vector<VectorUint32> group_points(num_groups);
+  std::vector<uint8_t> group_results(num_groups, 0);
+  ThreadPool thread_pool(
+      static_cast<int>(std::min<size_t>(num_threads, num_groups)));
+  for (size_t g = 0; g < num_groups; ++g) {
+    thread_pool.Schedule([this, &subtrees, &subtree_ids, subtree_data,
+                          &subtree_offsets, bitstream_version, &group_points,
+                          &group_results, num_subtrees, num_groups, g]() {
+      DynamicIntegerPointsKdTreeDecoder<compression_level_t> decoder(
+          dimension_);
+      decoder.bit_length_ = bit_length_;
+      FlatPointsOutputIterator points_it(&group_points[g]);
+      const size_t first = g * num_subtrees / num_groups;
+      const size_t last = (g + 1) * num_subtrees / num_groups;
+      for (size_t j = first; j < last; ++j) {
+        const uint32_t i = subtree_ids[j];
+        DecoderBuffer subtree_buffer;
+        subtree_buffer.Init(subtree_data + subtree_offsets[i],
+                            subtree_offsets[i + 1] - subtree_offsets[i],
+                            bitstream_version);
+        if (!decoder.StartDecoding(&subtree_buffer))
+          return;
+        if (!decoder.DecodeInternal(
+                subtrees.num_points[i], subtrees.last_axes[i],
+                &subtrees.bases[i * dimension_],
+                &subtrees.levels[i * dimension_], 0, nullptr, points_it))
+          return;
+        decoder.EndDecoding();
+      }
+      group_results[g] = 1;
+    });
+  }
+  thread_pool.Wait();
+
+  for (size_t g = 0; g < num_groups; ++g) {
+    if (!group_results[g])
+      return false;
+    const VectorUint32 &points = group_points[g];
+    for (size_t i = 0; i < points.size(); i += dimension_) {
+      std::copy(points.begin() + i, points.begin() + i + dimension_,
+                p_.begin());
+      *oit++ = p_;
+    }
+  }
+  return true;
+}
+
+template <int compression_level_t>
+bool DynamicIntegerPointsKdTreeDecoder<compression_level_t>::
+    CellIntersectsRegion(const uint32_t *base, const uint32_t *levels,
+                         const uint32_t *region_min,
+                         const uint32_t *region_max) const {
+  for (uint32_t i = 0; i < dimension_; ++i) {
+    const uint64_t cell_size = uint64_t(1) << (bit_length_ - levels[i]);
+    if (base[i] > region_max[i] || base[i] + cell_size - 1 < region_min[i])
+      return false;
+  }
+  return true;
+}
+
+template <int compression_level_t>
+template <class OutputIteratorT>
+bool DynamicIntegerPointsKdTreeDecoder<compression_level_t>::
+    DecodePointsLevelOrder(DecoderBuffer *buffer, OutputIteratorT oit,
+                           int max_depth, int64_t max_num_points,
+                           uint32_t *out_num_decoded_points) {
+  *out_num_decoded_points = 0;
+  if (!buffer->Decode(&bit_length_))
+    return false;
+  if (bit_length_ > 32)
+    return false;
+  if (!buffer->Decode(&num_points_))
+    return false;
+  if (num_points_ == 0)
+    return true;
+  min_values_.resize(dimension_);
+  max_values_.resize(dimension_);
+  if (!buffer->Decode(min_values_.data(), sizeof(uint32_t) * dimension_))
+    return false;
+  if (!buffer->Decode(max_values_.data(), sizeof(uint32_t) * dimension_))
+    return false;
+
+  if (!StartDecoding(buffer))
+    return false;
+  if (!DecodeLevelOrderInternal(oit, max_depth, max_num_points,
+                                out_num_decoded_points))
+    return false;
+  EndDecoding();
+  return true;
+}
+
+template <int compression_level_t>
+bool DynamicIntegerPointsKdTreeDecoder<compression_level_t>::StartDecoding(
+    DecoderBuffer *buffer) {
   if (!numbers_decoder_.StartDecoding(buffer))
     return false;
   if (!remaining_bits_decoder_.StartDecoding(buffer))
@@ -155,20 +522,20 @@ bool DynamicIntegerPointsKdTreeDecoder<compression_level_t>::DecodePoints(
     return false;
   if (!half_decoder_.StartDecoding(buffer))
     return false;
+  return true;
+}
 
-  DecodeInternal(num_points_, oit);
-
+template <int compression_level_t>
+void DynamicIntegerPointsKdTreeDecoder<compression_level_t>::EndDecoding() {
   numbers_decoder_.EndDecoding();
   remaining_bits_decoder_.EndDecoding();
   axis_decoder_.EndDecoding();
   half_decoder_.EndDecoding();
-
-  return true;
 }
 
 template <int compression_level_t>
 uint32_t DynamicIntegerPointsKdTreeDecoder<compression_level_t>::GetAxis(
-    uint32_t num_remaining_points, const VectorUint32 &levels,
+    uint32_t num_remaining_points, const uint32_t *levels,
     uint32_t last_axis) {
   if (!Policy::select_axis)
     return DRACO_INCREMENT_MOD(last_axis, dimension_);
@@ -189,12 +556,38 @@ uint32_t DynamicIntegerPointsKdTreeDecoder<compression_level_t>::GetAxis(
 
 template <int compression_level_t>
 template <class OutputIteratorT>
-void DynamicIntegerPointsKdTreeDecoder<compression_level_t>::DecodeInternal(
-    uint32_t num_points, OutputIteratorT oit) {
+void DynamicIntegerPointsKdTreeDecoder<compression_level_t>::
+    DecodeRemainingBits(uint32_t num_remaining_points, uint32_t axis,
+                        const uint32_t *old_base, const uint32_t *levels,
+                        OutputIteratorT &oit) {
+  // TODO(hemmer): axes_ not necessary, remove would change bitstream!
+  axes_[0] = axis;
+  for (int i = 1; i < dimension_; i++) {
+    axes_[i] = DRACO_INCREMENT_MOD(axes_[i - 1], dimension_);
+  }
+  for (uint32_t i = 0; i < num_remaining_points; ++i) {
+    for (int j = 0; j < dimension_; j++) {
+      p_[axes_[j]] = 0;
+      const uint32_t num_remaining_bits = bit_length_ - levels[axes_[j]];
+      if (num_remaining_bits)
+        remaining_bits_decoder_.DecodeLeastSignificantBits32(
+            num_remaining_bits, &p_[axes_[j]]);
+      p_[axes_[j]] = old_base[axes_[j]] | p_[axes_[j]];
+    }
+    *oit++ = p_;
+  }
+}
+
+template <int compression_level_t>
+template <class OutputIteratorT>
+bool DynamicIntegerPointsKdTreeDecoder<compression_level_t>::DecodeInternal(
+    uint32_t num_points, uint32_t root_last_axis, const uint32_t *root_base,
+    const uint32_t *root_levels, uint32_t max_subtree_points,
+    NodeList *out_subtrees, OutputIteratorT &oit) {
   typedef DecodingStatus Status;
-  base_stack_[0] = VectorUint32(dimension_, 0);
-  levels_stack_[0] = VectorUint32(dimension_, 0);
-  DecodingStatus init_status(num_points, 0, 0);
+  base_stack_[0].assign(root_base, root_base + dimension_);
+  levels_stack_[0].assign(root_levels, root_levels + dimension_);
+  DecodingStatus init_status(num_points, root_last_axis, 0);
   std::stack<Status> status_stack;
   status_stack.push(init_status);
 
@@ -209,7 +602,16 @@ void DynamicIntegerPointsKdTreeDecoder<compression_level_t>::DecodeInternal(
     const VectorUint32 &old_base = base_stack_[stack_pos];
     const VectorUint32 &levels = levels_stack_[stack_pos];
 
-    const uint32_t axis = GetAxis(num_remaining_points, levels, last_axis);
+    if (out_subtrees && num_remaining_points <= max_subtree_points) {
+      out_subtrees->AddNode(num_remaining_points, last_axis, old_base.data(),
+                            levels.data(), dimension_);
+      continue;
+    }
+
+    const uint32_t axis =
+        GetAxis(num_remaining_points, levels.data(), last_axis);
+    if (axis >= dimension_)
+      return false;  // Corrupted data.
     const uint32_t level = levels[axis];
 
     // All axes have been fully subdivided, just output points.
@@ -224,22 +626,8 @@ void DynamicIntegerPointsKdTreeDecoder<compression_level_t>::DecodeInternal(
 
     // Fast decoding of remaining bits if number of points is 1 or 2.
     if (num_remaining_points <= 2) {
-      // TODO(hemmer): axes_ not necessary, remove would change bitstream!
-      axes_[0] = axis;
-      for (int i = 1; i < dimension_; i++) {
-        axes_[i] = DRACO_INCREMENT_MOD(axes_[i - 1], dimension_);
-      }
-      for (uint32_t i = 0; i < num_remaining_points; ++i) {
-        for (int j = 0; j < dimension_; j++) {
-          p_[axes_[j]] = 0;
-          const uint32_t num_remaining_bits = bit_length_ - levels[axes_[j]];
-          if (num_remaining_bits)
-            remaining_bits_decoder_.DecodeLeastSignificantBits32(
-                num_remaining_bits, &p_[axes_[j]]);
-          p_[axes_[j]] = old_base[axes_[j]] | p_[axes_[j]];
-        }
-        *oit++ = p_;
-      }
+      DecodeRemainingBits(num_remaining_points, axis, old_base.data(),
+                          levels.data(), oit);
       continue;
     }
     const int num_remaining_bits = bit_length_ - level;
@@ -251,6 +639,8 @@ void DynamicIntegerPointsKdTreeDecoder<compression_level_t>::DecodeInternal(
 
     uint32_t number = 0;
     DecodeNumber(incoming_bits, &number);
+    if (number > num_remaining_points / 2)
+      return false;  // Corrupted data.
 
     uint32_t first_half = num_remaining_points / 2 - number;
     uint32_t second_half = num_remaining_points - first_half;
@@ -266,6 +656,119 @@ void DynamicIntegerPointsKdTreeDecoder<compression_level_t>::DecodeInternal(
     if (second_half)
       status_stack.push(DecodingStatus(second_half, axis, stack_pos + 1));
   }
+  return true;
+}
+
+template <int compression_level_t>
+template <class OutputIteratorT>
+bool DynamicIntegerPointsKdTreeDecoder<compression_level_t>::
+    DecodeLevelOrderInternal(OutputIteratorT oit, int max_depth,
+                             int64_t max_num_points,
+                             uint32_t *out_num_decoded_points) {
+  NodeList nodes, next_nodes;
+  const VectorUint32 zeros(dimension_, 0);
+  nodes.AddNode(num_points_, 0, zeros.data(), zeros.data(), dimension_);
+  VectorUint32 new_base(dimension_);
+  VectorUint32 new_levels(dimension_);
+  int64_t num_decoded_points = 0;
+  for (int depth = 0; nodes.size() > 0; ++depth) {
+    // Get the number of points that would be decoded if the decoding stopped
+    // after this level. Leaves output all their points and every other node
+    // is replaced by at most two children. Note that the encoder splits the
+    // points along an axis that was not fully subdivided yet, unless there is
+    // no such axis.
+    int64_t num_level_points = 0;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      const uint32_t *const levels = &nodes.levels[i * dimension_];
+      bool subdivided = true;
+      for (uint32_t j = 0; j < dimension_; ++j) {
+        subdivided &= levels[j] == bit_length_;
+      }
+      num_level_points +=
+          subdivided ? nodes.num_points[i] : std::min(nodes.num_points[i], 2u);
+    }
+    if ((max_depth >= 0 && depth >= max_depth) ||
+        (max_num_points >= 0 &&
+         num_decoded_points + num_level_points > max_num_points)) {
+      // Output the centers of the cells of all remaining nodes clipped by the
+      // bounding box of the points.
+      for (size_t i = 0; i < nodes.size(); ++i) {
+        const uint32_t *const old_base = &nodes.bases[i * dimension_];
+        const uint32_t *const levels = &nodes.levels[i * dimension_];
+        for (uint32_t j = 0; j < dimension_; ++j) {
+          const uint64_t cell_size = uint64_t(1) << (bit_length_ - levels[j]);
+          uint64_t min_value = std::max(old_base[j], min_values_[j]);
+          uint64_t max_value = std::min<uint64_t>(old_base[j] + cell_size - 1,
+                                                  max_values_[j]);
+          if (min_value > max_value)
+            min_value = max_value = old_base[j];  // Corrupted bounding box.
+          p_[j] = static_cast<uint32_t>((min_value + max_value) / 2);
+        }
+        *oit++ = p_;
+      }
+      *out_num_decoded_points =
+          static_cast<uint32_t>(num_decoded_points + nodes.size());
+      return true;
+    }
+
+    next_nodes.Clear();
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      const uint32_t num_remaining_points = nodes.num_points[i];
+      const uint32_t *const old_base = &nodes.bases[i * dimension_];
+      const uint32_t *const levels = &nodes.levels[i * dimension_];
+      const uint32_t axis =
+          GetAxis(num_remaining_points, levels, nodes.last_axes[i]);
+      if (axis >= dimension_)
+        return false;  // Corrupted data.
+      const uint32_t level = levels[axis];
+
+      if ((bit_length_ - level) == 0) {
+        for (uint32_t j = 0; j < dimension_; ++j) {
+          p_[j] = old_base[j];
+        }
+        for (uint32_t j = 0; j < num_remaining_points; ++j) {
+          *oit++ = p_;
+        }
+        num_decoded_points += num_remaining_points;
+        continue;
+      }
+      if (num_remaining_points <= 2) {
+        DecodeRemainingBits(num_remaining_points, axis, old_base, levels, oit);
+        num_decoded_points += num_remaining_points;
+        continue;
+      }
+
+      const int num_remaining_bits = bit_length_ - level;
+      const uint32_t modifier = 1 << (num_remaining_bits - 1);
+      std::copy(old_base, old_base + dimension_, new_base.begin());
+      new_base[axis] += modifier;
+
+      const int incoming_bits = bits::MostSignificantBit(num_remaining_points);
+      uint32_t number = 0;
+      DecodeNumber(incoming_bits, &number);
+      if (number > num_remaining_points / 2)
+        return false;  // Corrupted data.
+      uint32_t first_half = num_remaining_points / 2 - number;
+      uint32_t second_half = num_remaining_points - first_half;
+      if (first_half != second_half)
+        if (!half_decoder_.DecodeNextBit())
+          std::swap(first_half, second_half);
+
+      std::copy(levels, levels + dimension_, new_levels.begin());
+      new_levels[axis] += 1;
+      if (first_half) {
+        next_nodes.AddNode(first_half, axis, old_base, new_levels.data(),
+                           dimension_);
+      }
+      if (second_half) {
+        next_nodes.AddNode(second_half, axis, new_base.data(),
+                           new_levels.data(), dimension_);
+      }
+    }
+    std::swap(nodes, next_nodes);
+  }
+  *out_num_decoded_points = static_cast<uint32_t>(num_decoded_points);
+  return true;
 }
 
 extern template class DynamicIntegerPointsKdTreeDecoder<0>;
@@ -17,6 +17,7 @@
 
 #include <algorithm>
 #include <array>
+#include <limits>
 #include <memory>
 #include <stack>
 #include <vector>
@@ -29,6 +30,8 @@
 #include "draco/core/bit_utils.h"
 #include "draco/core/encoder_buffer.h"
 #include "draco/core/math_utils.h"
+#include "draco/core/thread_pool.h"
+#include "draco/core/varint_encoding.h"
 
 namespace draco {
 
@@ -85,6 +88,12 @@ struct DynamicIntegerPointsKdTreeEncoderCompressionPolicy<6>
 // in the smaller half of the two. This results in a better compression rate as
 // there are more leading zeros, which is then compressed better by the
 // arithmetic encoding.
+//
+// The nodes of the tree are normally encoded depth-first. Optionally, they can
+// be encoded level by level (see EncodePointsLevelOrder()), which allows the
+// decoder to stop after any level of the tree, or split into independently
+// encoded subtrees (see EncodePointsInSubtrees()), which allows the decoder to
+// skip parts of the tree.
 template <int compression_level_t>
 class DynamicIntegerPointsKdTreeEncoder {
   static_assert(compression_level_t >= 0, "Compression level must in [0..6].");
@@ -121,6 +130,33 @@ class DynamicIntegerPointsKdTreeEncoder {
     return EncodePoints(begin, end, 32, buffer);
   }
 
+  // Same as EncodePoints() but the nodes of the tree are encoded level by level
+  // (breadth-first). The decoder can then stop after any level and replace the
+  // remaining subtrees by representative points (see
+  // DynamicIntegerPointsKdTreeDecoder::DecodePointsLevelOrder()). The bounding
+  // box of the points is stored before the tree. Unlike the
+  // depth-first encoding, the memory used by the encoder and the decoder grows
+  // with the number of nodes in the widest level of the tree.
+  template <class RandomAccessIteratorT>
+  bool EncodePointsLevelOrder(RandomAccessIteratorT begin,
+                              RandomAccessIteratorT end,
+                              const uint32_t &bit_length,
+                              EncoderBuffer *buffer);
+
+  // Same as EncodePoints() but every subtree with at most |max_subtree_points|
+  // points is encoded independently of the rest of the tree. The byte sizes of
+  // all subtrees are stored after the top of the tree so that the decoder can
+  // skip subtrees outside of a region of interest (see
+  // DynamicIntegerPointsKdTreeDecoder::DecodePointsInRegion()). When
+  // |num_threads| is larger than 1, the subtrees are encoded in parallel. The
+  // encoded data does not depend on the number of threads.
+  template <class RandomAccessIteratorT>
+  bool EncodePointsInSubtrees(RandomAccessIteratorT begin,
+                              RandomAccessIteratorT end,
+                              const uint32_t &bit_length,
+                              uint32_t max_subtree_points,
+                              EncoderBuffer *buffer, int num_threads = 1);
+
   const uint32_t dimension() const { return dimension_; }
 
  private:
@@ -130,13 +166,49 @@ class DynamicIntegerPointsKdTreeEncoder {
     }
   }
 
+  template <class RandomAccessIteratorT>
+  bool EncodePointsImpl(RandomAccessIteratorT begin, RandomAccessIteratorT end,
+                        uint32_t bit_length, bool level_order,
+                        EncoderBuffer *buffer);
+
   template <class RandomAccessIteratorT>
   uint32_t GetAxis(RandomAccessIteratorT begin, RandomAccessIteratorT end,
-                   const VectorUint32 &old_base, const VectorUint32 &levels,
+                   const uint32_t *old_base, const uint32_t *levels,
                    uint32_t last_axis);
 
+  // Encodes all bits of points [begin, end) that are not defined by |levels|
+  // of the node containing the points.
+  template <class RandomAccessIteratorT>
+  void EncodeRemainingBits(RandomAccessIteratorT begin,
+                           RandomAccessIteratorT end, uint32_t axis,
+                           const uint32_t *levels);
+
+  template <class RandomAccessIteratorT>
+  struct NodeList;
+
+  void StartEncoding();
+  void EndEncoding(EncoderBuffer *buffer);
+
+  // Encodes the subtree of points [begin, end) whose root node has the given
+  // |root_base|, |root_levels| and |root_last_axis|. When |out_subtrees| is
+  // set, nodes with at most |max_subtree_points| points are not encoded but
+  // added to |out_subtrees|.
+  template <class RandomAccessIteratorT>
+  void EncodeInternal(RandomAccessIteratorT begin, RandomAccessIteratorT end,
+                      uint32_t root_last_axis, const uint32_t *root_base,
+                      const uint32_t *root_levels, uint32_t max_subtree_points,
+                      NodeList<RandomAccessIteratorT> *out_subtrees);
+
+  template <class RandomAccessIteratorT>
+  void EncodeLevelOrderInternal(RandomAccessIteratorT begin,
+                                RandomAccessIteratorT end);
+
+  // Encodes subtrees [first, last) of |subtrees| one after another into
+  // |buffer| and stores the byte size of the i-th subtree in |sizes[i]|.
   template <class RandomAccessIteratorT>
-  void EncodeInternal(RandomAccessIteratorT begin, RandomAccessIteratorT end);
+  void EncodeSubtrees(const NodeList<RandomAccessIteratorT> &subtrees,
+                      size_t first, size_t last, EncoderBuffer *buffer,
+                      uint64_t *sizes);
 
   class Splitter {
    public:
@@ -173,6 +245,35 @@ class DynamicIntegerPointsKdTreeEncoder {
     uint32_t stack_pos;  // used to get base and levels
   };
 
+  // List of tree nodes. Bases and levels of all nodes are stored in flat arrays
+  // with |dimension_| values per node.
+  template <class RandomAccessIteratorT>
+  struct NodeList {
+    void Clear() {
+      begins.clear();
+      ends.clear();
+      last_axes.clear();
+      bases.clear();
+      levels.clear();
+    }
+    void AddNode(RandomAccessIteratorT begin, RandomAccessIteratorT end,
+                 uint32_t last_axis, const uint32_t *base,
+                 const uint32_t *node_levels, uint32_t dimension) {
+      begins.push_back(begin);
+      ends.push_back(end);
+      last_axes.push_back(last_axis);
+      bases.insert(bases.end(), base, base + dimension);
+      levels.insert(levels.end(), node_levels, node_levels + dimension);
+    }
+    size_t size() const { return begins.size(); }
+
+    std::vector<RandomAccessIteratorT> begins;
+    std::vector<RandomAccessIteratorT> ends;
+    std::vector<uint32_t> last_axes;
+    std::vector<uint32_t> bases;
+    std::vector<uint32_t> levels;
+  };
+
   uint32_t bit_length_;
   uint32_t num_points_;
   uint32_t dimension_;
@@ -192,6 +293,110 @@ template <class RandomAccessIteratorT>
 bool DynamicIntegerPointsKdTreeEncoder<compression_level_t>::EncodePoints(
     RandomAccessIteratorT begin, RandomAccessIteratorT end,
     const uint32_t &bit_length, EncoderBuffer *buffer) {
+  return EncodePointsImpl(begin, end, bit_length, false, buffer);
+}
+
+template <int compression_level_t>
+template <class RandomAccessIteratorT>
+bool DynamicIntegerPointsKdTreeEncoder<
+    compression_level_t>::EncodePointsLevelOrder(RandomAccessIteratorT begin,
+                                                  RandomAccessIteratorT end,
+                                                  const uint32_t &bit_length,
+                                                  EncoderBuffer *buffer) {
+  return EncodePointsImpl(begin, end, bit_length, true, buffer);
+}
+
+template <int compression_level_t>
+template <class RandomAccessIteratorT>
+bool DynamicIntegerPointsKdTreeEncoder<compression_level_t>::
+    EncodePointsInSubtrees(RandomAccessIteratorT begin,
+                           RandomAccessIteratorT end,
+                           const uint32_t &bit_length,
+                           uint32_t max_subtree_points,
+                           EncoderBuffer *buffer, int num_threads) {
+  if (max_subtree_points == 0)
+    return false;
+  bit_length_ = bit_length;
+  num_points_ = end - begin;
+
+  buffer->Encode(bit_length_);
+  buffer->Encode(num_points_);
+  if (num_points_ == 0)
+    return true;
+  buffer->Encode(max_subtree_points);
+
+  // Encode the top of the tree.
+  NodeList<RandomAccessIteratorT> subtrees;
+  const VectorUint32 zeros(dimension_, 0);
+  StartEncoding();
+  EncodeInternal(begin, end, 0, zeros.data(), zeros.data(), max_subtree_points,
+                 &subtrees);
+  EndEncoding(buffer);
+
+  // Encode the subtrees into separate buffers and store their sizes. The
+  // subtrees hold disjoint ranges of points, so groups of consecutive subtrees
+  // can be encoded in parallel, each by its own encoder. The size of the
+  // groups depends only on the number of subtrees.
+  const size_t num_subtrees = subtrees.size();
+  std::vector<uint64_t> subtree_sizes(num_subtrees);
+  const size_t group_size = std::max<size_t>(num_subtrees / 64, 1);
+  const size_t num_groups = (num_subtrees + group_size - 1) / group_size;
+  std::vector<EncoderBuffer> group_buffers(num_groups);
+  if (num_threads > 1 && num_groups > 1) {
+    ThreadPool thread_pool(
+        static_cast<int>(std::min<size_t>(num_threads, num_groups)));
+    for (size_t g = 0; g < num_groups; ++g) {
+      thread_pool.Schedule([this, &subtrees, &subtree_sizes, &group_buffers,
+                            group_size, num_subtrees, g]() {
+        const size_t first = g * group_size;
+        const size_t last = std::min(first + group_size, num_subtrees);
+        DynamicIntegerPointsKdTreeEncoder<compression_level_t> encoder(
+            dimension_);
+        encoder.bit_length_ = bit_length_;
+        encoder.EncodeSubtrees(subtrees, first, last, &group_buffers[g],
+                               &subtree_sizes[first]);
+      });
+    }
+    thread_pool.Wait();
+  } else {
+    for (size_t g = 0; g < num_groups; ++g) {
+      const size_t first = g * group_size;
+      const size_t last = std::min(first + group_size, num_subtrees);
+      EncodeSubtrees(subtrees, first, last, &group_buffers[g],
+                     &subtree_sizes[first]);
+    }
+  }
+  for (const uint64_t size : subtree_sizes) {
+    EncodeVarint<uint64_t>(size, buffer);
+  }
+  for (const EncoderBuffer &group_buffer : group_buffers) {
+    buffer->Encode(group_buffer.data(), group_buffer.size());
+  }
+  return true;
+}
+
+template <int compression_level_t>
+template <class RandomAccessIteratorT>
+void DynamicIntegerPointsKdTreeEncoder<compression_level_t>::EncodeSubtrees(
+    const NodeList<RandomAccessIteratorT> &subtrees, size_t first, size_t last,
+    EncoderBuffer *buffer, uint64_t *sizes) {
+  for (size_t i = first; i < last; ++i) {
+    const size_t subtree_start = buffer->size();
+    StartEncoding();
+    EncodeInternal<RandomAccessIteratorT>(
+        subtrees.begins[i], subtrees.ends[i], subtrees.last_axes[i],
+        &subtrees.bases[i * dimension_], &subtrees.levels[i * dimension_], 0,
+        nullptr);
+    EndEncoding(buffer);
+    sizes[i - first] = buffer->size() - subtree_start;
+  }
+}
+
+template <int compression_level_t>
+template <class RandomAccessIteratorT>
+bool DynamicIntegerPointsKdTreeEncoder<compression_level_t>::EncodePointsImpl(
+    RandomAccessIteratorT begin, RandomAccessIteratorT end,
+    uint32_t bit_length, bool level_order, EncoderBuffer *buffer) {
   bit_length_ = bit_length;
   num_points_ = end - begin;
 
@@ -199,27 +404,57 @@ bool DynamicIntegerPointsKdTreeEncoder<compression_level_t>::EncodePoints(
   buffer->Encode(num_points_);
   if (num_points_ == 0)
     return true;
+  if (level_order) {
+    // Bounding box of the points used by the decoder to place points of
+    // subtrees that were not decoded.
+    VectorUint32 min_values(dimension_, std::numeric_limits<uint32_t>::max());
+    VectorUint32 max_values(dimension_, 0);
+    for (auto it = begin; it != end; ++it) {
+      for (uint32_t j = 0; j < dimension_; ++j) {
+        min_values[j] = std::min<uint32_t>(min_values[j], (*it)[j]);
+        max_values[j] = std::max<uint32_t>(max_values[j], (*it)[j]);
+      }
+    }
+    buffer->Encode(min_values.data(), sizeof(uint32_t) * dimension_);
+    buffer->Encode(max_values.data(), sizeof(uint32_t) * dimension_);
+  }
+
+  StartEncoding();
+  if (level_order) {
+    EncodeLevelOrderInternal(begin, end);
+  } else {
+    const VectorUint32 zeros(dimension_, 0);
+    EncodeInternal<RandomAccessIteratorT>(begin, end, 0, zeros.data(),
+                                          zeros.data(), 0, nullptr);
+  }
+  EndEncoding(buffer);
+  return true;
+}
 
+template <int compression_level_t>
+void DynamicIntegerPointsKdTreeEncoder<compression_level_t>::StartEncoding() {
+  // Reset the statistics of GetAxis() so that the encoded tree does not depend
+  // on trees encoded before.
+  std::fill(deviations_.begin(), deviations_.end(), 0);
   numbers_encoder_.StartEncoding();
   remaining_bits_encoder_.StartEncoding();
   axis_encoder_.StartEncoding();
   half_encoder_.StartEncoding();
+}
 
-  EncodeInternal(begin, end);
-
+template <int compression_level_t>
+void DynamicIntegerPointsKdTreeEncoder<compression_level_t>::EndEncoding(
+    EncoderBuffer *buffer) {
   numbers_encoder_.EndEncoding(buffer);
   remaining_bits_encoder_.EndEncoding(buffer);
   axis_encoder_.EndEncoding(buffer);
   half_encoder_.EndEncoding(buffer);
-
-  return true;
 }
 template <int compression_level_t>
 template <class RandomAccessIteratorT>
 uint32_t DynamicIntegerPointsKdTreeEncoder<compression_level_t>::GetAxis(
     RandomAccessIteratorT begin, RandomAccessIteratorT end,
-    const VectorUint32 &old_base, const VectorUint32 &levels,
-    uint32_t last_axis) {
+    const uint32_t *old_base, const uint32_t *levels, uint32_t last_axis) {
   if (!Policy::select_axis)
     return DRACO_INCREMENT_MOD(last_axis, dimension_);
 
@@ -267,15 +502,40 @@ uint32_t DynamicIntegerPointsKdTreeEncoder<compression_level_t>::GetAxis(
   return best_axis;
 }
 
+template <int compression_level_t>
+template <class RandomAccessIteratorT>
+void DynamicIntegerPointsKdTreeEncoder<compression_level_t>::
+    EncodeRemainingBits(RandomAccessIteratorT begin, RandomAccessIteratorT end,
+                        uint32_t axis, const uint32_t *levels) {
+  // TODO(hemmer): axes_ not necessary, remove would change bitstream!
+  axes_[0] = axis;
+  for (int i = 1; i < dimension_; i++) {
+    axes_[i] = DRACO_INCREMENT_MOD(axes_[i - 1], dimension_);
+  }
+  for (auto it = begin; it != end; ++it) {
+    const auto &p = *it;
+    for (int j = 0; j < dimension_; j++) {
+      const uint32_t num_remaining_bits = bit_length_ - levels[axes_[j]];
+      if (num_remaining_bits) {
+        remaining_bits_encoder_.EncodeLeastSignificantBits32(
+            num_remaining_bits, p[axes_[j]]);
+      }
+    }
+  }
+}
+
 template <int compression_level_t>
 template <class RandomAccessIteratorT>
 void DynamicIntegerPointsKdTreeEncoder<compression_level_t>::EncodeInternal(
-    RandomAccessIteratorT begin, RandomAccessIteratorT end) {
+    RandomAccessIteratorT begin, RandomAccessIteratorT end,
+    uint32_t root_last_axis, const uint32_t *root_base,
+    const uint32_t *root_levels, uint32_t max_subtree_points,
+    NodeList<RandomAccessIteratorT> *out_subtrees) {
   typedef EncodingStatus<RandomAccessIteratorT> Status;
 
-  base_stack_[0] = VectorUint32(dimension_, 0);
-  levels_stack_[0] = VectorUint32(dimension_, 0);
-  Status init_status(begin, end, 0, 0);
+  base_stack_[0].assign(root_base, root_base + dimension_);
+  levels_stack_[0].assign(root_levels, root_levels + dimension_);
+  Status init_status(begin, end, root_last_axis, 0);
   std::stack<Status> status_stack;
   status_stack.push(init_status);
 
@@ -291,7 +551,15 @@ void DynamicIntegerPointsKdTreeEncoder<compression_level_t>::EncodeInternal(
     const VectorUint32 &old_base = base_stack_[stack_pos];
     const VectorUint32 &levels = levels_stack_[stack_pos];
 
-    const uint32_t axis = GetAxis(begin, end, old_base, levels, last_axis);
+    if (out_subtrees &&
+        static_cast<uint32_t>(end - begin) <= max_subtree_points) {
+      out_subtrees->AddNode(begin, end, last_axis, old_base.data(),
+                            levels.data(), dimension_);
+      continue;
+    }
+
+    const uint32_t axis =
+        GetAxis(begin, end, old_base.data(), levels.data(), last_axis);
     const uint32_t level = levels[axis];
     const uint32_t num_remaining_points = end - begin;
 
@@ -302,21 +570,7 @@ void DynamicIntegerPointsKdTreeEncoder<compression_level_t>::EncodeInternal(
     // Fast encoding of remaining bits if number of points is 1 or 2.
     // Doing this also for 2 gives a slight additional speed up.
     if (num_remaining_points <= 2) {
-      // TODO(hemmer): axes_ not necessary, remove would change bitstream!
-      axes_[0] = axis;
-      for (int i = 1; i < dimension_; i++) {
-        axes_[i] = DRACO_INCREMENT_MOD(axes_[i - 1], dimension_);
-      }
-      for (uint32_t i = 0; i < num_remaining_points; ++i) {
-        const auto &p = *(begin + i);
-        for (int j = 0; j < dimension_; j++) {
-          const uint32_t num_remaining_bits = bit_length_ - levels[axes_[j]];
-          if (num_remaining_bits) {
-            remaining_bits_encoder_.EncodeLeastSignificantBits32(
-                num_remaining_bits, p[axes_[j]]);
-          }
-        }
-      }
+      EncodeRemainingBits(begin, end, axis, levels.data());
       continue;
     }
 
@@ -355,6 +609,72 @@ void DynamicIntegerPointsKdTreeEncoder<compression_level_t>::EncodeInternal(
       status_stack.push(Status(split, end, axis, stack_pos + 1));
   }
 }
+
+template <int compression_level_t>
+template <class RandomAccessIteratorT>
+void DynamicIntegerPointsKdTreeEncoder<compression_level_t>::
+    EncodeLevelOrderInternal(RandomAccessIteratorT begin,
+                             RandomAccessIteratorT end) {
+  // Nodes of the current and of the next level of the tree. The nodes are
+  // processed in the same way as in EncodeInternal() but the children of each
+  // node are postponed to the next level.
+  NodeList<RandomAccessIteratorT> nodes, next_nodes;
+  const VectorUint32 zeros(dimension_, 0);
+  nodes.AddNode(begin, end, 0, zeros.data(), zeros.data(), dimension_);
+  VectorUint32 new_base(dimension_);
+  VectorUint32 new_levels(dimension_);
+  while (nodes.size() > 0) {
+    next_nodes.Clear();
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      begin = nodes.begins[i];
+      end = nodes.ends[i];
+      const uint32_t *const old_base = &nodes.bases[i * dimension_];
+      const uint32_t *const levels = &nodes.levels[i * dimension_];
+      const uint32_t axis =
+          GetAxis(begin, end, old_base, levels, nodes.last_axes[i]);
+      const uint32_t level = levels[axis];
+      const uint32_t num_remaining_points = end - begin;
+
+      if ((bit_length_ - level) == 0)
+        continue;
+      if (num_remaining_points <= 2) {
+        EncodeRemainingBits(begin, end, axis, levels);
+        continue;
+      }
+
+      const uint32_t num_remaining_bits = bit_length_ - level;
+      const uint32_t modifier = 1 << (num_remaining_bits - 1);
+      std::copy(old_base, old_base + dimension_, new_base.begin());
+      new_base[axis] += modifier;
+      const RandomAccessIteratorT split =
+          std::partition(begin, end, Splitter(axis, new_base[axis]));
+
+      const int required_bits = bits::MostSignificantBit(num_remaining_points);
+      const uint32_t first_half = split - begin;
+      const uint32_t second_half = end - split;
+      const bool left = first_half < second_half;
+      if (first_half != second_half)
+        half_encoder_.EncodeBit(left);
+      if (left) {
+        EncodeNumber(required_bits, num_remaining_points / 2 - first_half);
+      } else {
+        EncodeNumber(required_bits, num_remaining_points / 2 - second_half);
+      }
+
+      std::copy(levels, levels + dimension_, new_levels.begin());
+      new_levels[axis] += 1;
+      if (split != begin) {
+        next_nodes.AddNode(begin, split, axis, old_base, new_levels.data(),
+                           dimension_);
+      }
+      if (split != end) {
+        next_nodes.AddNode(split, end, axis, new_base.data(),
+                           new_levels.data(), dimension_);
+      }
+    }
+    std::swap(nodes, next_nodes);
+  }
+}
 extern template class DynamicIntegerPointsKdTreeEncoder<0>;
 extern template class DynamicIntegerPointsKdTreeEncoder<2>;
 extern template class DynamicIntegerPointsKdTreeEncoder<4>;
@@ -0,0 +1,230 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include <cmath>
+#include <iterator>
+
+#include "benchmark/benchmark.h"
+#include "draco/compression/config/compression_shared.h"
+#include "draco/compression/point_cloud/algorithms/dynamic_integer_points_kd_tree_decoder.h"
+#include "draco/compression/point_cloud/algorithms/dynamic_integer_points_kd_tree_encoder.h"
+#include "draco/compression/point_cloud/algorithms/float_points_tree_decoder.h"
+#include "draco/compression/point_cloud/algorithms/float_points_tree_encoder.h"
+#include "draco/core/draco_benchmark_utils.h"
+
+namespace draco {
+
+namespace {
+
+constexpr int kNumPoints = 1 << 18;
+constexpr uint32_t kBitLength = 14;
+
+// Returns |num_points| points sampled from a wavy surface, quantized to
+// |kBitLength| bits.
+std::vector<Point3ui> CreateIntegerPoints(int num_points = kNumPoints) {
+  std::vector<Point3ui> points(num_points);
+  const int row_size =
+      static_cast<int>(std::ceil(std::sqrt(static_cast<float>(num_points))));
+  const float scale = static_cast<float>((1 << kBitLength) - 1) / row_size;
+  for (int i = 0; i < num_points; ++i) {
+    const float x = static_cast<float>(i % row_size);
+    const float y = static_cast<float>(i / row_size);
+    const float z = row_size * (0.5f + 0.25f * std::sin(x * 0.05f) *
+                                           std::cos(y * 0.07f));
+    points[i] = Point3ui(static_cast<uint32_t>(x * scale),
+                         static_cast<uint32_t>(y * scale),
+                         static_cast<uint32_t>(z * scale));
+  }
+  return points;
+}
+
+// Decodes state.range(0) points encoded depth-first by
+// DynamicIntegerPointsKdTreeEncoder.
+template <int compression_level_t>
+void BM_DynamicIntegerPointsKdTreeDecoder(benchmark::State &state) {
+  const int num_points = static_cast<int>(state.range(0));
+  std::vector<Point3ui> points = CreateIntegerPoints(num_points);
+  EncoderBuffer encoder_buffer;
+  DynamicIntegerPointsKdTreeEncoder<compression_level_t> encoder(3);
+  if (!encoder.EncodePoints(points.begin(), points.end(), kBitLength,
+                            &encoder_buffer)) {
+    state.SkipWithError("Failed to encode points.");
+    return;
+  }
+
+  std::vector<uint32_t> decoded_values;
+  decoded_values.reserve(3 * num_points);
+  for (auto _ : state) {
+    decoded_values.clear();
+    DecoderBuffer buffer;
+    buffer.Init(encoder_buffer.data(), encoder_buffer.size(),
+                kDracoBitstreamVersion);
+    DynamicIntegerPointsKdTreeDecoder<compression_level_t> decoder(3);
+    if (!decoder.DecodePoints(&buffer,
+                              FlatPointsOutputIterator(&decoded_values))) {
+      state.SkipWithError("Failed to decode points.");
+      break;
+    }
+    benchmark::DoNotOptimize(decoded_values.data());
+  }
+  state.SetItemsProcessed(state.iterations() * num_points);
+  state.SetBytesProcessed(state.iterations() * encoder_buffer.size());
+}
+BENCHMARK_TEMPLATE(BM_DynamicIntegerPointsKdTreeDecoder, 0)
+    ->ArgName("points")
+    ->Arg(kNumPoints)
+    ->Arg(10000000)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_DynamicIntegerPointsKdTreeDecoder, 2)
+    ->ArgName("points")
+    ->Arg(kNumPoints)
+    ->Arg(10000000)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_DynamicIntegerPointsKdTreeDecoder, 4)
+    ->ArgName("points")
+    ->Arg(kNumPoints)
+    ->Arg(10000000)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_DynamicIntegerPointsKdTreeDecoder, 6)
+    ->ArgName("points")
+    ->Arg(kNumPoints)
+    ->Arg(10000000)
+    ->Unit(benchmark::kMicrosecond);
+
+// Decodes points encoded level by level by DynamicIntegerPointsKdTreeEncoder
+// up to the tree depth state.range(0). Negative depth decodes the whole tree.
+void BM_DynamicIntegerPointsKdTreeDecoderLevelOrder(benchmark::State &state) {
+  std::vector<Point3ui> points = CreateIntegerPoints();
+  EncoderBuffer encoder_buffer;
+  DynamicIntegerPointsKdTreeEncoder<6> encoder(3);
+  if (!encoder.EncodePointsLevelOrder(points.begin(), points.end(), kBitLength,
+                                      &encoder_buffer)) {
+    state.SkipWithError("Failed to encode points.");
+    return;
+  }
+
+  const int max_depth = static_cast<int>(state.range(0));
+  std::vector<uint32_t> decoded_values;
+  decoded_values.reserve(3 * kNumPoints);
+  uint32_t num_decoded_points = 0;
+  for (auto _ : state) {
+    decoded_values.clear();
+    DecoderBuffer buffer;
+    buffer.Init(encoder_buffer.data(), encoder_buffer.size(),
+                kDracoBitstreamVersion);
+    DynamicIntegerPointsKdTreeDecoder<6> decoder(3);
+    if (!decoder.DecodePointsLevelOrder(
+            &buffer, FlatPointsOutputIterator(&decoded_values), max_depth, -1,
+            &num_decoded_points)) {
+      state.SkipWithError("Failed to decode points.");
+      break;
+    }
+    benchmark::DoNotOptimize(decoded_values.data());
+  }
+  state.counters["points"] = num_decoded_points;
+  state.SetItemsProcessed(state.iterations() * num_decoded_points);
+}
+BENCHMARK(BM_DynamicIntegerPointsKdTreeDecoderLevelOrder)
+    ->Arg(16)
+    ->Arg(-1)
+    ->Unit(benchmark::kMicrosecond);
+
+// Decodes all points encoded in independent subtrees by
+// DynamicIntegerPointsKdTreeEncoder using state.range(0) threads.
+void BM_DynamicIntegerPointsKdTreeDecoderSubtrees(benchmark::State &state) {
+  std::vector<Point3ui> points = CreateIntegerPoints();
+  EncoderBuffer encoder_buffer;
+  DynamicIntegerPointsKdTreeEncoder<6> encoder(3);
+  if (!encoder.EncodePointsInSubtrees(points.begin(), points.end(),
+                                      kBitLength, 1 << 12, &encoder_buffer)) {
+    state.SkipWithError("Failed to encode points.");
+    return;
+  }
+
+  const int num_threads = static_cast<int>(state.range(0));
+  const uint32_t region_min[3] = {0, 0, 0};
+  const uint32_t region_max[3] = {(1u << kBitLength) - 1,
+                                  (1u << kBitLength) - 1,
+                                  (1u << kBitLength) - 1};
+  std::vector<uint32_t> decoded_values;
+  decoded_values.reserve(3 * kNumPoints);
+  for (auto _ : state) {
+    decoded_values.clear();
+    DecoderBuffer buffer;
+    buffer.Init(encoder_buffer.data(), encoder_buffer.size(),
+                kDracoBitstreamVersion);
+    DynamicIntegerPointsKdTreeDecoder<6> decoder(3);
+    uint32_t num_decoded_points;
+    if (!decoder.DecodePointsInRegion(
+            &buffer, region_min, region_max,
+            FlatPointsOutputIterator(&decoded_values), &num_decoded_points,
+            num_threads)) {
+      state.SkipWithError("Failed to decode points.");
+      break;
+    }
+    benchmark::DoNotOptimize(decoded_values.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kNumPoints);
+  state.SetBytesProcessed(state.iterations() * encoder_buffer.size());
+}
+BENCHMARK(BM_DynamicIntegerPointsKdTreeDecoderSubtrees)
+    ->ArgName("threads")
+    ->Arg(1)
+    ->Arg(4)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+// Decodes float points encoded by FloatPointsTreeEncoder with compression
+// level state.range(0).
+void BM_FloatPointsTreeDecoder(benchmark::State &state) {
+  const std::vector<Point3ui> int_points = CreateIntegerPoints();
+  std::vector<Point3f> points(int_points.size());
+  for (size_t i = 0; i < int_points.size(); ++i) {
+    for (int c = 0; c < 3; ++c) {
+      points[i][c] = static_cast<float>(int_points[i][c]) / (1 << kBitLength);
+    }
+  }
+  FloatPointsTreeEncoder encoder(KDTREE, kBitLength,
+                                 static_cast<uint32_t>(state.range(0)));
+  if (!encoder.EncodePointCloud(points.begin(), points.end())) {
+    state.SkipWithError("Failed to encode points.");
+    return;
+  }
+
+  std::vector<Point3f> decoded_points;
+  decoded_points.reserve(kNumPoints);
+  for (auto _ : state) {
+    decoded_points.clear();
+    FloatPointsTreeDecoder decoder;
+    if (!decoder.DecodePointCloud(encoder.buffer()->data(),
+                                  encoder.buffer()->size(),
+                                  std::back_inserter(decoded_points))) {
+      state.SkipWithError("Failed to decode points.");
+      break;
+    }
+    benchmark::DoNotOptimize(decoded_points.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kNumPoints);
+  state.SetBytesProcessed(state.iterations() * encoder.buffer()->size());
+}
+BENCHMARK(BM_FloatPointsTreeDecoder)
+    ->ArgName("level")
+    ->Arg(0)
+    ->Arg(3)
+    ->Arg(6)
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace
+
+}  // namespace draco
@@ -14,6 +14,9 @@
 //
 #include "draco/compression/point_cloud/point_cloud_decoder.h"
 
+#include <algorithm>
+
+#include "draco/core/thread_pool.h"
 #include "draco/metadata/metadata_decoder.h"
 
 namespace draco {
@@ -21,9 +24,19 @@ namespace draco {
 PointCloudDecoder::PointCloudDecoder()
     : point_cloud_(nullptr),
       buffer_(nullptr),
+      buffer_start_(nullptr),
       version_major_(0),
       version_minor_(0),
-      options_(nullptr) {}
+      options_(nullptr),
+      stats_(nullptr),
+      num_decoding_threads_(1),
+      geometry_data_decoded_(false),
+      num_decoded_attributes_decoders_(0),
+      attributes_offset_(0),
+      num_geometry_attributes_(0),
+      are_attributes_decoders_created_(false),
+      num_read_attributes_decoders_(0),
+      peak_memory_usage_(0) {}
 
 Status PointCloudDecoder::DecodeHeader(DecoderBuffer *buffer,
                                        DracoHeader *out_header) {
@@ -60,9 +73,22 @@ Status PointCloudDecoder::Decode(const DecoderOptions &options,
                                  PointCloud *out_point_cloud) {
   options_ = &options;
   buffer_ = in_buffer;
+  buffer_start_ = in_buffer->data_head();
   point_cloud_ = out_point_cloud;
+  geometry_data_decoded_ = false;
+  num_decoded_attributes_decoders_ = 0;
+  peak_memory_usage_ = 0;
+  // Remove state of any previous call so that the decoder can be reused.
+  attributes_decoders_.clear();
+  attribute_to_decoder_map_.clear();
+  are_attributes_decoders_created_ = false;
+  num_read_attributes_decoders_ = 0;
+  attributes_decoder_checkpoints_.clear();
   DracoHeader header;
-  DRACO_RETURN_IF_ERROR(DecodeHeader(buffer_, &header))
+  {
+    CodingStatsScope scope(stats_, "header", -1, buffer_);
+    DRACO_RETURN_IF_ERROR(DecodeHeader(buffer_, &header))
+  }
   // Sanity check that we are really using the right decoder (mostly for cases
   // where the Decode method was called manually outside of our main API.
   if (header.encoder_type != GetGeometryType())
@@ -82,45 +108,124 @@ Status PointCloudDecoder::Decode(const DecoderOptions &options,
   buffer_->set_bitstream_version(
       DRACO_BITSTREAM_VERSION(version_major_, version_minor_));
 
+  // Attributes of older bit-streams are decoded directly into their final
+  // form which prevents deferring of the decoding work.
+  num_decoding_threads_ = 1;
+  if (bitstream_version() >= DRACO_BITSTREAM_VERSION(2, 0))
+    num_decoding_threads_ = options.GetGlobalInt("num_decoding_threads", 1);
+  deferred_attribute_tasks_.clear();
+
   if (bitstream_version() >= DRACO_BITSTREAM_VERSION(1, 3) &&
       (header.flags & METADATA_FLAG_MASK)) {
+    CodingStatsScope scope(stats_, "metadata", -1, buffer_);
     DRACO_RETURN_IF_ERROR(DecodeMetadata())
   }
   if (!InitializeDecoder())
     return Status(Status::ERROR, "Failed to initialize the decoder.");
   if (!DecodeGeometryData())
     return Status(Status::ERROR, "Failed to decode geometry data.");
+  geometry_data_decoded_ = true;
+  attributes_offset_ = GetBufferOffset();
+  num_geometry_attributes_ = point_cloud_->num_attributes();
   if (!DecodePointAttributes())
     return Status(Status::ERROR, "Failed to decode point attributes.");
   return OkStatus();
 }
 
+Status PointCloudDecoder::ResumeDecoding(DecoderBuffer *in_buffer) {
+  if (!geometry_data_decoded_)
+    return Status(Status::ERROR, "Geometry data is not decoded.");
+  buffer_ = in_buffer;
+  buffer_start_ = in_buffer->data_head();
+  buffer_->set_bitstream_version(bitstream_version());
+  const int32_t num_attributes_decoders =
+      static_cast<int32_t>(attributes_decoder_checkpoints_.size());
+  if (are_attributes_decoders_created_ &&
+      num_read_attributes_decoders_ == num_attributes_decoders) {
+    // Nothing is left to read. Failures of the last call were not caused by
+    // missing data.
+    if (num_decoded_attributes_decoders_ < num_attributes_decoders)
+      return Status(Status::ERROR, "Failed to decode point attributes.");
+    return OkStatus();
+  }
+  if (!are_attributes_decoders_created_) {
+    // The decoders are created again from the start of the attribute data.
+    DeleteAttributesFrom(num_geometry_attributes_);
+    attributes_decoders_.clear();
+    attribute_to_decoder_map_.clear();
+    deferred_attribute_tasks_.clear();
+    SeekBuffer(attributes_offset_);
+    if (!DecodePointAttributes())
+      return Status(Status::ERROR, "Failed to decode point attributes.");
+    return OkStatus();
+  }
+  // Decoders that did not read all their values are created again, because
+  // their state after the failure is unknown.
+  const AttributesDecoderCheckpoint &checkpoint =
+      attributes_decoder_checkpoints_[num_read_attributes_decoders_];
+  DeleteAttributesFrom(checkpoint.first_att_id);
+  deferred_attribute_tasks_.erase(
+      deferred_attribute_tasks_.begin() + checkpoint.num_deferred_tasks,
+      deferred_attribute_tasks_.end());
+  SeekBuffer(checkpoint.creation_offset);
+  if (!CreateAttributesDecoders(num_read_attributes_decoders_))
+    return Status(Status::ERROR, "Failed to decode point attributes.");
+  SeekBuffer(checkpoint.values_offset);
+  if (!DecodeAllAttributes() || !OnAttributesDecoded())
+    return Status(Status::ERROR, "Failed to decode point attributes.");
+  return OkStatus();
+}
+
 bool PointCloudDecoder::DecodePointAttributes() {
   uint8_t num_attributes_decoders;
   if (!buffer_->Decode(&num_attributes_decoders))
     return false;
+  attributes_decoder_checkpoints_.resize(num_attributes_decoders);
+  if (!CreateAttributesDecoders(0))
+    return false;
+
+  // Decode the actual attributes using the created attribute decoders.
+  if (!DecodeAllAttributes())
+    return false;
+
+  if (!OnAttributesDecoded())
+    return false;
+  return true;
+}
+
+bool PointCloudDecoder::CreateAttributesDecoders(int32_t first_dec_id) {
+  const int32_t num_attributes_decoders =
+      static_cast<int32_t>(attributes_decoder_checkpoints_.size());
   // Create all attribute decoders. This is implementation specific and the
   // derived classes can use any data encoded in the
   // PointCloudEncoder::EncodeAttributesEncoderIdentifier() call.
-  for (int i = 0; i < num_attributes_decoders; ++i) {
+  for (int i = first_dec_id; i < num_attributes_decoders; ++i) {
+    attributes_decoder_checkpoints_[i].creation_offset = GetBufferOffset();
     if (!CreateAttributesDecoder(i))
       return false;
   }
 
   // Initialize all attributes decoders. No data is decoded here.
-  for (auto &att_dec : attributes_decoders_) {
-    if (!att_dec->Initialize(this, point_cloud_))
+  for (int i = first_dec_id; i < num_attributes_decoders; ++i) {
+    if (!attributes_decoders_[i]->Initialize(this, point_cloud_))
       return false;
   }
 
-  // Decode any data needed by the attribute decoders.
-  for (int i = 0; i < num_attributes_decoders; ++i) {
+  // Decode any data needed by the attribute decoders. When decoders are
+  // created again by ResumeDecoding(), the data of the kept decoders is
+  // skipped.
+  if (first_dec_id > 0)
+    SeekBuffer(attributes_decoder_checkpoints_[first_dec_id].data_offset);
+  for (int i = first_dec_id; i < num_attributes_decoders; ++i) {
+    attributes_decoder_checkpoints_[i].data_offset = GetBufferOffset();
+    attributes_decoder_checkpoints_[i].first_att_id =
+        point_cloud_->num_attributes();
     if (!attributes_decoders_[i]->DecodeAttributesDecoderData(buffer_))
       return false;
   }
 
   // Create map between attribute and decoder ids.
-  for (int i = 0; i < num_attributes_decoders; ++i) {
+  for (int i = first_dec_id; i < num_attributes_decoders; ++i) {
     const int32_t num_attributes = attributes_decoders_[i]->GetNumAttributes();
     for (int j = 0; j < num_attributes; ++j) {
       int att_id = attributes_decoders_[i]->GetAttributeId(j);
@@ -130,27 +235,121 @@ bool PointCloudDecoder::DecodePointAttributes() {
       attribute_to_decoder_map_[att_id] = i;
     }
   }
+  are_attributes_decoders_created_ = true;
+  return true;
+}
 
-  // Decode the actual attributes using the created attribute decoders.
-  if (!DecodeAllAttributes())
-    return false;
+void PointCloudDecoder::DeleteAttributesFrom(int32_t first_att_id) {
+  // PointCloud::DeleteAttribute() removes the metadata with the unique id of
+  // the deleted attribute, so the attributes get an id without metadata first.
+  uint32_t unused_unique_id = 0;
+  if (point_cloud_->GetMetadata() != nullptr) {
+    for (const auto &att_metadata :
+         point_cloud_->GetMetadata()->attribute_metadatas()) {
+      unused_unique_id =
+          std::max(unused_unique_id, att_metadata->att_unique_id() + 1);
+    }
+  }
+  while (point_cloud_->num_attributes() > first_att_id) {
+    const int32_t att_id = point_cloud_->num_attributes() - 1;
+    point_cloud_->attribute(att_id)->set_unique_id(unused_unique_id);
+    point_cloud_->DeleteAttribute(att_id);
+  }
+}
 
-  if (!OnAttributesDecoded())
+bool PointCloudDecoder::DecodeAllAttributes() {
+  const int32_t num_attributes_decoders =
+      static_cast<int32_t>(attributes_decoders_.size());
+  for (int i = num_read_attributes_decoders_; i < num_attributes_decoders;
+       ++i) {
+    attributes_decoder_checkpoints_[i].values_offset = GetBufferOffset();
+    attributes_decoder_checkpoints_[i].num_deferred_tasks =
+        deferred_attribute_tasks_.size();
+    if (!attributes_decoders_[i]->DecodeAttributes(buffer_))
+      return false;
+    ++num_read_attributes_decoders_;
+    // Attributes with deferred tasks are not final until all tasks are run.
+    if (!IsParallelAttributeDecodingEnabled())
+      num_decoded_attributes_decoders_ = num_read_attributes_decoders_;
+  }
+  if (!RunDeferredAttributeTasks())
     return false;
+  num_decoded_attributes_decoders_ = attributes_decoders_.size();
   return true;
 }
 
-bool PointCloudDecoder::DecodeAllAttributes() {
-  for (auto &att_dec : attributes_decoders_) {
-    if (!att_dec->DecodeAttributes(buffer_))
+void PointCloudDecoder::AddDeferredAttributeTask(
+    int32_t att_id, const std::vector<int32_t> &parent_att_ids,
+    std::function<bool()> task) {
+  DeferredAttributeTask deferred_task;
+  deferred_task.att_id = att_id;
+  deferred_task.parent_att_ids = parent_att_ids;
+  deferred_task.task = std::move(task);
+  deferred_attribute_tasks_.push_back(std::move(deferred_task));
+}
+
+bool PointCloudDecoder::RunDeferredAttributeTasks() {
+  const int num_tasks = static_cast<int>(deferred_attribute_tasks_.size());
+  if (num_tasks == 0)
+    return true;
+  // Attributes that have a deferred task that is not finished yet.
+  std::vector<bool> is_att_pending(point_cloud_->num_attributes(), false);
+  for (const DeferredAttributeTask &task : deferred_attribute_tasks_) {
+    if (task.att_id < 0 || task.att_id >= point_cloud_->num_attributes())
       return false;
+    is_att_pending[task.att_id] = true;
+  }
+  std::vector<bool> is_task_finished(num_tasks, false);
+  std::vector<uint8_t> task_results(num_tasks, 0);
+  ThreadPool thread_pool(std::min(num_decoding_threads_, num_tasks));
+  int num_finished_tasks = 0;
+  // Execute the tasks in waves. Each wave contains all remaining tasks whose
+  // parent attributes are already finished. Since each task modifies only its
+  // own attribute, the decoded data does not depend on the execution order.
+  std::vector<int> wave;
+  while (num_finished_tasks < num_tasks) {
+    wave.clear();
+    for (int i = 0; i < num_tasks; ++i) {
+      if (is_task_finished[i])
+        continue;
+      bool parents_finished = true;
+      for (const int32_t parent_att_id :
+           deferred_attribute_tasks_[i].parent_att_ids) {
+        if (parent_att_id >= 0 &&
+            parent_att_id < static_cast<int32_t>(is_att_pending.size()) &&
+            is_att_pending[parent_att_id] &&
+            parent_att_id != deferred_attribute_tasks_[i].att_id) {
+          parents_finished = false;
+          break;
+        }
+      }
+      if (parents_finished)
+        wave.push_back(i);
+    }
+    if (wave.empty())
+      return false;  // Cyclic dependency between attributes.
+    for (const int task_id : wave) {
+      thread_pool.Schedule([this, &task_results, task_id]() {
+        task_results[task_id] = deferred_attribute_tasks_[task_id].task();
+      });
+    }
+    thread_pool.Wait();
+    for (const int task_id : wave) {
+      if (!task_results[task_id])
+        return false;
+      is_task_finished[task_id] = true;
+      is_att_pending[deferred_attribute_tasks_[task_id].att_id] = false;
+      ++num_finished_tasks;
+    }
   }
+  deferred_attribute_tasks_.clear();
   return true;
 }
 
 const PointAttribute *PointCloudDecoder::GetPortableAttribute(
     int32_t parent_att_id) {
-  if (parent_att_id < 0 || parent_att_id >= point_cloud_->num_attributes())
+  if (parent_att_id < 0 ||
+      parent_att_id >= static_cast<int32_t>(attribute_to_decoder_map_.size()))
     return nullptr;
   const int32_t parent_att_decoder_id =
       attribute_to_decoder_map_[parent_att_id];
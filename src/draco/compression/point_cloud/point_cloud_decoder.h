@@ -15,9 +15,13 @@
 #ifndef DRACO_COMPRESSION_POINT_CLOUD_POINT_CLOUD_DECODER_H_
 #define DRACO_COMPRESSION_POINT_CLOUD_POINT_CLOUD_DECODER_H_
 
+#include <algorithm>
+#include <functional>
+
 #include "draco/compression/attributes/attributes_decoder_interface.h"
 #include "draco/compression/config/compression_shared.h"
 #include "draco/compression/config/decoder_options.h"
+#include "draco/core/coding_stats.h"
 #include "draco/core/status.h"
 #include "draco/point_cloud/point_cloud.h"
 
@@ -40,6 +44,15 @@ class PointCloudDecoder {
   Status Decode(const DecoderOptions &options, DecoderBuffer *in_buffer,
                 PointCloud *out_point_cloud);
 
+  // Continues a Decode() call that failed after the geometry data was decoded,
+  // for example because the input data was incomplete. |in_buffer| must start
+  // with the same encoded data as the buffer of the failed call, but it may
+  // contain more of it. The decoded geometry data and all attribute decoders
+  // that read their data completely are kept, and decoding continues from the
+  // first unfinished attribute decoder. The options and the output point cloud
+  // of the failed call are reused. Can be called repeatedly.
+  Status ResumeDecoding(DecoderBuffer *in_buffer);
+
   bool SetAttributesDecoder(
       int att_decoder_id, std::unique_ptr<AttributesDecoderInterface> decoder) {
     if (att_decoder_id < 0)
@@ -62,6 +75,18 @@ class PointCloudDecoder {
     return DRACO_BITSTREAM_VERSION(version_major_, version_minor_);
   }
 
+  // Returns true when the geometry data (such as the mesh connectivity) was
+  // successfully decoded. The value remains valid after Decode() failed, which
+  // allows callers to use a partially decoded geometry.
+  bool is_geometry_data_decoded() const { return geometry_data_decoded_; }
+
+  // Returns the number of leading attribute decoders whose attributes are
+  // fully decoded in their final form. Like is_geometry_data_decoded(), the
+  // value remains valid after Decode() failed.
+  int32_t num_decoded_attributes_decoders() const {
+    return num_decoded_attributes_decoders_;
+  }
+
   const AttributesDecoderInterface *attributes_decoder(int dec_id) {
     return attributes_decoders_[dec_id].get();
   }
@@ -77,6 +102,39 @@ class PointCloudDecoder {
   DecoderBuffer *buffer() { return buffer_; }
   const DecoderOptions *options() const { return options_; }
 
+  // Sets the object that collects statistics of the decoding stages. Can be
+  // nullptr when no statistics should be collected.
+  void set_stats(CodingStats *stats) { stats_ = stats; }
+  CodingStats *stats() const { return stats_; }
+
+  // Returns true when attribute decoders should postpone all work that does
+  // not read the input buffer (such as reverting of predictions and attribute
+  // transforms) using AddDeferredAttributeTask(). The deferred tasks are then
+  // executed in parallel once all attribute data is read. Enabled by setting
+  // the global decoder option "num_decoding_threads" to a value larger than 1.
+  bool IsParallelAttributeDecodingEnabled() const {
+    return num_decoding_threads_ > 1;
+  }
+
+  // Adds a task that finishes decoding of attribute |att_id|. The task is not
+  // started before the tasks of all |parent_att_ids| are finished. It must
+  // return false on error.
+  void AddDeferredAttributeTask(int32_t att_id,
+                                const std::vector<int32_t> &parent_att_ids,
+                                std::function<bool()> task);
+
+  // Returns the peak number of bytes held by temporary data structures of the
+  // decoder (such as the corner tables of meshes) during the last Decode()
+  // call. Memory of the decoded geometry and of the arena of the input buffer
+  // is not included.
+  size_t peak_memory_usage() const { return peak_memory_usage_; }
+
+  // Used by the decoder subsystems to report that they currently hold
+  // |num_bytes| of temporary data.
+  void UpdatePeakMemoryUsage(size_t num_bytes) {
+    peak_memory_usage_ = std::max(peak_memory_usage_, num_bytes);
+  }
+
  protected:
   // Can be implemented by derived classes to perform any custom initialization
   // of the decoder. Called in the Decode() method.
@@ -93,6 +151,46 @@ class PointCloudDecoder {
   Status DecodeMetadata();
 
  private:
+  struct DeferredAttributeTask {
+    int32_t att_id;
+    std::vector<int32_t> parent_att_ids;
+    std::function<bool()> task;
+  };
+
+  // State of the decoding before an attribute decoder is created and before
+  // it starts decoding its data and its values. Used by ResumeDecoding() to
+  // continue with an attribute decoder that did not finish.
+  struct AttributesDecoderCheckpoint {
+    int64_t creation_offset;
+    int64_t data_offset;
+    int64_t values_offset;
+    int32_t first_att_id;
+    size_t num_deferred_tasks;
+  };
+
+  // Creates attribute decoders |first_dec_id| and higher and decodes their
+  // data that precedes the attribute values.
+  bool CreateAttributesDecoders(int32_t first_dec_id);
+
+  // Returns the current position in |buffer_| relative to the start of the
+  // encoded data. Unlike DecoderBuffer::decoded_size(), the offset is not
+  // affected when a decoder initializes the buffer with its remaining data.
+  int64_t GetBufferOffset() const {
+    return buffer_->data_head() - buffer_start_;
+  }
+  void SeekBuffer(int64_t offset) {
+    buffer_->Advance(offset - GetBufferOffset());
+  }
+
+  // Deletes attributes |first_att_id| and higher from the point cloud. Unlike
+  // PointCloud::DeleteAttribute(), metadata of the attributes is kept, because
+  // the attributes are going to be decoded again.
+  void DeleteAttributesFrom(int32_t first_att_id);
+
+  // Executes all tasks added with AddDeferredAttributeTask(). Independent
+  // tasks are executed in parallel.
+  bool RunDeferredAttributeTasks();
+
   // Point cloud that is being filled in by the decoder.
   PointCloud *point_cloud_;
 
@@ -103,12 +201,32 @@ class PointCloudDecoder {
 
   // Input buffer holding the encoded data.
   DecoderBuffer *buffer_;
+  // Start of the encoded data in |buffer_|.
+  const char *buffer_start_;
 
   // Bit-stream version of the encoder that encoded the input data.
   uint8_t version_major_;
   uint8_t version_minor_;
 
   const DecoderOptions *options_;
+  CodingStats *stats_;
+
+  int num_decoding_threads_;
+  std::vector<DeferredAttributeTask> deferred_attribute_tasks_;
+
+  bool geometry_data_decoded_;
+  int32_t num_decoded_attributes_decoders_;
+
+  // Offset of the attribute data in the input buffer and the number of point
+  // cloud attributes created together with the geometry data.
+  int64_t attributes_offset_;
+  int32_t num_geometry_attributes_;
+  // Set when all attribute decoders are created and their data is decoded.
+  bool are_attributes_decoders_created_;
+  // Number of leading attribute decoders that read all their values.
+  int32_t num_read_attributes_decoders_;
+  std::vector<AttributesDecoderCheckpoint> attributes_decoder_checkpoints_;
+  size_t peak_memory_usage_;
 };
 
 }  // namespace draco
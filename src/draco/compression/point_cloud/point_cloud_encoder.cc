@@ -14,12 +14,15 @@
 //
 #include "draco/compression/point_cloud/point_cloud_encoder.h"
 
+#include <algorithm>
+
+#include "draco/core/thread_pool.h"
 #include "draco/metadata/metadata_encoder.h"
 
 namespace draco {
 
 PointCloudEncoder::PointCloudEncoder()
-    : point_cloud_(nullptr), buffer_(nullptr) {}
+    : point_cloud_(nullptr), buffer_(nullptr), stats_(nullptr) {}
 
 void PointCloudEncoder::SetPointCloud(const PointCloud &pc) {
   point_cloud_ = &pc;
@@ -37,7 +40,10 @@ Status PointCloudEncoder::Encode(const EncoderOptions &options,
 
   if (!point_cloud_)
     return Status(Status::ERROR, "Invalid input geometry.");
-  DRACO_RETURN_IF_ERROR(EncodeHeader())
+  {
+    CodingStatsScope scope(stats_, "header", -1, buffer_);
+    DRACO_RETURN_IF_ERROR(EncodeHeader())
+  }
   DRACO_RETURN_IF_ERROR(EncodeMetadata())
   if (!InitializeEncoder())
     return Status(Status::ERROR, "Failed to initialize encoder.");
@@ -78,6 +84,7 @@ Status PointCloudEncoder::EncodeMetadata() {
   if (!point_cloud_->GetMetadata()) {
     return OkStatus();
   }
+  CodingStatsScope scope(stats_, "metadata", -1, buffer_);
   MetadataEncoder metadata_encoder;
   if (!metadata_encoder.EncodeGeometryMetadata(buffer_,
                                                point_cloud_->GetMetadata())) {
@@ -140,6 +147,9 @@ bool PointCloudEncoder::GenerateAttributesEncoders() {
 }
 
 bool PointCloudEncoder::EncodeAllAttributes() {
+  const int num_threads = options_->GetGlobalInt("num_encoding_threads", 1);
+  if (num_threads > 1 && attributes_encoders_.size() > 1)
+    return EncodeAllAttributesInParallel(num_threads);
   for (int att_encoder_id : attributes_encoder_ids_order_) {
     if (!attributes_encoders_[att_encoder_id]->EncodeAttributes(buffer_))
       return false;
@@ -147,6 +157,70 @@ bool PointCloudEncoder::EncodeAllAttributes() {
   return true;
 }
 
+bool PointCloudEncoder::EncodeAllAttributesInParallel(int num_threads) {
+  const int num_encoders = static_cast<int>(attributes_encoders_.size());
+  // Assign every attribute encoder to a wave. Encoders in the same wave do not
+  // depend on each other and they can be processed concurrently. Because
+  // |attributes_encoder_ids_order_| is already sorted by the dependencies, all
+  // parent encoders are assigned before their children.
+  std::vector<int> encoder_wave(num_encoders, 0);
+  int num_waves = 0;
+  for (int att_encoder_id : attributes_encoder_ids_order_) {
+    const AttributesEncoder *const att_enc =
+        attributes_encoders_[att_encoder_id].get();
+    int wave = 0;
+    for (int i = 0; i < att_enc->num_attributes(); ++i) {
+      const int32_t att_id = att_enc->GetAttributeId(i);
+      for (int p = 0; p < att_enc->NumParentAttributes(att_id); ++p) {
+        const int32_t parent_att_id = att_enc->GetParentAttributeId(att_id, p);
+        if (parent_att_id < 0 ||
+            parent_att_id >= point_cloud_->num_attributes())
+          return false;
+        const int32_t parent_encoder_id =
+            attribute_to_encoder_map_[parent_att_id];
+        if (parent_encoder_id == att_encoder_id)
+          continue;
+        wave = std::max(wave, encoder_wave[parent_encoder_id] + 1);
+      }
+    }
+    encoder_wave[att_encoder_id] = wave;
+    num_waves = std::max(num_waves, wave + 1);
+  }
+
+  // Each encoder writes its data into a separate buffer. The buffers are
+  // concatenated in the encoding order at the end so the output is identical
+  // to the output of the serial encoder.
+  std::vector<EncoderBuffer> encoder_buffers(num_encoders);
+  std::vector<uint8_t> encoder_results(num_encoders, 0);
+  ThreadPool thread_pool(std::min(num_threads, num_encoders));
+  for (int wave = 0; wave < num_waves; ++wave) {
+    for (int att_encoder_id : attributes_encoder_ids_order_) {
+      if (encoder_wave[att_encoder_id] != wave)
+        continue;
+      thread_pool.Schedule(
+          [this, &encoder_buffers, &encoder_results, att_encoder_id]() {
+            encoder_results[att_encoder_id] =
+                attributes_encoders_[att_encoder_id]->EncodeAttributes(
+                    &encoder_buffers[att_encoder_id]);
+          });
+    }
+    // Children of this wave may use the portable attributes of their parents
+    // so we need to wait until all encoders of the wave are finished.
+    thread_pool.Wait();
+    for (int att_encoder_id = 0; att_encoder_id < num_encoders;
+         ++att_encoder_id) {
+      if (encoder_wave[att_encoder_id] == wave &&
+          !encoder_results[att_encoder_id])
+        return false;
+    }
+  }
+  for (int att_encoder_id : attributes_encoder_ids_order_) {
+    const EncoderBuffer &encoder_buffer = encoder_buffers[att_encoder_id];
+    buffer_->Encode(encoder_buffer.data(), encoder_buffer.size());
+  }
+  return true;
+}
+
 bool PointCloudEncoder::MarkParentAttribute(int32_t parent_att_id) {
   if (parent_att_id < 0 || parent_att_id >= point_cloud_->num_attributes())
     return false;
@@ -18,6 +18,7 @@
 #include "draco/compression/attributes/attributes_encoder.h"
 #include "draco/compression/config/compression_shared.h"
 #include "draco/compression/config/encoder_options.h"
+#include "draco/core/coding_stats.h"
 #include "draco/core/encoder_buffer.h"
 #include "draco/core/status.h"
 #include "draco/point_cloud/point_cloud.h"
@@ -69,6 +70,11 @@ class PointCloudEncoder {
   const EncoderOptions *options() const { return options_; }
   const PointCloud *point_cloud() const { return point_cloud_; }
 
+  // Sets the object that collects statistics of the encoding stages. Can be
+  // nullptr when no statistics should be collected.
+  void set_stats(CodingStats *stats) { stats_ = stats; }
+  CodingStats *stats() const { return stats_; }
+
  protected:
   // Can be implemented by derived classes to perform any custom initialization
   // of the encoder. Called in the Encode() method.
@@ -106,9 +112,15 @@ class PointCloudEncoder {
   }
 
   // Encodes all the attribute data using the created attribute encoders.
+  // Independent attribute encoders are processed concurrently when the global
+  // encoder option "num_encoding_threads" is set to a value larger than 1.
   virtual bool EncodeAllAttributes();
 
  private:
+  // Encodes all the attribute data using up to |num_threads| threads. The
+  // encoded data is identical to the data produced by the serial encoder.
+  bool EncodeAllAttributesInParallel(int num_threads);
+
   // Encodes Draco header that is the same for all encoders.
   Status EncodeHeader();
 
@@ -135,6 +147,7 @@ class PointCloudEncoder {
   EncoderBuffer *buffer_;
 
   const EncoderOptions *options_;
+  CodingStats *stats_;
 };
 
 }  // namespace draco
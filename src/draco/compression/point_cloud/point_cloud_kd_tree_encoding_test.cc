@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 //
+#include "draco/compression/point_cloud/algorithms/dynamic_integer_points_kd_tree_decoder.h"
+#include "draco/compression/point_cloud/algorithms/dynamic_integer_points_kd_tree_encoder.h"
 #include "draco/compression/point_cloud/point_cloud_kd_tree_decoder.h"
 #include "draco/compression/point_cloud/point_cloud_kd_tree_encoder.h"
 #include "draco/core/draco_test_base.h"
@@ -51,30 +53,104 @@ class PointCloudKdTreeEncodingTest : public ::testing::Test {
     }
   }
 
-  void TestKdTreeEncoding(const PointCloud &pc) {
-    EncoderBuffer buffer;
+  void EncodePointCloud(const PointCloud &pc, bool level_order,
+                        EncoderBuffer *out_buffer, int subtree_points = 0,
+                        int num_threads = 1) {
     PointCloudKdTreeEncoder encoder;
     EncoderOptions options = EncoderOptions::CreateDefaultOptions();
     options.SetGlobalInt("quantization_bits", 12);
+    options.SetGlobalBool("kd_tree_level_order", level_order);
+    options.SetGlobalInt("kd_tree_subtree_points", subtree_points);
+    options.SetGlobalInt("num_encoding_threads", num_threads);
     encoder.SetPointCloud(pc);
-    ASSERT_TRUE(encoder.Encode(options, &buffer).ok());
+    ASSERT_TRUE(encoder.Encode(options, out_buffer).ok());
+  }
 
+  std::unique_ptr<PointCloud> DecodePointCloud(
+      const EncoderBuffer &buffer, const DecoderOptions &dec_options) {
     DecoderBuffer dec_buffer;
     dec_buffer.Init(buffer.data(), buffer.size());
     PointCloudKdTreeDecoder decoder;
-
     std::unique_ptr<PointCloud> out_pc(new PointCloud());
+    if (!decoder.Decode(dec_options, &dec_buffer, out_pc.get()).ok())
+      return nullptr;
+    return out_pc;
+  }
+
+  void TestKdTreeEncoding(const PointCloud &pc, bool level_order = false) {
+    EncoderBuffer buffer;
+    EncodePointCloud(pc, level_order, &buffer);
     DecoderOptions dec_options;
-    ASSERT_TRUE(decoder.Decode(dec_options, &dec_buffer, out_pc.get()).ok());
+    std::unique_ptr<PointCloud> out_pc = DecodePointCloud(buffer, dec_options);
+    ASSERT_NE(out_pc, nullptr);
 
     ComparePointClouds(pc, *out_pc.get());
   }
 
-  void TestFloatEncoding(const std::string &file_name) {
+  void TestFloatEncoding(const std::string &file_name,
+                         bool level_order = false) {
     std::unique_ptr<PointCloud> pc = ReadPointCloudFromTestFile(file_name);
     ASSERT_NE(pc, nullptr);
 
-    TestKdTreeEncoding(*pc.get());
+    TestKdTreeEncoding(*pc.get(), level_order);
+  }
+
+  std::unique_ptr<PointCloud> CreateIntPointCloud(int num_points) const {
+    PointCloudBuilder builder;
+    builder.Start(num_points);
+    const int att_id =
+        builder.AddAttribute(GeometryAttribute::POSITION, 3, DT_UINT32);
+    for (PointIndex i(0); i < num_points; ++i) {
+      // Generate some pseudo-random points.
+      const uint32_t pos[3] = {8 * ((i.value() * 7) % 127),
+                               13 * ((i.value() * 3) % 321),
+                               29 * ((i.value() * 19) % 450)};
+      builder.SetAttributeValueForPoint(att_id, i, pos);
+    }
+    return builder.Finalize(false);
+  }
+
+  // Returns the sorted positions of all points of |pc| that lie inside of the
+  // box [box_min, box_max].
+  std::vector<std::array<float, 3>> GetPointsInBox(const PointCloud &pc,
+                                                   const float *box_min,
+                                                   const float *box_max) const {
+    std::vector<std::array<float, 3>> points;
+    for (PointIndex i(0); i < pc.num_points(); ++i) {
+      std::array<float, 3> pos;
+      pc.attribute(0)->ConvertValue(pc.attribute(0)->mapped_index(i),
+                                    pos.data());
+      bool inside = true;
+      for (int c = 0; c < 3; ++c) {
+        inside &= pos[c] >= box_min[c] && pos[c] <= box_max[c];
+      }
+      if (inside)
+        points.push_back(pos);
+    }
+    std::sort(points.begin(), points.end());
+    return points;
+  }
+
+  // Checks that all points of |pc| lie within the bounding box of |in_pc|.
+  void CheckPointsInBoundingBox(const PointCloud &in_pc,
+                                const PointCloud &pc) const {
+    uint32_t min_values[3], max_values[3];
+    for (PointIndex i(0); i < in_pc.num_points(); ++i) {
+      uint32_t pos[3];
+      in_pc.attribute(0)->GetMappedValue(i, pos);
+      for (int c = 0; c < 3; ++c) {
+        min_values[c] = i == 0 ? pos[c] : std::min(min_values[c], pos[c]);
+        max_values[c] = i == 0 ? pos[c] : std::max(max_values[c], pos[c]);
+      }
+    }
+    for (PointIndex i(0); i < pc.num_points(); ++i) {
+      uint32_t pos[3];
+      pc.attribute(0)->GetMappedValue(i, pos);
+      for (int c = 0; c < 3; ++c) {
+        ASSERT_GE(pos[c], min_values[c]);
+        ASSERT_LE(pos[c], max_values[c]);
+      }
+    }
   }
 };
 
@@ -83,29 +159,286 @@ TEST_F(PointCloudKdTreeEncodingTest, TestFloatKdTreeEncoding) {
 }
 
 TEST_F(PointCloudKdTreeEncodingTest, TestIntKdTreeEncoding) {
-  constexpr int num_points = 120;
-  std::vector<std::array<uint32_t, 3>> points(num_points);
-  for (int i = 0; i < num_points; ++i) {
-    std::array<uint32_t, 3> pos;
-    // Generate some pseudo-random points.
-    pos[0] = 8 * ((i * 7) % 127);
-    pos[1] = 13 * ((i * 3) % 321);
-    pos[2] = 29 * ((i * 19) % 450);
-    points[i] = pos;
+  std::unique_ptr<PointCloud> pc = CreateIntPointCloud(120);
+  ASSERT_NE(pc, nullptr);
+
+  TestKdTreeEncoding(*pc.get());
+}
+
+TEST_F(PointCloudKdTreeEncodingTest, TestFloatKdTreeLevelOrderEncoding) {
+  TestFloatEncoding("cube_subd.obj", true);
+}
+
+TEST_F(PointCloudKdTreeEncodingTest, TestIntKdTreeLevelOrderEncoding) {
+  std::unique_ptr<PointCloud> pc = CreateIntPointCloud(5000);
+  ASSERT_NE(pc, nullptr);
+
+  TestKdTreeEncoding(*pc.get(), true);
+}
+
+TEST_F(PointCloudKdTreeEncodingTest, TestKdTreeMaxPoints) {
+  // Tests that the level order encoded point cloud can be decoded with a
+  // limited number of points.
+  std::unique_ptr<PointCloud> pc = CreateIntPointCloud(5000);
+  ASSERT_NE(pc, nullptr);
+  EncoderBuffer buffer;
+  EncodePointCloud(*pc, true, &buffer);
+
+  uint32_t last_num_points = 0;
+  for (int max_points : {0, 1, 10, 100, 1000, 4999}) {
+    DecoderOptions dec_options;
+    dec_options.SetGlobalInt("kd_tree_max_points", max_points);
+    std::unique_ptr<PointCloud> out_pc = DecodePointCloud(buffer, dec_options);
+    ASSERT_NE(out_pc, nullptr);
+    ASSERT_GT(out_pc->num_points(), 0);
+    ASSERT_LE(out_pc->num_points(), std::max(max_points, 1));
+    ASSERT_GE(out_pc->num_points(), last_num_points);
+    ASSERT_EQ(out_pc->attribute(0)->size(), out_pc->num_points());
+    CheckPointsInBoundingBox(*pc, *out_pc);
+    last_num_points = out_pc->num_points();
+  }
+  ASSERT_GT(last_num_points, 1000);
+
+  // The whole point cloud is decoded when the limit is large enough.
+  DecoderOptions dec_options;
+  dec_options.SetGlobalInt("kd_tree_max_points", 5000);
+  std::unique_ptr<PointCloud> out_pc = DecodePointCloud(buffer, dec_options);
+  ASSERT_NE(out_pc, nullptr);
+  ComparePointClouds(*pc, *out_pc);
+}
+
+TEST_F(PointCloudKdTreeEncodingTest, TestKdTreeMaxDepth) {
+  // Tests decoding of a limited number of levels of the level order encoded
+  // tree.
+  std::unique_ptr<PointCloud> pc = CreateIntPointCloud(5000);
+  ASSERT_NE(pc, nullptr);
+  EncoderBuffer buffer;
+  EncodePointCloud(*pc, true, &buffer);
+
+  uint32_t last_num_points = 0;
+  for (int max_depth = 0; max_depth < 12; ++max_depth) {
+    DecoderOptions dec_options;
+    dec_options.SetGlobalInt("kd_tree_max_depth", max_depth);
+    std::unique_ptr<PointCloud> out_pc = DecodePointCloud(buffer, dec_options);
+    ASSERT_NE(out_pc, nullptr);
+    // Each level can at most double the number of points.
+    ASSERT_LE(out_pc->num_points(), 1u << max_depth);
+    ASSERT_GE(out_pc->num_points(), last_num_points);
+    CheckPointsInBoundingBox(*pc, *out_pc);
+    last_num_points = out_pc->num_points();
+  }
+}
+
+TEST_F(PointCloudKdTreeEncodingTest, TestKdTreeLimitsIgnoredForDepthFirst) {
+  // The decoding limits apply only to the level order encoding.
+  std::unique_ptr<PointCloud> pc = CreateIntPointCloud(500);
+  ASSERT_NE(pc, nullptr);
+  EncoderBuffer buffer;
+  EncodePointCloud(*pc, false, &buffer);
+  DecoderOptions dec_options;
+  dec_options.SetGlobalInt("kd_tree_max_points", 10);
+  dec_options.SetGlobalInt("kd_tree_max_depth", 2);
+  std::unique_ptr<PointCloud> out_pc = DecodePointCloud(buffer, dec_options);
+  ASSERT_NE(out_pc, nullptr);
+  ComparePointClouds(*pc, *out_pc);
+}
+
+TEST_F(PointCloudKdTreeEncodingTest, TestCorruptedKdTreeData) {
+  // Tests that corrupted kd-tree data is either rejected or decoded into
+  // exactly the encoded number of points. E.g. an invalid split of a node must
+  // not produce more points than the node contains.
+  std::vector<Point3ui> points;
+  for (uint32_t i = 0; i < 300; ++i)
+    points.push_back(Point3ui(8 * ((i * 7) % 127), 13 * ((i * 3) % 321),
+                              29 * ((i * 19) % 450)));
+  EncoderBuffer buffer;
+  DynamicIntegerPointsKdTreeEncoder<6> encoder(3);
+  ASSERT_TRUE(encoder.EncodePoints(points.begin(), points.end(), 14, &buffer));
+  int num_failures = 0;
+  // Skip the bit length and the number of points.
+  for (size_t i = 2 * sizeof(uint32_t); i < buffer.size(); ++i) {
+    std::vector<char> corrupted_data(buffer.data(),
+                                     buffer.data() + buffer.size());
+    corrupted_data[i] ^= 0xff;
+    DecoderBuffer dec_buffer;
+    dec_buffer.Init(corrupted_data.data(), corrupted_data.size(),
+                    kDracoBitstreamVersion);
+    DynamicIntegerPointsKdTreeDecoder<6> decoder(3);
+    std::vector<uint32_t> decoded_values;
+    if (!decoder.DecodePoints(&dec_buffer,
+                              FlatPointsOutputIterator(&decoded_values))) {
+      ++num_failures;
+      continue;
+    }
+    ASSERT_EQ(decoded_values.size(), 3 * points.size());
   }
+  ASSERT_GT(num_failures, 0);
+}
 
-  PointCloudBuilder builder;
-  builder.Start(num_points);
-  const int att_id =
-      builder.AddAttribute(GeometryAttribute::POSITION, 3, DT_UINT32);
-  for (PointIndex i(0); i < num_points; ++i) {
-    builder.SetAttributeValueForPoint(att_id, PointIndex(i),
-                                      &(points[i.value()])[0]);
+TEST_F(PointCloudKdTreeEncodingTest, TestCorruptedKdTreeSubtreesData) {
+  // Same as above but for points decoded in a region from independently
+  // encoded subtrees, both serially and in parallel.
+  std::vector<Point3ui> points;
+  for (uint32_t i = 0; i < 300; ++i)
+    points.push_back(Point3ui(8 * ((i * 7) % 127), 13 * ((i * 3) % 321),
+                              29 * ((i * 19) % 450)));
+  EncoderBuffer buffer;
+  DynamicIntegerPointsKdTreeEncoder<6> encoder(3);
+  ASSERT_TRUE(encoder.EncodePointsInSubtrees(points.begin(), points.end(), 14,
+                                             20, &buffer));
+  const uint32_t region_min[3] = {0, 0, 0};
+  const uint32_t region_max[3] = {(1 << 14) - 1, (1 << 14) - 1,
+                                  (1 << 14) - 1};
+  for (int num_threads = 1; num_threads <= 2; ++num_threads) {
+    int num_failures = 0;
+    // Skip the bit length, the number of points and the subtree size limit.
+    for (size_t i = 3 * sizeof(uint32_t); i < buffer.size(); ++i) {
+      std::vector<char> corrupted_data(buffer.data(),
+                                       buffer.data() + buffer.size());
+      corrupted_data[i] ^= 0xff;
+      DecoderBuffer dec_buffer;
+      dec_buffer.Init(corrupted_data.data(), corrupted_data.size(),
+                      kDracoBitstreamVersion);
+      DynamicIntegerPointsKdTreeDecoder<6> decoder(3);
+      std::vector<uint32_t> decoded_values;
+      uint32_t num_decoded_points = 0;
+      if (!decoder.DecodePointsInRegion(
+              &dec_buffer, region_min, region_max,
+              FlatPointsOutputIterator(&decoded_values), &num_decoded_points,
+              num_threads)) {
+        ++num_failures;
+        continue;
+      }
+      ASSERT_EQ(decoded_values.size(), 3 * points.size());
+    }
+    ASSERT_GT(num_failures, 0);
   }
-  std::unique_ptr<PointCloud> pc = builder.Finalize(false);
+}
+
+TEST_F(PointCloudKdTreeEncodingTest, TestIntKdTreeSubtreesEncoding) {
+  std::unique_ptr<PointCloud> pc = CreateIntPointCloud(5000);
   ASSERT_NE(pc, nullptr);
+  for (int subtree_points : {1, 64, 10000}) {
+    EncoderBuffer buffer;
+    EncodePointCloud(*pc, false, &buffer, subtree_points);
+    std::unique_ptr<PointCloud> out_pc =
+        DecodePointCloud(buffer, DecoderOptions());
+    ASSERT_NE(out_pc, nullptr);
+    ComparePointClouds(*pc, *out_pc);
+  }
+}
 
-  TestKdTreeEncoding(*pc.get());
+TEST_F(PointCloudKdTreeEncodingTest, TestKdTreeSubtreesInParallel) {
+  // Tests that subtrees encoded and decoded by multiple threads give the same
+  // results as with a single thread.
+  std::unique_ptr<PointCloud> pc = CreateIntPointCloud(5000);
+  ASSERT_NE(pc, nullptr);
+  EncoderBuffer buffer;
+  EncodePointCloud(*pc, false, &buffer, 16);
+  EncoderBuffer parallel_buffer;
+  EncodePointCloud(*pc, false, &parallel_buffer, 16, 4);
+  ASSERT_EQ(std::vector<char>(buffer.data(), buffer.data() + buffer.size()),
+            std::vector<char>(parallel_buffer.data(),
+                              parallel_buffer.data() + parallel_buffer.size()));
+
+  const float box_min[3] = {300.f, 1000.f, 2000.f};
+  const float box_max[3] = {800.f, 4000.f, 13000.f};
+  for (bool use_box : {false, true}) {
+    DecoderOptions dec_options;
+    if (use_box) {
+      dec_options.SetGlobalVector("kd_tree_query_box_min", 3, box_min);
+      dec_options.SetGlobalVector("kd_tree_query_box_max", 3, box_max);
+    }
+    std::unique_ptr<PointCloud> out_pc = DecodePointCloud(buffer, dec_options);
+    ASSERT_NE(out_pc, nullptr);
+    dec_options.SetGlobalInt("num_decoding_threads", 4);
+    std::unique_ptr<PointCloud> parallel_pc =
+        DecodePointCloud(buffer, dec_options);
+    ASSERT_NE(parallel_pc, nullptr);
+    ASSERT_EQ(out_pc->num_points(), parallel_pc->num_points());
+    for (PointIndex i(0); i < out_pc->num_points(); ++i) {
+      uint32_t pos0[3], pos1[3];
+      out_pc->attribute(0)->GetMappedValue(i, pos0);
+      parallel_pc->attribute(0)->GetMappedValue(i, pos1);
+      for (int c = 0; c < 3; ++c) {
+        ASSERT_EQ(pos0[c], pos1[c]);
+      }
+    }
+  }
+}
+
+TEST_F(PointCloudKdTreeEncodingTest, TestIntKdTreeQueryBox) {
+  // Tests that only points inside of the query box are decoded.
+  std::unique_ptr<PointCloud> pc = CreateIntPointCloud(5000);
+  ASSERT_NE(pc, nullptr);
+  EncoderBuffer buffer;
+  EncodePointCloud(*pc, false, &buffer, 32);
+
+  const float boxes[][6] = {{0.f, 0.f, 0.f, 500.f, 2000.f, 6000.f},
+                            {300.f, 1000.f, 2000.f, 301.f, 4000.f, 13000.f},
+                            {-10.f, -10.f, -10.f, 1e10f, 1e10f, 1e10f},
+                            {2000.f, 0.f, 0.f, 3000.f, 100.f, 100.f}};
+  for (const float *box : boxes) {
+    DecoderOptions dec_options;
+    dec_options.SetGlobalVector("kd_tree_query_box_min", 3, box);
+    dec_options.SetGlobalVector("kd_tree_query_box_max", 3, box + 3);
+    std::unique_ptr<PointCloud> out_pc = DecodePointCloud(buffer, dec_options);
+    ASSERT_NE(out_pc, nullptr);
+    ASSERT_EQ(out_pc->attribute(0)->size(), out_pc->num_points());
+    ASSERT_EQ(GetPointsInBox(*out_pc, box, box + 3),
+              GetPointsInBox(*pc, box, box + 3));
+    ASSERT_EQ(out_pc->num_points(), GetPointsInBox(*pc, box, box + 3).size());
+  }
+}
+
+TEST_F(PointCloudKdTreeEncodingTest, TestFloatKdTreeQueryBox) {
+  std::unique_ptr<PointCloud> pc = ReadPointCloudFromTestFile("cube_subd.obj");
+  ASSERT_NE(pc, nullptr);
+  EncoderBuffer buffer;
+  EncodePointCloud(*pc, false, &buffer, 16);
+  std::unique_ptr<PointCloud> full_pc =
+      DecodePointCloud(buffer, DecoderOptions());
+  ASSERT_NE(full_pc, nullptr);
+  ComparePointClouds(*pc, *full_pc);
+
+  const float box_min[3] = {-0.3f, -10.f, 0.1f};
+  const float box_max[3] = {0.2f, 10.f, 10.f};
+  DecoderOptions dec_options;
+  dec_options.SetGlobalVector("kd_tree_query_box_min", 3, box_min);
+  dec_options.SetGlobalVector("kd_tree_query_box_max", 3, box_max);
+  std::unique_ptr<PointCloud> out_pc = DecodePointCloud(buffer, dec_options);
+  ASSERT_NE(out_pc, nullptr);
+  ASSERT_GT(out_pc->num_points(), 0);
+  ASSERT_LT(out_pc->num_points(), full_pc->num_points());
+  // Compare with the points of the fully decoded point cloud. The query box is
+  // converted to the quantized coordinates, so points very close to the
+  // boundary of the box may be classified differently.
+  const float eps = 1e-4f;
+  const float inner_min[3] = {box_min[0] + eps, box_min[1], box_min[2] + eps};
+  const float inner_max[3] = {box_max[0] - eps, box_max[1], box_max[2] - eps};
+  const float outer_min[3] = {box_min[0] - eps, box_min[1], box_min[2] - eps};
+  const float outer_max[3] = {box_max[0] + eps, box_max[1], box_max[2] + eps};
+  ASSERT_EQ(GetPointsInBox(*out_pc, outer_min, outer_max).size(),
+            out_pc->num_points());
+  ASSERT_GE(out_pc->num_points(),
+            GetPointsInBox(*full_pc, inner_min, inner_max).size());
+  ASSERT_LE(out_pc->num_points(),
+            GetPointsInBox(*full_pc, outer_min, outer_max).size());
+}
+
+TEST_F(PointCloudKdTreeEncodingTest, TestKdTreeEmptyQueryBox) {
+  std::unique_ptr<PointCloud> pc = CreateIntPointCloud(1000);
+  ASSERT_NE(pc, nullptr);
+  EncoderBuffer buffer;
+  EncodePointCloud(*pc, false, &buffer, 32);
+  const float box_min[3] = {-100.f, -100.f, -100.f};
+  const float box_max[3] = {-1.f, 100.f, 100.f};
+  DecoderOptions dec_options;
+  dec_options.SetGlobalVector("kd_tree_query_box_min", 3, box_min);
+  dec_options.SetGlobalVector("kd_tree_query_box_max", 3, box_max);
+  std::unique_ptr<PointCloud> out_pc = DecodePointCloud(buffer, dec_options);
+  ASSERT_NE(out_pc, nullptr);
+  ASSERT_EQ(out_pc->num_points(), 0);
 }
 
 }  // namespace draco
@@ -0,0 +1,379 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/compression/point_cloud/point_cloud_streaming_encoder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "draco/compression/point_cloud/point_cloud_kd_tree_encoder.h"
+#include "draco/core/quantization_utils.h"
+#include "draco/core/varint_encoding.h"
+#include "draco/point_cloud/point_cloud.h"
+
+namespace draco {
+
+namespace {
+
+// Number of points processed at once when a bucket is read or split.
+constexpr int kPointsPerBlock = 1 << 16;
+constexpr int kPointSize = 3 * sizeof(float);
+
+#ifdef _WIN32
+int SeekFile(FILE *file, uint64_t offset) {
+  return _fseeki64(file, offset, SEEK_SET);
+}
+#else
+int SeekFile(FILE *file, uint64_t offset) {
+  return fseeko(file, offset, SEEK_SET);
+}
+#endif
+
+}  // namespace
+
+TemporaryFileBucketStorage::~TemporaryFileBucketStorage() {
+  for (const auto &file : files_)
+    fclose(file.second);
+}
+
+bool TemporaryFileBucketStorage::Append(int bucket_id, const char *data,
+                                        size_t size) {
+  FILE *&file = files_[bucket_id];
+  if (file == nullptr) {
+    file = tmpfile();
+    if (file == nullptr) {
+      files_.erase(bucket_id);
+      return false;
+    }
+  }
+  return fwrite(data, 1, size, file) == size;
+}
+
+bool TemporaryFileBucketStorage::Read(int bucket_id, uint64_t offset,
+                                      size_t size, char *out_data) {
+  const auto it = files_.find(bucket_id);
+  if (it == files_.end())
+    return size == 0;
+  // Appends always move the file position to the end of the file, so it can
+  // be changed freely here.
+  if (SeekFile(it->second, offset) != 0)
+    return false;
+  const bool success = fread(out_data, 1, size, it->second) == size;
+  fseek(it->second, 0, SEEK_END);
+  return success;
+}
+
+void TemporaryFileBucketStorage::Release(int bucket_id) {
+  const auto it = files_.find(bucket_id);
+  if (it == files_.end())
+    return;
+  fclose(it->second);
+  files_.erase(it);
+}
+
+// Bucket of input points whose coordinates are stored in the bucket storage.
+struct PointCloudStreamingEncoder::Bucket {
+  Bucket() : id(-1), num_points(0) {
+    for (int i = 0; i < 3; ++i) {
+      bbox_min[i] = std::numeric_limits<float>::max();
+      bbox_max[i] = -std::numeric_limits<float>::max();
+    }
+  }
+  void AddPoint(const float *point) {
+    for (int i = 0; i < 3; ++i) {
+      bbox_min[i] = std::min(bbox_min[i], point[i]);
+      bbox_max[i] = std::max(bbox_max[i], point[i]);
+    }
+  }
+  int id;
+  uint64_t num_points;
+  float bbox_min[3];
+  float bbox_max[3];
+};
+
+struct PointCloudStreamingEncoder::EncodedTile {
+  uint32_t num_points;
+  float bbox_min[3];
+  float bbox_max[3];
+  // Size of the encoded data of the tile.
+  uint64_t size;
+};
+
+PointCloudStreamingEncoder::PointCloudStreamingEncoder()
+    : storage_(nullptr),
+      quantization_bits_(14),
+      max_tile_points_(kDefaultMaxTilePoints),
+      tile_options_(EncoderOptions::CreateDefaultOptions()),
+      next_bucket_id_(0),
+      tile_data_bucket_id_(-1),
+      quantization_range_(1.f) {
+  for (int i = 0; i < 3; ++i)
+    quantization_origin_[i] = 0.f;
+}
+
+Status PointCloudStreamingEncoder::Encode(const BatchReader &reader,
+                                          EncoderBuffer *out_buffer) {
+  return Encode(reader, [out_buffer](const char *data, size_t size) {
+    return out_buffer->Encode(data, size);
+  });
+}
+
+Status PointCloudStreamingEncoder::Encode(const BatchReader &reader,
+                                          const DataWriter &writer) {
+  if (quantization_bits_ < 1 || quantization_bits_ > 30)
+    return Status(Status::ERROR, "Invalid quantization bits.");
+  if (max_tile_points_ <= 0)
+    return Status(Status::ERROR, "Invalid maximum number of tile points.");
+  if (storage_ == nullptr) {
+    default_storage_.reset(new TemporaryFileBucketStorage());
+    storage_ = default_storage_.get();
+  }
+  next_bucket_id_ = 0;
+  tile_data_bucket_id_ = next_bucket_id_++;
+
+  Bucket root;
+  Status status = ReadInput(reader, &root);
+  // Buckets that still need to be processed. Sub-buckets are pushed in the
+  // reverse order so the tiles are ordered by the splits.
+  std::vector<Bucket> buckets;
+  if (status.ok())
+    buckets.push_back(root);
+  std::vector<EncodedTile> tiles;
+  std::vector<Bucket> sub_buckets;
+  while (status.ok() && !buckets.empty()) {
+    const Bucket bucket = buckets.back();
+    buckets.pop_back();
+    if (bucket.num_points > static_cast<uint64_t>(max_tile_points_)) {
+      status = SplitBucket(bucket, &sub_buckets);
+      if (!status.ok())
+        break;
+      // Buckets that can't be split any further are encoded as they are.
+      if (sub_buckets.size() > 1) {
+        storage_->Release(bucket.id);
+        buckets.insert(buckets.end(), sub_buckets.rbegin(),
+                       sub_buckets.rend());
+        continue;
+      }
+      storage_->Release(sub_buckets[0].id);
+    }
+    tiles.push_back(EncodedTile());
+    status = EncodeTile(bucket, &tiles.back());
+    storage_->Release(bucket.id);
+  }
+  if (status.ok())
+    status = WriteOutput(tiles, writer);
+
+  // Release all data that may be left after an error.
+  for (int id = 0; id < next_bucket_id_; ++id)
+    storage_->Release(id);
+  if (default_storage_ != nullptr) {
+    storage_ = nullptr;
+    default_storage_.reset();
+  }
+  return status;
+}
+
+Status PointCloudStreamingEncoder::ReadInput(const BatchReader &reader,
+                                             Bucket *out_bucket) {
+  out_bucket->id = next_bucket_id_++;
+  std::vector<float> positions;
+  while (true) {
+    positions.clear();
+    if (!reader(&positions))
+      return Status(Status::ERROR, "Failed to read input points.");
+    if (positions.empty())
+      break;
+    if (positions.size() % 3 != 0)
+      return Status(Status::ERROR, "Invalid number of point coordinates.");
+    for (size_t i = 0; i < positions.size(); i += 3) {
+      if (!std::isfinite(positions[i]) || !std::isfinite(positions[i + 1]) ||
+          !std::isfinite(positions[i + 2]))
+        return Status(Status::ERROR, "Invalid point coordinates.");
+      out_bucket->AddPoint(&positions[i]);
+    }
+    if (!storage_->Append(out_bucket->id,
+                          reinterpret_cast<const char *>(positions.data()),
+                          positions.size() * sizeof(float)))
+      return Status(Status::ERROR, "Failed to store input points.");
+    out_bucket->num_points += positions.size() / 3;
+  }
+  if (out_bucket->num_points == 0)
+    return Status(Status::ERROR, "No input points.");
+
+  // Compute the quantization grid the same way as the attribute quantization
+  // transform does.
+  quantization_range_ = 0.f;
+  for (int i = 0; i < 3; ++i) {
+    quantization_origin_[i] = out_bucket->bbox_min[i];
+    quantization_range_ = std::max(
+        quantization_range_, out_bucket->bbox_max[i] - out_bucket->bbox_min[i]);
+  }
+  if (quantization_range_ == 0.f)
+    quantization_range_ = 1.f;
+  return OkStatus();
+}
+
+Status PointCloudStreamingEncoder::SplitBucket(
+    const Bucket &bucket, std::vector<Bucket> *out_buckets) {
+  float split_values[3];
+  bool split_axes[3];
+  float max_size = 0.f;
+  for (int i = 0; i < 3; ++i)
+    max_size = std::max(max_size, bucket.bbox_max[i] - bucket.bbox_min[i]);
+  for (int i = 0; i < 3; ++i) {
+    const float size = bucket.bbox_max[i] - bucket.bbox_min[i];
+    split_axes[i] = size > 0.f && size >= 0.5f * max_size;
+    split_values[i] = bucket.bbox_min[i] + 0.5f * size;
+  }
+
+  // Sub-bucket of a point is given by the bits of the split axes.
+  Bucket sub_buckets[8];
+  std::vector<float> block(3 * kPointsPerBlock);
+  std::vector<float> sub_blocks[8];
+  const auto flush = [this, &sub_buckets, &sub_blocks](int i) {
+    if (sub_blocks[i].empty())
+      return true;
+    if (sub_buckets[i].id < 0)
+      sub_buckets[i].id = next_bucket_id_++;
+    const bool success = storage_->Append(
+        sub_buckets[i].id, reinterpret_cast<const char *>(sub_blocks[i].data()),
+        sub_blocks[i].size() * sizeof(float));
+    sub_blocks[i].clear();
+    return success;
+  };
+  for (uint64_t first_point = 0; first_point < bucket.num_points;
+       first_point += kPointsPerBlock) {
+    const int num_points = static_cast<int>(
+        std::min<uint64_t>(kPointsPerBlock, bucket.num_points - first_point));
+    if (!storage_->Read(bucket.id, first_point * kPointSize,
+                        num_points * kPointSize,
+                        reinterpret_cast<char *>(block.data())))
+      return Status(Status::ERROR, "Failed to read stored points.");
+    for (int p = 0; p < num_points; ++p) {
+      const float *const point = &block[3 * p];
+      int sub_bucket = 0;
+      for (int i = 0; i < 3; ++i) {
+        if (split_axes[i] && point[i] >= split_values[i])
+          sub_bucket |= 1 << i;
+      }
+      sub_buckets[sub_bucket].AddPoint(point);
+      sub_buckets[sub_bucket].num_points++;
+      sub_blocks[sub_bucket].insert(sub_blocks[sub_bucket].end(), point,
+                                    point + 3);
+      if (sub_blocks[sub_bucket].size() >= 3 * kPointsPerBlock &&
+          !flush(sub_bucket))
+        return Status(Status::ERROR, "Failed to store points.");
+    }
+  }
+  out_buckets->clear();
+  for (int i = 0; i < 8; ++i) {
+    if (!flush(i))
+      return Status(Status::ERROR, "Failed to store points.");
+    if (sub_buckets[i].num_points > 0)
+      out_buckets->push_back(sub_buckets[i]);
+  }
+  return OkStatus();
+}
+
+Status PointCloudStreamingEncoder::EncodeTile(const Bucket &bucket,
+                                              EncodedTile *out_tile) {
+  if (bucket.num_points > std::numeric_limits<int32_t>::max())
+    return Status(Status::ERROR, "Too many points in one tile.");
+  const int num_points = static_cast<int>(bucket.num_points);
+  out_tile->num_points = num_points;
+  for (int i = 0; i < 3; ++i) {
+    out_tile->bbox_min[i] = bucket.bbox_min[i];
+    out_tile->bbox_max[i] = bucket.bbox_max[i];
+  }
+
+  // Positions are encoded as integer points on the shared quantization grid.
+  PointCloud pc;
+  pc.set_num_points(num_points);
+  GeometryAttribute va;
+  va.Init(GeometryAttribute::POSITION, nullptr, 3, DT_UINT32, false,
+          3 * sizeof(uint32_t), 0);
+  const int att_id = pc.AddAttribute(va, true, num_points);
+  uint32_t *const quantized_points = reinterpret_cast<uint32_t *>(
+      pc.attribute(att_id)->GetAddress(AttributeValueIndex(0)));
+  Quantizer quantizer;
+  quantizer.Init(quantization_range_, (1 << quantization_bits_) - 1);
+  std::vector<float> block(3 * kPointsPerBlock);
+  for (int first_point = 0; first_point < num_points;
+       first_point += kPointsPerBlock) {
+    const int block_points =
+        std::min(kPointsPerBlock, num_points - first_point);
+    if (!storage_->Read(bucket.id,
+                        static_cast<uint64_t>(first_point) * kPointSize,
+                        block_points * kPointSize,
+                        reinterpret_cast<char *>(block.data())))
+      return Status(Status::ERROR, "Failed to read stored points.");
+    uint32_t *const dst = quantized_points + 3 * first_point;
+    for (int i = 0; i < 3 * block_points; ++i) {
+      dst[i] = quantizer.QuantizeFloat(block[i] - quantization_origin_[i % 3]);
+    }
+  }
+
+  PointCloudKdTreeEncoder encoder;
+  encoder.SetPointCloud(pc);
+  EncoderBuffer buffer;
+  DRACO_RETURN_IF_ERROR(encoder.Encode(tile_options_, &buffer))
+  if (!storage_->Append(tile_data_bucket_id_, buffer.data(), buffer.size()))
+    return Status(Status::ERROR, "Failed to store encoded tile.");
+  out_tile->size = buffer.size();
+  return OkStatus();
+}
+
+Status PointCloudStreamingEncoder::WriteOutput(
+    const std::vector<EncodedTile> &tiles, const DataWriter &writer) {
+  EncoderBuffer buffer;
+  // Draco header.
+  buffer.Encode("DRACO", 5);
+  buffer.Encode(kDracoBitstreamVersionMajor);
+  buffer.Encode(kDracoBitstreamVersionMinor);
+  buffer.Encode(static_cast<uint8_t>(POINT_CLOUD));
+  buffer.Encode(static_cast<uint8_t>(POINT_CLOUD_TILED_ENCODING));
+  buffer.Encode(static_cast<uint16_t>(0));
+
+  // Quantization grid followed by the tile directory.
+  buffer.Encode(static_cast<uint8_t>(quantization_bits_));
+  buffer.Encode(quantization_origin_, sizeof(quantization_origin_));
+  buffer.Encode(quantization_range_);
+  EncodeVarint(static_cast<uint32_t>(tiles.size()), &buffer);
+  uint64_t tile_offset = 0;
+  for (const EncodedTile &tile : tiles) {
+    EncodeVarint(tile.num_points, &buffer);
+    buffer.Encode(tile.bbox_min, sizeof(tile.bbox_min));
+    buffer.Encode(tile.bbox_max, sizeof(tile.bbox_max));
+    EncodeVarint(tile_offset, &buffer);
+    EncodeVarint(tile.size, &buffer);
+    tile_offset += tile.size;
+  }
+  if (!writer(buffer.data(), buffer.size()))
+    return Status(Status::ERROR, "Failed to write encoded data.");
+
+  // Copy the data of all tiles.
+  std::vector<char> block(kPointsPerBlock * kPointSize);
+  for (uint64_t offset = 0; offset < tile_offset; offset += block.size()) {
+    const size_t size = static_cast<size_t>(
+        std::min<uint64_t>(block.size(), tile_offset - offset));
+    if (!storage_->Read(tile_data_bucket_id_, offset, size, block.data()))
+      return Status(Status::ERROR, "Failed to read encoded tiles.");
+    if (!writer(block.data(), size))
+      return Status(Status::ERROR, "Failed to write encoded data.");
+  }
+  return OkStatus();
+}
+
+}  // namespace draco
@@ -0,0 +1,173 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// The streaming encoder compresses point clouds that don't fit into memory.
+// Input points are read in batches and stored into a PointBucketStorage (by
+// default temporary files). The points are then recursively split into
+// spatial buckets until each bucket contains at most "max tile points" points.
+// Each such bucket is loaded into memory and compressed as an independent
+// Draco point cloud using the kd-tree encoder.
+//
+// Positions of all tiles are quantized to a single grid that spans the whole
+// input. The encoded data starts with a tile directory storing the byte
+// offset, size and bounding box of every tile so that the decoder
+// (PointCloudTiledDecoder) can process the tiles independently.
+// Only the positions of the points are encoded.
+
+#ifndef DRACO_COMPRESSION_POINT_CLOUD_POINT_CLOUD_STREAMING_ENCODER_H_
+#define DRACO_COMPRESSION_POINT_CLOUD_POINT_CLOUD_STREAMING_ENCODER_H_
+
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "draco/compression/config/encoder_options.h"
+#include "draco/core/encoder_buffer.h"
+#include "draco/core/status.h"
+
+namespace draco {
+
+// Default maximum number of points in one tile.
+static constexpr int kDefaultMaxTilePoints = 1 << 20;
+
+// Interface for storing the data of spatial buckets while the input points are
+// being split into tiles. Each bucket is an append-only sequence of bytes that
+// is read back only after all data was appended to it.
+class PointBucketStorage {
+ public:
+  virtual ~PointBucketStorage() = default;
+
+  // Appends |size| bytes of |data| to bucket |bucket_id|. The bucket is
+  // created on the first append.
+  virtual bool Append(int bucket_id, const char *data, size_t size) = 0;
+
+  // Reads |size| bytes starting at |offset| of bucket |bucket_id| into
+  // |out_data|.
+  virtual bool Read(int bucket_id, uint64_t offset, size_t size,
+                    char *out_data) = 0;
+
+  // Deletes all data of bucket |bucket_id|. Does nothing when the bucket
+  // doesn't exist.
+  virtual void Release(int bucket_id) = 0;
+};
+
+// Storage that keeps every bucket in a separate temporary file. The files are
+// removed when the buckets are released or when the storage is destroyed.
+class TemporaryFileBucketStorage : public PointBucketStorage {
+ public:
+  TemporaryFileBucketStorage() {}
+  ~TemporaryFileBucketStorage() override;
+
+  bool Append(int bucket_id, const char *data, size_t size) override;
+  bool Read(int bucket_id, uint64_t offset, size_t size,
+            char *out_data) override;
+  void Release(int bucket_id) override;
+
+ private:
+  std::unordered_map<int, FILE *> files_;
+};
+
+// Class for encoding of point clouds that are read in batches of points.
+//
+// Usage:
+//   PointCloudStreamingEncoder encoder;
+//   encoder.SetQuantizationBits(16);
+//   const Status status = encoder.Encode(
+//       [&](std::vector<float> *positions) {
+//         return ReadNextPoints(&scanner, positions);
+//       },
+//       &out_buffer);
+class PointCloudStreamingEncoder {
+ public:
+  // Callback that fills |out_positions| with x, y, z coordinates of the next
+  // batch of input points. An empty batch marks the end of the input. Returns
+  // false on error.
+  typedef std::function<bool(std::vector<float> *out_positions)> BatchReader;
+
+  // Callback that receives |size| bytes of the encoded data. Returns false on
+  // error.
+  typedef std::function<bool(const char *data, size_t size)> DataWriter;
+
+  PointCloudStreamingEncoder();
+
+  // Sets the storage used for the buckets of points. The storage must outlive
+  // the encoding. When not set, the points are stored in temporary files.
+  void SetBucketStorage(PointBucketStorage *storage) { storage_ = storage; }
+
+  // Sets the number of bits used for quantization of the positions. The
+  // quantization grid spans the bounding box of all input points.
+  void SetQuantizationBits(int quantization_bits) {
+    quantization_bits_ = quantization_bits;
+  }
+
+  // Sets the maximum number of points stored in a single tile. Only one tile
+  // is held in memory at a time. Tiles may exceed the limit only when they
+  // contain many points at the same position.
+  void SetMaxTilePoints(int max_tile_points) {
+    max_tile_points_ = max_tile_points;
+  }
+
+  // Sets the speed options used for encoding of the tiles (see
+  // Encoder::SetSpeedOptions()).
+  void SetSpeedOptions(int encoding_speed, int decoding_speed) {
+    tile_options_.SetSpeed(encoding_speed, decoding_speed);
+  }
+
+  // Encodes all points provided by |reader| and passes the encoded data to
+  // |writer|.
+  Status Encode(const BatchReader &reader, const DataWriter &writer);
+
+  // Same as above but the encoded data is stored into |out_buffer|.
+  Status Encode(const BatchReader &reader, EncoderBuffer *out_buffer);
+
+ private:
+  struct Bucket;
+  struct EncodedTile;
+
+  // Stores all input points into a single bucket and computes their bounding
+  // box.
+  Status ReadInput(const BatchReader &reader, Bucket *out_bucket);
+
+  // Splits |bucket| into up to eight sub-buckets along the axes where the
+  // bucket is at least half as large as along its longest axis. Returns the
+  // non-empty sub-buckets.
+  Status SplitBucket(const Bucket &bucket, std::vector<Bucket> *out_buckets);
+
+  // Quantizes all points of |bucket|, encodes them as a point cloud and
+  // appends the encoded data to the tile data bucket.
+  Status EncodeTile(const Bucket &bucket, EncodedTile *out_tile);
+
+  // Writes the header, the tile directory and the data of all |tiles| to
+  // |writer|.
+  Status WriteOutput(const std::vector<EncodedTile> &tiles,
+                     const DataWriter &writer);
+
+  PointBucketStorage *storage_;
+  std::unique_ptr<PointBucketStorage> default_storage_;
+  int quantization_bits_;
+  int max_tile_points_;
+  EncoderOptions tile_options_;
+  int next_bucket_id_;
+  // Bucket holding the encoded data of all tiles.
+  int tile_data_bucket_id_;
+  // Quantization grid shared by all tiles.
+  float quantization_origin_[3];
+  float quantization_range_;
+};
+
+}  // namespace draco
+
+#endif  // DRACO_COMPRESSION_POINT_CLOUD_POINT_CLOUD_STREAMING_ENCODER_H_
@@ -0,0 +1,312 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <map>
+#include <random>
+
+#include "draco/compression/decode.h"
+#include "draco/compression/point_cloud/point_cloud_streaming_encoder.h"
+#include "draco/compression/point_cloud/point_cloud_tiled_decoder.h"
+#include "draco/core/draco_test_base.h"
+#include "draco/core/quantization_utils.h"
+
+namespace draco {
+
+namespace {
+
+// Storage that keeps all buckets in memory.
+class MemoryBucketStorage : public PointBucketStorage {
+ public:
+  bool Append(int bucket_id, const char *data, size_t size) override {
+    std::vector<char> &bucket = buckets_[bucket_id];
+    bucket.insert(bucket.end(), data, data + size);
+    return true;
+  }
+  bool Read(int bucket_id, uint64_t offset, size_t size,
+            char *out_data) override {
+    const std::vector<char> &bucket = buckets_[bucket_id];
+    if (offset + size > bucket.size())
+      return false;
+    memcpy(out_data, bucket.data() + offset, size);
+    return true;
+  }
+  void Release(int bucket_id) override { buckets_.erase(bucket_id); }
+
+  int num_buckets() const { return static_cast<int>(buckets_.size()); }
+
+ private:
+  std::map<int, std::vector<char>> buckets_;
+};
+
+}  // namespace
+
+class PointCloudStreamingEncodingTest : public ::testing::Test {
+ protected:
+  // Generates |num_clusters| clusters of points placed far from the origin.
+  std::vector<float> GeneratePoints(int num_points, int num_clusters) const {
+    std::mt19937 generator(num_points);
+    std::normal_distribution<float> distribution(0.f, 20.f);
+    std::vector<float> points(3 * num_points);
+    for (int i = 0; i < num_points; ++i) {
+      const int cluster = i % num_clusters;
+      points[3 * i] = 500000.f + 300.f * cluster + distribution(generator);
+      points[3 * i + 1] = 4000000.f + 200.f * cluster + distribution(generator);
+      points[3 * i + 2] = 10.f + 0.1f * distribution(generator);
+    }
+    return points;
+  }
+
+  // Encodes |points| in batches of |batch_size| points.
+  Status Encode(const std::vector<float> &points, int batch_size,
+                PointCloudStreamingEncoder *encoder,
+                EncoderBuffer *out_buffer) const {
+    size_t next_value = 0;
+    return encoder->Encode(
+        [&points, &next_value, batch_size](std::vector<float> *positions) {
+          const size_t end =
+              std::min(points.size(), next_value + 3 * batch_size);
+          positions->assign(points.begin() + next_value, points.begin() + end);
+          next_value = end;
+          return true;
+        },
+        out_buffer);
+  }
+
+  // Returns the values expected to be decoded for |points| quantized to
+  // |quantization_bits| bits. The values are sorted by points.
+  std::vector<std::array<float, 3>> GetExpectedPoints(
+      const std::vector<float> &points, int quantization_bits) const {
+    float min_values[3], max_values[3];
+    for (int c = 0; c < 3; ++c) {
+      min_values[c] = max_values[c] = points[c];
+    }
+    for (size_t i = 0; i < points.size(); ++i) {
+      min_values[i % 3] = std::min(min_values[i % 3], points[i]);
+      max_values[i % 3] = std::max(max_values[i % 3], points[i]);
+    }
+    float range = 0.f;
+    for (int c = 0; c < 3; ++c)
+      range = std::max(range, max_values[c] - min_values[c]);
+    if (range == 0.f)
+      range = 1.f;
+    const int max_quantized_value = (1 << quantization_bits) - 1;
+    Quantizer quantizer;
+    quantizer.Init(range, max_quantized_value);
+    Dequantizer dequantizer;
+    dequantizer.Init(range, max_quantized_value);
+    std::vector<std::array<float, 3>> expected_points(points.size() / 3);
+    for (size_t i = 0; i < points.size(); ++i) {
+      const int32_t value = quantizer(points[i] - min_values[i % 3]);
+      expected_points[i / 3][i % 3] =
+          dequantizer(value) + min_values[i % 3];
+    }
+    std::sort(expected_points.begin(), expected_points.end());
+    return expected_points;
+  }
+
+  // Returns the sorted positions of all points of |pc|.
+  std::vector<std::array<float, 3>> GetSortedPoints(
+      const PointCloud &pc) const {
+    const PointAttribute *const att =
+        pc.GetNamedAttribute(GeometryAttribute::POSITION);
+    std::vector<std::array<float, 3>> points(pc.num_points());
+    for (PointIndex i(0); i < pc.num_points(); ++i) {
+      att->GetMappedValue(i, points[i.value()].data());
+    }
+    std::sort(points.begin(), points.end());
+    return points;
+  }
+};
+
+TEST_F(PointCloudStreamingEncodingTest, TestTiles) {
+  // Tests that the points are split into tiles of the requested size and that
+  // all points are decoded on the shared quantization grid.
+  const std::vector<float> points = GeneratePoints(40000, 3);
+  MemoryBucketStorage storage;
+  PointCloudStreamingEncoder encoder;
+  encoder.SetBucketStorage(&storage);
+  encoder.SetQuantizationBits(16);
+  encoder.SetMaxTilePoints(1000);
+  EncoderBuffer buffer;
+  ASSERT_TRUE(Encode(points, 777, &encoder, &buffer).ok());
+  // All buckets must be released after the encoding.
+  ASSERT_EQ(storage.num_buckets(), 0);
+
+  DecoderBuffer dec_buffer;
+  dec_buffer.Init(buffer.data(), buffer.size());
+  PointCloudTiledDecoder decoder;
+  PointCloud pc;
+  DecoderOptions dec_options;
+  ASSERT_TRUE(decoder.Decode(dec_options, &dec_buffer, &pc).ok());
+  ASSERT_GT(decoder.tiles().size(), 40);
+  const PointAttribute *const att =
+      pc.GetNamedAttribute(GeometryAttribute::POSITION);
+  ASSERT_NE(att, nullptr);
+  PointIndex point_id(0);
+  for (const PointCloudTiledDecoder::TileInfo &tile : decoder.tiles()) {
+    ASSERT_LE(tile.num_points, 1000);
+    ASSERT_GT(tile.num_points, 0);
+    // The tile bounding boxes are computed from the original positions, so
+    // the decoded points may lie slightly outside of them.
+    for (uint32_t i = 0; i < tile.num_points; ++i, ++point_id) {
+      float pos[3];
+      att->GetMappedValue(point_id, pos);
+      for (int c = 0; c < 3; ++c) {
+        ASSERT_GE(pos[c], tile.bbox_min[c] - 0.5f);
+        ASSERT_LE(pos[c], tile.bbox_max[c] + 0.5f);
+      }
+    }
+  }
+  ASSERT_EQ(point_id.value(), pc.num_points());
+  ASSERT_EQ(GetSortedPoints(pc), GetExpectedPoints(points, 16));
+}
+
+TEST_F(PointCloudStreamingEncodingTest, TestTemporaryFiles) {
+  // Tests encoding with the default storage and decoding of the tiles with
+  // multiple threads.
+  const std::vector<float> points = GeneratePoints(20000, 5);
+  PointCloudStreamingEncoder encoder;
+  encoder.SetQuantizationBits(12);
+  encoder.SetMaxTilePoints(3000);
+  EncoderBuffer buffer;
+  ASSERT_TRUE(Encode(points, 5000, &encoder, &buffer).ok());
+
+  for (int num_threads = 1; num_threads <= 4; num_threads *= 2) {
+    DecoderBuffer dec_buffer;
+    dec_buffer.Init(buffer.data(), buffer.size());
+    Decoder decoder;
+    decoder.options()->SetGlobalInt("num_decoding_threads", num_threads);
+    auto statusor = decoder.DecodePointCloudFromBuffer(&dec_buffer);
+    ASSERT_TRUE(statusor.ok());
+    const std::unique_ptr<PointCloud> pc = std::move(statusor).value();
+    ASSERT_EQ(GetSortedPoints(*pc), GetExpectedPoints(points, 12));
+  }
+}
+
+TEST_F(PointCloudStreamingEncodingTest, TestDuplicatePoints) {
+  // Tests that a bucket of identical points is encoded as a single tile even
+  // when it exceeds the maximum tile size.
+  std::vector<float> points;
+  for (int i = 0; i < 500; ++i) {
+    points.push_back(1.f);
+    points.push_back(2.f);
+    points.push_back(3.f);
+  }
+  MemoryBucketStorage storage;
+  PointCloudStreamingEncoder encoder;
+  encoder.SetBucketStorage(&storage);
+  encoder.SetMaxTilePoints(100);
+  EncoderBuffer buffer;
+  ASSERT_TRUE(Encode(points, 64, &encoder, &buffer).ok());
+
+  DecoderBuffer dec_buffer;
+  dec_buffer.Init(buffer.data(), buffer.size());
+  PointCloudTiledDecoder decoder;
+  PointCloud pc;
+  DecoderOptions dec_options;
+  ASSERT_TRUE(decoder.Decode(dec_options, &dec_buffer, &pc).ok());
+  ASSERT_EQ(decoder.tiles().size(), 1);
+  ASSERT_EQ(GetSortedPoints(pc), GetExpectedPoints(points, 14));
+}
+
+TEST_F(PointCloudStreamingEncodingTest, TestDecodeTiles) {
+  // Tests decoding of individual tiles and of the tiles inside of a box after
+  // decoding of just the tile directory.
+  const std::vector<float> points = GeneratePoints(20000, 4);
+  MemoryBucketStorage storage;
+  PointCloudStreamingEncoder encoder;
+  encoder.SetBucketStorage(&storage);
+  encoder.SetMaxTilePoints(2000);
+  EncoderBuffer buffer;
+  ASSERT_TRUE(Encode(points, 3000, &encoder, &buffer).ok());
+
+  DecoderBuffer dec_buffer;
+  dec_buffer.Init(buffer.data(), buffer.size());
+  PointCloudTiledDecoder decoder;
+  ASSERT_TRUE(decoder.DecodeTileDirectory(&dec_buffer).ok());
+  ASSERT_GT(decoder.tiles().size(), 10);
+  ASSERT_EQ(dec_buffer.remaining_size(), 0);
+
+  // Options of the kd-tree decoder must not affect decoding of the tiles.
+  DecoderOptions dec_options;
+  dec_options.SetGlobalInt("kd_tree_max_points", 10);
+  dec_options.SetGlobalInt("kd_tree_max_depth", 2);
+  std::vector<std::array<float, 3>> tile_points;
+  for (int t = 0; t < static_cast<int>(decoder.tiles().size()); ++t) {
+    PointCloud tile_pc;
+    ASSERT_TRUE(decoder.DecodeTile(t, dec_options, &tile_pc).ok());
+    ASSERT_EQ(tile_pc.num_points(), decoder.tiles()[t].num_points);
+    const PointAttribute *const att =
+        tile_pc.GetNamedAttribute(GeometryAttribute::POSITION);
+    for (PointIndex i(0); i < tile_pc.num_points(); ++i) {
+      std::array<float, 3> pos;
+      att->GetMappedValue(i, pos.data());
+      tile_points.push_back(pos);
+    }
+  }
+  std::sort(tile_points.begin(), tile_points.end());
+  ASSERT_EQ(tile_points, GetExpectedPoints(points, 14));
+
+  // The same holds when all tiles are decoded at once.
+  DecoderBuffer full_buffer;
+  full_buffer.Init(buffer.data(), buffer.size());
+  PointCloudTiledDecoder full_decoder;
+  PointCloud full_pc;
+  ASSERT_TRUE(full_decoder.Decode(dec_options, &full_buffer, &full_pc).ok());
+  ASSERT_EQ(GetSortedPoints(full_pc), tile_points);
+
+  // Decode tiles of the first cluster.
+  const float box_min[3] = {499900.f, 3999900.f, 0.f};
+  const float box_max[3] = {500100.f, 4000100.f, 20.f};
+  const std::vector<int> tile_ids = decoder.FindTilesInBox(box_min, box_max);
+  ASSERT_FALSE(tile_ids.empty());
+  ASSERT_LT(tile_ids.size(), decoder.tiles().size());
+  PointCloud pc;
+  ASSERT_TRUE(decoder.DecodeTiles(tile_ids, dec_options, &pc).ok());
+  uint32_t num_points = 0;
+  for (const int t : tile_ids)
+    num_points += decoder.tiles()[t].num_points;
+  ASSERT_EQ(pc.num_points(), num_points);
+  ASSERT_FALSE(decoder.DecodeTile(-1, dec_options, &pc).ok());
+  ASSERT_FALSE(
+      decoder.DecodeTile(decoder.tiles().size(), dec_options, &pc).ok());
+}
+
+TEST_F(PointCloudStreamingEncodingTest, TestInvalidInput) {
+  MemoryBucketStorage storage;
+  PointCloudStreamingEncoder encoder;
+  encoder.SetBucketStorage(&storage);
+  EncoderBuffer buffer;
+  // No points.
+  ASSERT_FALSE(Encode(std::vector<float>(), 10, &encoder, &buffer).ok());
+  // Incomplete point.
+  ASSERT_FALSE(encoder
+                   .Encode(
+                       [](std::vector<float> *positions) {
+                         positions->assign(4, 1.f);
+                         return true;
+                       },
+                       &buffer)
+                   .ok());
+  // Reader error.
+  ASSERT_FALSE(
+      encoder.Encode([](std::vector<float> *) { return false; }, &buffer)
+          .ok());
+  ASSERT_EQ(storage.num_buckets(), 0);
+}
+
+}  // namespace draco
@@ -0,0 +1,228 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/compression/point_cloud/point_cloud_tiled_decoder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "draco/compression/point_cloud/point_cloud_kd_tree_decoder.h"
+#include "draco/core/quantization_utils.h"
+#include "draco/core/thread_pool.h"
+#include "draco/core/varint_decoding.h"
+#include "draco/metadata/metadata_decoder.h"
+
+namespace draco {
+
+PointCloudTiledDecoder::PointCloudTiledDecoder()
+    : tile_data_(nullptr), quantization_bits_(0), quantization_range_(0.f) {
+  for (int i = 0; i < 3; ++i)
+    quantization_origin_[i] = 0.f;
+}
+
+Status PointCloudTiledDecoder::DecodeTileDirectory(DecoderBuffer *in_buffer) {
+  DracoHeader header;
+  DRACO_RETURN_IF_ERROR(DecodeHeader(in_buffer, &header))
+  if (header.encoder_type != POINT_CLOUD ||
+      header.encoder_method != POINT_CLOUD_TILED_ENCODING)
+    return Status(Status::ERROR, "Not a tiled point cloud.");
+  if (header.version_major < 1 ||
+      header.version_major > kDracoBitstreamVersionMajor)
+    return Status(Status::UNKNOWN_VERSION, "Unknown major version.");
+  if (header.version_major == kDracoBitstreamVersionMajor &&
+      header.version_minor > kDracoBitstreamVersionMinor)
+    return Status(Status::UNKNOWN_VERSION, "Unknown minor version.");
+  in_buffer->set_bitstream_version(
+      DRACO_BITSTREAM_VERSION(header.version_major, header.version_minor));
+  if (header.flags & METADATA_FLAG_MASK) {
+    // Metadata is not needed for decoding of the tiles.
+    GeometryMetadata metadata;
+    MetadataDecoder metadata_decoder;
+    if (!metadata_decoder.DecodeGeometryMetadata(in_buffer, &metadata))
+      return Status(Status::ERROR, "Failed to decode metadata.");
+  }
+  if (!DecodeDirectory(in_buffer))
+    return Status(Status::ERROR, "Failed to decode the tile directory.");
+  return OkStatus();
+}
+
+std::vector<int> PointCloudTiledDecoder::FindTilesInBox(
+    const float box_min[3], const float box_max[3]) const {
+  std::vector<int> tile_ids;
+  for (int t = 0; t < static_cast<int>(tiles_.size()); ++t) {
+    const TileInfo &tile = tiles_[t];
+    bool intersects = true;
+    for (int c = 0; c < 3; ++c) {
+      if (tile.bbox_min[c] > box_max[c] || tile.bbox_max[c] < box_min[c]) {
+        intersects = false;
+        break;
+      }
+    }
+    if (intersects)
+      tile_ids.push_back(t);
+  }
+  return tile_ids;
+}
+
+bool PointCloudTiledDecoder::DecodeGeometryData() {
+  if (!DecodeDirectory(buffer()))
+    return false;
+  std::vector<int> tile_ids(tiles_.size());
+  for (int t = 0; t < static_cast<int>(tile_ids.size()); ++t)
+    tile_ids[t] = t;
+  return DecodeTiles(tile_ids, *options(), point_cloud()).ok();
+}
+
+bool PointCloudTiledDecoder::DecodeDirectory(DecoderBuffer *buffer) {
+  tiles_.clear();
+  tile_data_ = nullptr;
+  if (!buffer->Decode(&quantization_bits_))
+    return false;
+  if (quantization_bits_ < 1 || quantization_bits_ > 30)
+    return false;
+  if (!buffer->Decode(quantization_origin_, sizeof(quantization_origin_)))
+    return false;
+  if (!buffer->Decode(&quantization_range_))
+    return false;
+  if (!std::isfinite(quantization_range_))
+    return false;
+  uint32_t num_tiles;
+  if (!DecodeVarint(&num_tiles, buffer))
+    return false;
+  // Every directory entry takes at least 27 bytes.
+  if (num_tiles == 0 || num_tiles > buffer->remaining_size() / 27)
+    return false;
+  tiles_.resize(num_tiles);
+  uint64_t num_points = 0;
+  for (TileInfo &tile : tiles_) {
+    if (!DecodeVarint(&tile.num_points, buffer))
+      return false;
+    if (!buffer->Decode(tile.bbox_min, sizeof(tile.bbox_min)))
+      return false;
+    if (!buffer->Decode(tile.bbox_max, sizeof(tile.bbox_max)))
+      return false;
+    if (!DecodeVarint(&tile.offset, buffer))
+      return false;
+    if (!DecodeVarint(&tile.size, buffer))
+      return false;
+    num_points += tile.num_points;
+  }
+  if (num_points > std::numeric_limits<uint32_t>::max())
+    return false;
+  const uint64_t data_size = buffer->remaining_size();
+  uint64_t data_end = 0;
+  for (const TileInfo &tile : tiles_) {
+    if (tile.offset > data_size || tile.size > data_size - tile.offset)
+      return false;
+    data_end = std::max(data_end, tile.offset + tile.size);
+  }
+  tile_data_ = buffer->data_head();
+  buffer->Advance(data_end);
+  return true;
+}
+
+Status PointCloudTiledDecoder::DecodeTiles(const std::vector<int> &tile_ids,
+                                           const DecoderOptions &options,
+                                           PointCloud *out_point_cloud) const {
+  if (tile_data_ == nullptr)
+    return Status(Status::ERROR, "Tile directory is not decoded.");
+  uint64_t num_points = 0;
+  for (const int t : tile_ids) {
+    if (t < 0 || t >= static_cast<int>(tiles_.size()))
+      return Status(Status::ERROR, "Invalid tile id.");
+    num_points += tiles_[t].num_points;
+  }
+  if (num_points > std::numeric_limits<uint32_t>::max())
+    return Status(Status::ERROR, "Too many points.");
+
+  out_point_cloud->set_num_points(static_cast<uint32_t>(num_points));
+  GeometryAttribute va;
+  va.Init(GeometryAttribute::POSITION, nullptr, 3, DT_FLOAT32, false,
+          3 * sizeof(float), 0);
+  const int att_id = out_point_cloud->AddAttribute(va, true, num_points);
+  if (num_points == 0)
+    return OkStatus();
+  float *const positions = reinterpret_cast<float *>(
+      out_point_cloud->attribute(att_id)->GetAddress(AttributeValueIndex(0)));
+
+  // Decode the tiles concurrently when requested. Each tile writes its points
+  // into a separate range of the output attribute.
+  const int num_threads = options.GetGlobalInt("num_decoding_threads", 1);
+  const int num_tiles = static_cast<int>(tile_ids.size());
+  const int num_tile_threads = std::min(num_threads, num_tiles);
+  std::vector<uint8_t> tile_results(num_tiles, 0);
+  ThreadPool thread_pool(num_tile_threads > 1 ? num_tile_threads : 0);
+  uint64_t first_point = 0;
+  for (int i = 0; i < num_tiles; ++i) {
+    const TileInfo &tile = tiles_[tile_ids[i]];
+    float *const tile_positions = positions + 3 * first_point;
+    thread_pool.Schedule([this, &tile, &tile_results, i, tile_positions]() {
+      tile_results[i] = DecodeTileData(tile, tile_positions);
+    });
+    first_point += tile.num_points;
+  }
+  thread_pool.Wait();
+  for (const uint8_t result : tile_results) {
+    if (!result)
+      return Status(Status::ERROR, "Failed to decode a tile.");
+  }
+  return OkStatus();
+}
+
+bool PointCloudTiledDecoder::DecodeTileData(const TileInfo &tile,
+                                            float *out_positions) const {
+  DecoderBuffer tile_buffer;
+  tile_buffer.Init(tile_data_ + tile.offset, tile.size);
+  DecoderBuffer header_buffer(tile_buffer);
+  DracoHeader header;
+  if (!DecodeHeader(&header_buffer, &header).ok())
+    return false;
+  if (header.encoder_type != POINT_CLOUD ||
+      header.encoder_method != POINT_CLOUD_KD_TREE_ENCODING)
+    return false;  // Tiles cannot be nested.
+  // Tiles are always decoded completely and by a single thread, so none of the
+  // caller's options (such as the kd-tree level of detail or query box) are
+  // passed to the tile decoder.
+  DecoderOptions tile_options;
+  PointCloudKdTreeDecoder decoder;
+  PointCloud tile_pc;
+  if (!decoder.Decode(tile_options, &tile_buffer, &tile_pc).ok())
+    return false;
+  if (tile_pc.num_points() != tile.num_points)
+    return false;
+  const PointAttribute *const att =
+      tile_pc.GetNamedAttribute(GeometryAttribute::POSITION);
+  if (att == nullptr || att->data_type() != DT_UINT32 ||
+      att->num_components() != 3)
+    return false;
+
+  const uint32_t max_quantized_value = (1u << quantization_bits_) - 1;
+  Dequantizer dequantizer;
+  if (!dequantizer.Init(quantization_range_, max_quantized_value))
+    return false;
+  for (PointIndex p(0); p < tile.num_points; ++p) {
+    const uint32_t *const value = reinterpret_cast<const uint32_t *>(
+        att->GetAddress(att->mapped_index(p)));
+    for (int c = 0; c < 3; ++c) {
+      if (value[c] > max_quantized_value)
+        return false;
+      out_positions[3 * p.value() + c] =
+          dequantizer.DequantizeFloat(value[c]) + quantization_origin_[c];
+    }
+  }
+  return true;
+}
+
+}  // namespace draco
@@ -0,0 +1,99 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef DRACO_COMPRESSION_POINT_CLOUD_POINT_CLOUD_TILED_DECODER_H_
+#define DRACO_COMPRESSION_POINT_CLOUD_POINT_CLOUD_TILED_DECODER_H_
+
+#include <vector>
+
+#include "draco/compression/point_cloud/point_cloud_decoder.h"
+
+namespace draco {
+
+// Class for decoding data encoded by PointCloudStreamingEncoder. Decode()
+// stores points of all tiles into the output point cloud in the order of the
+// tiles. Inputs that are too large to be decoded at once can be processed one
+// tile at a time: DecodeTileDirectory() reads only the tile directory and
+// DecodeTiles() then decodes any subset of the tiles, for example the tiles
+// returned by FindTilesInBox(). Tiles are decoded concurrently when the global
+// decoder option "num_decoding_threads" is larger than 1.
+class PointCloudTiledDecoder : public PointCloudDecoder {
+ public:
+  // Entry of the tile directory.
+  struct TileInfo {
+    uint32_t num_points;
+    float bbox_min[3];
+    float bbox_max[3];
+    // Offset of the tile data from the end of the tile directory.
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  PointCloudTiledDecoder();
+
+  // Decodes the Draco header and the tile directory from |in_buffer| without
+  // decoding any tile. Only the tiles requested in DecodeTiles() are read
+  // later on, so |in_buffer| can map a file that doesn't fit into memory. The
+  // data of |in_buffer| must stay valid until the tiles are decoded.
+  Status DecodeTileDirectory(DecoderBuffer *in_buffer);
+
+  // Decodes positions of the tiles |tile_ids| into |out_point_cloud|. Points
+  // are stored in the order of |tile_ids|. Requires the tile directory decoded
+  // by DecodeTileDirectory() or Decode().
+  Status DecodeTiles(const std::vector<int> &tile_ids,
+                     const DecoderOptions &options,
+                     PointCloud *out_point_cloud) const;
+
+  // Decodes positions of a single tile into |out_point_cloud|.
+  Status DecodeTile(int tile_id, const DecoderOptions &options,
+                    PointCloud *out_point_cloud) const {
+    return DecodeTiles(std::vector<int>(1, tile_id), options, out_point_cloud);
+  }
+
+  // Returns ids of all tiles whose bounding box intersects the axis-aligned
+  // box defined by |box_min| and |box_max|.
+  std::vector<int> FindTilesInBox(const float box_min[3],
+                                  const float box_max[3]) const;
+
+  // Returns the tile directory of the decoded point cloud.
+  const std::vector<TileInfo> &tiles() const { return tiles_; }
+
+ protected:
+  bool DecodeGeometryData() override;
+  bool CreateAttributesDecoder(int32_t /* att_decoder_id */) override {
+    return false;
+  }
+  // All attribute data is decoded together with the tiles.
+  bool DecodePointAttributes() override { return true; }
+
+ private:
+  // Decodes the quantization parameters and the tile directory from |buffer|
+  // and skips the data of all tiles.
+  bool DecodeDirectory(DecoderBuffer *buffer);
+
+  // Decodes quantized positions of a single tile and stores their dequantized
+  // values into |out_positions|.
+  bool DecodeTileData(const TileInfo &tile, float *out_positions) const;
+
+  std::vector<TileInfo> tiles_;
+  // Data of all tiles. Tile offsets are relative to this pointer.
+  const char *tile_data_;
+  uint8_t quantization_bits_;
+  float quantization_origin_[3];
+  float quantization_range_;
+};
+
+}  // namespace draco
+
+#endif  // DRACO_COMPRESSION_POINT_CLOUD_POINT_CLOUD_TILED_DECODER_H_
@@ -18,13 +18,13 @@
 // See http://arxiv.org/abs/1311.2540v2 for more information on rANS.
 // This file is based off libvpx's ans.h.
 
-#include <vector>
-
 #define ANS_DIVIDE_BY_MULTIPLY 1
 #if ANS_DIVIDE_BY_MULTIPLY
 #include "draco/core/divide.h"
 #endif
+#include "draco/core/arena.h"
 #include "draco/core/macros.h"
+#include "draco/core/rans_simd_decoder.h"
 
 namespace draco {
 
@@ -338,60 +338,95 @@ struct rans_sym {
 // The max number of precision bits is currently 19. The actual number of
 // symbols in the input alphabet should be (much) smaller than that, otherwise
 // the compression rate may suffer.
-template <int rans_precision_bits_t>
+// |num_states_t| specifies the number of independent rANS states that are used
+// in a round-robin fashion to encode the input symbols. All states share the
+// same output buffer. Using more than one state breaks the serial dependency
+// between consecutive symbols on the decoder side, which allows the decoder to
+// process several symbols in parallel. The number of states must be a power of
+// two. With one state, the produced data is identical to the original
+// single-state rANS coder.
+template <int rans_precision_bits_t, int num_states_t = 1>
 class RAnsEncoder {
+  static_assert(num_states_t > 0 && (num_states_t & (num_states_t - 1)) == 0,
+                "Number of rANS states must be a power of two.");
+
  public:
-  RAnsEncoder() {}
+  RAnsEncoder() : buf_(nullptr), buf_offset_(0), state_id_(0) {}
 
   // Provides the input buffer where the data is going to be stored.
   inline void write_init(uint8_t *const buf) {
-    ans_.buf = buf;
-    ans_.buf_offset = 0;
-    ans_.state = l_rans_base;
+    buf_ = buf;
+    buf_offset_ = 0;
+    state_id_ = 0;
+    for (int i = 0; i < num_states_t; ++i) {
+      states_[i] = l_rans_base;
+    }
   }
 
   // Needs to be called after all symbols are encoded.
   inline int write_end() {
-    uint32_t state;
-    DCHECK_GE(ans_.state, l_rans_base);
-    DCHECK_LT(ans_.state, l_rans_base * io_base);
-    state = ans_.state - l_rans_base;
-    if (state < (1 << 6)) {
-      ans_.buf[ans_.buf_offset] = (0x00 << 6) + state;
-      return ans_.buf_offset + 1;
-    } else if (state < (1 << 14)) {
-      mem_put_le16(ans_.buf + ans_.buf_offset, (0x01 << 14) + state);
-      return ans_.buf_offset + 2;
-    } else if (state < (1 << 22)) {
-      mem_put_le24(ans_.buf + ans_.buf_offset, (0x02 << 22) + state);
-      return ans_.buf_offset + 3;
-    } else if (state < (1 << 30)) {
-      mem_put_le32(ans_.buf + ans_.buf_offset, (0x03 << 30) + state);
-      return ans_.buf_offset + 4;
-    } else {
-      DCHECK(0 && "State is too large to be serialized");
-      return ans_.buf_offset;
+    // The decoder processes the symbols in the reverse order, therefore it
+    // starts with the state that was used to encode the last symbol. The states
+    // are stored such that the decoder reads them in the order in which it is
+    // going to use them (the first state is stored at the end of the buffer).
+    const int last_state_id = (state_id_ + num_states_t - 1) & state_id_mask;
+    for (int i = num_states_t - 1; i >= 0; --i) {
+      const int state_id = (last_state_id - i) & state_id_mask;
+      if (!write_state(states_[state_id]))
+        return buf_offset_;
     }
+    return buf_offset_;
   }
 
   // rANS with normalization
   // sym->prob takes the place of l_s from the paper
   // rans_precision is m
   inline void rans_write(const struct rans_sym *const sym) {
+    uint32_t &state = states_[state_id_];
+    state_id_ = (state_id_ + 1) & state_id_mask;
     const uint32_t p = sym->prob;
-    while (ans_.state >= l_rans_base / rans_precision * io_base * p) {
-      ans_.buf[ans_.buf_offset++] = ans_.state % io_base;
-      ans_.state /= io_base;
+    while (state >= l_rans_base / rans_precision * io_base * p) {
+      buf_[buf_offset_++] = state % io_base;
+      state /= io_base;
     }
     // TODO(ostava): The division and multiplication should be optimized.
-    ans_.state =
-        (ans_.state / p) * rans_precision + ans_.state % p + sym->cum_prob;
+    state = (state / p) * rans_precision + state % p + sym->cum_prob;
   }
 
  private:
+  // Serializes a final |state| into the output buffer. Returns false when the
+  // state is out of the valid range.
+  inline bool write_state(uint32_t state) {
+    DCHECK_GE(state, l_rans_base);
+    DCHECK_LT(state, l_rans_base * io_base);
+    state -= l_rans_base;
+    if (state < (1 << 6)) {
+      buf_[buf_offset_] = (0x00 << 6) + state;
+      buf_offset_ += 1;
+    } else if (state < (1 << 14)) {
+      mem_put_le16(buf_ + buf_offset_, (0x01 << 14) + state);
+      buf_offset_ += 2;
+    } else if (state < (1 << 22)) {
+      mem_put_le24(buf_ + buf_offset_, (0x02 << 22) + state);
+      buf_offset_ += 3;
+    } else if (state < (1 << 30)) {
+      mem_put_le32(buf_ + buf_offset_, (0x03 << 30) + state);
+      buf_offset_ += 4;
+    } else {
+      DCHECK(0 && "State is too large to be serialized");
+      return false;
+    }
+    return true;
+  }
+
   static constexpr int rans_precision = 1 << rans_precision_bits_t;
   static constexpr int l_rans_base = rans_precision * 4;
-  AnsCoder ans_;
+  static constexpr int state_id_mask = num_states_t - 1;
+  uint8_t *buf_;
+  int buf_offset_;
+  // Index of the state that is going to be used for the next symbol.
+  int state_id_;
+  uint32_t states_[num_states_t];
 };
 
 struct rans_dec_sym {
@@ -401,67 +436,90 @@ struct rans_dec_sym {
 };
 
 // Class for performing rANS decoding using a desired number of precision bits.
-// The number of precision bits needs to be the same as with the RAnsEncoder
-// that was used to encode the input data.
-template <int rans_precision_bits_t>
+// The number of precision bits and the number of states needs to be the same
+// as with the RAnsEncoder that was used to encode the input data.
+template <int rans_precision_bits_t, int num_states_t = 1>
 class RAnsDecoder {
+  static_assert(num_states_t > 0 && (num_states_t & (num_states_t - 1)) == 0,
+                "Number of rANS states must be a power of two.");
+
  public:
-  RAnsDecoder() {}
+  RAnsDecoder() : buf_(nullptr), buf_offset_(0), state_id_(0) {}
 
   // Initializes the decoder from the input buffer. The |offset| specifies the
   // number of bytes encoded by the encoder. A non zero return value is an
   // error.
   inline int read_init(const uint8_t *const buf, int offset) {
-    unsigned x;
-    if (offset < 1)
-      return 1;
-    ans_.buf = buf;
-    x = buf[offset - 1] >> 6;
-    if (x == 0) {
-      ans_.buf_offset = offset - 1;
-      ans_.state = buf[offset - 1] & 0x3F;
-    } else if (x == 1) {
-      if (offset < 2)
-        return 1;
-      ans_.buf_offset = offset - 2;
-      ans_.state = mem_get_le16(buf + offset - 2) & 0x3FFF;
-    } else if (x == 2) {
-      if (offset < 3)
+    buf_ = buf;
+    state_id_ = 0;
+    for (int i = 0; i < num_states_t; ++i) {
+      if (read_state(&offset, &states_[i]) != 0)
         return 1;
-      ans_.buf_offset = offset - 3;
-      ans_.state = mem_get_le24(buf + offset - 3) & 0x3FFFFF;
-    } else if (x == 3) {
-      ans_.buf_offset = offset - 4;
-      ans_.state = mem_get_le32(buf + offset - 4) & 0x3FFFFFFF;
-    } else {
-      return 1;
     }
-    ans_.state += l_rans_base;
-    if (ans_.state >= l_rans_base * io_base)
-      return 1;
+    buf_offset_ = offset;
     return 0;
   }
 
-  inline int read_end() { return ans_.state == l_rans_base; }
+  inline int read_end() {
+    for (int i = 0; i < num_states_t; ++i) {
+      if (states_[i] != l_rans_base)
+        return 0;
+    }
+    return 1;
+  }
 
   inline int reader_has_error() {
-    return ans_.state < l_rans_base && ans_.buf_offset == 0;
+    return states_[state_id_] < l_rans_base && buf_offset_ == 0;
   }
 
   inline int rans_read() {
-    unsigned rem;
-    unsigned quo;
-    struct rans_dec_sym sym;
-    while (ans_.state < l_rans_base && ans_.buf_offset > 0) {
-      ans_.state = ans_.state * io_base + ans_.buf[--ans_.buf_offset];
+    const int val = rans_read_state(&states_[state_id_]);
+    state_id_ = (state_id_ + 1) & state_id_mask;
+    return val;
+  }
+
+  // Decodes |num_values| symbols into |out_values|. This is equivalent to
+  // calling rans_read() |num_values| times, but the symbols of all states are
+  // decoded in one batch which exposes the independent states to the compiler
+  // and to the CPU. When available, SIMD instructions are used to decode all
+  // states at once (see rans_simd_decoder.h).
+  inline void rans_read_n(uint32_t num_values, uint32_t *out_values) {
+    uint32_t i = 0;
+    // Process the leading symbols until we reach the first state.
+    for (; i < num_values && state_id_ != 0; ++i) {
+      out_values[i] = rans_read();
+    }
+    if (num_states_t > 1) {
+      // Decode as many rounds as possible using the vectorized decoder.
+      const uint32_t num_simd_rounds = RAnsDecodeRoundsSimd(
+          num_states_t, rans_precision_bits_t, lut_table_.data(),
+          probability_table_.data(), buf_, &buf_offset_, states_,
+          (num_values - i) / num_states_t, out_values + i);
+      i += num_simd_rounds * num_states_t;
+      uint32_t states[num_states_t];
+      for (int s = 0; s < num_states_t; ++s) {
+        states[s] = states_[s];
+      }
+      for (; i + num_states_t <= num_values; i += num_states_t) {
+        for (int s = 0; s < num_states_t; ++s) {
+          out_values[i + s] = rans_read_state(&states[s]);
+        }
+      }
+      for (int s = 0; s < num_states_t; ++s) {
+        states_[s] = states[s];
+      }
+    }
+    // Decode any remaining symbols.
+    for (; i < num_values; ++i) {
+      out_values[i] = rans_read();
     }
-    // |rans_precision| is a power of two compile time constant, and the below
-    // division and modulo are going to be optimized by the compiler.
-    quo = ans_.state / rans_precision;
-    rem = ans_.state % rans_precision;
-    fetch_sym(&sym, rem);
-    ans_.state = quo * sym.prob + rem - sym.cum_prob;
-    return sym.val;
+  }
+
+  // Sets the arena used for the look-up tables. Must be called before
+  // rans_build_look_up_table().
+  void set_arena(Arena *arena) {
+    lut_table_ = ArenaVector<uint32_t>(ArenaAllocator<uint32_t>(arena));
+    probability_table_ = ArenaVector<rans_sym>(ArenaAllocator<rans_sym>(arena));
   }
 
   // Construct a lookup table with |rans_precision| number of entries.
@@ -491,6 +549,58 @@ class RAnsDecoder {
   }
 
  private:
+  // Reads one state that was stored before |*offset| by the encoder and
+  // updates the |*offset| to point to the beginning of the state. A non zero
+  // return value is an error.
+  inline int read_state(int *offset, uint32_t *out_state) const {
+    unsigned x;
+    if (*offset < 1)
+      return 1;
+    x = buf_[*offset - 1] >> 6;
+    if (x == 0) {
+      *offset -= 1;
+      *out_state = buf_[*offset] & 0x3F;
+    } else if (x == 1) {
+      if (*offset < 2)
+        return 1;
+      *offset -= 2;
+      *out_state = mem_get_le16(buf_ + *offset) & 0x3FFF;
+    } else if (x == 2) {
+      if (*offset < 3)
+        return 1;
+      *offset -= 3;
+      *out_state = mem_get_le24(buf_ + *offset) & 0x3FFFFF;
+    } else if (x == 3) {
+      if (*offset < 4)
+        return 1;
+      *offset -= 4;
+      *out_state = mem_get_le32(buf_ + *offset) & 0x3FFFFFFF;
+    } else {
+      return 1;
+    }
+    *out_state += l_rans_base;
+    if (*out_state >= l_rans_base * io_base)
+      return 1;
+    return 0;
+  }
+
+  inline int rans_read_state(uint32_t *state) {
+    unsigned rem;
+    unsigned quo;
+    struct rans_dec_sym sym;
+    uint32_t x = *state;
+    while (x < l_rans_base && buf_offset_ > 0) {
+      x = x * io_base + buf_[--buf_offset_];
+    }
+    // |rans_precision| is a power of two compile time constant, and the below
+    // division and modulo are going to be optimized by the compiler.
+    quo = x / rans_precision;
+    rem = x % rans_precision;
+    fetch_sym(&sym, rem);
+    *state = quo * sym.prob + rem - sym.cum_prob;
+    return sym.val;
+  }
+
   inline void fetch_sym(struct rans_dec_sym *out, uint32_t rem) {
     uint32_t symbol = lut_table_[rem];
     out->val = symbol;
@@ -500,9 +610,14 @@ class RAnsDecoder {
 
   static constexpr int rans_precision = 1 << rans_precision_bits_t;
   static constexpr int l_rans_base = rans_precision * 4;
-  std::vector<uint32_t> lut_table_;
-  std::vector<rans_sym> probability_table_;
-  AnsDecoder ans_;
+  static constexpr int state_id_mask = num_states_t - 1;
+  ArenaVector<uint32_t> lut_table_;
+  ArenaVector<rans_sym> probability_table_;
+  const uint8_t *buf_;
+  int buf_offset_;
+  // Index of the state that is going to be used for the next symbol.
+  int state_id_;
+  uint32_t states_[num_states_t];
 };
 
 #undef ANS_DIVREM
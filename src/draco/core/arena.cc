@@ -0,0 +1,78 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/core/arena.h"
+
+#include <algorithm>
+#include <cstddef>
+
+namespace draco {
+
+namespace {
+
+// Size of the first memory block of an arena.
+constexpr size_t kMinBlockSize = 64 * 1024;
+
+// Alignment of all allocations. Memory blocks allocated by new[] are aligned
+// at least as much.
+constexpr size_t kAlignment = alignof(std::max_align_t);
+
+}  // namespace
+
+Arena::Arena() : block_offset_(0) {}
+
+void *Arena::Allocate(size_t size) {
+  const size_t offset = (block_offset_ + kAlignment - 1) & ~(kAlignment - 1);
+  if (blocks_.empty() || offset + size > blocks_.back().size) {
+    // Each new block is at least twice as large as the previous one so that
+    // the number of blocks stays logarithmic in the used memory.
+    const size_t block_size =
+        blocks_.empty() ? kMinBlockSize : 2 * blocks_.back().size;
+    AddBlock(std::max(block_size, size));
+    block_offset_ = size;
+    return blocks_.back().data.get();
+  }
+  block_offset_ = offset + size;
+  return blocks_.back().data.get() + offset;
+}
+
+void Arena::Reset() {
+  if (blocks_.size() > 1) {
+    const size_t size = capacity();
+    blocks_.clear();
+    AddBlock(size);
+  }
+  block_offset_ = 0;
+}
+
+void Arena::Release() {
+  blocks_.clear();
+  block_offset_ = 0;
+}
+
+size_t Arena::capacity() const {
+  size_t size = 0;
+  for (const Block &block : blocks_)
+    size += block.size;
+  return size;
+}
+
+void Arena::AddBlock(size_t size) {
+  Block block;
+  block.data.reset(new uint8_t[size]);
+  block.size = size;
+  blocks_.push_back(std::move(block));
+}
+
+}  // namespace draco
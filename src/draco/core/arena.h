@@ -0,0 +1,114 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef DRACO_CORE_ARENA_H_
+#define DRACO_CORE_ARENA_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace draco {
+
+// Monotonic allocator for short-lived scratch memory. Allocations are carved
+// out of large memory blocks and they are never freed individually. Instead,
+// all allocations are released at once by Reset(), which keeps the memory
+// blocks for reuse. Repeated operations with a similar memory footprint
+// therefore stop allocating memory on the heap after the first run.
+// The class is not thread-safe.
+class Arena {
+ public:
+  Arena();
+
+  // Returns |size| bytes of memory aligned for any fundamental type. The
+  // memory is valid until Reset() or Release() is called.
+  void *Allocate(size_t size);
+
+  // Releases all allocations made since the last reset. When the allocations
+  // did not fit into a single memory block, the blocks are merged into one
+  // large block to serve the same allocations next time.
+  void Reset();
+
+  // Releases all allocations and frees all memory blocks.
+  void Release();
+
+  // Returns the total size of all memory blocks owned by the arena.
+  size_t capacity() const;
+
+ private:
+  struct Block {
+    std::unique_ptr<uint8_t[]> data;
+    size_t size;
+  };
+
+  void AddBlock(size_t size);
+
+  std::vector<Block> blocks_;
+  // Number of bytes used in the last block.
+  size_t block_offset_;
+};
+
+// Allocator compatible with the standard containers that allocates memory
+// from an Arena. When no arena is set, the memory is allocated on the heap.
+template <typename T>
+class ArenaAllocator {
+ public:
+  typedef T value_type;
+  // Containers take over the arena of the container they are assigned from.
+  typedef std::true_type propagate_on_container_copy_assignment;
+  typedef std::true_type propagate_on_container_move_assignment;
+  typedef std::true_type propagate_on_container_swap;
+
+  explicit ArenaAllocator(Arena *arena = nullptr) : arena_(arena) {}
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U> &other) : arena_(other.arena()) {}
+
+  T *allocate(size_t n) {
+    if (arena_ == nullptr)
+      return std::allocator<T>().allocate(n);
+    return static_cast<T *>(arena_->Allocate(n * sizeof(T)));
+  }
+
+  void deallocate(T *p, size_t n) {
+    // Arena memory is released all at once by Arena::Reset().
+    if (arena_ == nullptr)
+      std::allocator<T>().deallocate(p, n);
+  }
+
+  Arena *arena() const { return arena_; }
+
+ private:
+  Arena *arena_;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {
+  return a.arena() == b.arena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {
+  return a.arena() != b.arena();
+}
+
+// Vector that allocates its elements from an Arena.
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+}  // namespace draco
+
+#endif  // DRACO_CORE_ARENA_H_
@@ -0,0 +1,81 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/core/arena.h"
+
+#include <cstddef>
+
+#include "draco/core/draco_test_base.h"
+
+namespace {
+
+TEST(ArenaTest, TestAlignment) {
+  draco::Arena arena;
+  for (size_t size = 1; size < 100; size += 7) {
+    const uintptr_t address =
+        reinterpret_cast<uintptr_t>(arena.Allocate(size));
+    ASSERT_EQ(address % alignof(std::max_align_t), 0u);
+  }
+}
+
+TEST(ArenaTest, TestMemoryIsReused) {
+  // Tests that the same sequence of allocations doesn't grow the arena after
+  // it was reset.
+  draco::Arena arena;
+  ASSERT_EQ(arena.capacity(), 0u);
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < 100; ++i) {
+      uint8_t *const data = static_cast<uint8_t *>(arena.Allocate(10000));
+      data[0] = data[9999] = 1;
+    }
+    const size_t capacity = arena.capacity();
+    ASSERT_GE(capacity, 1000000u);
+    arena.Reset();
+    ASSERT_EQ(arena.capacity(), capacity);
+    if (round > 0) {
+      // All allocations fit into a single block now.
+      void *const first = arena.Allocate(10000);
+      arena.Allocate(98 * 10000);
+      ASSERT_EQ(arena.capacity(), capacity);
+      arena.Reset();
+      ASSERT_EQ(arena.Allocate(1), first);
+      arena.Reset();
+    }
+  }
+  arena.Release();
+  ASSERT_EQ(arena.capacity(), 0u);
+}
+
+TEST(ArenaTest, TestArenaVector) {
+  draco::Arena arena;
+  const draco::ArenaAllocator<int> alloc(&arena);
+  draco::ArenaVector<int> values(alloc);
+  for (int i = 0; i < 10000; ++i)
+    values.push_back(i);
+  for (int i = 0; i < 10000; ++i)
+    ASSERT_EQ(values[i], i);
+  ASSERT_GT(arena.capacity(), 0u);
+
+  // Vectors without an arena use the heap.
+  draco::ArenaVector<int> heap_values;
+  heap_values.assign(values.begin(), values.end());
+  ASSERT_EQ(heap_values.get_allocator().arena(), nullptr);
+  ASSERT_EQ(heap_values[9999], 9999);
+
+  // Assignment transfers the arena.
+  heap_values = draco::ArenaVector<int>(draco::ArenaAllocator<int>(&arena));
+  ASSERT_EQ(heap_values.get_allocator().arena(), &arena);
+}
+
+}  // namespace
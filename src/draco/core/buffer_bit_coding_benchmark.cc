@@ -0,0 +1,65 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "benchmark/benchmark.h"
+#include "draco/compression/config/compression_shared.h"
+#include "draco/core/decoder_buffer.h"
+#include "draco/core/draco_benchmark_utils.h"
+#include "draco/core/encoder_buffer.h"
+
+namespace draco {
+
+namespace {
+
+constexpr int kNumBitValues = 1 << 16;
+
+// Decodes values of state.range(0) bits each from the bit sequence of a
+// DecoderBuffer.
+void BM_DecodeLeastSignificantBits32(benchmark::State &state) {
+  const int num_bits = static_cast<int>(state.range(0));
+  const std::vector<uint32_t> values = CreateSymbols(kNumBitValues, num_bits);
+  EncoderBuffer encoder_buffer;
+  encoder_buffer.StartBitEncoding(
+      static_cast<int64_t>(num_bits) * values.size(), true);
+  for (const uint32_t value : values) {
+    encoder_buffer.EncodeLeastSignificantBits32(num_bits, value);
+  }
+  encoder_buffer.EndBitEncoding();
+
+  std::vector<uint32_t> decoded_values(values.size());
+  for (auto _ : state) {
+    DecoderBuffer buffer;
+    buffer.Init(encoder_buffer.data(), encoder_buffer.size(),
+                kDracoBitstreamVersion);
+    uint64_t size;
+    if (!buffer.StartBitDecoding(true, &size)) {
+      state.SkipWithError("Failed to start bit decoding.");
+      break;
+    }
+    for (size_t i = 0; i < decoded_values.size(); ++i) {
+      buffer.DecodeLeastSignificantBits32(num_bits, &decoded_values[i]);
+    }
+    buffer.EndBitDecoding();
+    benchmark::DoNotOptimize(decoded_values.data());
+  }
+  if (decoded_values != values)
+    state.SkipWithError("Decoded values don't match the encoded values.");
+  state.SetItemsProcessed(state.iterations() * values.size());
+  state.SetBytesProcessed(state.iterations() * encoder_buffer.size());
+}
+BENCHMARK(BM_DecodeLeastSignificantBits32)->Arg(1)->Arg(5)->Arg(12)->Arg(20);
+
+}  // namespace
+
+}  // namespace draco
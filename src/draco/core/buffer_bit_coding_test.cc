@@ -113,4 +113,54 @@ TEST_F(BufferBitCodingTest, TestMultipleBits) {
   }
 }
 
+TEST_F(BufferBitCodingTest, TestMixedBitWidths) {
+  // Encode values of all supported bit widths so that they cross both byte
+  // and 64-bit word boundaries of the decoder cache.
+  constexpr int buffer_size = 256;
+  char buffer[buffer_size];
+  BitEncoder encoder(buffer);
+  uint64_t expected_bits = 0;
+  for (int round = 0; round < 3; ++round) {
+    for (int nbits = 0; nbits <= 32; ++nbits) {
+      const uint32_t value = 0x9e3779b9u * (nbits + 1) + round;
+      encoder.PutBits(value, nbits);
+      expected_bits += nbits;
+      ASSERT_EQ(expected_bits, encoder.Bits());
+    }
+  }
+
+  BitDecoder decoder;
+  decoder.reset(static_cast<const void *>(buffer), (expected_bits + 7) / 8);
+  for (int round = 0; round < 3; ++round) {
+    for (int nbits = 0; nbits <= 32; ++nbits) {
+      const uint32_t value = 0x9e3779b9u * (nbits + 1) + round;
+      const uint32_t mask =
+          static_cast<uint32_t>((static_cast<uint64_t>(1) << nbits) - 1);
+      uint32_t x = 0;
+      ASSERT_TRUE(decoder.GetBits(nbits, &x));
+      ASSERT_EQ(value & mask, x);
+    }
+  }
+  ASSERT_EQ(expected_bits, decoder.BitsDecoded());
+}
+
+TEST_F(BufferBitCodingTest, TestDecodingPastEnd) {
+  // Bits past the end of the buffer are decoded as zeros and they are not
+  // counted as decoded bits.
+  const uint8_t data[] = {0xff, 0xff, 0xff};
+
+  BitDecoder decoder;
+  decoder.reset(static_cast<const void *>(data), sizeof(data));
+
+  uint32_t x = 0;
+  ASSERT_TRUE(decoder.GetBits(20, &x));
+  ASSERT_EQ(0xfffffu, x);
+  ASSERT_TRUE(decoder.GetBits(8, &x));
+  ASSERT_EQ(0xfu, x);
+  ASSERT_EQ(24u, decoder.BitsDecoded());
+  ASSERT_TRUE(decoder.GetBits(32, &x));
+  ASSERT_EQ(0u, x);
+  ASSERT_EQ(24u, decoder.BitsDecoded());
+}
+
 }  // namespace draco
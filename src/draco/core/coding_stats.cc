@@ -0,0 +1,114 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/core/coding_stats.h"
+
+#ifdef DRACO_STATS_SUPPORTED
+#include <atomic>
+#endif
+
+namespace draco {
+
+#ifdef DRACO_STATS_SUPPORTED
+namespace {
+
+std::atomic<CodingStats::AllocationCounter> allocation_counter(nullptr);
+
+}  // namespace
+#endif
+
+void CodingStats::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  stages_.clear();
+}
+
+void CodingStats::AddStage(const char *name, int att_id, int64_t time_us,
+                           int64_t num_bytes, int64_t num_allocations) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Stage *stage = nullptr;
+  for (Stage &s : stages_) {
+    if (s.att_id == att_id && s.name == name) {
+      stage = &s;
+      break;
+    }
+  }
+  if (stage == nullptr) {
+    stages_.push_back({name, att_id, 0, 0, 0, 0});
+    stage = &stages_.back();
+  }
+  stage->num_runs++;
+  stage->time_us += time_us;
+  stage->num_bytes += num_bytes;
+  stage->num_allocations += num_allocations;
+}
+
+std::vector<CodingStats::Stage> CodingStats::GetStages() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stages_;
+}
+
+bool CodingStats::GetStage(const std::string &name, int att_id,
+                           Stage *out_stage) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const Stage &stage : stages_) {
+    if (stage.att_id == att_id && stage.name == name) {
+      *out_stage = stage;
+      return true;
+    }
+  }
+  return false;
+}
+
+void CodingStats::SetAllocationCounter(AllocationCounter counter) {
+#ifdef DRACO_STATS_SUPPORTED
+  allocation_counter.store(counter, std::memory_order_relaxed);
+#endif
+}
+
+int64_t CodingStats::GetNumAllocations() {
+#ifdef DRACO_STATS_SUPPORTED
+  const AllocationCounter counter =
+      allocation_counter.load(std::memory_order_relaxed);
+  if (counter != nullptr)
+    return counter();
+#endif
+  return 0;
+}
+
+#ifdef DRACO_STATS_SUPPORTED
+void CodingStatsScope::Start() {
+  if (stats_ == nullptr)
+    return;
+  start_num_allocations_ = CodingStats::GetNumAllocations();
+  start_time_ = std::chrono::steady_clock::now();
+}
+
+CodingStatsScope::~CodingStatsScope() {
+  if (stats_ == nullptr)
+    return;
+  const int64_t time_us =
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - start_time_)
+          .count();
+  int64_t num_bytes = 0;
+  if (decoder_buffer_ != nullptr)
+    num_bytes = decoder_buffer_->data_head() - decoder_buffer_start_;
+  if (encoder_buffer_ != nullptr)
+    num_bytes = encoder_buffer_->size() - encoder_buffer_start_;
+  stats_->AddStage(name_, att_id_, time_us, num_bytes,
+                   CodingStats::GetNumAllocations() - start_num_allocations_);
+}
+#endif
+
+}  // namespace draco
@@ -0,0 +1,166 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef DRACO_CORE_CODING_STATS_H_
+#define DRACO_CORE_CODING_STATS_H_
+
+#include <cinttypes>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifdef DRACO_STATS_SUPPORTED
+#include <chrono>
+#endif
+
+#include "draco/core/decoder_buffer.h"
+#include "draco/core/encoder_buffer.h"
+
+namespace draco {
+
+// Statistics of the individual stages of encoding or decoding, such as the
+// connectivity coding or the entropy coding of each attribute. The statistics
+// are collected only when the library is built with DRACO_STATS_SUPPORTED
+// defined (cmake option ENABLE_STATS). Otherwise, no stages are ever recorded
+// and the collection code is compiled out. The layout of the class does not
+// depend on DRACO_STATS_SUPPORTED so that it can be embedded in public types
+// used by code built without the define.
+// Stages can be recorded concurrently from multiple threads.
+class CodingStats {
+ public:
+  struct Stage {
+    // Name of the stage, e.g. "connectivity".
+    std::string name;
+    // Id of the processed attribute or -1 when the stage is not specific to
+    // any attribute.
+    int att_id;
+    // Total number of times the stage was executed.
+    int64_t num_runs;
+    // Total wall time of the stage in microseconds.
+    int64_t time_us;
+    // Total number of bytes read from the decoder buffer or written to the
+    // encoder buffer by the stage.
+    int64_t num_bytes;
+    // Total number of heap allocations made while the stage was running, as
+    // reported by the counter set with SetAllocationCounter(). Only the
+    // allocations of the thread that runs the stage are included when the
+    // counter counts per thread, so allocations of worker threads used by the
+    // stage (see "num_decoding_threads") are missing. A process-wide counter
+    // also includes allocations of unrelated threads. Always 0 when no
+    // counter is set.
+    int64_t num_allocations;
+  };
+
+  CodingStats() {}
+
+  // Removes all recorded stages.
+  void Clear();
+
+  // Records one execution of stage |name|. Executions of the same stage for
+  // the same attribute are accumulated.
+  void AddStage(const char *name, int att_id, int64_t time_us,
+                int64_t num_bytes, int64_t num_allocations);
+
+  // Returns all stages in the order they were first recorded.
+  std::vector<Stage> GetStages() const;
+
+  // Finds stage |name| of attribute |att_id|. Returns false when the stage
+  // was not recorded.
+  bool GetStage(const std::string &name, int att_id, Stage *out_stage) const;
+
+  // Function that returns the number of heap allocations made so far by the
+  // calling thread.
+  typedef int64_t (*AllocationCounter)();
+
+  // Sets the function used to count the heap allocations of the stages. The
+  // library never replaces the allocator of the application, so allocations
+  // are counted only when the application installs a counter, e.g. one
+  // backed by its own replacement of the global operator new. Passing
+  // nullptr disables the counting (default).
+  static void SetAllocationCounter(AllocationCounter counter);
+
+  // Returns the value of the allocation counter, or 0 when no counter is set
+  // or when the statistics are not supported.
+  static int64_t GetNumAllocations();
+
+ private:
+  mutable std::mutex mutex_;
+  std::vector<Stage> stages_;
+};
+
+// Records a stage into CodingStats for the lifetime of the object. When
+// |stats| is nullptr or when the statistics are not supported, the object
+// does nothing.
+//
+// Usage:
+//   {
+//     CodingStatsScope scope(decoder->stats(), "connectivity", -1, buffer);
+//     DecodeConnectivity(buffer);
+//   }
+class CodingStatsScope {
+ public:
+#ifdef DRACO_STATS_SUPPORTED
+  CodingStatsScope(CodingStats *stats, const char *name, int att_id)
+      : stats_(stats),
+        name_(name),
+        att_id_(att_id),
+        decoder_buffer_(nullptr),
+        decoder_buffer_start_(nullptr),
+        encoder_buffer_(nullptr),
+        encoder_buffer_start_(0) {
+    Start();
+  }
+  // Counts the bytes read from |buffer| as the bytes of the stage.
+  CodingStatsScope(CodingStats *stats, const char *name, int att_id,
+                   const DecoderBuffer *buffer)
+      : CodingStatsScope(stats, name, att_id) {
+    decoder_buffer_ = buffer;
+    decoder_buffer_start_ = buffer->data_head();
+  }
+  // Counts the bytes written to |buffer| as the bytes of the stage.
+  CodingStatsScope(CodingStats *stats, const char *name, int att_id,
+                   const EncoderBuffer *buffer)
+      : CodingStatsScope(stats, name, att_id) {
+    encoder_buffer_ = buffer;
+    encoder_buffer_start_ = buffer->size();
+  }
+  ~CodingStatsScope();
+#else
+  CodingStatsScope(CodingStats *, const char *, int) {}
+  CodingStatsScope(CodingStats *, const char *, int, const DecoderBuffer *) {}
+  CodingStatsScope(CodingStats *, const char *, int, const EncoderBuffer *) {}
+#endif
+
+  CodingStatsScope(const CodingStatsScope &) = delete;
+  CodingStatsScope &operator=(const CodingStatsScope &) = delete;
+
+#ifdef DRACO_STATS_SUPPORTED
+ private:
+  void Start();
+
+  CodingStats *const stats_;
+  const char *const name_;
+  const int att_id_;
+  const DecoderBuffer *decoder_buffer_;
+  const char *decoder_buffer_start_;
+  const EncoderBuffer *encoder_buffer_;
+  size_t encoder_buffer_start_;
+  std::chrono::steady_clock::time_point start_time_;
+  int64_t start_num_allocations_;
+#endif
+};
+
+}  // namespace draco
+
+#endif  // DRACO_CORE_CODING_STATS_H_
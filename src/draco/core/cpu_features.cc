@@ -0,0 +1,83 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/core/cpu_features.h"
+
+#if defined(DRACO_X86_SIMD_SUPPORTED) && defined(_MSC_VER)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace draco {
+
+#if defined(DRACO_X86_SIMD_SUPPORTED) && defined(_MSC_VER)
+namespace {
+
+// Bits of the cpuid registers used by the detection below.
+constexpr int kCpuidSse41Bit = 1 << 19;     // Leaf 1, ecx.
+constexpr int kCpuidOsxsaveBit = 1 << 27;   // Leaf 1, ecx.
+constexpr int kCpuidAvxBit = 1 << 28;       // Leaf 1, ecx.
+constexpr int kCpuidAvx2Bit = 1 << 5;       // Leaf 7, ebx.
+
+bool DetectSse41() {
+  int info[4];
+  __cpuid(info, 1);
+  return (info[2] & kCpuidSse41Bit) != 0;
+}
+
+bool DetectAvx2() {
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7)
+    return false;
+  __cpuid(info, 1);
+  if ((info[2] & kCpuidOsxsaveBit) == 0 || (info[2] & kCpuidAvxBit) == 0)
+    return false;
+  // Check that the OS saves the YMM registers.
+  if ((_xgetbv(0) & 6) != 6)
+    return false;
+  __cpuidex(info, 7, 0);
+  return (info[1] & kCpuidAvx2Bit) != 0;
+}
+
+}  // namespace
+#endif
+
+bool CpuSupportsSse41() {
+#if defined(DRACO_X86_SIMD_SUPPORTED) && defined(_MSC_VER)
+  static const bool supported = DetectSse41();
+  return supported;
+#elif defined(DRACO_X86_SIMD_SUPPORTED) && \
+    (defined(__GNUC__) || defined(__clang__))
+  static const bool supported = __builtin_cpu_supports("sse4.1");
+  return supported;
+#else
+  return false;
+#endif
+}
+
+bool CpuSupportsAvx2() {
+#if defined(DRACO_X86_SIMD_SUPPORTED) && defined(_MSC_VER)
+  static const bool supported = DetectAvx2();
+  return supported;
+#elif defined(DRACO_X86_SIMD_SUPPORTED) && \
+    (defined(__GNUC__) || defined(__clang__))
+  static const bool supported = __builtin_cpu_supports("avx2");
+  return supported;
+#else
+  return false;
+#endif
+}
+
+}  // namespace draco
@@ -0,0 +1,47 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef DRACO_CORE_CPU_FEATURES_H_
+#define DRACO_CORE_CPU_FEATURES_H_
+
+// Helpers for selecting SIMD code paths at runtime. The SIMD kernels are
+// compiled for the specific instruction sets using the
+// DRACO_TARGET_ATTRIBUTE() macro so that the rest of the library can be built
+// for the baseline architecture.
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || \
+    defined(_M_IX86)
+#define DRACO_X86_SIMD_SUPPORTED
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define DRACO_NEON_SUPPORTED
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define DRACO_TARGET_ATTRIBUTE(isa) __attribute__((target(isa)))
+#else
+#define DRACO_TARGET_ATTRIBUTE(isa)
+#endif
+
+namespace draco {
+
+// Returns true when the host CPU (and OS) supports the given instruction set.
+// Always returns false on non-x86 architectures.
+bool CpuSupportsSse41();
+bool CpuSupportsAvx2();
+
+}  // namespace draco
+
+#endif  // DRACO_CORE_CPU_FEATURES_H_
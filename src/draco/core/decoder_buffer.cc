@@ -24,7 +24,8 @@ DecoderBuffer::DecoderBuffer()
       data_size_(0),
       pos_(0),
       bit_mode_(false),
-      bitstream_version_(0) {}
+      bitstream_version_(0),
+      arena_(nullptr) {}
 
 void DecoderBuffer::Init(const char *data, size_t data_size) {
   Init(data, data_size, bitstream_version_);
@@ -63,7 +64,12 @@ void DecoderBuffer::EndBitDecoding() {
 }
 
 DecoderBuffer::BitDecoder::BitDecoder()
-    : bit_buffer_(nullptr), bit_buffer_end_(nullptr), bit_offset_(0) {}
+    : bit_buffer_(nullptr),
+      bit_buffer_end_(nullptr),
+      bit_offset_(0),
+      next_byte_(nullptr),
+      cache_(0),
+      cache_bits_(0) {}
 
 DecoderBuffer::BitDecoder::~BitDecoder() {}
 
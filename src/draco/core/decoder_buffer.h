@@ -23,6 +23,8 @@
 
 namespace draco {
 
+class Arena;
+
 // Class is a wrapper around input data used by MeshDecoder. It provides a
 // basic interface for decoding either typed or variable-bit sized data.
 class DecoderBuffer {
@@ -113,8 +115,20 @@ class DecoderBuffer {
   // Returns the bitstream associated with the data. Returns 0 if unknown.
   uint16_t bitstream_version() const { return bitstream_version_; }
 
+  // Sets the arena used for scratch memory of decoders reading from this
+  // buffer, or nullptr to allocate the scratch memory on the heap. The arena is
+  // kept by Init() and it is shared with all copies of the buffer. Only data
+  // that does not outlive the decoding can be allocated from the arena and the
+  // arena is used only while the input data is being read, which never happens
+  // concurrently.
+  void set_arena(Arena *arena) { arena_ = arena; }
+  Arena *arena() const { return arena_; }
+
  private:
-  // Internal helper class to decode bits from a bit buffer.
+  // Internal helper class to decode bits from a bit buffer. The bits are read
+  // through a 64-bit cache that is refilled with whole words from the bit
+  // buffer, so that up to 32 bits can be extracted with a single shift and
+  // mask. Reading past the end of the bit buffer returns zero bits.
   class BitDecoder {
    public:
     BitDecoder();
@@ -125,6 +139,9 @@ class DecoderBuffer {
       bit_offset_ = 0;
       bit_buffer_ = static_cast<const uint8_t *>(b);
       bit_buffer_end_ = bit_buffer_ + s;
+      next_byte_ = bit_buffer_;
+      cache_ = 0;
+      cache_bits_ = 0;
     }
 
     // Returns number of bits decoded so far.
@@ -140,56 +157,74 @@ class DecoderBuffer {
     inline uint32_t EnsureBits(int k) {
       DCHECK_LE(k, 24);
       DCHECK_LE(static_cast<uint64_t>(k), AvailBits());
-
-      uint32_t buf = 0;
-      for (int i = 0; i < k; ++i) {
-        buf |= PeekBit(i) << i;
-      }
-      return buf;  // Okay to return extra bits
+      if (cache_bits_ < k)
+        Refill();
+      return static_cast<uint32_t>(cache_ & LowBitsMask(k));
     }
 
-    inline void ConsumeBits(int k) { bit_offset_ += k; }
+    inline void ConsumeBits(int k) {
+      cache_ >>= k;
+      cache_bits_ -= k;
+      AdvanceBitOffset(k);
+    }
 
     // Returns |nbits| bits in |x|.
     inline bool GetBits(int32_t nbits, uint32_t *x) {
       DCHECK_GE(nbits, 0);
       DCHECK_LE(nbits, 32);
-      uint32_t value = 0;
-      for (int32_t bit = 0; bit < nbits; ++bit)
-        value |= GetBit() << bit;
-      *x = value;
+      if (cache_bits_ < nbits)
+        Refill();
+      *x = static_cast<uint32_t>(cache_ & LowBitsMask(nbits));
+      cache_ >>= nbits;
+      cache_bits_ -= nbits;
+      AdvanceBitOffset(nbits);
       return true;
     }
 
    private:
-    // TODO(fgalligan): Add support for error reporting on range check.
-    // Returns one bit from the bit buffer.
-    inline int GetBit() {
-      const size_t off = bit_offset_;
-      const size_t byte_offset = off >> 3;
-      const int bit_shift = static_cast<int>(off & 0x7);
-      if (bit_buffer_ + byte_offset < bit_buffer_end_) {
-        const int bit = (bit_buffer_[byte_offset] >> bit_shift) & 1;
-        bit_offset_ = off + 1;
-        return bit;
-      }
-      return 0;
+    static inline uint64_t LowBitsMask(int nbits) {
+      return (static_cast<uint64_t>(1) << nbits) - 1;
     }
 
-    inline int PeekBit(int offset) {
-      const size_t off = bit_offset_ + offset;
-      const size_t byte_offset = off >> 3;
-      const int bit_shift = static_cast<int>(off & 0x7);
-      if (bit_buffer_ + byte_offset < bit_buffer_end_) {
-        const int bit = (bit_buffer_[byte_offset] >> bit_shift) & 1;
-        return bit;
+    // Tops up the cache to at least 56 valid bits. Bits of |cache_| above
+    // |cache_bits_| are always either zero or equal to the upcoming bits of
+    // the buffer, so whole words can be ORed into the cache.
+    inline void Refill() {
+      if (bit_buffer_end_ - next_byte_ >= 8) {
+        uint64_t word;
+        memcpy(&word, next_byte_, sizeof(word));
+        cache_ |= word << cache_bits_;
+        const int num_bytes = (63 - cache_bits_) >> 3;
+        next_byte_ += num_bytes;
+        cache_bits_ += num_bytes * 8;
+        return;
+      }
+      // Close to the end of the buffer. Bytes past the end are zero.
+      while (cache_bits_ <= 56) {
+        if (next_byte_ < bit_buffer_end_) {
+          cache_ |= static_cast<uint64_t>(*next_byte_++) << cache_bits_;
+        }
+        cache_bits_ += 8;
       }
-      return 0;
+    }
+
+    // TODO(fgalligan): Add support for error reporting on range check.
+    // Bits decoded past the end of the buffer are not counted.
+    inline void AdvanceBitOffset(int nbits) {
+      const size_t buffer_bits = (bit_buffer_end_ - bit_buffer_) * 8;
+      bit_offset_ += nbits;
+      if (bit_offset_ > buffer_bits)
+        bit_offset_ = buffer_bits;
     }
 
     const uint8_t *bit_buffer_;
     const uint8_t *bit_buffer_end_;
     size_t bit_offset_;
+    // Next byte of the bit buffer that is going to be loaded into the cache.
+    const uint8_t *next_byte_;
+    // Cached bits that were loaded from the buffer but not decoded yet.
+    uint64_t cache_;
+    int cache_bits_;
   };
   friend class BufferBitCodingTest;
 
@@ -201,6 +236,7 @@ class DecoderBuffer {
   BitDecoder bit_decoder_;
   bool bit_mode_;
   uint16_t bitstream_version_;
+  Arena *arena_;
 };
 
 }  // namespace draco
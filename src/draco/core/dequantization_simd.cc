@@ -0,0 +1,169 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/core/dequantization_simd.h"
+
+#include "draco/core/cpu_features.h"
+
+#if defined(DRACO_X86_SIMD_SUPPORTED)
+#include <immintrin.h>
+#endif
+#if defined(DRACO_NEON_SUPPORTED)
+#include <arm_neon.h>
+#endif
+
+// All kernels below mirror Dequantizer::DequantizeFloat(). The scalar code
+// converts the absolute value of the input and restores the sign after the
+// multiplication by the quantization factor. Because the rounding of the
+// conversion and of the multiplication is symmetric, the same result is
+// obtained by flipping the sign bit of the product, which also keeps the
+// behavior for INT32_MIN whose absolute value is not representable. The
+// multiplications by the factor and by the range must not be merged and the
+// addition of the origin must not be fused with the multiplication, otherwise
+// the results would differ from the scalar code in the last bit.
+//
+// The input values are interleaved, so one group of N entries (where N is the
+// number of SIMD lanes) covers exactly |num_components| registers and the
+// origins of all groups can be loaded from the same pattern.
+
+namespace draco {
+
+namespace {
+
+// Maximum number of components supported by the kernels.
+constexpr int kMaxNumComponents = 4;
+
+// Fills |pattern| with the |num_components| origins repeated |num_lanes|
+// times.
+void FillOriginPattern(const float *origin, int num_components,
+                       int num_lanes, float *pattern) {
+  for (int i = 0; i < num_lanes * num_components; ++i) {
+    pattern[i] = origin[i % num_components];
+  }
+}
+
+#if defined(DRACO_X86_SIMD_SUPPORTED)
+
+DRACO_TARGET_ATTRIBUTE("sse4.1")
+int DequantizeFloatsSse41(const int32_t *in, int num_entries,
+                          int num_components, float max_quantized_value_factor,
+                          float range, const float *origin, float *out) {
+  alignas(16) float pattern[4 * kMaxNumComponents];
+  FillOriginPattern(origin, num_components, 4, pattern);
+  const __m128 factor = _mm_set1_ps(max_quantized_value_factor);
+  const __m128 range_vec = _mm_set1_ps(range);
+  const __m128i sign_mask = _mm_set1_epi32(INT32_MIN);
+  const int num_groups = num_entries / 4;
+  for (int g = 0; g < num_groups; ++g) {
+    for (int c = 0; c < num_components; ++c) {
+      const __m128i val =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(in));
+      const __m128i sign = _mm_and_si128(val, sign_mask);
+      __m128 norm_value =
+          _mm_mul_ps(_mm_cvtepi32_ps(_mm_abs_epi32(val)), factor);
+      norm_value = _mm_xor_ps(norm_value, _mm_castsi128_ps(sign));
+      _mm_storeu_ps(out, _mm_add_ps(_mm_mul_ps(norm_value, range_vec),
+                                    _mm_load_ps(pattern + 4 * c)));
+      in += 4;
+      out += 4;
+    }
+  }
+  return num_groups * 4;
+}
+
+DRACO_TARGET_ATTRIBUTE("avx2")
+int DequantizeFloatsAvx2(const int32_t *in, int num_entries,
+                         int num_components, float max_quantized_value_factor,
+                         float range, const float *origin, float *out) {
+  alignas(32) float pattern[8 * kMaxNumComponents];
+  FillOriginPattern(origin, num_components, 8, pattern);
+  const __m256 factor = _mm256_set1_ps(max_quantized_value_factor);
+  const __m256 range_vec = _mm256_set1_ps(range);
+  const __m256i sign_mask = _mm256_set1_epi32(INT32_MIN);
+  const int num_groups = num_entries / 8;
+  for (int g = 0; g < num_groups; ++g) {
+    for (int c = 0; c < num_components; ++c) {
+      const __m256i val =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in));
+      const __m256i sign = _mm256_and_si256(val, sign_mask);
+      __m256 norm_value =
+          _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_abs_epi32(val)), factor);
+      norm_value = _mm256_xor_ps(norm_value, _mm256_castsi256_ps(sign));
+      _mm256_storeu_ps(out,
+                       _mm256_add_ps(_mm256_mul_ps(norm_value, range_vec),
+                                     _mm256_load_ps(pattern + 8 * c)));
+      in += 8;
+      out += 8;
+    }
+  }
+  return num_groups * 8;
+}
+
+#endif  // DRACO_X86_SIMD_SUPPORTED
+
+#if defined(DRACO_NEON_SUPPORTED)
+
+int DequantizeFloatsNeon(const int32_t *in, int num_entries,
+                         int num_components, float max_quantized_value_factor,
+                         float range, const float *origin, float *out) {
+  float pattern[4 * kMaxNumComponents];
+  FillOriginPattern(origin, num_components, 4, pattern);
+  const float32x4_t factor = vdupq_n_f32(max_quantized_value_factor);
+  const float32x4_t range_vec = vdupq_n_f32(range);
+  const uint32x4_t sign_mask = vdupq_n_u32(0x80000000u);
+  const int num_groups = num_entries / 4;
+  for (int g = 0; g < num_groups; ++g) {
+    for (int c = 0; c < num_components; ++c) {
+      const int32x4_t val = vld1q_s32(in);
+      const uint32x4_t sign = vandq_u32(vreinterpretq_u32_s32(val), sign_mask);
+      const float32x4_t norm_value =
+          vmulq_f32(vcvtq_f32_s32(vabsq_s32(val)), factor);
+      const float32x4_t signed_value = vreinterpretq_f32_u32(
+          veorq_u32(vreinterpretq_u32_f32(norm_value), sign));
+      vst1q_f32(out, vaddq_f32(vmulq_f32(signed_value, range_vec),
+                               vld1q_f32(pattern + 4 * c)));
+      in += 4;
+      out += 4;
+    }
+  }
+  return num_groups * 4;
+}
+
+#endif  // DRACO_NEON_SUPPORTED
+
+}  // namespace
+
+int DequantizeFloatsSimd(const int32_t *in, int num_entries,
+                         int num_components, float max_quantized_value_factor,
+                         float range, const float *origin, float *out) {
+  if (num_components <= 0 || num_components > kMaxNumComponents)
+    return 0;
+#if defined(DRACO_X86_SIMD_SUPPORTED)
+  if (CpuSupportsAvx2()) {
+    return DequantizeFloatsAvx2(in, num_entries, num_components,
+                                max_quantized_value_factor, range, origin, out);
+  }
+  if (CpuSupportsSse41()) {
+    return DequantizeFloatsSse41(in, num_entries, num_components,
+                                 max_quantized_value_factor, range, origin,
+                                 out);
+  }
+#elif defined(DRACO_NEON_SUPPORTED)
+  return DequantizeFloatsNeon(in, num_entries, num_components,
+                              max_quantized_value_factor, range, origin, out);
+#endif
+  return 0;
+}
+
+}  // namespace draco
@@ -0,0 +1,39 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef DRACO_CORE_DEQUANTIZATION_SIMD_H_
+#define DRACO_CORE_DEQUANTIZATION_SIMD_H_
+
+#include <stdint.h>
+
+namespace draco {
+
+// Dequantizes up to |num_entries| entries of |num_components| interleaved
+// quantized values |in| into |out| using the SIMD instructions supported by
+// the host CPU. Each output value is computed the same way as
+// Dequantizer::DequantizeFloat() with the given |max_quantized_value_factor|
+// and |range|, followed by the addition of the per-component |origin|.
+//
+// Only whole groups of entries that fit into the SIMD registers are processed
+// and the rest needs to be dequantized by the scalar code. Returns the number
+// of dequantized entries, which is 0 when there is no SIMD implementation for
+// the given number of components or for the host CPU. The output values are
+// always bit-exact with the output of the scalar code.
+int DequantizeFloatsSimd(const int32_t *in, int num_entries,
+                         int num_components, float max_quantized_value_factor,
+                         float range, const float *origin, float *out);
+
+}  // namespace draco
+
+#endif  // DRACO_CORE_DEQUANTIZATION_SIMD_H_
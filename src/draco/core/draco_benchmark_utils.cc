@@ -0,0 +1,114 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/core/draco_benchmark_utils.h"
+
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <random>
+
+#include "draco/core/vector_d.h"
+#include "testing/draco_test_config.h"
+
+namespace draco {
+
+namespace {
+static constexpr char kTestDataDir[] = DRACO_TEST_DATA_DIR;
+
+// Returns the height of the grid surface at the grid coordinates |x|, |y|.
+float GetGridHeight(float x, float y) {
+  return 4.f * std::sin(x * 0.05f) * std::cos(y * 0.07f);
+}
+}  // namespace
+
+std::string GetBenchmarkFileFullPath(const std::string &file_name) {
+  return std::string(kTestDataDir) + std::string("/") + file_name;
+}
+
+std::vector<char> ReadBenchmarkFile(const std::string &file_name) {
+  std::ifstream file(GetBenchmarkFileFullPath(file_name), std::ios::binary);
+  if (!file)
+    return std::vector<char>();
+  return std::vector<char>(std::istreambuf_iterator<char>(file),
+                           std::istreambuf_iterator<char>());
+}
+
+std::unique_ptr<Mesh> CreateGridMesh(int grid_size) {
+  std::unique_ptr<Mesh> mesh(new Mesh());
+  const int row_size = grid_size + 1;
+  const int num_points = row_size * row_size;
+  mesh->set_num_points(num_points);
+
+  GeometryAttribute va;
+  va.Init(GeometryAttribute::POSITION, nullptr, 3, DT_FLOAT32, false,
+          sizeof(float) * 3, 0);
+  PointAttribute *const pos_att =
+      mesh->attribute(mesh->AddAttribute(va, true, num_points));
+  va.Init(GeometryAttribute::NORMAL, nullptr, 3, DT_FLOAT32, false,
+          sizeof(float) * 3, 0);
+  PointAttribute *const norm_att =
+      mesh->attribute(mesh->AddAttribute(va, true, num_points));
+  va.Init(GeometryAttribute::TEX_COORD, nullptr, 2, DT_FLOAT32, false,
+          sizeof(float) * 2, 0);
+  PointAttribute *const tex_att =
+      mesh->attribute(mesh->AddAttribute(va, true, num_points));
+
+  for (int y = 0; y < row_size; ++y) {
+    for (int x = 0; x < row_size; ++x) {
+      const AttributeValueIndex avi(y * row_size + x);
+      const Vector3f pos(static_cast<float>(x), static_cast<float>(y),
+                         GetGridHeight(x, y));
+      pos_att->SetAttributeValue(avi, &pos[0]);
+      // Normal computed from the central differences of the height field.
+      Vector3f normal(GetGridHeight(x - 1, y) - GetGridHeight(x + 1, y),
+                      GetGridHeight(x, y - 1) - GetGridHeight(x, y + 1), 2.f);
+      normal.Normalize();
+      norm_att->SetAttributeValue(avi, &normal[0]);
+      const float tex_coord[2] = {static_cast<float>(x) / grid_size,
+                                  static_cast<float>(y) / grid_size};
+      tex_att->SetAttributeValue(avi, tex_coord);
+    }
+  }
+
+  for (int y = 0; y < grid_size; ++y) {
+    for (int x = 0; x < grid_size; ++x) {
+      const PointIndex p(y * row_size + x);
+      const PointIndex p_right = p + 1;
+      const PointIndex p_up = p + row_size;
+      const PointIndex p_diag = p + row_size + 1;
+      mesh->AddFace({{p, p_right, p_diag}});
+      mesh->AddFace({{p, p_diag, p_up}});
+    }
+  }
+  return mesh;
+}
+
+std::vector<uint32_t> CreateSymbols(int num_values, int max_bit_length) {
+  std::mt19937 generator(13);
+  std::vector<uint32_t> symbols(num_values);
+  for (int i = 0; i < num_values; ++i) {
+    // Each additional bit of the symbol is used with probability 1/2.
+    uint32_t r = generator();
+    int bit_length = 0;
+    while (bit_length < max_bit_length && (r & 1)) {
+      ++bit_length;
+      r >>= 1;
+    }
+    symbols[i] = generator() & ((1u << bit_length) - 1);
+  }
+  return symbols;
+}
+
+}  // namespace draco
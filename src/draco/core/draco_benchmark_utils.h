@@ -0,0 +1,47 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef DRACO_CORE_DRACO_BENCHMARK_UTILS_H_
+#define DRACO_CORE_DRACO_BENCHMARK_UTILS_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "draco/mesh/mesh.h"
+
+namespace draco {
+
+// Returns the full path to a given file in the test data directory.
+std::string GetBenchmarkFileFullPath(const std::string &file_name);
+
+// Returns the content of a given file in the test data directory or an empty
+// vector when the file can't be read.
+std::vector<char> ReadBenchmarkFile(const std::string &file_name);
+
+// Creates a mesh of a regular grid with |grid_size| x |grid_size| cells, each
+// split into two triangles. The grid is displaced into a smooth wave so that
+// the mesh has float positions, normals and texture coordinates that behave
+// like the data of a scanned surface. One grid cell has unit size.
+std::unique_ptr<Mesh> CreateGridMesh(int grid_size);
+
+// Returns |num_values| pseudo-random symbols with a roughly geometric
+// distribution, which is typical for prediction corrections. All symbols are
+// smaller than 2^|max_bit_length|. The same sequence is returned for the same
+// input.
+std::vector<uint32_t> CreateSymbols(int num_values, int max_bit_length);
+
+}  // namespace draco
+
+#endif  // DRACO_CORE_DRACO_BENCHMARK_UTILS_H_
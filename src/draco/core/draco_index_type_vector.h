@@ -49,6 +49,7 @@ class IndexTypeVector {
   }
 
   size_t size() const { return vector_.size(); }
+  size_t capacity() const { return vector_.capacity(); }
 
   void push_back(const ValueTypeT &val) { vector_.push_back(val); }
   void push_back(ValueTypeT &&val) { vector_.push_back(std::move(val)); }
@@ -83,12 +83,30 @@ class EncoderBuffer {
     // |data| is the buffer to write the bits into.
     explicit BitEncoder(char *data) : bit_buffer_(data), bit_offset_(0) {}
 
-    // Write |nbits| of |data| into the bit buffer.
+    // Write |nbits| of |data| into the bit buffer. All bits are written in a
+    // single pass over the at most five affected bytes.
     void PutBits(uint32_t data, int32_t nbits) {
       DCHECK_GE(nbits, 0);
       DCHECK_LE(nbits, 32);
-      for (int32_t bit = 0; bit < nbits; ++bit)
-        PutBit((data >> bit) & 1);
+      if (nbits == 0)
+        return;
+      const uint64_t off = static_cast<uint64_t>(bit_offset_);
+      const uint64_t byte_offset = off >> 3;
+      const int bit_shift = off & 7;
+      uint8_t *const dst =
+          reinterpret_cast<uint8_t *>(bit_buffer_) + byte_offset;
+
+      // Merge the new bits with the already encoded bits of the first byte.
+      const uint64_t value_mask = (static_cast<uint64_t>(1) << nbits) - 1;
+      uint64_t word = (static_cast<uint64_t>(data) & value_mask) << bit_shift;
+      word |= dst[0] & ((1u << bit_shift) - 1);
+
+      const int num_bytes = (bit_shift + nbits + 7) >> 3;
+      for (int i = 0; i < num_bytes; ++i) {
+        dst[i] = static_cast<uint8_t>(word);
+        word >>= 8;
+      }
+      bit_offset_ += nbits;
     }
 
     // Return number of bits encoded so far.
@@ -105,21 +123,6 @@ class EncoderBuffer {
     }
 
    private:
-    void PutBit(uint8_t value) {
-      const int byte_size = 8;
-      const uint64_t off = static_cast<uint64_t>(bit_offset_);
-      const uint64_t byte_offset = off / byte_size;
-      const int bit_shift = off % byte_size;
-
-      // TODO(fgalligan): Check performance if we add a branch and only do one
-      // memory write if bit_shift is 7. Also try using a temporary variable to
-      // hold the bits before writing to the buffer.
-
-      bit_buffer_[byte_offset] &= ~(1 << bit_shift);
-      bit_buffer_[byte_offset] |= value << bit_shift;
-      bit_offset_++;
-    }
-
     char *bit_buffer_;
     size_t bit_offset_;
   };
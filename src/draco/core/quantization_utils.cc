@@ -14,6 +14,8 @@
 //
 #include "draco/core/quantization_utils.h"
 
+#include "draco/core/dequantization_simd.h"
+
 namespace draco {
 
 Quantizer::Quantizer() : range_(1.f), max_quantized_value_(1) {}
@@ -33,4 +35,20 @@ bool Dequantizer::Init(float range, int32_t max_quantized_value) {
   return true;
 }
 
+void Dequantizer::DequantizeValues(const int32_t *in, int num_entries,
+                                   int num_components, const float *origin,
+                                   float *out) const {
+  const int num_simd_entries =
+      DequantizeFloatsSimd(in, num_entries, num_components,
+                           max_quantized_value_factor_, range_, origin, out);
+  const int num_simd_values = num_simd_entries * num_components;
+  in += num_simd_values;
+  out += num_simd_values;
+  for (int i = num_simd_entries; i < num_entries; ++i) {
+    for (int c = 0; c < num_components; ++c) {
+      *out++ = DequantizeFloat(*in++) + origin[c];
+    }
+  }
+}
+
 }  // namespace draco
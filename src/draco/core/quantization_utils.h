@@ -76,6 +76,14 @@ class Dequantizer {
   }
   inline float operator()(int32_t val) const { return DequantizeFloat(val); }
 
+  // Dequantizes |num_entries| entries of |num_components| interleaved values
+  // stored in |in| and adds the per-component |origin| to them. The results
+  // are written to |out| and they are identical to the values computed by
+  // DequantizeFloat(in[i]) + origin[c]. Uses SIMD instructions when they are
+  // supported by the host CPU.
+  void DequantizeValues(const int32_t *in, int num_entries, int num_components,
+                        const float *origin, float *out) const;
+
  private:
   float range_;
   // Distance between two normalized dequantized values.
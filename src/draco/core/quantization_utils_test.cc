@@ -14,6 +14,8 @@
 //
 #include "draco/core/quantization_utils.h"
 
+#include <vector>
+
 #include "draco/core/draco_test_base.h"
 
 namespace draco {
@@ -53,4 +55,29 @@ TEST_F(QuantizationUtilsTest, TestDequantizer) {
   ASSERT_FALSE(dequantizer.Init(1.f, -4));
 }
 
+TEST_F(QuantizationUtilsTest, TestDequantizeValues) {
+  // Test that the bulk dequantization produces the same results as the scalar
+  // dequantization for various numbers of entries and components.
+  Dequantizer dequantizer;
+  ASSERT_TRUE(dequantizer.Init(17.3f, (1 << 14) - 1));
+  const float origin[5] = {-3.7f, 0.f, 1.1f, 1000.25f, -0.001f};
+  for (int num_components = 1; num_components <= 5; ++num_components) {
+    for (int num_entries = 0; num_entries < 40; ++num_entries) {
+      const int num_values = num_entries * num_components;
+      std::vector<int32_t> in(num_values);
+      for (int i = 0; i < num_values; ++i) {
+        // Mix of positive and negative values including the extremes.
+        in[i] = ((i * 7919) % ((1 << 15) - 1)) - ((1 << 14) - 1);
+      }
+      std::vector<float> out(num_values);
+      dequantizer.DequantizeValues(in.data(), num_entries, num_components,
+                                   origin, out.data());
+      for (int i = 0; i < num_values; ++i) {
+        ASSERT_EQ(out[i], dequantizer.DequantizeFloat(in[i]) +
+                              origin[i % num_components]);
+      }
+    }
+  }
+}
+
 }  // namespace draco
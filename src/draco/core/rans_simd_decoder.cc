@@ -0,0 +1,217 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/core/rans_simd_decoder.h"
+
+#include "draco/core/ans.h"
+#include "draco/core/cpu_features.h"
+
+#if defined(DRACO_X86_SIMD_SUPPORTED)
+#include <smmintrin.h>
+#endif
+#if defined(DRACO_NEON_SUPPORTED)
+#include <arm_neon.h>
+#endif
+
+// All kernels below mirror RAnsDecoder::rans_read(). The renormalization of a
+// state reads bytes from the end of the buffer until the state is at least
+// |l_rans_base|. Because |l_rans_base| is a multiple of 2^14 and every decoded
+// state is at least 4, the number of bytes needed by a state (0-3) can be
+// computed up front by comparing the state against |l_rans_base|,
+// |l_rans_base| / 2^8 and |l_rans_base| / 2^16. The k bytes read by the scalar
+// decoder then form a little endian number that starts k bytes before the
+// current buffer offset. The states consume the bytes in their order, so the
+// offsets of the states are given by a prefix sum of their byte counts.
+// As long as at least 3 bytes per state are available, the renormalization can
+// never run out of data, which is the only case where the scalar decoder
+// behaves differently.
+
+namespace draco {
+
+namespace {
+
+#if defined(DRACO_X86_SIMD_SUPPORTED)
+
+DRACO_TARGET_ATTRIBUTE("sse4.1")
+uint32_t DecodeRoundsSse41(int num_states, int rans_precision_bits,
+                           const uint32_t *lut_table,
+                           const rans_sym *probability_table,
+                           const uint8_t *buf, int *buf_offset,
+                           uint32_t *states, uint32_t num_rounds,
+                           uint32_t *out_values) {
+  const uint32_t l_rans_base = 4u << rans_precision_bits;
+  const __m128i base_0 = _mm_set1_epi32(l_rans_base);
+  const __m128i base_1 = _mm_set1_epi32(l_rans_base >> 8);
+  const __m128i base_2 = _mm_set1_epi32(l_rans_base >> 16);
+  const __m128i one = _mm_set1_epi32(1);
+  const __m128i mult_1 = _mm_set1_epi32(1 << 8);
+  const __m128i mult_2 = _mm_set1_epi32(1 << 16);
+  const __m128i mult_3 = _mm_set1_epi32(1 << 24);
+  const __m128i rem_mask = _mm_set1_epi32((1 << rans_precision_bits) - 1);
+  const __m128i precision_shift = _mm_cvtsi32_si128(rans_precision_bits);
+  alignas(16) uint32_t lane_values[4];
+  alignas(16) uint32_t lane_probs[4];
+  alignas(16) uint32_t lane_cum_probs[4];
+  int offset = *buf_offset;
+  uint32_t round = 0;
+  for (; round < num_rounds; ++round) {
+    if (offset < 3 * num_states)
+      break;
+    // Process the states in groups of four. The groups are independent, so
+    // the CPU can overlap their decoding.
+    for (int g = 0; g < num_states; g += 4) {
+      __m128i x =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(states + g));
+      const __m128i m_0 = _mm_cmpgt_epi32(base_0, x);
+      const __m128i m_1 = _mm_cmpgt_epi32(base_1, x);
+      const __m128i m_2 = _mm_cmpgt_epi32(base_2, x);
+      __m128i mult = _mm_blendv_epi8(one, mult_1, m_0);
+      mult = _mm_blendv_epi8(mult, mult_2, m_1);
+      mult = _mm_blendv_epi8(mult, mult_3, m_2);
+      const __m128i num_bytes = _mm_sub_epi32(
+          _mm_setzero_si128(), _mm_add_epi32(_mm_add_epi32(m_0, m_1), m_2));
+      _mm_store_si128(reinterpret_cast<__m128i *>(lane_values), num_bytes);
+      for (int s = 0; s < 4; ++s) {
+        offset -= lane_values[s];
+        lane_values[s] = mem_get_le32(buf + offset);
+      }
+      const __m128i words =
+          _mm_load_si128(reinterpret_cast<__m128i *>(lane_values));
+      const __m128i bytes = _mm_and_si128(words, _mm_sub_epi32(mult, one));
+      x = _mm_add_epi32(_mm_mullo_epi32(x, mult), bytes);
+
+      // Decode the symbols.
+      const __m128i rem = _mm_and_si128(x, rem_mask);
+      const __m128i quo = _mm_srl_epi32(x, precision_shift);
+      _mm_store_si128(reinterpret_cast<__m128i *>(lane_values), rem);
+      for (int s = 0; s < 4; ++s) {
+        const uint32_t symbol = lut_table[lane_values[s]];
+        lane_values[s] = symbol;
+        lane_probs[s] = probability_table[symbol].prob;
+        lane_cum_probs[s] = probability_table[symbol].cum_prob;
+      }
+      const __m128i prob =
+          _mm_load_si128(reinterpret_cast<__m128i *>(lane_probs));
+      const __m128i cum_prob =
+          _mm_load_si128(reinterpret_cast<__m128i *>(lane_cum_probs));
+      x = _mm_add_epi32(_mm_mullo_epi32(quo, prob),
+                        _mm_sub_epi32(rem, cum_prob));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(states + g), x);
+      _mm_storeu_si128(
+          reinterpret_cast<__m128i *>(out_values + round * num_states + g),
+          _mm_load_si128(reinterpret_cast<__m128i *>(lane_values)));
+    }
+  }
+  *buf_offset = offset;
+  return round;
+}
+
+#endif  // DRACO_X86_SIMD_SUPPORTED
+
+#if defined(DRACO_NEON_SUPPORTED)
+
+uint32_t DecodeRoundsNeon(int num_states, int rans_precision_bits,
+                          const uint32_t *lut_table,
+                          const rans_sym *probability_table,
+                          const uint8_t *buf, int *buf_offset,
+                          uint32_t *states, uint32_t num_rounds,
+                          uint32_t *out_values) {
+  const uint32_t l_rans_base = 4u << rans_precision_bits;
+  const uint32x4_t base_0 = vdupq_n_u32(l_rans_base);
+  const uint32x4_t base_1 = vdupq_n_u32(l_rans_base >> 8);
+  const uint32x4_t base_2 = vdupq_n_u32(l_rans_base >> 16);
+  const uint32x4_t one = vdupq_n_u32(1);
+  const uint32x4_t mult_1 = vdupq_n_u32(1 << 8);
+  const uint32x4_t mult_2 = vdupq_n_u32(1 << 16);
+  const uint32x4_t mult_3 = vdupq_n_u32(1 << 24);
+  const uint32x4_t rem_mask = vdupq_n_u32((1 << rans_precision_bits) - 1);
+  const int32x4_t precision_shift = vdupq_n_s32(-rans_precision_bits);
+  uint32_t lane_values[4];
+  uint32_t lane_probs[4];
+  uint32_t lane_cum_probs[4];
+  int offset = *buf_offset;
+  uint32_t round = 0;
+  for (; round < num_rounds; ++round) {
+    if (offset < 3 * num_states)
+      break;
+    // Process the states in groups of four.
+    for (int g = 0; g < num_states; g += 4) {
+      uint32x4_t x = vld1q_u32(states + g);
+      const uint32x4_t m_0 = vcltq_u32(x, base_0);
+      const uint32x4_t m_1 = vcltq_u32(x, base_1);
+      const uint32x4_t m_2 = vcltq_u32(x, base_2);
+      uint32x4_t mult = vbslq_u32(m_0, mult_1, one);
+      mult = vbslq_u32(m_1, mult_2, mult);
+      mult = vbslq_u32(m_2, mult_3, mult);
+      const uint32x4_t num_bytes =
+          vsubq_u32(vdupq_n_u32(0), vaddq_u32(vaddq_u32(m_0, m_1), m_2));
+      vst1q_u32(lane_values, num_bytes);
+      for (int s = 0; s < 4; ++s) {
+        offset -= lane_values[s];
+        lane_values[s] = mem_get_le32(buf + offset);
+      }
+      const uint32x4_t bytes =
+          vandq_u32(vld1q_u32(lane_values), vsubq_u32(mult, one));
+      x = vmlaq_u32(bytes, x, mult);
+
+      // Decode the symbols.
+      const uint32x4_t rem = vandq_u32(x, rem_mask);
+      const uint32x4_t quo = vshlq_u32(x, precision_shift);
+      vst1q_u32(lane_values, rem);
+      for (int s = 0; s < 4; ++s) {
+        const uint32_t symbol = lut_table[lane_values[s]];
+        lane_values[s] = symbol;
+        lane_probs[s] = probability_table[symbol].prob;
+        lane_cum_probs[s] = probability_table[symbol].cum_prob;
+      }
+      x = vmlaq_u32(vsubq_u32(rem, vld1q_u32(lane_cum_probs)), quo,
+                    vld1q_u32(lane_probs));
+      vst1q_u32(states + g, x);
+      vst1q_u32(out_values + round * num_states + g, vld1q_u32(lane_values));
+    }
+  }
+  *buf_offset = offset;
+  return round;
+}
+
+#endif  // DRACO_NEON_SUPPORTED
+
+}  // namespace
+
+uint32_t RAnsDecodeRoundsSimd(int num_states, int rans_precision_bits,
+                              const uint32_t *lut_table,
+                              const rans_sym *probability_table,
+                              const uint8_t *buf, int *buf_offset,
+                              uint32_t *states, uint32_t num_rounds,
+                              uint32_t *out_values) {
+  if (num_states % 4 != 0)
+    return 0;
+#if defined(DRACO_X86_SIMD_SUPPORTED)
+  // Note that an AVX2 kernel processing eight states at once (with or without
+  // the gather instructions) was measured to be slower than two interleaved
+  // groups of four states processed by the SSE4.1 kernel.
+  if (CpuSupportsSse41()) {
+    return DecodeRoundsSse41(num_states, rans_precision_bits, lut_table,
+                             probability_table, buf, buf_offset, states,
+                             num_rounds, out_values);
+  }
+#elif defined(DRACO_NEON_SUPPORTED)
+  return DecodeRoundsNeon(num_states, rans_precision_bits, lut_table,
+                          probability_table, buf, buf_offset, states,
+                          num_rounds, out_values);
+#endif
+  return 0;
+}
+
+}  // namespace draco
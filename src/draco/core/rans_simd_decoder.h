@@ -0,0 +1,47 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef DRACO_CORE_RANS_SIMD_DECODER_H_
+#define DRACO_CORE_RANS_SIMD_DECODER_H_
+
+#include <stdint.h>
+
+namespace draco {
+
+struct rans_sym;
+
+// Decodes up to |num_rounds| rounds of |num_states| interleaved rANS states
+// (see RAnsDecoder in ans.h) using the SIMD instructions supported by the host
+// CPU. One round decodes one symbol for each of the states, in the order of the
+// states. |buf| and |buf_offset| describe the encoded data that was not
+// consumed yet and |states| contains the current values of the rANS states.
+// All of them are updated to reflect the decoded rounds.
+// |lut_table| and |probability_table| are the tables built by
+// RAnsDecoder::rans_build_look_up_table().
+//
+// The decoding stops early when the remaining data is too short for the
+// vectorized renormalization, and the rest needs to be decoded by the scalar
+// decoder. Returns the number of decoded rounds, which is 0 when there is no
+// SIMD implementation for the given number of states or for the host CPU. The
+// decoded symbols are always identical to the output of the scalar decoder.
+uint32_t RAnsDecodeRoundsSimd(int num_states, int rans_precision_bits,
+                              const uint32_t *lut_table,
+                              const rans_sym *probability_table,
+                              const uint8_t *buf, int *buf_offset,
+                              uint32_t *states, uint32_t num_rounds,
+                              uint32_t *out_values);
+
+}  // namespace draco
+
+#endif  // DRACO_CORE_RANS_SIMD_DECODER_H_
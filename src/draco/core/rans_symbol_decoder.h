@@ -16,6 +16,7 @@
 #define DRACO_CORE_RANS_SYMBOL_DECODER_H_
 
 #include "draco/compression/config/compression_shared.h"
+#include "draco/core/arena.h"
 #include "draco/core/decoder_buffer.h"
 #include "draco/core/rans_symbol_coding.h"
 #include "draco/core/varint_decoding.h"
@@ -24,9 +25,9 @@ namespace draco {
 
 // A helper class for decoding symbols using the rANS algorithm (see ans.h).
 // The class can be used to decode the probability table and the data encoded
-// by the RAnsSymbolEncoder. |unique_symbols_bit_length_t| must be the same as
-// the one used for the corresponding RAnsSymbolEncoder.
-template <int unique_symbols_bit_length_t>
+// by the RAnsSymbolEncoder. |unique_symbols_bit_length_t| and |num_states_t|
+// must be the same as the ones used for the corresponding RAnsSymbolEncoder.
+template <int unique_symbols_bit_length_t, int num_states_t = 1>
 class RAnsSymbolDecoder {
  public:
   RAnsSymbolDecoder() : num_symbols_(0) {}
@@ -40,6 +41,11 @@ class RAnsSymbolDecoder {
   // encoded data after this call.
   bool StartDecoding(DecoderBuffer *buffer);
   uint32_t DecodeSymbol() { return ans_.rans_read(); }
+  // Decodes |num_values| symbols at once. Faster than calling DecodeSymbol()
+  // repeatedly when more than one rANS state is used.
+  void DecodeSymbols(uint32_t num_values, uint32_t *out_values) {
+    ans_.rans_read_n(num_values, out_values);
+  }
   void EndDecoding();
 
  private:
@@ -48,13 +54,22 @@ class RAnsSymbolDecoder {
           unique_symbols_bit_length_t);
   static constexpr int rans_precision_ = 1 << rans_precision_bits_;
 
-  std::vector<uint32_t> probability_table_;
+  ArenaVector<uint32_t> probability_table_;
   uint32_t num_symbols_;
-  RAnsDecoder<rans_precision_bits_> ans_;
+  RAnsDecoder<rans_precision_bits_, num_states_t> ans_;
 };
 
+// Aliases of the RAnsSymbolDecoder with a fixed number of rANS states that can
+// be used as template template arguments.
+template <int unique_symbols_bit_length_t>
+using RAnsSymbolDecoderX1 = RAnsSymbolDecoder<unique_symbols_bit_length_t, 1>;
+template <int unique_symbols_bit_length_t>
+using RAnsSymbolDecoderX4 = RAnsSymbolDecoder<unique_symbols_bit_length_t, 4>;
 template <int unique_symbols_bit_length_t>
-bool RAnsSymbolDecoder<unique_symbols_bit_length_t>::Create(
+using RAnsSymbolDecoderX8 = RAnsSymbolDecoder<unique_symbols_bit_length_t, 8>;
+
+template <int unique_symbols_bit_length_t, int num_states_t>
+bool RAnsSymbolDecoder<unique_symbols_bit_length_t, num_states_t>::Create(
     DecoderBuffer *buffer) {
   // Check that the DecoderBuffer version is set.
   if (buffer->bitstream_version() == 0)
@@ -70,6 +85,10 @@ bool RAnsSymbolDecoder<unique_symbols_bit_length_t>::Create(
     if (!DecodeVarint(&num_symbols_, buffer))
       return false;
   }
+  // The tables are not used after the decoding of |buffer| is finished.
+  probability_table_ =
+      ArenaVector<uint32_t>(ArenaAllocator<uint32_t>(buffer->arena()));
+  ans_.set_arena(buffer->arena());
   probability_table_.resize(num_symbols_);
   if (num_symbols_ == 0)
     return true;
@@ -113,9 +132,9 @@ bool RAnsSymbolDecoder<unique_symbols_bit_length_t>::Create(
   return true;
 }
 
-template <int unique_symbols_bit_length_t>
-bool RAnsSymbolDecoder<unique_symbols_bit_length_t>::StartDecoding(
-    DecoderBuffer *buffer) {
+template <int unique_symbols_bit_length_t, int num_states_t>
+bool RAnsSymbolDecoder<unique_symbols_bit_length_t,
+                       num_states_t>::StartDecoding(DecoderBuffer *buffer) {
   uint64_t bytes_encoded;
   // Decode the number of bytes encoded by the encoder.
 #ifdef DRACO_BACKWARDS_COMPATIBILITY_SUPPORTED
@@ -139,8 +158,9 @@ bool RAnsSymbolDecoder<unique_symbols_bit_length_t>::StartDecoding(
   return true;
 }
 
-template <int unique_symbols_bit_length_t>
-void RAnsSymbolDecoder<unique_symbols_bit_length_t>::EndDecoding() {
+template <int unique_symbols_bit_length_t, int num_states_t>
+void RAnsSymbolDecoder<unique_symbols_bit_length_t,
+                       num_states_t>::EndDecoding() {
   ans_.read_end();
 }
 
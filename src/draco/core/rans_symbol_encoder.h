@@ -29,7 +29,10 @@ namespace draco {
 // A helper class for encoding symbols using the rANS algorithm (see ans.h).
 // The class can be used to initialize and encode probability table needed by
 // rANS, and to perform encoding of symbols into the provided EncoderBuffer.
-template <int unique_symbols_bit_length_t>
+// |num_states_t| is the number of interleaved rANS states (see ans.h). The
+// data encoded with more than one state can be decoded faster, but it must be
+// decoded with a RAnsSymbolDecoder that uses the same number of states.
+template <int unique_symbols_bit_length_t, int num_states_t = 1>
 class RAnsSymbolEncoder {
  public:
   RAnsSymbolEncoder()
@@ -78,13 +81,22 @@ class RAnsSymbolEncoder {
   // Expected number of bits that is needed to encode the input.
   uint64_t num_expected_bits_;
 
-  RAnsEncoder<rans_precision_bits_> ans_;
+  RAnsEncoder<rans_precision_bits_, num_states_t> ans_;
   // Initial offset of the encoder buffer before any ans data was encoded.
   uint64_t buffer_offset_;
 };
 
+// Aliases of the RAnsSymbolEncoder with a fixed number of rANS states that can
+// be used as template template arguments.
+template <int unique_symbols_bit_length_t>
+using RAnsSymbolEncoderX1 = RAnsSymbolEncoder<unique_symbols_bit_length_t, 1>;
 template <int unique_symbols_bit_length_t>
-bool RAnsSymbolEncoder<unique_symbols_bit_length_t>::Create(
+using RAnsSymbolEncoderX4 = RAnsSymbolEncoder<unique_symbols_bit_length_t, 4>;
+template <int unique_symbols_bit_length_t>
+using RAnsSymbolEncoderX8 = RAnsSymbolEncoder<unique_symbols_bit_length_t, 8>;
+
+template <int unique_symbols_bit_length_t, int num_states_t>
+bool RAnsSymbolEncoder<unique_symbols_bit_length_t, num_states_t>::Create(
     const uint64_t *frequencies, int num_symbols, EncoderBuffer *buffer) {
   // Compute the total of the input frequencies.
   uint64_t total_freq = 0;
@@ -192,8 +204,8 @@ bool RAnsSymbolEncoder<unique_symbols_bit_length_t>::Create(
   return true;
 }
 
-template <int unique_symbols_bit_length_t>
-bool RAnsSymbolEncoder<unique_symbols_bit_length_t>::EncodeTable(
+template <int unique_symbols_bit_length_t, int num_states_t>
+bool RAnsSymbolEncoder<unique_symbols_bit_length_t, num_states_t>::EncodeTable(
     EncoderBuffer *buffer) {
   EncodeVarint(num_symbols_, buffer);
   // Use varint encoding for the probabilities (first two bits represent the
@@ -240,11 +252,13 @@ bool RAnsSymbolEncoder<unique_symbols_bit_length_t>::EncodeTable(
   return true;
 }
 
-template <int unique_symbols_bit_length_t>
-void RAnsSymbolEncoder<unique_symbols_bit_length_t>::StartEncoding(
-    EncoderBuffer *buffer) {
-  // Allocate extra storage just in case.
-  const uint64_t required_bits = 2 * num_expected_bits_ + 32;
+template <int unique_symbols_bit_length_t, int num_states_t>
+void RAnsSymbolEncoder<unique_symbols_bit_length_t,
+                       num_states_t>::StartEncoding(EncoderBuffer *buffer) {
+  // Allocate extra storage just in case. Each rANS state needs up to 32 bits
+  // for its final value and it can emit a few bytes when it is used for the
+  // first time.
+  const uint64_t required_bits = 2 * num_expected_bits_ + 64 * num_states_t;
 
   buffer_offset_ = buffer->size();
   const int64_t required_bytes = (required_bits + 7) / 8;
@@ -254,8 +268,8 @@ void RAnsSymbolEncoder<unique_symbols_bit_length_t>::StartEncoding(
   ans_.write_init(data + buffer_offset_);
 }
 
-template <int unique_symbols_bit_length_t>
-void RAnsSymbolEncoder<unique_symbols_bit_length_t>::EndEncoding(
+template <int unique_symbols_bit_length_t, int num_states_t>
+void RAnsSymbolEncoder<unique_symbols_bit_length_t, num_states_t>::EndEncoding(
     EncoderBuffer *buffer) {
   char *const src = const_cast<char *>(buffer->data()) + buffer_offset_;
 
@@ -0,0 +1,126 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "benchmark/benchmark.h"
+#include "draco/compression/config/compression_shared.h"
+#include "draco/core/decoder_buffer.h"
+#include "draco/core/draco_benchmark_utils.h"
+#include "draco/core/encoder_buffer.h"
+#include "draco/core/options.h"
+#include "draco/core/rans_symbol_decoder.h"
+#include "draco/core/rans_symbol_encoder.h"
+#include "draco/core/symbol_decoding.h"
+#include "draco/core/symbol_encoding.h"
+
+namespace draco {
+
+namespace {
+
+constexpr int kNumSymbols = 1 << 18;
+constexpr int kSymbolBitLength = 12;
+
+// Decodes symbols encoded with RAnsSymbolEncoder. When |bulk_t| is true, all
+// symbols are decoded with one call of RAnsSymbolDecoder::DecodeSymbols().
+// Otherwise they are decoded one by one.
+template <int num_states_t, bool bulk_t>
+void BM_RAnsSymbolDecoder(benchmark::State &state) {
+  const std::vector<uint32_t> symbols =
+      CreateSymbols(kNumSymbols, kSymbolBitLength);
+  std::vector<uint64_t> frequencies(1 << kSymbolBitLength, 0);
+  for (const uint32_t symbol : symbols) {
+    ++frequencies[symbol];
+  }
+  EncoderBuffer encoder_buffer;
+  RAnsSymbolEncoder<kSymbolBitLength, num_states_t> encoder;
+  encoder.Create(frequencies.data(), frequencies.size(), &encoder_buffer);
+  encoder.StartEncoding(&encoder_buffer);
+  for (int i = kNumSymbols - 1; i >= 0; --i) {
+    encoder.EncodeSymbol(symbols[i]);
+  }
+  encoder.EndEncoding(&encoder_buffer);
+
+  std::vector<uint32_t> decoded_symbols(kNumSymbols);
+  for (auto _ : state) {
+    DecoderBuffer buffer;
+    buffer.Init(encoder_buffer.data(), encoder_buffer.size(),
+                kDracoBitstreamVersion);
+    RAnsSymbolDecoder<kSymbolBitLength, num_states_t> decoder;
+    if (!decoder.Create(&buffer) || !decoder.StartDecoding(&buffer)) {
+      state.SkipWithError("Failed to start symbol decoding.");
+      break;
+    }
+    if (bulk_t) {
+      decoder.DecodeSymbols(kNumSymbols, decoded_symbols.data());
+    } else {
+      for (int i = 0; i < kNumSymbols; ++i) {
+        decoded_symbols[i] = decoder.DecodeSymbol();
+      }
+    }
+    decoder.EndDecoding();
+    benchmark::DoNotOptimize(decoded_symbols.data());
+  }
+  if (decoded_symbols != symbols)
+    state.SkipWithError("Decoded symbols don't match the encoded symbols.");
+  state.SetItemsProcessed(state.iterations() * kNumSymbols);
+  state.SetBytesProcessed(state.iterations() * encoder_buffer.size());
+}
+BENCHMARK_TEMPLATE2(BM_RAnsSymbolDecoder, 1, false);
+BENCHMARK_TEMPLATE2(BM_RAnsSymbolDecoder, 1, true);
+BENCHMARK_TEMPLATE2(BM_RAnsSymbolDecoder, 4, true);
+BENCHMARK_TEMPLATE2(BM_RAnsSymbolDecoder, 8, true);
+
+// Decodes symbols encoded with EncodeSymbols() using the coding method
+// state.range(0) and state.range(1) interleaved rANS states.
+void BM_DecodeSymbols(benchmark::State &state) {
+  const int num_components = 3;
+  const std::vector<uint32_t> symbols =
+      CreateSymbols(kNumSymbols, kSymbolBitLength);
+  Options options;
+  SetSymbolEncodingMethod(&options,
+                          static_cast<SymbolCodingMethod>(state.range(0)));
+  SetSymbolEncodingNumRAnsStates(&options, static_cast<int>(state.range(1)));
+  EncoderBuffer encoder_buffer;
+  if (!EncodeSymbols(symbols.data(), kNumSymbols, num_components, &options,
+                     &encoder_buffer)) {
+    state.SkipWithError("Failed to encode symbols.");
+    return;
+  }
+
+  std::vector<uint32_t> decoded_symbols(kNumSymbols);
+  for (auto _ : state) {
+    DecoderBuffer buffer;
+    buffer.Init(encoder_buffer.data(), encoder_buffer.size(),
+                kDracoBitstreamVersion);
+    if (!DecodeSymbols(kNumSymbols, num_components, &buffer,
+                       decoded_symbols.data())) {
+      state.SkipWithError("Failed to decode symbols.");
+      break;
+    }
+    benchmark::DoNotOptimize(decoded_symbols.data());
+  }
+  if (decoded_symbols != symbols)
+    state.SkipWithError("Decoded symbols don't match the encoded symbols.");
+  state.SetItemsProcessed(state.iterations() * kNumSymbols);
+  state.SetBytesProcessed(state.iterations() * encoder_buffer.size());
+}
+BENCHMARK(BM_DecodeSymbols)
+    ->ArgNames({"method", "states"})
+    ->Args({SYMBOL_CODING_TAGGED, 1})
+    ->Args({SYMBOL_CODING_RAW, 1})
+    ->Args({SYMBOL_CODING_RAW, 4})
+    ->Args({SYMBOL_CODING_RAW, 8});
+
+}  // namespace
+
+}  // namespace draco
@@ -16,6 +16,8 @@
 #include "draco/core/decoder_buffer.h"
 #include "draco/core/draco_test_base.h"
 #include "draco/core/encoder_buffer.h"
+#include "draco/core/rans_symbol_decoder.h"
+#include "draco/core/rans_symbol_encoder.h"
 #include "draco/core/symbol_coding_utils.h"
 #include "draco/core/symbol_decoding.h"
 #include "draco/core/symbol_encoding.h"
@@ -34,6 +36,52 @@ class SymbolCodingTest : public ::testing::Test {
     ASSERT_EQ(x, y);
   }
 
+  // Encodes |symbols| with RAnsSymbolEncoder and verifies that the bulk
+  // (possibly vectorized) decoding produces the same output as decoding the
+  // symbols one by one.
+  template <int unique_symbols_bit_length_t, int num_states_t>
+  void TestBulkRAnsDecoding(const std::vector<uint32_t> &symbols) {
+    uint32_t max_symbol = 0;
+    for (const uint32_t symbol : symbols) {
+      max_symbol = std::max(max_symbol, symbol);
+    }
+    std::vector<uint64_t> frequencies(max_symbol + 1, 0);
+    for (const uint32_t symbol : symbols) {
+      ++frequencies[symbol];
+    }
+    EncoderBuffer eb;
+    RAnsSymbolEncoder<unique_symbols_bit_length_t, num_states_t> encoder;
+    ASSERT_TRUE(encoder.Create(frequencies.data(), frequencies.size(), &eb));
+    encoder.StartEncoding(&eb);
+    for (int i = static_cast<int>(symbols.size()) - 1; i >= 0; --i) {
+      encoder.EncodeSymbol(symbols[i]);
+    }
+    encoder.EndEncoding(&eb);
+
+    std::vector<uint32_t> bulk_out(symbols.size());
+    std::vector<uint32_t> single_out(symbols.size());
+    for (int pass = 0; pass < 2; ++pass) {
+      DecoderBuffer db;
+      db.Init(eb.data(), eb.size());
+      db.set_bitstream_version(bitstream_version_);
+      RAnsSymbolDecoder<unique_symbols_bit_length_t, num_states_t> decoder;
+      ASSERT_TRUE(decoder.Create(&db));
+      ASSERT_TRUE(decoder.StartDecoding(&db));
+      if (pass == 0) {
+        decoder.DecodeSymbols(symbols.size(), bulk_out.data());
+      } else {
+        for (size_t i = 0; i < symbols.size(); ++i) {
+          single_out[i] = decoder.DecodeSymbol();
+        }
+      }
+      decoder.EndDecoding();
+    }
+    for (size_t i = 0; i < symbols.size(); ++i) {
+      ASSERT_EQ(symbols[i], single_out[i]);
+      ASSERT_EQ(symbols[i], bulk_out[i]);
+    }
+  }
+
   uint16_t bitstream_version_;
 };
 
@@ -90,6 +138,59 @@ TEST_F(SymbolCodingTest, TestManyNumbers) {
   }
 }
 
+TEST_F(SymbolCodingTest, TestInterleavedRAnsStates) {
+  // This test verifies that SymbolCoding successfully encodes symbols using
+  // all supported numbers of interleaved rANS states, including inputs whose
+  // size is not a multiple of the number of states.
+  std::vector<uint32_t> in_values;
+  for (int i = 0; i < 10003; ++i) {
+    in_values.push_back((i * 7919) % 97 + (i % 5 == 0 ? 300 : 0));
+  }
+  const int num_states[] = {1, 4, 8};
+  for (int num_values : {1, 3, 7, 9, 10003}) {
+    for (int states : num_states) {
+      Options options;
+      SetSymbolEncodingMethod(&options, SYMBOL_CODING_RAW);
+      ASSERT_TRUE(SetSymbolEncodingNumRAnsStates(&options, states));
+
+      EncoderBuffer eb;
+      ASSERT_TRUE(
+          EncodeSymbols(in_values.data(), num_values, 1, &options, &eb));
+      std::vector<uint32_t> out_values(num_values);
+      DecoderBuffer db;
+      db.Init(eb.data(), eb.size());
+      db.set_bitstream_version(bitstream_version_);
+      ASSERT_TRUE(DecodeSymbols(num_values, 1, &db, &out_values[0]));
+      for (int i = 0; i < num_values; ++i) {
+        ASSERT_EQ(in_values[i], out_values[i]);
+      }
+    }
+  }
+  Options options;
+  ASSERT_FALSE(SetSymbolEncodingNumRAnsStates(&options, 3));
+}
+
+TEST_F(SymbolCodingTest, TestBulkRAnsDecoding) {
+  // This test verifies that the bulk decoding of interleaved rANS states
+  // (vectorized when supported by the CPU) matches the scalar decoder.
+  std::vector<uint32_t> symbols;
+  uint32_t seed = 1;
+  for (int i = 0; i < 50001; ++i) {
+    seed = seed * 1103515245 + 12345;
+    const uint32_t r = (seed >> 16) & 0x7fff;
+    // Skewed distribution with a few rare large symbols.
+    symbols.push_back(r % 16 == 0 ? r % 2000 : r % 7);
+  }
+  TestBulkRAnsDecoding<5, 4>(symbols);
+  TestBulkRAnsDecoding<5, 8>(symbols);
+  TestBulkRAnsDecoding<12, 4>(symbols);
+  TestBulkRAnsDecoding<12, 8>(symbols);
+  TestBulkRAnsDecoding<18, 8>(symbols);
+  // Inputs shorter than a few rounds are decoded by the scalar path only.
+  symbols.resize(13);
+  TestBulkRAnsDecoding<5, 8>(symbols);
+}
+
 TEST_F(SymbolCodingTest, TestEmpty) {
   // This test verifies that SymbolCoding successfully encodes an empty array.
   EncoderBuffer eb;
@@ -38,11 +38,23 @@ bool DecodeSymbols(uint32_t num_values, int num_components,
   if (!src_buffer->Decode(&scheme))
     return false;
   if (scheme == SYMBOL_CODING_TAGGED) {
-    return DecodeTaggedSymbols<RAnsSymbolDecoder>(num_values, num_components,
-                                                  src_buffer, out_values);
+    return DecodeTaggedSymbols<RAnsSymbolDecoderX1>(
+        num_values, num_components, src_buffer, out_values);
   } else if (scheme == SYMBOL_CODING_RAW) {
-    return DecodeRawSymbols<RAnsSymbolDecoder>(num_values, src_buffer,
-                                               out_values);
+    return DecodeRawSymbols<RAnsSymbolDecoderX1>(num_values, src_buffer,
+                                                 out_values);
+  } else if (scheme == SYMBOL_CODING_RAW_INTERLEAVED) {
+    // Decode the number of interleaved rANS states.
+    uint8_t num_states;
+    if (!src_buffer->Decode(&num_states))
+      return false;
+    if (num_states == 4) {
+      return DecodeRawSymbols<RAnsSymbolDecoderX4>(num_values, src_buffer,
+                                                   out_values);
+    } else if (num_states == 8) {
+      return DecodeRawSymbols<RAnsSymbolDecoderX8>(num_values, src_buffer,
+                                                   out_values);
+    }
   }
   return false;
 }
@@ -93,11 +105,8 @@ bool DecodeRawSymbolsInternal(uint32_t num_values, DecoderBuffer *src_buffer,
 
   if (!decoder.StartDecoding(src_buffer))
     return false;
-  for (uint32_t i = 0; i < num_values; ++i) {
-    // Decode a symbol into the value.
-    const uint32_t value = decoder.DecodeSymbol();
-    out_values[i] = value;
-  }
+  // Decode all symbols into the values.
+  decoder.DecodeSymbols(num_values, out_values);
   decoder.EndDecoding();
   return true;
 }
@@ -27,6 +27,7 @@ namespace draco {
 constexpr int32_t kMaxTagSymbolBitLength = 32;
 constexpr int kMaxRawEncodingBitLength = 18;
 constexpr int kDefaultSymbolCodingCompressionLevel = 7;
+constexpr int kDefaultNumInterleavedRAnsStates = 4;
 
 typedef uint64_t TaggedBitLengthFrequencies[kMaxTagSymbolBitLength];
 
@@ -42,6 +43,13 @@ bool SetSymbolEncodingCompressionLevel(Options *options,
   return true;
 }
 
+bool SetSymbolEncodingNumRAnsStates(Options *options, int num_states) {
+  if (num_states != 1 && num_states != 4 && num_states != 8)
+    return false;
+  options->SetInt("symbol_encoding_num_rans_states", num_states);
+  return true;
+}
+
 // Computes bit lengths of the input values. If num_components > 1, the values
 // are processed in "num_components" sized chunks and the bit length is always
 // computed for the largest value from the chunk.
@@ -150,16 +158,41 @@ bool EncodeSymbols(const uint32_t *symbols, int num_values, int num_components,
       method = SYMBOL_CODING_RAW;
     }
   }
-  // Use the tagged scheme.
+  // Use the interleaved variant of the raw scheme when more than one rANS
+  // state was requested.
+  int num_rans_states = 1;
+  if (options != nullptr &&
+      options->IsOptionSet("symbol_encoding_num_rans_states")) {
+    num_rans_states = options->GetInt("symbol_encoding_num_rans_states");
+  }
+  if (method == SYMBOL_CODING_RAW && num_rans_states > 1) {
+    method = SYMBOL_CODING_RAW_INTERLEAVED;
+  } else if (method == SYMBOL_CODING_RAW_INTERLEAVED && num_rans_states <= 1) {
+    num_rans_states = kDefaultNumInterleavedRAnsStates;
+  }
   target_buffer->Encode(static_cast<uint8_t>(method));
   if (method == SYMBOL_CODING_TAGGED) {
-    return EncodeTaggedSymbols<RAnsSymbolEncoder>(
+    return EncodeTaggedSymbols<RAnsSymbolEncoderX1>(
         symbols, num_values, num_components, bit_lengths, target_buffer);
   }
   if (method == SYMBOL_CODING_RAW) {
-    return EncodeRawSymbols<RAnsSymbolEncoder>(symbols, num_values, max_value,
-                                               num_unique_symbols, options,
-                                               target_buffer);
+    return EncodeRawSymbols<RAnsSymbolEncoderX1>(symbols, num_values,
+                                                 max_value, num_unique_symbols,
+                                                 options, target_buffer);
+  }
+  if (method == SYMBOL_CODING_RAW_INTERLEAVED) {
+    target_buffer->Encode(static_cast<uint8_t>(num_rans_states));
+    if (num_rans_states == 4) {
+      return EncodeRawSymbols<RAnsSymbolEncoderX4>(
+          symbols, num_values, max_value, num_unique_symbols, options,
+          target_buffer);
+    }
+    if (num_rans_states == 8) {
+      return EncodeRawSymbols<RAnsSymbolEncoderX8>(
+          symbols, num_values, max_value, num_unique_symbols, options,
+          target_buffer);
+    }
+    return false;
   }
   // Unknown method selected.
   return false;
@@ -42,6 +42,13 @@ void SetSymbolEncodingMethod(Options *options, SymbolCodingMethod method);
 // Returns false if an invalid level has been set.
 bool SetSymbolEncodingCompressionLevel(Options *options, int compression_level);
 
+// Sets the number of interleaved rANS states used by the raw symbol coding.
+// Supported values are 1 (default), 4 and 8. When more than one state is used,
+// the raw scheme is replaced by SYMBOL_CODING_RAW_INTERLEAVED that decodes
+// faster at the cost of a few extra bytes per encoded array. Returns false if
+// an unsupported number of states has been set.
+bool SetSymbolEncodingNumRAnsStates(Options *options, int num_states);
+
 }  // namespace draco
 
 #endif  // DRACO_CORE_SYMBOL_ENCODING_H_
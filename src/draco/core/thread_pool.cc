@@ -0,0 +1,103 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/core/thread_pool.h"
+
+namespace draco {
+
+#ifdef DRACO_MULTITHREADING_SUPPORTED
+
+ThreadPool::ThreadPool(int num_threads)
+    : num_unfinished_tasks_(0), stop_(false), num_threads_(0) {
+  for (int i = 0; i < num_threads; ++i) {
+    workers_.push_back(std::thread(&ThreadPool::RunWorker, this));
+  }
+  num_threads_ = static_cast<int>(workers_.size());
+}
+
+ThreadPool::~ThreadPool() {
+  Wait();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  task_scheduled_.notify_all();
+  for (std::thread &worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::Schedule(std::function<void()> task) {
+  if (workers_.empty()) {
+    task();
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(std::move(task));
+    ++num_unfinished_tasks_;
+  }
+  task_scheduled_.notify_one();
+}
+
+void ThreadPool::Wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  tasks_finished_.wait(lock, [this] { return num_unfinished_tasks_ == 0; });
+}
+
+int ThreadPool::GetHardwareConcurrency() {
+  const int num_threads = static_cast<int>(std::thread::hardware_concurrency());
+  return num_threads > 0 ? num_threads : 1;
+}
+
+void ThreadPool::RunWorker() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      task_scheduled_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+      if (tasks_.empty())
+        return;  // The pool is being stopped.
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+    bool all_finished;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      all_finished = (--num_unfinished_tasks_ == 0);
+    }
+    if (all_finished)
+      tasks_finished_.notify_all();
+  }
+}
+
+#else  // DRACO_MULTITHREADING_SUPPORTED
+
+ThreadPool::ThreadPool(int /* num_threads */)
+    : num_unfinished_tasks_(0), stop_(false), num_threads_(0) {}
+
+ThreadPool::~ThreadPool() {}
+
+void ThreadPool::Schedule(std::function<void()> task) { task(); }
+
+void ThreadPool::Wait() {}
+
+int ThreadPool::GetHardwareConcurrency() { return 1; }
+
+void ThreadPool::RunWorker() {}
+
+#endif  // DRACO_MULTITHREADING_SUPPORTED
+
+}  // namespace draco
@@ -0,0 +1,72 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef DRACO_CORE_THREAD_POOL_H_
+#define DRACO_CORE_THREAD_POOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace draco {
+
+// Simple pool of worker threads executing scheduled tasks in the order they
+// were scheduled. When the library is built without multithreading support
+// (DRACO_MULTITHREADING_SUPPORTED is not defined) or when the pool has no
+// worker threads, the tasks are executed directly by the thread that calls
+// Schedule(). The layout of the class does not depend on
+// DRACO_MULTITHREADING_SUPPORTED; the worker state is just left unused
+// without multithreading support.
+class ThreadPool {
+ public:
+  // Creates a pool with |num_threads| worker threads.
+  explicit ThreadPool(int num_threads);
+
+  // Waits for all scheduled tasks and stops the worker threads.
+  ~ThreadPool();
+
+  // Schedules |task| for execution on one of the worker threads.
+  void Schedule(std::function<void()> task);
+
+  // Blocks until all scheduled tasks are finished.
+  void Wait();
+
+  int num_threads() const { return num_threads_; }
+
+  // Returns the number of threads that can run concurrently on the host, or 1
+  // if the number is unknown or multithreading is not supported.
+  static int GetHardwareConcurrency();
+
+ private:
+  void RunWorker();
+
+  std::vector<std::thread> workers_;
+  std::deque<std::function<void()>> tasks_;
+  std::mutex mutex_;
+  // Signaled when a new task is scheduled or when the pool is being stopped.
+  std::condition_variable task_scheduled_;
+  // Signaled when all scheduled tasks are finished.
+  std::condition_variable tasks_finished_;
+  // Number of tasks that are either waiting in |tasks_| or being executed.
+  int num_unfinished_tasks_;
+  bool stop_;
+  int num_threads_;
+};
+
+}  // namespace draco
+
+#endif  // DRACO_CORE_THREAD_POOL_H_
@@ -0,0 +1,61 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/core/thread_pool.h"
+
+#include <vector>
+
+#include "draco/core/draco_test_base.h"
+
+namespace {
+
+class ThreadPoolTest : public ::testing::Test {
+ protected:
+  void TestExecutesAllTasks(int num_threads) {
+    draco::ThreadPool thread_pool(num_threads);
+    constexpr int kNumTasks = 100;
+    std::vector<int> results(kNumTasks, 0);
+    for (int round = 1; round <= 3; ++round) {
+      for (int i = 0; i < kNumTasks; ++i) {
+        thread_pool.Schedule([&results, i]() { results[i] += i; });
+      }
+      thread_pool.Wait();
+      for (int i = 0; i < kNumTasks; ++i) {
+        ASSERT_EQ(results[i], round * i);
+      }
+    }
+  }
+};
+
+TEST_F(ThreadPoolTest, TestExecutesAllTasks) {
+  TestExecutesAllTasks(0);
+  TestExecutesAllTasks(1);
+  TestExecutesAllTasks(4);
+}
+
+TEST_F(ThreadPoolTest, TestDestructorWaitsForTasks) {
+  constexpr int kNumTasks = 50;
+  std::vector<int> results(kNumTasks, 0);
+  {
+    draco::ThreadPool thread_pool(3);
+    for (int i = 0; i < kNumTasks; ++i) {
+      thread_pool.Schedule([&results, i]() { results[i] = 1; });
+    }
+  }
+  for (int i = 0; i < kNumTasks; ++i) {
+    ASSERT_EQ(results[i], 1);
+  }
+}
+
+}  // namespace
@@ -0,0 +1,102 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/io/mapped_file.h"
+
+#include <fstream>
+
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+#define DRACO_MMAP_SUPPORTED
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace draco {
+
+MappedFile::MappedFile() : data_(nullptr), size_(0), mapped_data_(nullptr) {}
+
+MappedFile::~MappedFile() { Close(); }
+
+bool MappedFile::Open(const std::string &file_name) {
+  Close();
+  if (Map(file_name))
+    return true;
+  return Read(file_name);
+}
+
+void MappedFile::Close() {
+#ifdef DRACO_MMAP_SUPPORTED
+  if (mapped_data_ != nullptr)
+    munmap(mapped_data_, size_);
+#endif
+  mapped_data_ = nullptr;
+  data_ = nullptr;
+  size_ = 0;
+  buffer_.clear();
+  buffer_.shrink_to_fit();
+}
+
+bool MappedFile::Map(const std::string &file_name) {
+#ifdef DRACO_MMAP_SUPPORTED
+  const int fd = open(file_name.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat file_stat;
+  // Only regular files can be mapped. Empty files can't be mapped either, but
+  // they are handled correctly by the fallback.
+  if (fstat(fd, &file_stat) != 0 || !S_ISREG(file_stat.st_mode) ||
+      file_stat.st_size <= 0) {
+    close(fd);
+    return false;
+  }
+  const size_t file_size = static_cast<size_t>(file_stat.st_size);
+  void *const mapped_data =
+      mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping remains valid after the file descriptor is closed.
+  close(fd);
+  if (mapped_data == MAP_FAILED)
+    return false;
+  // All our readers process the data from the beginning to the end.
+  madvise(mapped_data, file_size, MADV_SEQUENTIAL);
+  mapped_data_ = mapped_data;
+  data_ = static_cast<const char *>(mapped_data);
+  size_ = file_size;
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool MappedFile::Read(const std::string &file_name) {
+  std::ifstream file(file_name, std::ios::binary);
+  if (!file)
+    return false;
+  file.seekg(0, std::ios::end);
+  const std::streampos file_size = file.tellg();
+  if (file_size < 0)
+    return false;
+  file.seekg(0, std::ios::beg);
+  buffer_.resize(static_cast<size_t>(file_size));
+  if (!buffer_.empty() && !file.read(buffer_.data(), buffer_.size())) {
+    buffer_.clear();
+    return false;
+  }
+  data_ = buffer_.data();
+  size_ = buffer_.size();
+  return true;
+}
+
+}  // namespace draco
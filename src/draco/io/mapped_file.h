@@ -0,0 +1,65 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef DRACO_IO_MAPPED_FILE_H_
+#define DRACO_IO_MAPPED_FILE_H_
+
+#include <string>
+#include <vector>
+
+#include "draco/core/macros.h"
+
+namespace draco {
+
+// Read-only view of the whole content of a file. Where supported, the file is
+// mapped into memory so that the data is never copied and the pages are loaded
+// lazily by the operating system. Files that can't be mapped (or platforms
+// without memory mapping) fall back to reading the file into a heap buffer.
+// The data can be passed directly to DecoderBuffer::Init() and it remains
+// valid until Close() is called or the instance is destroyed.
+class MappedFile {
+ public:
+  MappedFile();
+  ~MappedFile();
+
+  // Opens |file_name| and makes its content available through data(). Any
+  // previously opened file is closed. Returns false when the file can't be
+  // opened or read.
+  bool Open(const std::string &file_name);
+  void Close();
+
+  const char *data() const { return data_; }
+  size_t size() const { return size_; }
+
+  // Returns true when the data is mapped directly from the file.
+  bool is_mapped() const { return mapped_data_ != nullptr; }
+
+ private:
+  // Maps the whole file into memory. Returns false on error.
+  bool Map(const std::string &file_name);
+  // Reads the whole file into |buffer_|. Returns false on error.
+  bool Read(const std::string &file_name);
+
+  const char *data_;
+  size_t size_;
+  void *mapped_data_;
+  // Used when the file is not mapped.
+  std::vector<char> buffer_;
+
+  DISALLOW_COPY_AND_ASSIGN(MappedFile);
+};
+
+}  // namespace draco
+
+#endif  // DRACO_IO_MAPPED_FILE_H_
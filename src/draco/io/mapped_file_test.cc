@@ -0,0 +1,54 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/io/mapped_file.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+#include "draco/core/draco_test_base.h"
+#include "draco/core/draco_test_utils.h"
+
+namespace {
+
+TEST(MappedFileTest, TestFileContent) {
+  const std::string file_names[] = {"test_nm.obj",
+                                    "test_nm.obj.edgebreaker.1.2.0.drc"};
+  for (const std::string &file_name : file_names) {
+    const std::string path = draco::GetTestFileFullPath(file_name);
+    std::ifstream input_file(path, std::ios::binary);
+    ASSERT_TRUE(input_file);
+    const std::vector<char> expected_data(
+        (std::istreambuf_iterator<char>(input_file)),
+        std::istreambuf_iterator<char>());
+
+    draco::MappedFile file;
+    ASSERT_TRUE(file.Open(path)) << file_name;
+    ASSERT_EQ(file.size(), expected_data.size());
+    ASSERT_TRUE(std::equal(expected_data.begin(), expected_data.end(),
+                           file.data()));
+    file.Close();
+    ASSERT_EQ(file.size(), 0u);
+    ASSERT_EQ(file.data(), nullptr);
+  }
+}
+
+TEST(MappedFileTest, TestMissingFile) {
+  draco::MappedFile file;
+  ASSERT_FALSE(file.Open(draco::GetTestFileFullPath("missing_file.drc")));
+  ASSERT_EQ(file.size(), 0u);
+}
+
+}  // namespace
@@ -14,8 +14,7 @@
 //
 #include "draco/io/mesh_io.h"
 
-#include <fstream>
-
+#include "draco/io/mapped_file.h"
 #include "draco/io/obj_decoder.h"
 #include "draco/io/parser_utils.h"
 #include "draco/io/ply_decoder.h"
@@ -40,13 +39,22 @@ StatusOr<std::unique_ptr<Mesh>> ReadMeshFromFile(const std::string &file_name) {
 
 StatusOr<std::unique_ptr<Mesh>> ReadMeshFromFile(const std::string &file_name,
                                                  bool use_metadata) {
+  Options options;
+  options.SetBool("use_metadata", use_metadata);
+  return ReadMeshFromFile(file_name, options);
+}
+
+StatusOr<std::unique_ptr<Mesh>> ReadMeshFromFile(const std::string &file_name,
+                                                 const Options &options) {
+  const int num_parsing_threads = options.GetInt("num_parsing_threads", 1);
   std::unique_ptr<Mesh> mesh(new Mesh());
   // Analyze file extension.
   const std::string extension = LowercaseFileExtension(file_name);
   if (extension == "obj") {
     // Wavefront OBJ file format.
     ObjDecoder obj_decoder;
-    obj_decoder.set_use_metadata(use_metadata);
+    obj_decoder.set_use_metadata(options.GetBool("use_metadata", false));
+    obj_decoder.set_num_threads(num_parsing_threads);
     const Status obj_status = obj_decoder.DecodeFromFile(file_name, mesh.get());
     if (!obj_status.ok())
       return obj_status;
@@ -55,6 +63,7 @@ StatusOr<std::unique_ptr<Mesh>> ReadMeshFromFile(const std::string &file_name,
   if (extension == "ply") {
     // Wavefront PLY file format.
     PlyDecoder ply_decoder;
+    ply_decoder.set_num_threads(num_parsing_threads);
     if (!ply_decoder.DecodeFromFile(file_name, mesh.get()))
       return Status(Status::ERROR, "Unknown error.");
     return std::move(mesh);
@@ -62,13 +71,13 @@ StatusOr<std::unique_ptr<Mesh>> ReadMeshFromFile(const std::string &file_name,
 
   // Otherwise not an obj file. Assume the file was encoded with one of the
   // draco encoding methods.
-  std::ifstream is(file_name.c_str(), std::ios::binary);
-  if (!is)
+  MappedFile file;
+  if (!file.Open(file_name))
     return Status(Status::ERROR, "Invalid input stream.");
-  if (!ReadMeshFromStream(&mesh, is).good())
-    return Status(Status::ERROR,
-                  "Unknown error.");  // Error reading the stream.
-  return std::move(mesh);
+  DecoderBuffer buffer;
+  buffer.Init(file.data(), file.size());
+  Decoder decoder;
+  return decoder.DecodeMeshFromBuffer(&buffer);
 }
 
 }  // namespace draco
@@ -18,6 +18,7 @@
 #include "draco/compression/config/compression_shared.h"
 #include "draco/compression/decode.h"
 #include "draco/compression/expert_encode.h"
+#include "draco/core/options.h"
 
 namespace draco {
 
@@ -89,6 +90,14 @@ StatusOr<std::unique_ptr<Mesh>> ReadMeshFromFile(const std::string &file_name);
 StatusOr<std::unique_ptr<Mesh>> ReadMeshFromFile(const std::string &file_name,
                                                  bool use_metadata);
 
+// Reads a mesh from a file using the provided |options|. Supported options:
+//   "use_metadata" (bool): Same as |use_metadata| of the previous function.
+//   "num_parsing_threads" (int): Maximum number of threads used for parsing
+//                                of text based (.obj and .ply) input files.
+// Returns nullptr with an error status if the decoding failed.
+StatusOr<std::unique_ptr<Mesh>> ReadMeshFromFile(const std::string &file_name,
+                                                 const Options &options);
+
 }  // namespace draco
 
 #endif  // DRACO_MESH_MESH_IO_H_
@@ -0,0 +1,90 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Benchmarks of the OBJ and PLY decoders. The input files are read into
+// memory up front, so only the parsing and the construction of the mesh are
+// measured.
+#include "benchmark/benchmark.h"
+#include "draco/core/draco_benchmark_utils.h"
+#include "draco/io/obj_decoder.h"
+#include "draco/io/ply_decoder.h"
+
+namespace draco {
+
+namespace {
+
+const char *const kObjFiles[] = {"cube_subd.obj", "mat_test.obj",
+                                 "test_nm.obj", "test_sphere.obj"};
+const char *const kPlyFiles[] = {"bun_zipper.ply", "cube_att.ply",
+                                 "test_pos_color_ascii.ply"};
+
+// Decodes the OBJ file with index state.range(0).
+void BM_DecodeObj(benchmark::State &state) {
+  const char *const file_name = kObjFiles[state.range(0)];
+  const std::vector<char> data = ReadBenchmarkFile(file_name);
+  if (data.empty()) {
+    state.SkipWithError("Failed to read the input file.");
+    return;
+  }
+  for (auto _ : state) {
+    DecoderBuffer buffer;
+    buffer.Init(data.data(), data.size());
+    ObjDecoder decoder;
+    Mesh mesh;
+    const Status status = decoder.DecodeFromBuffer(&buffer, &mesh);
+    if (!status.ok()) {
+      state.SkipWithError(status.error_msg());
+      return;
+    }
+    benchmark::DoNotOptimize(mesh.num_points());
+  }
+  state.SetLabel(file_name);
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+// Decodes the PLY file with index state.range(0).
+void BM_DecodePly(benchmark::State &state) {
+  const char *const file_name = kPlyFiles[state.range(0)];
+  const std::vector<char> data = ReadBenchmarkFile(file_name);
+  if (data.empty()) {
+    state.SkipWithError("Failed to read the input file.");
+    return;
+  }
+  for (auto _ : state) {
+    DecoderBuffer buffer;
+    buffer.Init(data.data(), data.size());
+    PlyDecoder decoder;
+    Mesh mesh;
+    if (!decoder.DecodeFromBuffer(&buffer, &mesh)) {
+      state.SkipWithError("Failed to decode the input file.");
+      return;
+    }
+    benchmark::DoNotOptimize(mesh.num_points());
+  }
+  state.SetLabel(file_name);
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+BENCHMARK(BM_DecodeObj)
+    ->ArgName("input")
+    ->DenseRange(0, 3)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_DecodePly)
+    ->ArgName("input")
+    ->DenseRange(0, 2)
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace
+
+}  // namespace draco
@@ -14,18 +14,28 @@
 //
 #include "draco/io/obj_decoder.h"
 
+#include <algorithm>
 #include <cctype>
 #include <cmath>
-#include <fstream>
+#include <cstring>
+#include <memory>
 
+#include "draco/core/thread_pool.h"
+#include "draco/io/mapped_file.h"
 #include "draco/io/parser_utils.h"
 #include "draco/metadata/geometry_metadata.h"
 
 namespace draco {
 
+namespace {
+
+// Minimum number of bytes parsed by a single thread.
+constexpr int64_t kMinParallelChunkSize = 1 << 20;
+
+}  // namespace
+
 ObjDecoder::ObjDecoder()
-    : counting_mode_(true),
-      num_obj_faces_(0),
+    : num_obj_faces_(0),
       num_positions_(0),
       num_tex_coords_(0),
       num_normals_(0),
@@ -39,6 +49,8 @@ ObjDecoder::ObjDecoder()
       deduplicate_input_values_(true),
       last_material_id_(0),
       use_metadata_(false),
+      num_threads_(1),
+      is_chunk_decoder_(false),
       out_mesh_(nullptr),
       out_point_cloud_(nullptr) {}
 
@@ -50,19 +62,10 @@ Status ObjDecoder::DecodeFromFile(const std::string &file_name,
 
 Status ObjDecoder::DecodeFromFile(const std::string &file_name,
                                   PointCloud *out_point_cloud) {
-  std::ifstream file(file_name, std::ios::binary);
-  if (!file)
+  MappedFile file;
+  if (!file.Open(file_name) || file.size() == 0)
     return Status(Status::IO_ERROR);
-  // Read the whole file into a buffer.
-  auto pos0 = file.tellg();
-  file.seekg(0, std::ios::end);
-  auto file_size = file.tellg() - pos0;
-  if (file_size == 0)
-    return Status(Status::IO_ERROR);
-  file.seekg(0, std::ios::beg);
-  std::vector<char> data(file_size);
-  file.read(&data[0], file_size);
-  buffer_.Init(&data[0], file_size);
+  buffer_.Init(file.data(), file.size());
 
   out_point_cloud_ = out_point_cloud;
   input_file_name_ = file_name;
@@ -82,20 +85,135 @@ Status ObjDecoder::DecodeFromBuffer(DecoderBuffer *buffer,
 }
 
 Status ObjDecoder::DecodeInternal() {
-  // In the first pass, count the number of different elements in the geometry.
-  // In case the desired output is just a point cloud (i.e., when
-  // out_mesh_ == nullptr) the decoder will ignore all information about the
-  // connectivity that may be included in the source data.
-  counting_mode_ = true;
+  // Parse all lines and gather all data in a single pass. In case the desired
+  // output is just a point cloud (i.e., when out_mesh_ == nullptr) the decoder
+  // will ignore all information about the connectivity that may be included in
+  // the source data.
   ResetCounters();
   material_name_to_id_.clear();
-  last_sub_obj_id_ = 0;
-  // Parse all lines.
+  const int num_chunks = static_cast<int>(std::min<int64_t>(
+      num_threads_, buffer_.remaining_size() / kMinParallelChunkSize));
+  Status status = num_chunks > 1 ? ParseDefinitionsInParallel(num_chunks)
+                                 : ParseDefinitions();
+  if (status.ok())
+    status = CreateGeometry();
+  // The parsed data is not needed anymore.
+  ResetCounters();
+  positions_.shrink_to_fit();
+  tex_coords_.shrink_to_fit();
+  normals_.shrink_to_fit();
+  corner_indices_.shrink_to_fit();
+  face_material_ids_.shrink_to_fit();
+  face_sub_obj_ids_.shrink_to_fit();
+  return status;
+}
+
+Status ObjDecoder::ParseDefinitions() {
   Status status(Status::OK);
   while (ParseDefinition(&status) && status.ok()) {
   }
-  if (!status.ok())
-    return status;
+  return status;
+}
+
+Status ObjDecoder::ParseDefinitionsInParallel(int num_chunks) {
+  // Split the input into chunks of roughly the same size that end at line
+  // boundaries.
+  const char *const data = buffer_.data_head();
+  const int64_t data_size = buffer_.remaining_size();
+  std::vector<int64_t> chunk_offsets(1, 0);
+  for (int c = 1; c < num_chunks; ++c) {
+    const int64_t split = std::max(chunk_offsets.back(),
+                                   data_size * c / num_chunks);
+    const void *const line_end =
+        std::memchr(data + split, '\n', data_size - split);
+    if (line_end == nullptr)
+      break;
+    const int64_t offset = static_cast<const char *>(line_end) - data + 1;
+    if (offset < data_size && offset > chunk_offsets.back())
+      chunk_offsets.push_back(offset);
+  }
+  chunk_offsets.push_back(data_size);
+  num_chunks = static_cast<int>(chunk_offsets.size()) - 1;
+
+  std::vector<std::unique_ptr<ObjDecoder>> chunk_decoders(num_chunks);
+  std::vector<Status> chunk_statuses(num_chunks);
+  ThreadPool thread_pool(num_chunks > 1 ? num_chunks : 0);
+  for (int c = 0; c < num_chunks; ++c) {
+    chunk_decoders[c].reset(new ObjDecoder());
+    ObjDecoder *const chunk_decoder = chunk_decoders[c].get();
+    chunk_decoder->is_chunk_decoder_ = true;
+    chunk_decoder->buffer_.Init(data + chunk_offsets[c],
+                                chunk_offsets[c + 1] - chunk_offsets[c]);
+    thread_pool.Schedule([chunk_decoder, &chunk_statuses, c]() {
+      chunk_decoder->ResetCounters();
+      chunk_statuses[c] = chunk_decoder->ParseDefinitions();
+    });
+  }
+  thread_pool.Wait();
+
+  // Merge the chunks in their original order. Chunks are merged before their
+  // status is checked so that errors of the skipped definitions are reported
+  // in the same order as by the serial parser.
+  for (int c = 0; c < num_chunks; ++c) {
+    DRACO_RETURN_IF_ERROR(MergeChunk(*chunk_decoders[c], chunk_offsets[c]));
+    DRACO_RETURN_IF_ERROR(chunk_statuses[c]);
+    chunk_decoders[c].reset();
+  }
+  buffer_.Advance(data_size);
+  return OkStatus();
+}
+
+Status ObjDecoder::MergeChunk(const ObjDecoder &chunk_decoder,
+                              int64_t chunk_offset) {
+  // Relative indices of the chunk were resolved against the number of values
+  // parsed within the chunk. Offset them by the number of preceding values.
+  const int num_preceding_values[3] = {num_positions_, num_tex_coords_,
+                                       num_normals_};
+  const size_t first_corner = corner_indices_.size();
+  corner_indices_.insert(corner_indices_.end(),
+                         chunk_decoder.corner_indices_.begin(),
+                         chunk_decoder.corner_indices_.end());
+  for (const int64_t index : chunk_decoder.relative_corner_indices_) {
+    const int component = index % 3;
+    corner_indices_[first_corner + index / 3][component] +=
+        num_preceding_values[component];
+  }
+  positions_.insert(positions_.end(), chunk_decoder.positions_.begin(),
+                    chunk_decoder.positions_.end());
+  tex_coords_.insert(tex_coords_.end(), chunk_decoder.tex_coords_.begin(),
+                     chunk_decoder.tex_coords_.end());
+  normals_.insert(normals_.end(), chunk_decoder.normals_.begin(),
+                  chunk_decoder.normals_.end());
+  num_positions_ += chunk_decoder.num_positions_;
+  num_tex_coords_ += chunk_decoder.num_tex_coords_;
+  num_normals_ += chunk_decoder.num_normals_;
+
+  // Parse the definitions skipped by the chunk decoder in their original order
+  // and assign the resulting materials and sub-objects to the chunk faces.
+  const DecoderBuffer input_buffer = buffer_;
+  size_t next_definition = 0;
+  for (int f = 0; f <= chunk_decoder.num_obj_faces_; ++f) {
+    while (next_definition < chunk_decoder.skipped_definitions_.size() &&
+           chunk_decoder.skipped_definitions_[next_definition].first == f) {
+      buffer_.StartDecodingFrom(
+          input_buffer.decoded_size() + chunk_offset +
+          chunk_decoder.skipped_definitions_[next_definition].second);
+      Status status(Status::OK);
+      ParseDefinition(&status);
+      DRACO_RETURN_IF_ERROR(status);
+      ++next_definition;
+    }
+    if (f < chunk_decoder.num_obj_faces_) {
+      face_material_ids_.push_back(last_material_id_);
+      face_sub_obj_ids_.push_back(last_sub_obj_id_);
+    }
+  }
+  num_obj_faces_ += chunk_decoder.num_obj_faces_;
+  buffer_ = input_buffer;
+  return OkStatus();
+}
+
+Status ObjDecoder::CreateGeometry() {
   bool use_identity_mapping = false;
   if (num_obj_faces_ == 0) {
     // Mesh has no faces. In this case we try to read the geometry as a point
@@ -113,6 +231,8 @@ Status ObjDecoder::DecodeInternal() {
 
     out_mesh_ = nullptr;  // Treat the output geometry as a point cloud.
     use_identity_mapping = true;
+  } else if (num_positions_ == 0) {
+    return Status(Status::ERROR, "No position attribute");
   }
 
   // Initialize point cloud and mesh properties.
@@ -134,6 +254,9 @@ Status ObjDecoder::DecodeInternal() {
             sizeof(float) * 3, 0);
     pos_att_id_ = out_point_cloud_->AddAttribute(va, use_identity_mapping,
                                                  num_positions_);
+    out_point_cloud_->attribute(pos_att_id_)
+        ->buffer()
+        ->Write(0, positions_.data(), positions_.size() * sizeof(float));
   }
   if (num_tex_coords_ > 0) {
     GeometryAttribute va;
@@ -141,6 +264,9 @@ Status ObjDecoder::DecodeInternal() {
             sizeof(float) * 2, 0);
     tex_att_id_ = out_point_cloud_->AddAttribute(va, use_identity_mapping,
                                                  num_tex_coords_);
+    out_point_cloud_->attribute(tex_att_id_)
+        ->buffer()
+        ->Write(0, tex_coords_.data(), tex_coords_.size() * sizeof(float));
   }
   if (num_normals_ > 0) {
     GeometryAttribute va;
@@ -148,6 +274,9 @@ Status ObjDecoder::DecodeInternal() {
             sizeof(float) * 3, 0);
     norm_att_id_ =
         out_point_cloud_->AddAttribute(va, use_identity_mapping, num_normals_);
+    out_point_cloud_->attribute(norm_att_id_)
+        ->buffer()
+        ->Write(0, normals_.data(), normals_.size() * sizeof(float));
   }
   if (num_materials_ > 0 && num_obj_faces_ > 0) {
     GeometryAttribute va;
@@ -215,15 +344,6 @@ Status ObjDecoder::DecodeInternal() {
     }
   }
 
-  // Perform a second iteration of parsing and fill all the data.
-  counting_mode_ = false;
-  ResetCounters();
-  // Start parsing from the beginning of the buffer again.
-  buffer()->StartDecodingFrom(0);
-  while (ParseDefinition(&status) && status.ok()) {
-  }
-  if (!status.ok())
-    return status;
   if (out_mesh_) {
     // Add faces with identity mapping between vertex and corner indices.
     // Duplicate vertices will get removed later.
@@ -234,13 +354,22 @@ Status ObjDecoder::DecodeInternal() {
       out_mesh_->SetFace(i, face);
     }
   }
+  if (num_obj_faces_ > 0) {
+    for (FaceIndex i(0); i < num_obj_faces_; ++i) {
+      for (int c = 0; c < 3; ++c) {
+        const int corner = 3 * i.value() + c;
+        MapPointToVertexIndices(PointIndex(corner), i,
+                                corner_indices_[corner]);
+      }
+    }
+  }
 #ifdef DRACO_ATTRIBUTE_DEDUPLICATION_SUPPORTED
   if (deduplicate_input_values_) {
     out_point_cloud_->DeduplicateAttributeValues();
   }
   out_point_cloud_->DeduplicatePointIds();
 #endif
-  return status;
+  return OkStatus();
 }
 
 void ObjDecoder::ResetCounters() {
@@ -250,6 +379,14 @@ void ObjDecoder::ResetCounters() {
   num_normals_ = 0;
   last_material_id_ = 0;
   last_sub_obj_id_ = 0;
+  positions_.clear();
+  tex_coords_.clear();
+  normals_.clear();
+  corner_indices_.clear();
+  face_material_ids_.clear();
+  face_sub_obj_ids_.clear();
+  skipped_definitions_.clear();
+  relative_corner_indices_.clear();
 }
 
 bool ObjDecoder::ParseDefinition(Status *status) {
@@ -272,6 +409,13 @@ bool ObjDecoder::ParseDefinition(Status *status) {
     return true;
   if (ParseFace(status))
     return true;
+  if (is_chunk_decoder_) {
+    // All other definitions are parsed when the chunk is merged.
+    skipped_definitions_.push_back(
+        std::make_pair(num_obj_faces_, buffer()->decoded_size()));
+    parser::SkipLine(buffer());
+    return true;
+  }
   if (ParseMaterial(status))
     return true;
   if (ParseMaterialLib(status))
@@ -292,20 +436,17 @@ bool ObjDecoder::ParseVertexPosition(Status *status) {
     return false;
   // Vertex definition found!
   buffer()->Advance(2);
-  if (!counting_mode_) {
-    // Parse three float numbers for vertex position coordinates.
-    float val[3];
-    for (int i = 0; i < 3; ++i) {
-      parser::SkipWhitespace(buffer());
-      if (!parser::ParseFloat(buffer(), val + i)) {
-        *status = Status(Status::ERROR, "Failed to parse a float number");
-        // The definition is processed so return true.
-        return true;
-      }
+  // Parse three float numbers for vertex position coordinates.
+  float val[3];
+  for (int i = 0; i < 3; ++i) {
+    parser::SkipWhitespace(buffer());
+    if (!parser::ParseFloat(buffer(), val + i)) {
+      *status = Status(Status::ERROR, "Failed to parse a float number");
+      // The definition is processed so return true.
+      return true;
     }
-    out_point_cloud_->attribute(pos_att_id_)
-        ->SetAttributeValue(AttributeValueIndex(num_positions_), val);
   }
+  positions_.insert(positions_.end(), val, val + 3);
   ++num_positions_;
   parser::SkipLine(buffer());
   return true;
@@ -320,20 +461,17 @@ bool ObjDecoder::ParseNormal(Status *status) {
     return false;
   // Normal definition found!
   buffer()->Advance(2);
-  if (!counting_mode_) {
-    // Parse three float numbers for the normal vector.
-    float val[3];
-    for (int i = 0; i < 3; ++i) {
-      parser::SkipWhitespace(buffer());
-      if (!parser::ParseFloat(buffer(), val + i)) {
-        *status = Status(Status::ERROR, "Failed to parse a float number");
-        // The definition is processed so return true.
-        return true;
-      }
+  // Parse three float numbers for the normal vector.
+  float val[3];
+  for (int i = 0; i < 3; ++i) {
+    parser::SkipWhitespace(buffer());
+    if (!parser::ParseFloat(buffer(), val + i)) {
+      *status = Status(Status::ERROR, "Failed to parse a float number");
+      // The definition is processed so return true.
+      return true;
     }
-    out_point_cloud_->attribute(norm_att_id_)
-        ->SetAttributeValue(AttributeValueIndex(num_normals_), val);
   }
+  normals_.insert(normals_.end(), val, val + 3);
   ++num_normals_;
   parser::SkipLine(buffer());
   return true;
@@ -348,20 +486,17 @@ bool ObjDecoder::ParseTexCoord(Status *status) {
     return false;
   // Texture coord definition found!
   buffer()->Advance(2);
-  if (!counting_mode_) {
-    // Parse two float numbers for the texture coordinate.
-    float val[2];
-    for (int i = 0; i < 2; ++i) {
-      parser::SkipWhitespace(buffer());
-      if (!parser::ParseFloat(buffer(), val + i)) {
-        *status = Status(Status::ERROR, "Failed to parse a float number");
-        // The definition is processed so return true.
-        return true;
-      }
+  // Parse two float numbers for the texture coordinate.
+  float val[2];
+  for (int i = 0; i < 2; ++i) {
+    parser::SkipWhitespace(buffer());
+    if (!parser::ParseFloat(buffer(), val + i)) {
+      *status = Status(Status::ERROR, "Failed to parse a float number");
+      // The definition is processed so return true.
+      return true;
     }
-    out_point_cloud_->attribute(tex_att_id_)
-        ->SetAttributeValue(AttributeValueIndex(num_tex_coords_), val);
   }
+  tex_coords_.insert(tex_coords_.end(), val, val + 2);
   ++num_tex_coords_;
   parser::SkipLine(buffer());
   return true;
@@ -376,65 +511,50 @@ bool ObjDecoder::ParseFace(Status *status) {
     return false;
   // Face definition found!
   buffer()->Advance(1);
-  if (!counting_mode_) {
-    std::array<int32_t, 3> indices[4];
-    // Parse face indices (we try to look for up to four to support quads).
-    int num_valid_indices = 0;
-    for (int i = 0; i < 4; ++i) {
-      if (!ParseVertexIndices(&indices[i])) {
-        if (i == 3) {
-          break;  // It's OK if there is no fourth vertex index.
-        }
-        *status = Status(Status::ERROR, "Failed to parse vertex indices");
-        return true;
-      }
-      ++num_valid_indices;
-    }
-    // Process the first face.
-    for (int i = 0; i < 3; ++i) {
-      const PointIndex vert_id(3 * num_obj_faces_ + i);
-      MapPointToVertexIndices(vert_id, indices[i]);
-    }
-    ++num_obj_faces_;
-    if (num_valid_indices == 4) {
-      // Add an additional triangle for the quad.
-      //
-      //   3----2
-      //   |  / |
-      //   | /  |
-      //   0----1
-      //
-      const PointIndex vert_id(3 * num_obj_faces_);
-      MapPointToVertexIndices(vert_id, indices[0]);
-      MapPointToVertexIndices(vert_id + 1, indices[2]);
-      MapPointToVertexIndices(vert_id + 2, indices[3]);
-      ++num_obj_faces_;
-    }
-  } else {
-    // We are in the counting mode.
-    // We need to determine how many triangles are in the obj face.
-    // Go over the line and check how many gaps there are between non-empty
-    // sub-strings.
-    parser::SkipWhitespace(buffer());
-    int num_indices = 0;
-    bool is_end = false;
-    while (buffer()->Peek(&c) && c != '\n') {
-      if (parser::PeekWhitespace(buffer(), &is_end)) {
-        buffer()->Advance(1);
-      } else {
-        // Non-whitespace reached.. assume it's index declaration, skip it.
-        num_indices++;
-        while (!parser::PeekWhitespace(buffer(), &is_end) && !is_end) {
-          buffer()->Advance(1);
-        }
+  std::array<int32_t, 3> indices[4];
+  int relative_masks[4];
+  // Parse face indices (we try to look for up to four to support quads).
+  int num_valid_indices = 0;
+  for (int i = 0; i < 4; ++i) {
+    if (!ParseVertexIndices(&indices[i])) {
+      if (i == 3) {
+        break;  // It's OK if there is no fourth vertex index.
       }
+      *status = Status(Status::ERROR, "Failed to parse vertex indices");
+      return true;
     }
-    if (num_indices < 3 || num_indices > 4) {
+    relative_masks[i] = ResolveVertexIndices(&indices[i]);
+    ++num_valid_indices;
+  }
+  // Make sure there are no more indices on the line (comments are allowed).
+  bool is_end = false;
+  while (buffer()->Peek(&c) && c != '\n' && c != '#') {
+    if (!parser::PeekWhitespace(buffer(), &is_end)) {
       *status = Status(Status::ERROR, "Invalid number of indices on a face");
-      return false;
+      return true;
     }
-    // Either one or two new triangles.
-    num_obj_faces_ += num_indices - 2;
+    buffer()->Advance(1);
+  }
+  // Process the first face.
+  for (int i = 0; i < 3; ++i)
+    AddCorner(indices[i], relative_masks[i]);
+  face_material_ids_.push_back(last_material_id_);
+  face_sub_obj_ids_.push_back(last_sub_obj_id_);
+  ++num_obj_faces_;
+  if (num_valid_indices == 4) {
+    // Add an additional triangle for the quad.
+    //
+    //   3----2
+    //   |  / |
+    //   | /  |
+    //   0----1
+    //
+    AddCorner(indices[0], relative_masks[0]);
+    AddCorner(indices[2], relative_masks[2]);
+    AddCorner(indices[3], relative_masks[3]);
+    face_material_ids_.push_back(last_material_id_);
+    face_sub_obj_ids_.push_back(last_sub_obj_id_);
+    ++num_obj_faces_;
   }
   parser::SkipLine(buffer());
   return true;
@@ -470,9 +590,6 @@ bool ObjDecoder::ParseMaterialLib(Status *status) {
 }
 
 bool ObjDecoder::ParseMaterial(Status * /* status */) {
-  // In second pass, skip when we don't use materials.
-  if (!counting_mode_ && material_att_id_ < 0)
-    return false;
   std::array<char, 6> c;
   if (!buffer()->Peek(&c)) {
     return false;
@@ -488,8 +605,8 @@ bool ObjDecoder::ParseMaterial(Status * /* status */) {
     return false;
   auto it = material_name_to_id_.find(mat_name);
   if (it == material_name_to_id_.end()) {
-    // In first pass, materials found in obj that's not in the .mtl file
-    // will be added to the list.
+    // Materials found in obj that's not in the .mtl file will be added to the
+    // list.
     last_material_id_ = num_materials_;
     material_name_to_id_[mat_name] = num_materials_++;
     return true;
@@ -562,65 +679,67 @@ bool ObjDecoder::ParseVertexIndices(std::array<int32_t, 3> *out_indices) {
   return true;
 }
 
-void ObjDecoder::MapPointToVertexIndices(
-    PointIndex vert_id, const std::array<int32_t, 3> &indices) {
-  // Use face entries to store mapping between vertex and attribute indices
-  // (positions, texture coordinates and normal indices).
+int ObjDecoder::ResolveVertexIndices(std::array<int32_t, 3> *indices) const {
   // Any given index is used when indices[x] != 0. For positive values, the
   // point is mapped directly to the specified attribute index. Negative input
   // indices indicate addressing from the last element (e.g. -1 is the last
   // attribute value of a given type, -2 the second last, etc.).
-  if (indices[0] > 0) {
-    out_point_cloud_->attribute(pos_att_id_)
-        ->SetPointMapEntry(vert_id, AttributeValueIndex(indices[0] - 1));
-  } else if (indices[0] < 0) {
-    out_point_cloud_->attribute(pos_att_id_)
-        ->SetPointMapEntry(vert_id,
-                           AttributeValueIndex(num_positions_ + indices[0]));
+  const int num_values[3] = {num_positions_, num_tex_coords_, num_normals_};
+  int relative_mask = 0;
+  for (int i = 0; i < 3; ++i) {
+    int32_t &index = (*indices)[i];
+    if (index > 0) {
+      index = index - 1;
+    } else if (index < 0) {
+      index = num_values[i] + index;
+      relative_mask |= 1 << i;
+    }
+    // Texture and normal indices that were not provided but are expected
+    // use 0 as the default value.
   }
+  return relative_mask;
+}
 
-  if (tex_att_id_ >= 0) {
-    if (indices[1] > 0) {
-      out_point_cloud_->attribute(tex_att_id_)
-          ->SetPointMapEntry(vert_id, AttributeValueIndex(indices[1] - 1));
-    } else if (indices[1] < 0) {
-      out_point_cloud_->attribute(tex_att_id_)
-          ->SetPointMapEntry(vert_id,
-                             AttributeValueIndex(num_tex_coords_ + indices[1]));
-    } else {
-      // Texture index not provided but expected. Insert 0 entry as the
-      // default value.
-      out_point_cloud_->attribute(tex_att_id_)
-          ->SetPointMapEntry(vert_id, AttributeValueIndex(0));
+void ObjDecoder::AddCorner(const std::array<int32_t, 3> &indices,
+                           int relative_mask) {
+  if (is_chunk_decoder_) {
+    for (int i = 0; i < 3; ++i) {
+      if (relative_mask & (1 << i)) {
+        relative_corner_indices_.push_back(
+            static_cast<int64_t>(corner_indices_.size()) * 3 + i);
+      }
     }
   }
+  corner_indices_.push_back(indices);
+}
 
+void ObjDecoder::MapPointToVertexIndices(
+    PointIndex vert_id, FaceIndex fi, const std::array<int32_t, 3> &indices) {
+  // Use face entries to store mapping between vertex and attribute indices
+  // (positions, texture coordinates and normal indices).
+  out_point_cloud_->attribute(pos_att_id_)
+      ->SetPointMapEntry(vert_id, AttributeValueIndex(indices[0]));
+  if (tex_att_id_ >= 0) {
+    out_point_cloud_->attribute(tex_att_id_)
+        ->SetPointMapEntry(vert_id, AttributeValueIndex(indices[1]));
+  }
   if (norm_att_id_ >= 0) {
-    if (indices[2] > 0) {
-      out_point_cloud_->attribute(norm_att_id_)
-          ->SetPointMapEntry(vert_id, AttributeValueIndex(indices[2] - 1));
-    } else if (indices[2] < 0) {
-      out_point_cloud_->attribute(norm_att_id_)
-          ->SetPointMapEntry(vert_id,
-                             AttributeValueIndex(num_normals_ + indices[2]));
-    } else {
-      // Normal index not provided but expected. Insert 0 entry as the default
-      // value.
-      out_point_cloud_->attribute(norm_att_id_)
-          ->SetPointMapEntry(vert_id, AttributeValueIndex(0));
-    }
+    out_point_cloud_->attribute(norm_att_id_)
+        ->SetPointMapEntry(vert_id, AttributeValueIndex(indices[2]));
   }
 
   // Assign material index to the point if it is available.
   if (material_att_id_ >= 0) {
     out_point_cloud_->attribute(material_att_id_)
-        ->SetPointMapEntry(vert_id, AttributeValueIndex(last_material_id_));
+        ->SetPointMapEntry(
+            vert_id, AttributeValueIndex(face_material_ids_[fi.value()]));
   }
 
   // Assign sub-object index to the point if it is available.
   if (sub_obj_att_id_ >= 0) {
     out_point_cloud_->attribute(sub_obj_att_id_)
-        ->SetPointMapEntry(vert_id, AttributeValueIndex(last_sub_obj_id_));
+        ->SetPointMapEntry(vert_id,
+                           AttributeValueIndex(face_sub_obj_ids_[fi.value()]));
   }
 }
 
@@ -635,22 +754,14 @@ bool ObjDecoder::ParseMaterialFile(const std::string &file_name,
   }
   full_path += file_name;
 
-  std::ifstream file(full_path, std::ios::binary);
-  if (!file)
-    return false;
-  // Read the whole file into a buffer.
-  file.seekg(0, std::ios::end);
-  const std::string::size_type file_size = file.tellg();
-  if (file_size == 0)
+  MappedFile file;
+  if (!file.Open(full_path) || file.size() == 0)
     return false;
-  file.seekg(0, std::ios::beg);
-  std::vector<char> data(file_size);
-  file.read(&data[0], file_size);
 
   // Backup the original decoder buffer.
   DecoderBuffer old_buffer = buffer_;
 
-  buffer_.Init(&data[0], file_size);
+  buffer_.Init(file.data(), file.size());
 
   num_materials_ = 0;
   while (ParseMaterialFileDefinition(status)) {
@@ -15,8 +15,11 @@
 #ifndef DRACO_IO_OBJ_DECODER_H_
 #define DRACO_IO_OBJ_DECODER_H_
 
+#include <array>
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "draco/core/decoder_buffer.h"
 #include "draco/core/status.h"
@@ -28,6 +31,13 @@ namespace draco {
 // connectivity data is not needed).. This decoder can handle decoding of
 // positions, texture coordinates, normals and triangular faces.
 // All other geometry properties are ignored.
+// The input is parsed in a single pass. All parsed values are gathered in
+// growable arrays and the output geometry is created once the whole input has
+// been processed.
+// When more than one parsing thread is requested, large inputs are split at
+// line boundaries into chunks that are parsed concurrently. The parsed chunks
+// are then merged in their original order, which produces the same geometry
+// as the serial parsing.
 class ObjDecoder {
  public:
   ObjDecoder();
@@ -49,15 +59,32 @@ class ObjDecoder {
   // Flag for whether using metadata to record other information in the obj
   // file, e.g. material names, object names.
   void set_use_metadata(bool flag) { use_metadata_ = flag; }
+  // Sets the maximum number of threads used for parsing of the input data.
+  // Default: 1
+  void set_num_threads(int num_threads) { num_threads_ = num_threads; }
 
  protected:
   Status DecodeInternal();
   DecoderBuffer *buffer() { return &buffer_; }
 
  private:
-  // Resets internal counters for attributes and faces.
+  // Resets internal counters and removes all parsed attributes and faces.
   void ResetCounters();
 
+  // Parses all definitions of the input buffer serially.
+  Status ParseDefinitions();
+
+  // Splits the input buffer into |num_chunks| chunks of whole lines, parses
+  // them concurrently and merges the parsed data.
+  Status ParseDefinitionsInParallel(int num_chunks);
+
+  // Appends data parsed by |chunk_decoder| to the data of this decoder.
+  // |chunk_offset| is the position of the chunk in the input buffer.
+  Status MergeChunk(const ObjDecoder &chunk_decoder, int64_t chunk_offset);
+
+  // Creates attributes and faces of the output geometry from the parsed data.
+  Status CreateGeometry();
+
   // Parses the next mesh property definition (position, tex coord, normal, or
   // face). If the parsed data is unrecognized, it will be skipped.
   // Returns false when the end of file was reached.
@@ -78,18 +105,26 @@ class ObjDecoder {
   // Returns false on error.
   bool ParseVertexIndices(std::array<int32_t, 3> *out_indices);
 
-  // Maps specified point index to the parsed vertex indices (triplet of
-  // position, texture coordinate, and normal indices) .
-  void MapPointToVertexIndices(PointIndex pi,
+  // Converts parsed vertex indices into zero based indices of the parsed
+  // values. Negative input indices address values relative to the last parsed
+  // value. Indices that are not present are set to 0.
+  // Returns a bit mask of the indices that were relative.
+  int ResolveVertexIndices(std::array<int32_t, 3> *indices) const;
+
+  // Adds a face corner with the given resolved vertex |indices|.
+  // |relative_mask| is the bit mask returned by ResolveVertexIndices().
+  void AddCorner(const std::array<int32_t, 3> &indices, int relative_mask);
+
+  // Maps specified point index to the resolved vertex indices (triplet of
+  // position, texture coordinate, and normal indices) and to the material and
+  // sub-object of face |fi|.
+  void MapPointToVertexIndices(PointIndex pi, FaceIndex fi,
                                const std::array<int32_t, 3> &indices);
 
   // Parses material file definitions from a separate file.
   bool ParseMaterialFile(const std::string &file_name, Status *status);
   bool ParseMaterialFileDefinition(Status *status);
 
-  // If set to true, the parser will count the number of various definitions
-  // but it will not parse the actual data or add any new entries to the mesh.
-  bool counting_mode_;
   int num_obj_faces_;
   int num_positions_;
   int num_tex_coords_;
@@ -114,6 +149,29 @@ class ObjDecoder {
   std::unordered_map<std::string, int> obj_name_to_id_;
 
   bool use_metadata_;
+  int num_threads_;
+
+  // Set for decoders that parse a single chunk of the input of another decoder.
+  // Chunk decoders don't know the state of the preceding chunks. Therefore
+  // they don't process definitions that depend on it (such as materials and
+  // sub-objects) and they resolve relative vertex indices only partially.
+  bool is_chunk_decoder_;
+  // Offsets of definitions skipped by a chunk decoder, paired with the number
+  // of faces parsed before each definition.
+  std::vector<std::pair<int, int64_t>> skipped_definitions_;
+  // Components of |corner_indices_| (corner * 3 + component) that a chunk
+  // decoder resolved relative to the number of values parsed in the chunk.
+  std::vector<int64_t> relative_corner_indices_;
+
+  // Parsed attribute values.
+  std::vector<float> positions_;
+  std::vector<float> tex_coords_;
+  std::vector<float> normals_;
+  // Resolved vertex indices of all corners of the parsed faces.
+  std::vector<std::array<int32_t, 3>> corner_indices_;
+  // Material and sub-object ids of the parsed faces.
+  std::vector<int32_t> face_material_ids_;
+  std::vector<int32_t> face_sub_obj_ids_;
 
   DecoderBuffer buffer_;
 
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 //
+#include <cstring>
 #include <sstream>
 
 #include "draco/core/draco_test_base.h"
@@ -187,4 +188,109 @@ TEST_F(ObjDecoderTest, TestObjDecodingAll) {
   test_decoding("inf_nan.obj");
 }
 
+TEST_F(ObjDecoderTest, RelativeIndicesAndComments) {
+  // Tests decoding of faces that use negative (relative) indices and that are
+  // followed by comments. The negative indices must be resolved using the
+  // values parsed before the face.
+  const std::string data =
+      "v 0 0 0\n"
+      "v 1 0 0\n"
+      "v 1 1 0\n"
+      "f -3 -2 -1 # First face.\n"
+      "v 0 1 0\n"
+      "f 1 3 -1\n";
+  DecoderBuffer buffer;
+  buffer.Init(data.data(), data.size());
+  ObjDecoder decoder;
+  decoder.set_deduplicate_input_values(false);
+  Mesh mesh;
+  ASSERT_TRUE(decoder.DecodeFromBuffer(&buffer, &mesh).ok());
+  ASSERT_EQ(mesh.num_faces(), 2);
+  const PointAttribute *const pos_att =
+      mesh.GetNamedAttribute(GeometryAttribute::POSITION);
+  ASSERT_NE(pos_att, nullptr);
+  const float expected_x[2][3] = {{0.f, 1.f, 1.f}, {0.f, 1.f, 0.f}};
+  const float expected_y[2][3] = {{0.f, 0.f, 1.f}, {0.f, 1.f, 1.f}};
+  for (FaceIndex f(0); f < 2; ++f) {
+    for (int c = 0; c < 3; ++c) {
+      float pos[3];
+      pos_att->GetMappedValue(mesh.face(f)[c], pos);
+      ASSERT_EQ(pos[0], expected_x[f.value()][c]);
+      ASSERT_EQ(pos[1], expected_y[f.value()][c]);
+    }
+  }
+}
+
+TEST_F(ObjDecoderTest, TooManyFaceIndices) {
+  const std::string data =
+      "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nv 0 2 0\nf 1 2 3 4 5\n";
+  DecoderBuffer buffer;
+  buffer.Init(data.data(), data.size());
+  ObjDecoder decoder;
+  Mesh mesh;
+  ASSERT_FALSE(decoder.DecodeFromBuffer(&buffer, &mesh).ok());
+}
+
+TEST_F(ObjDecoderTest, ParallelParsing) {
+  // Tests that parsing of a large input in multiple threads produces the same
+  // mesh as the serial parsing. The input mixes absolute and relative indices
+  // with material and sub-object definitions so that the chunk boundaries
+  // split all of them.
+  const int grid_size = 300;
+  std::ostringstream obj;
+  obj << "# Generated grid.\n";
+  for (int y = 0; y < grid_size; ++y) {
+    for (int x = 0; x < grid_size; ++x) {
+      obj << "v " << x << " " << y << " " << (x * y) % 7 << "\n";
+      obj << "vt " << x * 0.5f << " " << y * 0.25f << "\n";
+    }
+  }
+  for (int y = 0; y + 1 < grid_size; ++y) {
+    obj << "o row" << y % 5 << "\nusemtl mat" << y % 3 << "\n";
+    for (int x = 0; x + 1 < grid_size; ++x) {
+      const int v = y * grid_size + x + 1;
+      // Relative index of vertex |v + grid_size + 1|.
+      const int relative_v = v + grid_size - grid_size * grid_size;
+      obj << "f " << v << "/" << v << " " << v + 1 << "/" << v + 1 << " "
+          << relative_v << "/" << v + grid_size + 1 << " " << v + grid_size
+          << "\n";
+    }
+  }
+  // Relative indices referencing values parsed right before the face.
+  obj << "v 0 0 1\nv 1 0 1\nv 0 1 1\nf -3 -2 -1\n";
+  const std::string data = obj.str();
+
+  std::unique_ptr<Mesh> meshes[2];
+  for (int i = 0; i < 2; ++i) {
+    DecoderBuffer buffer;
+    buffer.Init(data.data(), data.size());
+    ObjDecoder decoder;
+    decoder.set_deduplicate_input_values(false);
+    decoder.set_num_threads(i == 0 ? 1 : 4);
+    meshes[i].reset(new Mesh());
+    ASSERT_TRUE(decoder.DecodeFromBuffer(&buffer, meshes[i].get()).ok());
+  }
+  const Mesh &serial_mesh = *meshes[0];
+  const Mesh &parallel_mesh = *meshes[1];
+  ASSERT_EQ(serial_mesh.num_faces(), 2 * (grid_size - 1) * (grid_size - 1) + 1);
+  ASSERT_EQ(serial_mesh.num_faces(), parallel_mesh.num_faces());
+  ASSERT_EQ(serial_mesh.num_points(), parallel_mesh.num_points());
+  ASSERT_EQ(serial_mesh.num_attributes(), 4);
+  ASSERT_EQ(serial_mesh.num_attributes(), parallel_mesh.num_attributes());
+  for (FaceIndex f(0); f < serial_mesh.num_faces(); ++f) {
+    ASSERT_EQ(serial_mesh.face(f), parallel_mesh.face(f));
+  }
+  for (int a = 0; a < serial_mesh.num_attributes(); ++a) {
+    const PointAttribute *const serial_att = serial_mesh.attribute(a);
+    const PointAttribute *const parallel_att = parallel_mesh.attribute(a);
+    ASSERT_EQ(serial_att->size(), parallel_att->size());
+    for (PointIndex p(0); p < serial_mesh.num_points(); ++p) {
+      ASSERT_EQ(serial_att->mapped_index(p), parallel_att->mapped_index(p));
+    }
+    ASSERT_EQ(0, memcmp(serial_att->buffer()->data(),
+                        parallel_att->buffer()->data(),
+                        serial_att->buffer()->data_size()));
+  }
+}
+
 }  // namespace draco
@@ -17,7 +17,12 @@
 #include <algorithm>
 #include <cctype>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <iterator>
+#include <limits>
+#include <locale>
+#include <sstream>
 
 namespace draco {
 namespace parser {
@@ -71,68 +76,168 @@ void SkipLine(DecoderBuffer *buffer) {
   }
 }
 
+namespace {
+
+// Maximum number of decimal digits that always fit into uint64_t.
+constexpr int kMaxMantissaDigits = 19;
+
+// Powers of ten that are exactly representable in double precision.
+constexpr double kExactPowersOfTen[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+constexpr int kMaxExactPowerOfTen = 22;
+
+inline bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+// Accumulates decimal digits starting at |*pos| into |*mantissa| and advances
+// |*pos| past them. Digits that don't fit into the mantissa are skipped and
+// |*is_truncated| is set. Returns the number of parsed digits.
+int ParseDigits(const char **pos, const char *end, uint64_t *mantissa,
+                int *num_mantissa_digits, bool *is_truncated) {
+  // Accumulate the digits in local variables so that they can stay in
+  // registers.
+  const char *p = *pos;
+  uint64_t m = *mantissa;
+  int num_digits = *num_mantissa_digits;
+  for (; p < end && IsDigit(*p); ++p) {
+    if (num_digits < kMaxMantissaDigits) {
+      m = m * 10 + (*p - '0');
+      ++num_digits;
+    } else {
+      *is_truncated = true;
+    }
+  }
+  *mantissa = m;
+  *num_mantissa_digits = num_digits;
+  const int num_parsed_digits = static_cast<int>(p - *pos);
+  *pos = p;
+  return num_parsed_digits;
+}
+
+// Returns true when |value| lies exactly halfway between two adjacent normal
+// single precision numbers. Rounding of such values to float may differ from
+// rounding of the original decimal number.
+inline bool IsFloatRoundingTie(double value) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  // Double has 29 more mantissa bits than float.
+  const uint64_t kTieMask = (uint64_t(1) << 29) - 1;
+  return (bits & kTieMask) == (uint64_t(1) << 28);
+}
+
+// Parses special floating point constants (inf, nan) with the given |sign|.
+bool ParseFloatConstant(DecoderBuffer *buffer, int sign, float *value) {
+  std::string text;
+  if (!ParseString(buffer, &text))
+    return false;
+  double v;
+  if (text == "inf" || text == "Inf") {
+    v = std::numeric_limits<double>::infinity();
+  } else if (text == "nan" || text == "NaN") {
+    v = nan("");
+  } else {
+    // Invalid string.
+    return false;
+  }
+  *value = (sign < 0) ? -v : v;
+  return true;
+}
+
+// Converts the number stored in [|begin|, |end|) using the standard library.
+// The stream uses the classic locale, so the result does not depend on the
+// decimal separator of the global C locale like strtof() would.
+float ParseFloatSlow(const char *begin, const char *end) {
+  std::istringstream stream(std::string(begin, end));
+  stream.imbue(std::locale::classic());
+  float value = 0.f;
+  stream >> value;
+  if (stream.fail() && std::fabs(value) == std::numeric_limits<float>::max()) {
+    // Out of range values are clamped by the stream, return infinity instead.
+    value = std::copysign(std::numeric_limits<float>::infinity(), value);
+  }
+  return value;
+}
+
+}  // namespace
+
 bool ParseFloat(DecoderBuffer *buffer, float *value) {
+  const char *const begin = buffer->data_head();
+  const char *const end = begin + buffer->remaining_size();
+  const char *p = begin;
+
   // Read optional sign.
-  char ch;
-  if (!buffer->Peek(&ch))
+  if (p == end)
     return false;
-  int sign = GetSignValue(ch);
+  int sign = GetSignValue(*p);
   if (sign != 0) {
-    buffer->Advance(1);
+    ++p;
   } else {
     sign = 1;
   }
 
-  // Parse integer component.
-  bool have_digits = false;
-  double v = 0.0;
-  while (buffer->Peek(&ch) && ch >= '0' && ch <= '9') {
-    v *= 10.0;
-    v += (ch - '0');
-    buffer->Advance(1);
-    have_digits = true;
+  // Gather all significant digits into a single integer mantissa.
+  uint64_t mantissa = 0;
+  int num_mantissa_digits = 0;
+  bool is_truncated = false;
+  const int num_integer_digits =
+      ParseDigits(&p, end, &mantissa, &num_mantissa_digits, &is_truncated);
+  int num_fraction_digits = 0;
+  if (p < end && *p == '.') {
+    ++p;
+    num_fraction_digits =
+        ParseDigits(&p, end, &mantissa, &num_mantissa_digits, &is_truncated);
   }
-  if (ch == '.') {
-    // Parse fractional component.
-    buffer->Advance(1);
-    double fraction = 1.0;
-    while (buffer->Peek(&ch) && ch >= '0' && ch <= '9') {
-      fraction *= 0.1;
-      v += (ch - '0') * fraction;
-      buffer->Advance(1);
-      have_digits = true;
-    }
+
+  if (num_integer_digits == 0 && num_fraction_digits == 0) {
+    buffer->Advance(p - begin);
+    return ParseFloatConstant(buffer, sign, value);
   }
 
-  if (!have_digits) {
-    // Check for special constants (inf, nan, ...).
-    std::string text;
-    if (!ParseString(buffer, &text))
-      return false;
-    if (text == "inf" || text == "Inf") {
-      v = std::numeric_limits<double>::infinity();
-    } else if (text == "nan" || text == "NaN") {
-      v = nan("");
-    } else {
-      // Invalid string.
+  // Handle exponent if present.
+  int32_t exponent = 0;
+  if (p < end && (*p == 'e' || *p == 'E')) {
+    ++p;  // Skip 'e' marker.
+    int exponent_sign = 1;
+    if (p < end && GetSignValue(*p) != 0) {
+      exponent_sign = GetSignValue(*p);
+      ++p;
+    }
+    if (p == end || !IsDigit(*p)) {
+      buffer->Advance(p - begin);
       return false;
     }
-  } else {
-    // Handle exponent if present.
-    if (ch == 'e' || ch == 'E') {
-      buffer->Advance(1);  // Skip 'e' marker.
-
-      // Parse integer exponent.
-      int32_t exponent = 0;
-      if (!ParseSignedInt(buffer, &exponent))
-        return false;
-
-      // Apply exponent scaling to value.
-      v *= pow(10.0, exponent);
+    for (; p < end && IsDigit(*p); ++p) {
+      // Larger exponents overflow or underflow any float anyway.
+      if (exponent < 100000)
+        exponent = exponent * 10 + (*p - '0');
     }
+    exponent *= exponent_sign;
   }
+  buffer->Advance(p - begin);
 
-  *value = (sign < 0) ? -v : v;
+  const int32_t exponent10 = exponent - num_fraction_digits;
+  if (!is_truncated && mantissa <= (uint64_t(1) << 53) &&
+      exponent10 >= -kMaxExactPowerOfTen &&
+      exponent10 <= kMaxExactPowerOfTen) {
+    // Both the mantissa and the power of ten are exact, so the division or
+    // multiplication below is correctly rounded (Clinger's fast path).
+    double v = static_cast<double>(mantissa);
+    if (exponent10 < 0) {
+      v /= kExactPowersOfTen[-exponent10];
+    } else {
+      v *= kExactPowersOfTen[exponent10];
+    }
+    if (v == 0.0 || (v >= std::numeric_limits<float>::min() &&
+                     v <= std::numeric_limits<float>::max() &&
+                     !IsFloatRoundingTie(v))) {
+      *value = static_cast<float>((sign < 0) ? -v : v);
+      return true;
+    }
+  }
+  // Fall back to the correctly rounded conversion of the standard library.
+  // This is needed only for numbers with many significant digits or large
+  // exponents.
+  *value = ParseFloatSlow(begin, p);
   return true;
 }
 
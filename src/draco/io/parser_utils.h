@@ -31,7 +31,8 @@ void SkipWhitespace(DecoderBuffer *buffer);
 bool PeekWhitespace(DecoderBuffer *buffer, bool *end_reached);
 void SkipLine(DecoderBuffer *buffer);
 
-// Parses signed floating point number or returns false on error.
+// Parses signed floating point number or returns false on error. The parsed
+// value is correctly rounded to the nearest float.
 bool ParseFloat(DecoderBuffer *buffer, float *value);
 
 // Parses a signed integer (can be preceded by '-' or '+' characters.
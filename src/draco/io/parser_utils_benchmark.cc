@@ -0,0 +1,134 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include <cstdlib>
+#include <sstream>
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "draco/core/draco_benchmark_utils.h"
+#include "draco/io/parser_utils.h"
+
+namespace draco {
+
+namespace {
+
+// Test files whose floating point values are parsed.
+const char *const kInputFiles[] = {"bun_zipper.ply", "cube_subd.obj",
+                                   "mat_test.obj", "test_sphere.obj"};
+
+// Returns the floating point values of the input file with index |input|
+// separated by single spaces, the way they appear in the file. For OBJ files
+// these are the values of all vertex lines ("v", "vt" and "vn") and for PLY
+// files the values of all vertex lines after the header. The values are
+// extracted only once. |num_values| is set to the number of the values.
+const std::string &GetInputValues(int input, int *num_values) {
+  static std::string values[sizeof(kInputFiles) / sizeof(kInputFiles[0])];
+  static int value_counts[sizeof(kInputFiles) / sizeof(kInputFiles[0])];
+  if (values[input].empty()) {
+    const std::vector<char> data = ReadBenchmarkFile(kInputFiles[input]);
+    std::istringstream stream(std::string(data.begin(), data.end()));
+    const bool is_ply = std::string(kInputFiles[input]).find(".ply") !=
+                        std::string::npos;
+    int num_ply_vertices = 0;
+    bool ply_header = is_ply;
+    std::string line;
+    while (std::getline(stream, line)) {
+      std::istringstream line_stream(line);
+      std::string token;
+      if (ply_header) {
+        line_stream >> token;
+        if (token == "element") {
+          std::string name;
+          line_stream >> name;
+          if (name == "vertex")
+            line_stream >> num_ply_vertices;
+        } else if (token == "end_header") {
+          ply_header = false;
+        }
+        continue;
+      }
+      if (is_ply) {
+        if (num_ply_vertices-- <= 0)
+          break;
+      } else {
+        line_stream >> token;
+        if (token != "v" && token != "vt" && token != "vn")
+          continue;
+      }
+      while (line_stream >> token) {
+        values[input] += token;
+        values[input] += ' ';
+        ++value_counts[input];
+      }
+    }
+  }
+  *num_values = value_counts[input];
+  return values[input];
+}
+
+// Parses the values of the input file state.range(0) with parser::ParseFloat().
+void BM_ParseFloat(benchmark::State &state) {
+  const int input = static_cast<int>(state.range(0));
+  int num_values;
+  const std::string &values = GetInputValues(input, &num_values);
+  for (auto _ : state) {
+    DecoderBuffer buffer;
+    buffer.Init(values.data(), values.size());
+    for (int i = 0; i < num_values; ++i) {
+      float value;
+      if (!parser::ParseFloat(&buffer, &value)) {
+        state.SkipWithError("Failed to parse a value.");
+        return;
+      }
+      benchmark::DoNotOptimize(value);
+      parser::SkipWhitespace(&buffer);
+    }
+  }
+  state.SetLabel(kInputFiles[input]);
+  state.SetItemsProcessed(state.iterations() * num_values);
+  state.SetBytesProcessed(state.iterations() * values.size());
+}
+
+// Parses the same values as BM_ParseFloat with strtof() for reference.
+void BM_ParseFloatStrtof(benchmark::State &state) {
+  const int input = static_cast<int>(state.range(0));
+  int num_values;
+  const std::string &values = GetInputValues(input, &num_values);
+  for (auto _ : state) {
+    const char *p = values.c_str();
+    for (int i = 0; i < num_values; ++i) {
+      char *end;
+      const float value = strtof(p, &end);  // NOLINT
+      benchmark::DoNotOptimize(value);
+      p = end;
+    }
+  }
+  state.SetLabel(kInputFiles[input]);
+  state.SetItemsProcessed(state.iterations() * num_values);
+  state.SetBytesProcessed(state.iterations() * values.size());
+}
+
+BENCHMARK(BM_ParseFloat)
+    ->ArgName("input")
+    ->DenseRange(0, 3)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ParseFloatStrtof)
+    ->ArgName("input")
+    ->DenseRange(0, 3)
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace
+
+}  // namespace draco
@@ -0,0 +1,127 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "draco/io/parser_utils.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+#include "draco/core/draco_test_base.h"
+
+namespace draco {
+
+class ParserUtilsTest : public ::testing::Test {
+ protected:
+  // Parses |text| and checks that the result matches strtof() and that the
+  // whole text was consumed.
+  void TestParseFloat(const std::string &text) const {
+    DecoderBuffer buffer;
+    buffer.Init(text.data(), text.size());
+    float value;
+    ASSERT_TRUE(parser::ParseFloat(&buffer, &value)) << text;
+    ASSERT_EQ(buffer.remaining_size(), 0) << text;
+    const float expected_value = strtof(text.c_str(), nullptr);
+    if (std::isnan(expected_value)) {
+      ASSERT_TRUE(std::isnan(value)) << text;
+    } else {
+      ASSERT_EQ(value, expected_value) << text;
+      ASSERT_EQ(std::signbit(value), std::signbit(expected_value)) << text;
+    }
+  }
+};
+
+TEST_F(ParserUtilsTest, TestParseFloat) {
+  const char *const texts[] = {"0",
+                                "-0",
+                                "+1",
+                                "1.",
+                                ".5",
+                                "-.25",
+                                "0.1",
+                                "3.14159265358979323846",
+                                "0.70710678118654752440",
+                                "1e10",
+                                "1E-10",
+                                "-2.5e+3",
+                                "123456789012345678901234",
+                                "0.000000000000000000000000000001",
+                                "16777217",
+                                "4.0000004",
+                                "1e38",
+                                "3.4028236e38",
+                                "1.17549435e-38",
+                                "1e-45",
+                                "1e100000",
+                                "1e-100000",
+                                "inf",
+                                "-inf",
+                                "nan"};
+  for (const char *text : texts) {
+    TestParseFloat(text);
+  }
+}
+
+TEST_F(ParserUtilsTest, TestParseFloatRandom) {
+  // Compares the parser with strtof() on random numbers of various precisions
+  // and magnitudes.
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<double> mantissa_distribution(-10.0, 10.0);
+  std::uniform_int_distribution<int> exponent_distribution(-40, 40);
+  std::uniform_int_distribution<int> precision_distribution(1, 20);
+  char text[64];
+  for (int i = 0; i < 100000; ++i) {
+    const double v = mantissa_distribution(generator) *
+                     std::pow(10.0, exponent_distribution(generator));
+    const int precision = precision_distribution(generator);
+    if (i % 2 == 0) {
+      snprintf(text, sizeof(text), "%.*g", precision, v);
+    } else {
+      snprintf(text, sizeof(text), "%.*f", precision, v / 1e30);
+    }
+    TestParseFloat(text);
+  }
+}
+
+TEST_F(ParserUtilsTest, TestParseFloatStopsAtDelimiter) {
+  const std::string text = "1.5/2 -3e2\n";
+  DecoderBuffer buffer;
+  buffer.Init(text.data(), text.size());
+  float value;
+  ASSERT_TRUE(parser::ParseFloat(&buffer, &value));
+  ASSERT_EQ(value, 1.5f);
+  char c;
+  ASSERT_TRUE(buffer.Peek(&c));
+  ASSERT_EQ(c, '/');
+  buffer.Advance(1);
+  ASSERT_TRUE(parser::ParseFloat(&buffer, &value));
+  ASSERT_EQ(value, 2.f);
+  parser::SkipWhitespace(&buffer);
+  ASSERT_TRUE(parser::ParseFloat(&buffer, &value));
+  ASSERT_EQ(value, -300.f);
+}
+
+TEST_F(ParserUtilsTest, TestParseFloatInvalid) {
+  const char *const texts[] = {"", "-", ".", "abc", "1e", "1e+"};
+  for (const std::string text : texts) {
+    DecoderBuffer buffer;
+    buffer.Init(text.data(), text.size());
+    float value;
+    ASSERT_FALSE(parser::ParseFloat(&buffer, &value)) << text;
+  }
+}
+
+}  // namespace draco
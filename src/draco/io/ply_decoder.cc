@@ -14,14 +14,61 @@
 //
 #include "draco/io/ply_decoder.h"
 
-#include <fstream>
+#include <vector>
 
 #include "draco/core/macros.h"
+#include "draco/io/mapped_file.h"
 #include "draco/io/ply_property_reader.h"
 
 namespace draco {
 
-PlyDecoder::PlyDecoder() : out_mesh_(nullptr), out_point_cloud_(nullptr) {}
+namespace {
+
+// Copies values of |properties| into the interleaved components of the first
+// |num_values| entries of |attribute|. All properties must store values of
+// |DataTypeT| type. Each property is copied as a whole column.
+template <typename DataTypeT>
+void CopyPropertiesToAttribute(
+    const std::vector<const PlyProperty *> &properties, int64_t num_values,
+    PointAttribute *attribute) {
+  const int num_components = static_cast<int>(properties.size());
+  DataTypeT *const dst =
+      reinterpret_cast<DataTypeT *>(attribute->buffer()->data());
+  for (int c = 0; c < num_components; ++c) {
+    const DataTypeT *const src = reinterpret_cast<const DataTypeT *>(
+        properties[c]->GetDataEntryAddress(0));
+    for (int64_t i = 0; i < num_values; ++i) {
+      dst[i * num_components + c] = src[i];
+    }
+  }
+}
+
+// Adds all triangular faces stored in the lists of |vertex_indices| to
+// |mesh|. |read_index| returns the vertex index stored at a given value
+// offset of the property.
+template <typename ReadIndexT>
+void AddTriangularFaces(const PlyProperty *vertex_indices, int64_t num_faces,
+                        const ReadIndexT &read_index, Mesh *mesh) {
+  Mesh::Face face;
+  FaceIndex face_index(0);
+  for (int64_t i = 0; i < num_faces; ++i) {
+    const int64_t list_offset = vertex_indices->GetListEntryOffset(i);
+    const int64_t list_size = vertex_indices->GetListEntryNumValues(i);
+    // TODO(ostava): Assume triangular faces only for now.
+    if (list_size != 3)
+      continue;  // All non-triangular faces are skipped.
+    for (int64_t c = 0; c < 3; ++c)
+      face[c] = read_index(list_offset + c);
+    mesh->SetFace(face_index, face);
+    face_index++;
+  }
+  mesh->SetNumFaces(face_index.value());
+}
+
+}  // namespace
+
+PlyDecoder::PlyDecoder()
+    : out_mesh_(nullptr), out_point_cloud_(nullptr), num_threads_(1) {}
 
 bool PlyDecoder::DecodeFromFile(const std::string &file_name, Mesh *out_mesh) {
   out_mesh_ = out_mesh;
@@ -30,20 +77,10 @@ bool PlyDecoder::DecodeFromFile(const std::string &file_name, Mesh *out_mesh) {
 
 bool PlyDecoder::DecodeFromFile(const std::string &file_name,
                                 PointCloud *out_point_cloud) {
-  std::ifstream file(file_name, std::ios::binary);
-  if (!file)
+  MappedFile file;
+  if (!file.Open(file_name) || file.size() == 0)
     return false;
-  // Read the whole file into a buffer.
-  auto pos0 = file.tellg();
-  file.seekg(0, std::ios::end);
-  auto file_size = file.tellg() - pos0;
-  if (file_size == 0)
-    return false;
-  file.seekg(0, std::ios::beg);
-  std::vector<char> data(file_size);
-  file.read(&data[0], file_size);
-
-  buffer_.Init(&data[0], file_size);
+  buffer_.Init(file.data(), file.size());
   return DecodeFromBuffer(&buffer_, out_point_cloud);
 }
 
@@ -61,6 +98,7 @@ bool PlyDecoder::DecodeFromBuffer(DecoderBuffer *buffer,
 
 bool PlyDecoder::DecodeInternal() {
   PlyReader ply_reader;
+  ply_reader.set_num_threads(num_threads_);
   if (!ply_reader.Read(buffer()))
     return false;
   // First, decode the connectivity data.
@@ -98,21 +136,24 @@ bool PlyDecoder::DecodeFaceData(const PlyElement *face_element) {
     return false;  // No faces defined.
   }
 
-  PlyPropertyReader<PointIndex::ValueType> vertex_index_reader(vertex_indices);
-  Mesh::Face face;
-  FaceIndex face_index(0);
-  for (int i = 0; i < num_faces; ++i) {
-    const int64_t list_offset = vertex_indices->GetListEntryOffset(i);
-    const int64_t list_size = vertex_indices->GetListEntryNumValues(i);
-    // TODO(ostava): Assume triangular faces only for now.
-    if (list_size != 3)
-      continue;  // All non-triangular faces are skipped.
-    for (int64_t c = 0; c < 3; ++c)
-      face[c] = vertex_index_reader.ReadValue(list_offset + c);
-    out_mesh_->SetFace(face_index, face);
-    face_index++;
+  if (vertex_indices->data_type() == DT_INT32 ||
+      vertex_indices->data_type() == DT_UINT32) {
+    // Read the most common index types directly without any conversion.
+    const PointIndex::ValueType *const indices =
+        reinterpret_cast<const PointIndex::ValueType *>(
+            vertex_indices->GetDataEntryAddress(0));
+    AddTriangularFaces(
+        vertex_indices, num_faces,
+        [indices](int64_t offset) { return indices[offset]; }, out_mesh_);
+  } else {
+    PlyPropertyReader<PointIndex::ValueType> vertex_index_reader(
+        vertex_indices);
+    AddTriangularFaces(vertex_indices, num_faces,
+                       [&vertex_index_reader](int64_t offset) {
+                         return vertex_index_reader.ReadValue(offset);
+                       },
+                       out_mesh_);
   }
-  out_mesh_->SetNumFaces(face_index.value());
   return true;
 }
 
@@ -139,21 +180,12 @@ bool PlyDecoder::DecodeVertexData(const PlyElement *vertex_element) {
         z_prop->data_type() != DT_FLOAT32) {
       return false;
     }
-    PlyPropertyReader<float> x_reader(x_prop);
-    PlyPropertyReader<float> y_reader(y_prop);
-    PlyPropertyReader<float> z_reader(z_prop);
     GeometryAttribute va;
     va.Init(GeometryAttribute::POSITION, nullptr, 3, DT_FLOAT32, false,
             sizeof(float) * 3, 0);
     const int att_id = out_point_cloud_->AddAttribute(va, true, num_vertices);
-    for (PointIndex::ValueType i = 0; i < num_vertices; ++i) {
-      std::array<float, 3> val;
-      val[0] = x_reader.ReadValue(i);
-      val[1] = y_reader.ReadValue(i);
-      val[2] = z_reader.ReadValue(i);
-      out_point_cloud_->attribute(att_id)->SetAttributeValue(
-          AttributeValueIndex(i), &val[0]);
-    }
+    CopyPropertiesToAttribute<float>({x_prop, y_prop, z_prop}, num_vertices,
+                                     out_point_cloud_->attribute(att_id));
   }
 
   // Decode normals if present.
@@ -165,21 +197,13 @@ bool PlyDecoder::DecodeVertexData(const PlyElement *vertex_element) {
     if (n_x_prop->data_type() == DT_FLOAT32 &&
         n_y_prop->data_type() == DT_FLOAT32 &&
         n_z_prop->data_type() == DT_FLOAT32) {
-      PlyPropertyReader<float> x_reader(n_x_prop);
-      PlyPropertyReader<float> y_reader(n_y_prop);
-      PlyPropertyReader<float> z_reader(n_z_prop);
       GeometryAttribute va;
       va.Init(GeometryAttribute::NORMAL, nullptr, 3, DT_FLOAT32, false,
               sizeof(float) * 3, 0);
       const int att_id = out_point_cloud_->AddAttribute(va, true, num_vertices);
-      for (PointIndex::ValueType i = 0; i < num_vertices; ++i) {
-        std::array<float, 3> val;
-        val[0] = x_reader.ReadValue(i);
-        val[1] = y_reader.ReadValue(i);
-        val[2] = z_reader.ReadValue(i);
-        out_point_cloud_->attribute(att_id)->SetAttributeValue(
-            AttributeValueIndex(i), &val[0]);
-      }
+      CopyPropertiesToAttribute<float>({n_x_prop, n_y_prop, n_z_prop},
+                                       num_vertices,
+                                       out_point_cloud_->attribute(att_id));
     }
   }
 
@@ -199,7 +223,7 @@ bool PlyDecoder::DecodeVertexData(const PlyElement *vertex_element) {
     ++num_colors;
 
   if (num_colors) {
-    std::vector<std::unique_ptr<PlyPropertyReader<uint8_t>>> color_readers;
+    std::vector<const PlyProperty *> color_props;
     const PlyProperty *p;
     if (r_prop) {
       p = r_prop;
@@ -207,8 +231,7 @@ bool PlyDecoder::DecodeVertexData(const PlyElement *vertex_element) {
       DCHECK_EQ(true, p->data_type() == DT_UINT8);
       if (p->data_type() != DT_UINT8)
         return false;
-      color_readers.push_back(std::unique_ptr<PlyPropertyReader<uint8_t>>(
-          new PlyPropertyReader<uint8_t>(p)));
+      color_props.push_back(p);
     }
     if (g_prop) {
       p = g_prop;
@@ -216,8 +239,7 @@ bool PlyDecoder::DecodeVertexData(const PlyElement *vertex_element) {
       DCHECK_EQ(true, p->data_type() == DT_UINT8);
       if (p->data_type() != DT_UINT8)
         return false;
-      color_readers.push_back(std::unique_ptr<PlyPropertyReader<uint8_t>>(
-          new PlyPropertyReader<uint8_t>(p)));
+      color_props.push_back(p);
     }
     if (b_prop) {
       p = b_prop;
@@ -225,8 +247,7 @@ bool PlyDecoder::DecodeVertexData(const PlyElement *vertex_element) {
       DCHECK_EQ(true, p->data_type() == DT_UINT8);
       if (p->data_type() != DT_UINT8)
         return false;
-      color_readers.push_back(std::unique_ptr<PlyPropertyReader<uint8_t>>(
-          new PlyPropertyReader<uint8_t>(p)));
+      color_props.push_back(p);
     }
     if (a_prop) {
       p = a_prop;
@@ -234,8 +255,7 @@ bool PlyDecoder::DecodeVertexData(const PlyElement *vertex_element) {
       DCHECK_EQ(true, p->data_type() == DT_UINT8);
       if (p->data_type() != DT_UINT8)
         return false;
-      color_readers.push_back(std::unique_ptr<PlyPropertyReader<uint8_t>>(
-          new PlyPropertyReader<uint8_t>(p)));
+      color_props.push_back(p);
     }
 
     GeometryAttribute va;
@@ -243,14 +263,8 @@ bool PlyDecoder::DecodeVertexData(const PlyElement *vertex_element) {
             sizeof(uint8_t) * num_colors, 0);
     const int32_t att_id =
         out_point_cloud_->AddAttribute(va, true, num_vertices);
-    for (PointIndex::ValueType i = 0; i < num_vertices; ++i) {
-      std::array<uint8_t, 4> val;
-      for (int j = 0; j < num_colors; j++) {
-        val[j] = color_readers[j]->ReadValue(i);
-      }
-      out_point_cloud_->attribute(att_id)->SetAttributeValue(
-          AttributeValueIndex(i), &val[0]);
-    }
+    CopyPropertiesToAttribute<uint8_t>(color_props, num_vertices,
+                                       out_point_cloud_->attribute(att_id));
   }
 
   return true;
@@ -41,6 +41,10 @@ class PlyDecoder {
   bool DecodeFromBuffer(DecoderBuffer *buffer, Mesh *out_mesh);
   bool DecodeFromBuffer(DecoderBuffer *buffer, PointCloud *out_point_cloud);
 
+  // Sets the maximum number of threads used for parsing of ASCII PLY data.
+  // Default: 1
+  void set_num_threads(int num_threads) { num_threads_ = num_threads; }
+
  protected:
   bool DecodeInternal();
   DecoderBuffer *buffer() { return &buffer_; }
@@ -55,6 +59,7 @@ class PlyDecoder {
   // always set but |out_mesh_| is optional.
   Mesh *out_mesh_;
   PointCloud *out_point_cloud_;
+  int num_threads_;
 };
 
 }  // namespace draco
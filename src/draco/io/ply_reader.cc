@@ -14,14 +14,71 @@
 //
 #include "draco/io/ply_reader.h"
 
+#include <algorithm>
 #include <array>
+#include <cstring>
 #include <regex>
 
+#include "draco/core/thread_pool.h"
 #include "draco/io/parser_utils.h"
 #include "draco/io/ply_property_writer.h"
 
 namespace draco {
 
+namespace {
+
+// Minimum number of element entries parsed by a single thread.
+constexpr int64_t kMinParallelChunkEntries = 1 << 14;
+
+// Skips whitespace in front of the next value of an ASCII entry. Line breaks
+// are skipped only when entries may span multiple lines.
+void SkipValueSeparators(DecoderBuffer *buffer, bool single_entry_lines) {
+  if (single_entry_lines)
+    parser::SkipCharacters(buffer, " \t\r");
+  else
+    parser::SkipWhitespace(buffer);
+}
+
+// Copies |num_values| values of |ValueSizeT| bytes that are |stride| bytes
+// apart in |src| into the contiguous |dst|.
+template <int ValueSizeT>
+void CopyStridedValues(const uint8_t *src, int64_t stride, int64_t num_values,
+                       uint8_t *dst) {
+  for (int64_t i = 0; i < num_values; ++i) {
+    memcpy(dst, src, ValueSizeT);
+    src += stride;
+    dst += ValueSizeT;
+  }
+}
+
+void CopyStridedValues(const uint8_t *src, int64_t stride, int value_size,
+                       int64_t num_values, uint8_t *dst) {
+  // Dispatch the common sizes to copies of a constant size that compile into
+  // single load and store instructions.
+  switch (value_size) {
+    case 1:
+      return CopyStridedValues<1>(src, stride, num_values, dst);
+    case 2:
+      return CopyStridedValues<2>(src, stride, num_values, dst);
+    case 3:
+      return CopyStridedValues<3>(src, stride, num_values, dst);
+    case 4:
+      return CopyStridedValues<4>(src, stride, num_values, dst);
+    case 6:
+      return CopyStridedValues<6>(src, stride, num_values, dst);
+    case 8:
+      return CopyStridedValues<8>(src, stride, num_values, dst);
+    case 12:
+      return CopyStridedValues<12>(src, stride, num_values, dst);
+    default:
+      for (int64_t i = 0; i < num_values; ++i) {
+        memcpy(dst + i * value_size, src + i * stride, value_size);
+      }
+  }
+}
+
+}  // namespace
+
 PlyProperty::PlyProperty(const std::string &name, DataType data_type,
                          DataType list_type)
     : name_(name), data_type_(data_type), list_data_type_(list_type) {
@@ -32,7 +89,7 @@ PlyProperty::PlyProperty(const std::string &name, DataType data_type,
 PlyElement::PlyElement(const std::string &name, int64_t num_entries)
     : name_(name), num_entries_(num_entries) {}
 
-PlyReader::PlyReader() : format_(kLittleEndian) {}
+PlyReader::PlyReader() : format_(kLittleEndian), num_threads_(1) {}
 
 bool PlyReader::Read(DecoderBuffer *buffer) {
   error_message_.clear();
@@ -188,6 +245,10 @@ bool PlyReader::ParsePropertiesData(DecoderBuffer *buffer) {
 
 bool PlyReader::ParseElementData(DecoderBuffer *buffer, int element_index) {
   PlyElement &element = elements_[element_index];
+  if (ParseFixedSizeElementData(buffer, &element))
+    return true;
+  if (ParseTriangleListElementData(buffer, &element))
+    return true;
   for (int entry = 0; entry < element.num_entries(); ++entry) {
     for (int i = 0; i < element.num_properties(); ++i) {
       PlyProperty &prop = element.property(i);
@@ -217,16 +278,163 @@ bool PlyReader::ParseElementData(DecoderBuffer *buffer, int element_index) {
   return true;
 }
 
+bool PlyReader::ParseFixedSizeElementData(DecoderBuffer *buffer,
+                                          PlyElement *element) {
+  int64_t entry_size = 0;
+  for (const PlyProperty &prop : element->properties_) {
+    if (prop.is_list())
+      return false;
+    entry_size += prop.data_type_num_bytes();
+  }
+  const int64_t num_entries = element->num_entries();
+  if (entry_size == 0 || buffer->remaining_size() < num_entries * entry_size)
+    return false;
+  const uint8_t *const entries =
+      reinterpret_cast<const uint8_t *>(buffer->data_head());
+  int64_t prop_offset = 0;
+  for (PlyProperty &prop : element->properties_) {
+    const int num_bytes = prop.data_type_num_bytes();
+    const size_t data_offset = prop.data_.size();
+    prop.data_.resize(data_offset + num_entries * num_bytes);
+    CopyStridedValues(entries + prop_offset, entry_size, num_bytes,
+                      num_entries, prop.data_.data() + data_offset);
+    prop_offset += num_bytes;
+  }
+  buffer->Advance(num_entries * entry_size);
+  return true;
+}
+
+bool PlyReader::ParseTriangleListElementData(DecoderBuffer *buffer,
+                                             PlyElement *element) {
+  if (element->num_properties() != 1 || !element->property(0).is_list())
+    return false;
+  PlyProperty &prop = element->property(0);
+  const int count_size = prop.list_data_type_num_bytes();
+  const int list_size = 3 * prop.data_type_num_bytes();
+  const int64_t entry_size = count_size + list_size;
+  const int64_t num_entries = element->num_entries();
+  if (buffer->remaining_size() < num_entries * entry_size)
+    return false;
+  const uint8_t *const entries =
+      reinterpret_cast<const uint8_t *>(buffer->data_head());
+  // Check that all lists have three values. The counts are stored as little
+  // endian integers.
+  for (int64_t i = 0; i < num_entries; ++i) {
+    const uint8_t *const count = entries + i * entry_size;
+    if (count[0] != 3)
+      return false;
+    for (int b = 1; b < count_size; ++b) {
+      if (count[b] != 0)
+        return false;
+    }
+  }
+  const int64_t first_value = prop.data_.size() / prop.data_type_num_bytes_;
+  const size_t data_offset = prop.data_.size();
+  prop.data_.resize(data_offset + num_entries * list_size);
+  CopyStridedValues(entries + count_size, entry_size, list_size, num_entries,
+                    prop.data_.data() + data_offset);
+  prop.list_data_.reserve(prop.list_data_.size() + 2 * num_entries);
+  for (int64_t i = 0; i < num_entries; ++i) {
+    prop.list_data_.push_back(first_value + 3 * i);
+    prop.list_data_.push_back(3);
+  }
+  buffer->Advance(num_entries * entry_size);
+  return true;
+}
+
 bool PlyReader::ParseElementDataAscii(DecoderBuffer *buffer,
                                       int element_index) {
   PlyElement &element = elements_[element_index];
-  for (int entry = 0; entry < element.num_entries(); ++entry) {
-    for (int i = 0; i < element.num_properties(); ++i) {
-      PlyProperty &prop = element.property(i);
+  const int num_chunks = static_cast<int>(std::min<int64_t>(
+      num_threads_, element.num_entries() / kMinParallelChunkEntries));
+  if (num_chunks > 1 &&
+      ParseElementDataAsciiInParallel(buffer, element_index, num_chunks))
+    return true;
+  // Fall back to the serial parsing that doesn't depend on the line layout.
+  return ParseEntriesAscii(buffer, element.num_entries(), false,
+                           &element.properties_);
+}
+
+bool PlyReader::ParseElementDataAsciiInParallel(DecoderBuffer *buffer,
+                                                int element_index,
+                                                int num_chunks) {
+  PlyElement &element = elements_[element_index];
+  DecoderBuffer data_buffer(*buffer);
+  parser::SkipWhitespace(&data_buffer);
+  const char *const data = data_buffer.data_head();
+  const char *const data_end = data + data_buffer.remaining_size();
+
+  // Find the first line of each chunk.
+  const int64_t num_entries = element.num_entries();
+  std::vector<int64_t> chunk_first_entries(num_chunks + 1);
+  std::vector<const char *> chunk_starts(num_chunks + 1);
+  const char *line = data;
+  int chunk = 0;
+  for (int64_t entry = 0; entry < num_entries; ++entry) {
+    if (entry == num_entries * chunk / num_chunks) {
+      chunk_first_entries[chunk] = entry;
+      chunk_starts[chunk++] = line;
+    }
+    if (line == data_end)
+      return false;  // Not enough lines.
+    const void *const line_end = std::memchr(line, '\n', data_end - line);
+    line = line_end ? static_cast<const char *>(line_end) + 1 : data_end;
+  }
+  chunk_first_entries[num_chunks] = num_entries;
+  chunk_starts[num_chunks] = line;
+
+  // Parse the chunks into local copies of the element properties.
+  std::vector<std::vector<PlyProperty>> chunk_properties(num_chunks);
+  std::vector<uint8_t> chunk_successes(num_chunks, 0);
+  ThreadPool thread_pool(num_chunks);
+  for (int c = 0; c < num_chunks; ++c) {
+    chunk_properties[c] = element.properties_;
+    thread_pool.Schedule([&chunk_properties, &chunk_successes,
+                          &chunk_first_entries, &chunk_starts, c]() {
+      DecoderBuffer chunk_buffer;
+      chunk_buffer.Init(chunk_starts[c], chunk_starts[c + 1] - chunk_starts[c]);
+      chunk_successes[c] = ParseEntriesAscii(
+          &chunk_buffer, chunk_first_entries[c + 1] - chunk_first_entries[c],
+          true, &chunk_properties[c]);
+    });
+  }
+  thread_pool.Wait();
+  for (int c = 0; c < num_chunks; ++c) {
+    if (!chunk_successes[c])
+      return false;
+  }
+
+  // Append the chunk data to the element properties. List offsets of each
+  // chunk are relative to the first value of the chunk.
+  for (int i = 0; i < element.num_properties(); ++i) {
+    PlyProperty &prop = element.property(i);
+    for (int c = 0; c < num_chunks; ++c) {
+      const PlyProperty &chunk_prop = chunk_properties[c][i];
+      const int64_t num_preceding_values =
+          prop.data_.size() / prop.data_type_num_bytes_;
+      prop.data_.insert(prop.data_.end(), chunk_prop.data_.begin(),
+                        chunk_prop.data_.end());
+      for (size_t l = 0; l < chunk_prop.list_data_.size(); l += 2) {
+        prop.list_data_.push_back(chunk_prop.list_data_[l] +
+                                  num_preceding_values);
+        prop.list_data_.push_back(chunk_prop.list_data_[l + 1]);
+      }
+    }
+  }
+  data_buffer.Advance(line - data);
+  *buffer = data_buffer;
+  return true;
+}
+
+bool PlyReader::ParseEntriesAscii(DecoderBuffer *buffer, int64_t num_entries,
+                                  bool single_entry_lines,
+                                  std::vector<PlyProperty> *properties) {
+  for (int64_t entry = 0; entry < num_entries; ++entry) {
+    for (PlyProperty &prop : *properties) {
       PlyPropertyWriter<double> prop_writer(&prop);
       int32_t num_entries = 1;
       if (prop.is_list()) {
-        parser::SkipWhitespace(buffer);
+        SkipValueSeparators(buffer, single_entry_lines);
         // Parse the number of entries for the list element.
         if (!parser::ParseSignedInt(buffer, &num_entries))
           return false;
@@ -239,7 +447,7 @@ bool PlyReader::ParseElementDataAscii(DecoderBuffer *buffer,
       }
       // Read and store the actual property data.
       for (int v = 0; v < num_entries; ++v) {
-        parser::SkipWhitespace(buffer);
+        SkipValueSeparators(buffer, single_entry_lines);
         if (prop.data_type() == DT_FLOAT32 || prop.data_type() == DT_FLOAT64) {
           float val;
           if (!parser::ParseFloat(buffer, &val))
@@ -253,6 +461,21 @@ bool PlyReader::ParseElementDataAscii(DecoderBuffer *buffer,
         }
       }
     }
+    if (single_entry_lines) {
+      // Only whitespace may follow the entry on its line.
+      SkipValueSeparators(buffer, true);
+      char c;
+      if (buffer->Peek(&c)) {
+        if (c != '\n')
+          return false;
+        buffer->Advance(1);
+      }
+    }
+  }
+  if (single_entry_lines) {
+    parser::SkipWhitespace(buffer);
+    if (buffer->remaining_size() > 0)
+      return false;
   }
   return true;
 }
@@ -77,6 +77,8 @@ class PlyProperty {
 // arbitrary properties such as vertex coordinates or face indices.
 class PlyElement {
  public:
+  friend class PlyReader;
+
   PlyElement(const std::string &name, int64_t num_entries);
   void AddProperty(const PlyProperty &prop) {
     property_index_[prop.name()] = properties_.size();
@@ -113,6 +115,12 @@ class PlyReader {
   PlyReader();
   bool Read(DecoderBuffer *buffer);
 
+  // Sets the maximum number of threads used for parsing of ASCII element data.
+  // Large elements are split into chunks of lines that are parsed
+  // concurrently.
+  // Default: 1
+  void set_num_threads(int num_threads) { num_threads_ = num_threads; }
+
   const PlyElement *GetElementByName(const std::string &name) const {
     const auto it = element_index_.find(name);
     if (it != element_index_.end())
@@ -134,8 +142,34 @@ class PlyReader {
   bool ParseProperty(DecoderBuffer *buffer);
   bool ParsePropertiesData(DecoderBuffer *buffer);
   bool ParseElementData(DecoderBuffer *buffer, int element_index);
+
+  // Parses binary data of an element whose properties all have a fixed size.
+  // Values of each property are extracted from the packed entries at once.
+  // Returns false when the element contains a list property or when the
+  // buffer doesn't contain data of all entries.
+  bool ParseFixedSizeElementData(DecoderBuffer *buffer, PlyElement *element);
+
+  // Parses binary data of an element with a single list property where all
+  // lists contain three values, such as faces of a triangular mesh. Returns
+  // false when the element data doesn't have this layout.
+  bool ParseTriangleListElementData(DecoderBuffer *buffer,
+                                    PlyElement *element);
   bool ParseElementDataAscii(DecoderBuffer *buffer, int element_index);
 
+  // Parses ASCII data of an element in |num_chunks| concurrently parsed chunks.
+  // Requires each entry to be stored on a separate line. Returns false when
+  // the data is not stored in this layout or when it is invalid. In that case
+  // the buffer and the element are left unchanged.
+  bool ParseElementDataAsciiInParallel(DecoderBuffer *buffer,
+                                       int element_index, int num_chunks);
+
+  // Parses |num_entries| entries of ASCII data into |properties|. When
+  // |single_entry_lines| is set, each entry must be on a separate line and
+  // the buffer must not contain any data after the last entry.
+  static bool ParseEntriesAscii(DecoderBuffer *buffer, int64_t num_entries,
+                                bool single_entry_lines,
+                                std::vector<PlyProperty> *properties);
+
   // Splits |line| by whitespace characters.
   std::vector<std::string> SplitWords(const std::string &line);
   DataType GetDataTypeFromString(const std::string &name) const;
@@ -144,6 +178,7 @@ class PlyReader {
   std::string error_message_;
   std::map<std::string, int> element_index_;
   Format format_;
+  int num_threads_;
 };
 
 }  // namespace draco
@@ -15,6 +15,7 @@
 #include "draco/io/ply_reader.h"
 
 #include <fstream>
+#include <sstream>
 
 #include "draco/core/draco_test_base.h"
 #include "draco/core/draco_test_utils.h"
@@ -37,6 +38,135 @@ class PlyReaderTest : public ::testing::Test {
     file.read(&data[0], is_size);
     return data;
   }
+
+  // Returns an ASCII PLY with |num_vertices| vertices and faces. When
+  // |split_entries| is set, the values of each vertex span two lines.
+  std::string GenerateAsciiPly(int num_vertices, bool split_entries) const {
+    std::ostringstream ply;
+    ply << "ply\nformat ascii 1.0\n";
+    ply << "element vertex " << num_vertices << "\n";
+    ply << "property float x\nproperty float y\nproperty int id\n";
+    ply << "element face " << num_vertices - 2 << "\n";
+    ply << "property list uchar int vertex_indices\nend_header\n";
+    for (int i = 0; i < num_vertices; ++i) {
+      ply << i * 0.5f << " " << -i * 0.25f << (split_entries ? "\n" : " ")
+          << i << "\n";
+    }
+    for (int i = 0; i + 2 < num_vertices; ++i) {
+      if (i % 2 == 0)
+        ply << "3 " << i << " " << i + 1 << " " << i + 2 << "\n";
+      else
+        ply << "4 " << i << " " << i + 1 << " " << i + 2 << " 0\n";
+    }
+    return ply.str();
+  }
+
+  // Tests that parsing of |ply| in multiple threads produces the same data as
+  // the serial parsing.
+  void TestParallelParsing(const std::string &ply) const {
+    PlyReader readers[2];
+    for (int i = 0; i < 2; ++i) {
+      DecoderBuffer buf;
+      buf.Init(ply.data(), ply.size());
+      readers[i].set_num_threads(i == 0 ? 1 : 4);
+      ASSERT_TRUE(readers[i].Read(&buf));
+    }
+    ASSERT_EQ(readers[0].num_elements(), readers[1].num_elements());
+    for (int e = 0; e < readers[0].num_elements(); ++e) {
+      const PlyElement &element = readers[0].element(e);
+      const PlyElement &parallel_element = readers[1].element(e);
+      ASSERT_EQ(element.num_properties(), parallel_element.num_properties());
+      for (int p = 0; p < element.num_properties(); ++p) {
+        const PlyProperty &prop = element.property(p);
+        const PlyProperty &parallel_prop = parallel_element.property(p);
+        PlyPropertyReader<double> values(&prop);
+        PlyPropertyReader<double> parallel_values(&parallel_prop);
+        int num_values = element.num_entries();
+        if (prop.is_list()) {
+          for (int i = 0; i < element.num_entries(); ++i) {
+            ASSERT_EQ(prop.GetListEntryOffset(i),
+                      parallel_prop.GetListEntryOffset(i));
+            ASSERT_EQ(prop.GetListEntryNumValues(i),
+                      parallel_prop.GetListEntryNumValues(i));
+          }
+          const int last_entry = element.num_entries() - 1;
+          num_values = prop.GetListEntryOffset(last_entry) +
+                       prop.GetListEntryNumValues(last_entry);
+        }
+        for (int i = 0; i < num_values; ++i) {
+          ASSERT_EQ(values.ReadValue(i), parallel_values.ReadValue(i));
+        }
+      }
+    }
+  }
+
+  // Returns a binary PLY with |num_vertices| vertices and faces. The face with
+  // index |quad_face| (if any) is stored as a quad.
+  std::string GenerateBinaryPly(int num_vertices, int quad_face) const {
+    std::ostringstream ply;
+    ply << "ply\nformat binary_little_endian 1.0\n";
+    ply << "element vertex " << num_vertices << "\n";
+    ply << "property float x\nproperty uchar red\nproperty ushort id\n";
+    ply << "element face " << num_vertices << "\n";
+    ply << "property list uchar int vertex_indices\nend_header\n";
+    std::string data = ply.str();
+    const auto append = [&data](const void *value, size_t size) {
+      data.append(static_cast<const char *>(value), size);
+    };
+    for (int i = 0; i < num_vertices; ++i) {
+      const float x = i * 0.5f;
+      const uint8_t red = i % 256;
+      const uint16_t id = i;
+      append(&x, sizeof(x));
+      append(&red, sizeof(red));
+      append(&id, sizeof(id));
+    }
+    for (int i = 0; i < num_vertices; ++i) {
+      const uint8_t count = i == quad_face ? 4 : 3;
+      append(&count, sizeof(count));
+      for (int c = 0; c < count; ++c) {
+        const int32_t index = (i + c) % num_vertices;
+        append(&index, sizeof(index));
+      }
+    }
+    return data;
+  }
+
+  // Checks the data of a PLY generated by GenerateBinaryPly().
+  void TestBinaryPly(int num_vertices, int quad_face) const {
+    const std::string data = GenerateBinaryPly(num_vertices, quad_face);
+    DecoderBuffer buf;
+    buf.Init(data.data(), data.size());
+    PlyReader reader;
+    ASSERT_TRUE(reader.Read(&buf));
+    ASSERT_EQ(buf.remaining_size(), 0);
+    const PlyElement *const vertices = reader.GetElementByName("vertex");
+    ASSERT_NE(vertices, nullptr);
+    PlyPropertyReader<float> x_reader(vertices->GetPropertyByName("x"));
+    PlyPropertyReader<int> red_reader(vertices->GetPropertyByName("red"));
+    PlyPropertyReader<int> id_reader(vertices->GetPropertyByName("id"));
+    for (int i = 0; i < num_vertices; ++i) {
+      ASSERT_EQ(x_reader.ReadValue(i), i * 0.5f);
+      ASSERT_EQ(red_reader.ReadValue(i), i % 256);
+      ASSERT_EQ(id_reader.ReadValue(i), i);
+    }
+    const PlyElement *const faces = reader.GetElementByName("face");
+    ASSERT_NE(faces, nullptr);
+    const PlyProperty *const indices =
+        faces->GetPropertyByName("vertex_indices");
+    ASSERT_NE(indices, nullptr);
+    PlyPropertyReader<int> index_reader(indices);
+    int64_t offset = 0;
+    for (int i = 0; i < num_vertices; ++i) {
+      const int count = i == quad_face ? 4 : 3;
+      ASSERT_EQ(indices->GetListEntryOffset(i), offset);
+      ASSERT_EQ(indices->GetListEntryNumValues(i), count);
+      for (int c = 0; c < count; ++c) {
+        ASSERT_EQ(index_reader.ReadValue(offset + c), (i + c) % num_vertices);
+      }
+      offset += count;
+    }
+  }
 };
 
 TEST_F(PlyReaderTest, TestReader) {
@@ -139,4 +269,24 @@ TEST_F(PlyReaderTest, TestReaderMoreDataTypes) {
   }
 }
 
+TEST_F(PlyReaderTest, TestReaderAsciiParallel) {
+  TestParallelParsing(GenerateAsciiPly(100000, false));
+}
+
+TEST_F(PlyReaderTest, TestReaderAsciiParallelMultiLineEntries) {
+  // Entries spanning multiple lines can't be parsed in parallel. The reader
+  // must fall back to the serial parsing.
+  TestParallelParsing(GenerateAsciiPly(100000, true));
+}
+
+TEST_F(PlyReaderTest, TestReaderBinaryPacked) {
+  // All faces are triangles so both elements are read as packed entries.
+  TestBinaryPly(1000, -1);
+}
+
+TEST_F(PlyReaderTest, TestReaderBinaryMixedFaceLists) {
+  // A single quad face requires the general parsing of the face lists.
+  TestBinaryPly(1000, 500);
+}
+
 }  // namespace draco
@@ -14,8 +14,7 @@
 //
 #include "draco/io/point_cloud_io.h"
 
-#include <fstream>
-
+#include "draco/io/mapped_file.h"
 #include "draco/io/obj_decoder.h"
 #include "draco/io/parser_utils.h"
 #include "draco/io/ply_decoder.h"
@@ -24,6 +23,12 @@ namespace draco {
 
 StatusOr<std::unique_ptr<PointCloud>> ReadPointCloudFromFile(
     const std::string &file_name) {
+  return ReadPointCloudFromFile(file_name, Options());
+}
+
+StatusOr<std::unique_ptr<PointCloud>> ReadPointCloudFromFile(
+    const std::string &file_name, const Options &options) {
+  const int num_parsing_threads = options.GetInt("num_parsing_threads", 1);
   std::unique_ptr<PointCloud> pc(new PointCloud());
   // Analyze file extension.
   const std::string extension = parser::ToLower(
@@ -32,6 +37,7 @@ StatusOr<std::unique_ptr<PointCloud>> ReadPointCloudFromFile(
   if (extension == ".obj") {
     // Wavefront OBJ file format.
     ObjDecoder obj_decoder;
+    obj_decoder.set_num_threads(num_parsing_threads);
     const Status obj_status = obj_decoder.DecodeFromFile(file_name, pc.get());
     if (!obj_status.ok())
       return obj_status;
@@ -40,6 +46,7 @@ StatusOr<std::unique_ptr<PointCloud>> ReadPointCloudFromFile(
   if (extension == ".ply") {
     // Wavefront PLY file format.
     PlyDecoder ply_decoder;
+    ply_decoder.set_num_threads(num_parsing_threads);
     if (!ply_decoder.DecodeFromFile(file_name, pc.get()))
       return Status(Status::ERROR, "Unknown error.");
     return std::move(pc);
@@ -47,13 +54,13 @@ StatusOr<std::unique_ptr<PointCloud>> ReadPointCloudFromFile(
 
   // Otherwise not an obj file. Assume the file was encoded with one of the
   // draco encoding methods.
-  std::ifstream is(file_name.c_str(), std::ios::binary);
-  if (!is)
+  MappedFile file;
+  if (!file.Open(file_name))
     return Status(Status::ERROR, "Invalid input stream.");
-  if (!ReadPointCloudFromStream(&pc, is).good())
-    return Status(Status::ERROR,
-                  "Unknown error.");  // Error reading the stream.
-  return std::move(pc);
+  DecoderBuffer buffer;
+  buffer.Init(file.data(), file.size());
+  Decoder decoder;
+  return decoder.DecodePointCloudFromBuffer(&buffer);
 }
 
 }  // namespace draco
@@ -18,6 +18,7 @@
 #include "draco/compression/config/compression_shared.h"
 #include "draco/compression/decode.h"
 #include "draco/compression/expert_encode.h"
+#include "draco/core/options.h"
 
 namespace draco {
 
@@ -84,6 +85,14 @@ InStreamT &ReadPointCloudFromStream(std::unique_ptr<PointCloud> *point_cloud,
 StatusOr<std::unique_ptr<PointCloud>> ReadPointCloudFromFile(
     const std::string &file_name);
 
+// Reads a point cloud from a file using the provided |options|. Supported
+// options:
+//   "num_parsing_threads" (int): Maximum number of threads used for parsing
+//                                of text based (.obj and .ply) input files.
+// Returns nullptr with an error status if the decoding failed.
+StatusOr<std::unique_ptr<PointCloud>> ReadPointCloudFromFile(
+    const std::string &file_name, const Options &options);
+
 }  // namespace draco
 
 #endif  // DRACO_IO_POINT_CLOUD_IO_H_
@@ -62,7 +62,12 @@ bool CornerTable::Reset(int num_faces, int num_vertices) {
     return false;
   corner_to_vertex_map_.assign(num_faces * 3, kInvalidVertexIndex);
   opposite_corners_.assign(num_faces * 3, kInvalidCornerIndex);
+  vertex_corners_.clear();
   vertex_corners_.reserve(num_vertices);
+  non_manifold_vertex_parents_.clear();
+  num_original_vertices_ = 0;
+  num_degenerated_faces_ = 0;
+  num_isolated_vertices_ = 0;
   ClearValenceCache();
   ClearValenceCacheInaccurate();
   return true;
@@ -196,9 +201,10 @@ bool CornerTable::ComputeVertexCorners(int num_vertices) {
   num_original_vertices_ = num_vertices;
   vertex_corners_.resize(num_vertices, kInvalidCornerIndex);
   // Arrays for marking visited vertices and corners that allow us to detect
-  // non-manifold vertices.
-  std::vector<bool> visited_vertices(num_vertices, false);
-  std::vector<bool> visited_corners(num_corners(), false);
+  // non-manifold vertices. Bytes are used instead of std::vector<bool> to
+  // avoid the bit masking on every access.
+  std::vector<uint8_t> visited_vertices(num_vertices, false);
+  std::vector<uint8_t> visited_corners(num_corners(), false);
 
   for (FaceIndex f(0); f < num_faces(); ++f) {
     const CornerIndex first_face_corner = FirstCorner(f);
@@ -262,7 +268,7 @@ bool CornerTable::ComputeVertexCorners(int num_vertices) {
 
   // Count the number of isolated (unprocessed) vertices.
   num_isolated_vertices_ = 0;
-  for (bool visited : visited_vertices) {
+  for (const uint8_t visited : visited_vertices) {
     if (!visited)
       ++num_isolated_vertices_;
   }
@@ -281,6 +287,15 @@ bool CornerTable::IsDegenerated(FaceIndex face) const {
   return false;
 }
 
+size_t CornerTable::GetMemoryUsage() const {
+  return corner_to_vertex_map_.capacity() * sizeof(VertexIndex) +
+         opposite_corners_.capacity() * sizeof(CornerIndex) +
+         vertex_corners_.capacity() * sizeof(CornerIndex) +
+         non_manifold_vertex_parents_.capacity() * sizeof(VertexIndex) +
+         vertex_valence_cache_8_bit_.capacity() * sizeof(int8_t) +
+         vertex_valence_cache_32_bit_.capacity() * sizeof(int32_t);
+}
+
 int CornerTable::Valence(VertexIndex v) const {
   if (v == kInvalidVertexIndex)
     return -1;
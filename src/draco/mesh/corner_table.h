@@ -66,7 +66,9 @@ class CornerTable {
   // Resets the corner table to the given number of invalid faces.
   bool Reset(int num_faces);
 
-  // Resets the corner table to the given number of invalid faces and vertices.
+  // Resets the corner table to the given number of invalid faces and reserves
+  // space for |num_vertices| vertices. Any existing vertices are removed while
+  // the allocated memory is kept.
   bool Reset(int num_faces, int num_vertices);
 
   inline int num_vertices() const { return vertex_corners_.size(); }
@@ -271,6 +273,9 @@ class CornerTable {
 
   bool IsDegenerated(FaceIndex face) const;
 
+  // Returns the number of bytes allocated by the corner table.
+  size_t GetMemoryUsage() const;
+
   // Methods that modify an existing corner table.
   // Sets the opposite corner mapping between two corners. Caller must ensure
   // that the indices are valid.
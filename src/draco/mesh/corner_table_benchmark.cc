@@ -0,0 +1,52 @@
+// Copyright 2017 The Draco Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "benchmark/benchmark.h"
+#include "draco/core/draco_benchmark_utils.h"
+#include "draco/mesh/corner_table.h"
+
+namespace draco {
+
+namespace {
+
+// Initializes a corner table of a grid mesh with state.range(0) x
+// state.range(0) cells.
+void BM_CornerTableInitialize(benchmark::State &state) {
+  const std::unique_ptr<Mesh> mesh =
+      CreateGridMesh(static_cast<int>(state.range(0)));
+  IndexTypeVector<FaceIndex, CornerTable::FaceType> faces(mesh->num_faces());
+  for (FaceIndex f(0); f < mesh->num_faces(); ++f) {
+    for (int i = 0; i < 3; ++i) {
+      faces[f][i] = VertexIndex(mesh->face(f)[i].value());
+    }
+  }
+  for (auto _ : state) {
+    CornerTable corner_table;
+    if (!corner_table.Initialize(faces)) {
+      state.SkipWithError("Failed to initialize the corner table.");
+      break;
+    }
+    benchmark::DoNotOptimize(corner_table.num_vertices());
+  }
+  state.SetItemsProcessed(state.iterations() * mesh->num_faces());
+}
+BENCHMARK(BM_CornerTableInitialize)
+    ->ArgName("grid")
+    ->Arg(64)
+    ->Arg(512)
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace
+
+}  // namespace draco
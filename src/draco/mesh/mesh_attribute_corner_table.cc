@@ -116,6 +116,15 @@ void MeshAttributeCornerTable::AddSeamEdge(CornerIndex c) {
   }
 }
 
+size_t MeshAttributeCornerTable::GetMemoryUsage() const {
+  // Boolean vectors store one bit per element.
+  return (is_edge_on_seam_.capacity() + is_vertex_on_seam_.capacity()) / 8 +
+         corner_to_vertex_map_.capacity() * sizeof(VertexIndex) +
+         vertex_to_left_most_corner_map_.capacity() * sizeof(CornerIndex) +
+         vertex_to_attribute_entry_id_map_.capacity() *
+             sizeof(AttributeValueIndex);
+}
+
 void MeshAttributeCornerTable::RecomputeVertices(const Mesh *mesh,
                                                  const PointAttribute *att) {
   if (mesh != nullptr && att != nullptr) {
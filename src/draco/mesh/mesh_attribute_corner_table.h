@@ -106,6 +106,10 @@ class MeshAttributeCornerTable {
   }
 
   bool no_interior_seams() const { return no_interior_seams_; }
+
+  // Returns the number of bytes allocated by the attribute corner table. The
+  // memory of the base corner table is not included.
+  size_t GetMemoryUsage() const;
   const CornerTable *corner_table() const { return corner_table_; }
 
  private:
@@ -13,10 +13,13 @@
 // limitations under the License.
 //
 #include <cinttypes>
-#include <fstream>
+#include <cstdlib>
+#include <new>
+#include <string>
 
 #include "draco/compression/decode.h"
 #include "draco/core/cycle_timer.h"
+#include "draco/io/mapped_file.h"
 #include "draco/io/obj_encoder.h"
 #include "draco/io/parser_utils.h"
 #include "draco/io/ply_encoder.h"
@@ -28,9 +31,18 @@ struct Options {
 
   std::string input;
   std::string output;
+  int num_threads;
+  int max_points;
+  bool use_query_box;
+  float query_box[6];
+  bool print_stats;
 };
 
-Options::Options() {}
+Options::Options()
+    : num_threads(1),
+      max_points(-1),
+      use_query_box(false),
+      print_stats(false) {}
 
 void Usage() {
   printf("Usage: draco_decoder [options] -i input\n");
@@ -38,8 +50,47 @@ void Usage() {
   printf("Main options:\n");
   printf("  -h | -?               show help.\n");
   printf("  -o <output>           output file name.\n");
+  printf("  -threads <value>      number of threads used for decoding of\n");
+  printf("                        independent attributes, mesh chunks and\n");
+  printf("                        point cloud subtrees.\n");
+  printf("                        Default: 1.\n");
+  printf("  -max_points <value>   maximum number of decoded points of point\n");
+  printf("                        clouds encoded with -lod.\n");
+  printf("  -box <x0> <y0> <z0> <x1> <y1> <z1>\n");
+  printf("                        decodes only points inside of the box\n");
+  printf("                        from point clouds encoded with\n");
+  printf("                        -subtree_points.\n");
+  printf("  -stats                prints time and size of the individual\n");
+  printf("                        decoding stages. Requires a build with\n");
+  printf("                        ENABLE_STATS.\n");
 }
 
+int StringToInt(const std::string &s) {
+  char *end;
+  return strtol(s.c_str(), &end, 10);  // NOLINT
+}
+
+void PrintStats(const draco::CodingStats &stats) {
+  for (const draco::CodingStats::Stage &stage : stats.GetStages()) {
+    std::string name = stage.name;
+    if (stage.att_id >= 0)
+      name += " (attribute " + std::to_string(stage.att_id) + ")";
+    printf("  %-32s %8" PRId64 " us %10" PRId64 " bytes %8" PRId64
+           " allocations\n",
+           name.c_str(), stage.time_us, stage.num_bytes,
+           stage.num_allocations);
+  }
+}
+
+#ifdef DRACO_STATS_SUPPORTED
+// Number of heap allocations made by the current thread. Counted by the
+// replacement of the global allocation functions below and reported in the
+// decoding statistics.
+thread_local int64_t num_heap_allocations = 0;
+
+int64_t GetNumHeapAllocations() { return num_heap_allocations; }
+#endif
+
 int ReturnError(const draco::Status &status) {
   printf("Failed to decode the input file %s\n", status.error_msg());
   return -1;
@@ -47,6 +98,21 @@ int ReturnError(const draco::Status &status) {
 
 }  // namespace
 
+#ifdef DRACO_STATS_SUPPORTED
+// The array and nothrow variants call these functions by default.
+void *operator new(size_t size) {
+  ++num_heap_allocations;
+  void *const ptr = std::malloc(size > 0 ? size : 1);
+  if (ptr == nullptr)
+    throw std::bad_alloc();
+  return ptr;
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+#endif
+
 int main(int argc, char **argv) {
   Options options;
   const int argc_check = argc - 1;
@@ -59,6 +125,17 @@ int main(int argc, char **argv) {
       options.input = argv[++i];
     } else if (!strcmp("-o", argv[i]) && i < argc_check) {
       options.output = argv[++i];
+    } else if (!strcmp("-threads", argv[i]) && i < argc_check) {
+      options.num_threads = StringToInt(argv[++i]);
+    } else if (!strcmp("-max_points", argv[i]) && i < argc_check) {
+      options.max_points = StringToInt(argv[++i]);
+    } else if (!strcmp("-box", argv[i]) && i + 6 < argc) {
+      options.use_query_box = true;
+      for (int j = 0; j < 6; ++j) {
+        options.query_box[j] = strtof(argv[++i], nullptr);
+      }
+    } else if (!strcmp("-stats", argv[i])) {
+      options.print_stats = true;
     }
   }
   if (argc < 3 || options.input.empty()) {
@@ -66,30 +143,27 @@ int main(int argc, char **argv) {
     return -1;
   }
 
-  std::ifstream input_file(options.input, std::ios::binary);
-  if (!input_file) {
+  // Map the input file into memory.
+  draco::MappedFile input_file;
+  if (!input_file.Open(options.input)) {
     printf("Failed opening the input file.\n");
     return -1;
   }
 
-  // Read the file stream into a buffer.
-  std::streampos file_size = 0;
-  input_file.seekg(0, std::ios::end);
-  file_size = input_file.tellg() - file_size;
-  input_file.seekg(0, std::ios::beg);
-  std::vector<char> data(file_size);
-  input_file.read(data.data(), file_size);
-
-  if (data.empty()) {
+  if (input_file.size() == 0) {
     printf("Empty input file.\n");
     return -1;
   }
 
   // Create a draco decoding buffer. Note that no data is copied in this step.
   draco::DecoderBuffer buffer;
-  buffer.Init(data.data(), data.size());
+  buffer.Init(input_file.data(), input_file.size());
 
   draco::CycleTimer timer;
+  draco::CodingStats stats;
+#ifdef DRACO_STATS_SUPPORTED
+  draco::CodingStats::SetAllocationCounter(&GetNumHeapAllocations);
+#endif
   // Decode the input data into a geometry.
   std::unique_ptr<draco::PointCloud> pc;
   draco::Mesh *mesh = nullptr;
@@ -101,6 +175,10 @@ int main(int argc, char **argv) {
   if (geom_type == draco::TRIANGULAR_MESH) {
     timer.Start();
     draco::Decoder decoder;
+    decoder.options()->SetGlobalInt("num_decoding_threads",
+                                    options.num_threads);
+    if (options.print_stats)
+      decoder.SetStats(&stats);
     auto statusor = decoder.DecodeMeshFromBuffer(&buffer);
     if (!statusor.ok()) {
       return ReturnError(statusor.status());
@@ -115,6 +193,17 @@ int main(int argc, char **argv) {
     // Failed to decode it as mesh, so let's try to decode it as a point cloud.
     timer.Start();
     draco::Decoder decoder;
+    decoder.options()->SetGlobalInt("num_decoding_threads",
+                                    options.num_threads);
+    if (options.print_stats)
+      decoder.SetStats(&stats);
+    decoder.options()->SetGlobalInt("kd_tree_max_points", options.max_points);
+    if (options.use_query_box) {
+      decoder.options()->SetGlobalVector("kd_tree_query_box_min", 3,
+                                         options.query_box);
+      decoder.options()->SetGlobalVector("kd_tree_query_box_max", 3,
+                                         options.query_box + 3);
+    }
     auto statusor = decoder.DecodePointCloudFromBuffer(&buffer);
     if (!statusor.ok()) {
       return ReturnError(statusor.status());
@@ -172,5 +261,7 @@ int main(int argc, char **argv) {
   }
   printf("Decoded geometry saved to %s (%" PRId64 " ms to decode)\n",
          options.output.c_str(), timer.GetInMs());
+  if (options.print_stats)
+    PrintStats(stats);
   return 0;
 }
@@ -35,6 +35,11 @@ struct Options {
   int generic_quantization_bits;
   bool generic_deleted;
   int compression_level;
+  int num_rans_states;
+  int num_threads;
+  int max_chunk_faces;
+  bool kd_tree_level_order;
+  int kd_tree_subtree_points;
   bool use_metadata;
   std::string input;
   std::string output;
@@ -50,6 +55,11 @@ Options::Options()
       generic_quantization_bits(8),
       generic_deleted(false),
       compression_level(7),
+      num_rans_states(1),
+      num_threads(1),
+      max_chunk_faces(0),
+      kd_tree_level_order(false),
+      kd_tree_subtree_points(0),
       use_metadata(false) {}
 
 void Usage() {
@@ -77,6 +87,26 @@ void Usage() {
   printf(
       "  -cl <value>           compression level [0-10], most=10, least=0, "
       "default=7.\n");
+  printf(
+      "  -rans_states <value>  number of interleaved rANS states used for "
+      "attribute\n                        values [1, 4, 8], more states decode "
+      "faster, default=1.\n");
+  printf(
+      "  -threads <value>      number of threads used for parsing of text "
+      "input\n                        files and for encoding of independent "
+      "attributes\n                        and point cloud subtrees, "
+      "default=1.\n");
+  printf(
+      "  -chunk_faces <value>  splits meshes into chunks with at most <value> "
+      "faces\n                        that can be decoded in parallel.\n");
+  printf(
+      "  -lod                  encodes point clouds so that they can be "
+      "decoded at\n                        a lower level of detail.\n");
+  printf(
+      "  -subtree_points <value> splits point clouds into subtrees with at "
+      "most\n                        <value> points that can be skipped "
+      "when decoding\n                        a region of the point "
+      "cloud.\n");
   printf(
       "  --skip ATTRIBUTE_NAME skip a given attribute (NORMAL, TEX_COORD, "
       "GENERIC)\n");
@@ -240,6 +270,29 @@ int main(int argc, char **argv) {
       }
     } else if (!strcmp("-cl", argv[i]) && i < argc_check) {
       options.compression_level = StringToInt(argv[++i]);
+    } else if (!strcmp("-rans_states", argv[i]) && i < argc_check) {
+      options.num_rans_states = StringToInt(argv[++i]);
+      if (options.num_rans_states != 1 && options.num_rans_states != 4 &&
+          options.num_rans_states != 8) {
+        printf("Error: The number of rANS states must be 1, 4 or 8.\n");
+        return -1;
+      }
+    } else if (!strcmp("-threads", argv[i]) && i < argc_check) {
+      options.num_threads = StringToInt(argv[++i]);
+    } else if (!strcmp("-chunk_faces", argv[i]) && i < argc_check) {
+      options.max_chunk_faces = StringToInt(argv[++i]);
+      if (options.max_chunk_faces <= 0) {
+        printf("Error: The number of chunk faces must be positive.\n");
+        return -1;
+      }
+    } else if (!strcmp("-lod", argv[i])) {
+      options.kd_tree_level_order = true;
+    } else if (!strcmp("-subtree_points", argv[i]) && i < argc_check) {
+      options.kd_tree_subtree_points = StringToInt(argv[++i]);
+      if (options.kd_tree_subtree_points <= 0) {
+        printf("Error: The number of subtree points must be positive.\n");
+        return -1;
+      }
     } else if (!strcmp("--skip", argv[i]) && i < argc_check) {
       if (!strcmp("NORMAL", argv[i + 1])) {
         options.normals_quantization_bits = -1;
@@ -261,11 +314,13 @@ int main(int argc, char **argv) {
     return -1;
   }
 
+  draco::Options read_options;
+  read_options.SetBool("use_metadata", options.use_metadata);
+  read_options.SetInt("num_parsing_threads", options.num_threads);
   std::unique_ptr<draco::PointCloud> pc;
   draco::Mesh *mesh = nullptr;
   if (!options.is_point_cloud) {
-    auto maybe_mesh =
-        draco::ReadMeshFromFile(options.input, options.use_metadata);
+    auto maybe_mesh = draco::ReadMeshFromFile(options.input, read_options);
     if (!maybe_mesh.ok()) {
       printf("Failed loading the input mesh: %s.\n",
              maybe_mesh.status().error_msg());
@@ -274,7 +329,7 @@ int main(int argc, char **argv) {
     mesh = maybe_mesh.value().get();
     pc = std::move(maybe_mesh).value();
   } else {
-    auto maybe_pc = draco::ReadPointCloudFromFile(options.input);
+    auto maybe_pc = draco::ReadPointCloudFromFile(options.input, read_options);
     if (!maybe_pc.ok()) {
       printf("Failed loading the input point cloud: %s.\n",
              maybe_pc.status().error_msg());
@@ -347,6 +402,23 @@ int main(int argc, char **argv) {
                                      options.generic_quantization_bits);
   }
   encoder.SetSpeedOptions(speed, speed);
+  if (options.num_rans_states > 1) {
+    encoder.options().SetGlobalInt("num_rans_states", options.num_rans_states);
+  }
+  if (options.num_threads > 1) {
+    encoder.options().SetGlobalInt("num_encoding_threads",
+                                   options.num_threads);
+  }
+  if (options.max_chunk_faces > 0) {
+    encoder.SetEncodingMethod(draco::MESH_CHUNKED_ENCODING);
+    encoder.SetMaxChunkFaces(options.max_chunk_faces);
+  }
+  if (options.kd_tree_level_order) {
+    encoder.SetKdTreeLevelOrder(true);
+  }
+  if (options.kd_tree_subtree_points > 0) {
+    encoder.SetKdTreeSubtreePoints(options.kd_tree_subtree_points);
+  }
 
   if (options.output.empty()) {
     // Create a default output file by attaching .drc to the input file name.
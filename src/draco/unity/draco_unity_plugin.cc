@@ -63,85 +63,71 @@ int DecodeMeshForUnity(char *data, unsigned int length,
     return -2;
   }
 
-  draco::Decoder decoder;
-  auto statusor = decoder.DecodeMeshFromBuffer(&buffer);
-  if (!statusor.ok()) {
+  // Decode the mesh straight into the output arrays without materializing
+  // the dequantized attributes in a draco::Mesh first.
+  draco::MeshBufferDecoder decoder;
+  if (!decoder.Decode(&buffer).ok()) {
     return -3;
   }
-  std::unique_ptr<draco::Mesh> in_mesh = std::move(statusor).value();
 
   *tmp_mesh = new DracoToUnityMesh();
   DracoToUnityMesh *unity_mesh = *tmp_mesh;
-  unity_mesh->num_faces = in_mesh->num_faces();
-  unity_mesh->num_vertices = in_mesh->num_points();
+  unity_mesh->num_faces = decoder.num_faces();
+  unity_mesh->num_vertices = decoder.num_points();
 
-  unity_mesh->indices = new int[in_mesh->num_faces() * 3];
-  for (draco::FaceIndex face_id(0); face_id < in_mesh->num_faces(); ++face_id) {
-    const Mesh::Face &face = in_mesh->face(draco::FaceIndex(face_id));
-    memcpy(unity_mesh->indices + face_id.value() * 3,
-           reinterpret_cast<const int *>(face.data()), sizeof(int) * 3);
+  unity_mesh->indices = new int[decoder.num_faces() * 3];
+  if (!decoder.WriteIndices(draco::DT_UINT32, unity_mesh->indices).ok()) {
+    ReleaseUnityMesh(tmp_mesh);
+    return -8;
   }
 
   // TODO(zhafang): Add other attributes.
-  unity_mesh->position = new float[in_mesh->num_points() * 3];
-  const auto pos_att =
-      in_mesh->GetNamedAttribute(draco::GeometryAttribute::POSITION);
-  for (draco::PointIndex i(0); i < in_mesh->num_points(); ++i) {
-    const draco::AttributeValueIndex val_index = pos_att->mapped_index(i);
-    if (!pos_att->ConvertValue<float, 3>(
-            val_index, unity_mesh->position + i.value() * 3)) {
-      ReleaseUnityMesh(&unity_mesh);
-      return -8;
-    }
+  unity_mesh->position = new float[decoder.num_points() * 3];
+  if (!decoder
+           .WriteAttribute(draco::GeometryAttribute::POSITION,
+                           draco::DT_FLOAT32, 3, 0, unity_mesh->position)
+           .ok()) {
+    ReleaseUnityMesh(tmp_mesh);
+    return -8;
   }
   // Get normal attributes.
-  const auto normal_att =
-      in_mesh->GetNamedAttribute(draco::GeometryAttribute::NORMAL);
-  if (normal_att != nullptr) {
-    unity_mesh->normal = new float[in_mesh->num_points() * 3];
+  if (decoder.HasAttribute(draco::GeometryAttribute::NORMAL)) {
+    unity_mesh->normal = new float[decoder.num_points() * 3];
     unity_mesh->has_normal = true;
-    for (draco::PointIndex i(0); i < in_mesh->num_points(); ++i) {
-      const draco::AttributeValueIndex val_index = normal_att->mapped_index(i);
-      if (!normal_att->ConvertValue<float, 3>(
-              val_index, unity_mesh->normal + i.value() * 3)) {
-        ReleaseUnityMesh(&unity_mesh);
-        return -8;
-      }
+    if (!decoder
+             .WriteAttribute(draco::GeometryAttribute::NORMAL,
+                             draco::DT_FLOAT32, 3, 0, unity_mesh->normal)
+             .ok()) {
+      ReleaseUnityMesh(tmp_mesh);
+      return -8;
     }
   }
   // Get color attributes.
-  const auto color_att =
-      in_mesh->GetNamedAttribute(draco::GeometryAttribute::COLOR);
-  if (color_att != nullptr) {
-    unity_mesh->color = new float[in_mesh->num_points() * 3];
+  if (decoder.HasAttribute(draco::GeometryAttribute::COLOR)) {
+    unity_mesh->color = new float[decoder.num_points() * 3];
     unity_mesh->has_color = true;
-    for (draco::PointIndex i(0); i < in_mesh->num_points(); ++i) {
-      const draco::AttributeValueIndex val_index = color_att->mapped_index(i);
-      if (!color_att->ConvertValue<float, 3>(
-              val_index, unity_mesh->color + i.value() * 3)) {
-        ReleaseUnityMesh(&unity_mesh);
-        return -8;
-      }
+    if (!decoder
+             .WriteAttribute(draco::GeometryAttribute::COLOR,
+                             draco::DT_FLOAT32, 3, 0, unity_mesh->color)
+             .ok()) {
+      ReleaseUnityMesh(tmp_mesh);
+      return -8;
     }
   }
   // Get texture coordinates attributes.
-  const auto texcoord_att =
-      in_mesh->GetNamedAttribute(draco::GeometryAttribute::TEX_COORD);
-  if (texcoord_att != nullptr) {
-    unity_mesh->texcoord = new float[in_mesh->num_points() * 2];
+  if (decoder.HasAttribute(draco::GeometryAttribute::TEX_COORD)) {
+    unity_mesh->texcoord = new float[decoder.num_points() * 2];
     unity_mesh->has_texcoord = true;
-    for (draco::PointIndex i(0); i < in_mesh->num_points(); ++i) {
-      const draco::AttributeValueIndex val_index =
-          texcoord_att->mapped_index(i);
-      if (!texcoord_att->ConvertValue<float, 3>(
-              val_index, unity_mesh->texcoord + i.value() * 3)) {
-        ReleaseUnityMesh(&unity_mesh);
-        return -8;
-      }
+    if (!decoder
+             .WriteAttribute(draco::GeometryAttribute::TEX_COORD,
+                             draco::DT_FLOAT32, 2, 0, unity_mesh->texcoord)
+             .ok()) {
+      ReleaseUnityMesh(tmp_mesh);
+      return -8;
     }
   }
 
-  return in_mesh->num_faces();
+  return decoder.num_faces();
 }
 
 }  // namespace draco